@@ -0,0 +1,55 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_BUFFER_TEXT_WRITER_H
+#define LIBSHADERTRAP_BUFFER_TEXT_WRITER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <vector>
+
+#include "libshadertrap/command_dump_buffer_text.h"
+
+namespace shadertrap {
+
+// Called by WriteBufferText with each chunk of |size| characters of text at
+// |text|, which is only valid during the call. Returns false if the chunk could
+// not be written.
+using TextChunkConsumer = std::function<bool(const char* text, size_t size)>;
+
+// Writes the buffer contents in |data| as text, as described by
+// |format_entries|, passing it to |consume_chunk| in chunks of about 1 MiB.
+// Values are formatted directly from |data| into the chunk, so the text is
+// never held in memory whole. Integers are written in decimal. Each float is
+// written with the fewest significant digits, from 6 to 9, that read back as
+// the same value, so that values that 6 digits represent exactly are written
+// as they would be by an output stream. Returns false if a chunk could not be
+// written, in which case no further chunks are passed on.
+bool WriteBufferText(
+    const uint8_t* data,
+    const std::vector<CommandDumpBufferText::FormatEntry>& format_entries,
+    const TextChunkConsumer& consume_chunk);
+
+// Writes the buffer contents in |data| to |stream| as text, as above. Returns
+// false if writing to |stream| fails.
+bool WriteBufferText(
+    const uint8_t* data,
+    const std::vector<CommandDumpBufferText::FormatEntry>& format_entries,
+    std::ostream* stream);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_BUFFER_TEXT_WRITER_H
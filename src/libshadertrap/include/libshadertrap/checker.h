@@ -19,11 +19,16 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "libshadertrap/api_version.h"
+#include "libshadertrap/command_assert_buffer_hash.h"
 #include "libshadertrap/command_assert_equal.h"
+#include "libshadertrap/command_assert_matches_image.h"
 #include "libshadertrap/command_assert_pixels.h"
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
 #include "libshadertrap/command_assert_similar_emd_histogram.h"
+#include "libshadertrap/command_assert_similar_image.h"
 #include "libshadertrap/command_bind_sampler.h"
 #include "libshadertrap/command_bind_shader_storage_buffer.h"
 #include "libshadertrap/command_bind_texture.h"
@@ -34,15 +39,18 @@
 #include "libshadertrap/command_create_program.h"
 #include "libshadertrap/command_create_renderbuffer.h"
 #include "libshadertrap/command_create_sampler.h"
+#include "libshadertrap/command_create_texture_2d.h"
 #include "libshadertrap/command_declare_shader.h"
 #include "libshadertrap/command_dump_buffer_binary.h"
 #include "libshadertrap/command_dump_buffer_text.h"
 #include "libshadertrap/command_dump_renderbuffer.h"
 #include "libshadertrap/command_run_compute.h"
+#include "libshadertrap/command_run_compute_indirect.h"
 #include "libshadertrap/command_run_graphics.h"
 #include "libshadertrap/command_set_sampler_parameter.h"
 #include "libshadertrap/command_set_texture_parameter.h"
 #include "libshadertrap/command_set_uniform.h"
+#include "libshadertrap/command_update_buffer.h"
 #include "libshadertrap/command_visitor.h"
 #include "libshadertrap/glslang.h"
 #include "libshadertrap/message_consumer.h"
@@ -54,13 +62,25 @@ class Checker : public CommandVisitor {
  public:
   Checker(MessageConsumer* message_consumer, ApiVersion api_version);
 
+  bool VisitAssertBufferHash(
+      CommandAssertBufferHash* assert_buffer_hash) override;
+
   bool VisitAssertEqual(CommandAssertEqual* assert_equal) override;
 
+  bool VisitAssertMatchesImage(
+      CommandAssertMatchesImage* assert_matches_image) override;
+
   bool VisitAssertPixels(CommandAssertPixels* assert_pixels) override;
 
+  bool VisitAssertRenderbufferHash(
+      CommandAssertRenderbufferHash* assert_renderbuffer_hash) override;
+
   bool VisitAssertSimilarEmdHistogram(
       CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) override;
 
+  bool VisitAssertSimilarImage(
+      CommandAssertSimilarImage* assert_similar_image) override;
+
   bool VisitBindSampler(CommandBindSampler* bind_sampler) override;
 
   bool VisitBindShaderStorageBuffer(
@@ -85,6 +105,9 @@ class Checker : public CommandVisitor {
   bool VisitCreateRenderbuffer(
       CommandCreateRenderbuffer* create_renderbuffer) override;
 
+  bool VisitCreateTexture2D(
+      CommandCreateTexture2D* create_texture_2d) override;
+
   bool VisitDeclareShader(CommandDeclareShader* declare_shader) override;
 
   bool VisitDumpBufferBinary(
@@ -97,6 +120,9 @@ class Checker : public CommandVisitor {
 
   bool VisitRunCompute(CommandRunCompute* run_compute) override;
 
+  bool VisitRunComputeIndirect(
+      CommandRunComputeIndirect* run_compute_indirect) override;
+
   bool VisitRunGraphics(CommandRunGraphics* run_graphics) override;
 
   bool VisitSetSamplerParameter(
@@ -107,6 +133,8 @@ class Checker : public CommandVisitor {
 
   bool VisitSetUniform(CommandSetUniform* set_uniform) override;
 
+  bool VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) override;
+
   bool CheckIdentifierIsFresh(const Token& identifier_token);
 
  private:
@@ -124,6 +152,28 @@ class Checker : public CommandVisitor {
   bool CheckRenderbufferDimensionsMatch(const Token& renderbuffer_token_1,
                                         const Token& renderbuffer_token_2);
 
+  // Returns true if and only if |program_identifier_token| refers to a compute
+  // program, reporting an error otherwise.
+  bool CheckIsComputeProgram(const Token& program_identifier_token);
+
+  // Requires that the indirect data buffer of |command_run_graphics| exists
+  // and holds a complete, aligned set of draw parameters at each offset.
+  bool CheckIndirectDrawParameters(
+      const CommandRunGraphics& command_run_graphics);
+
+  // Requires that |format_entries| is non-empty. Returns true if and only if
+  // every entry has a valid count and the entries together cover exactly the
+  // bytes of |buffer|.
+  bool CheckFormatEntries(
+      const std::vector<CommandDumpBufferText::FormatEntry>& format_entries,
+      const CommandCreateBuffer& buffer);
+
+  // Returns true if and only if the API version being checked is at least
+  // |gl_version| when working with OpenGL, or at least |gles_version| when
+  // working with OpenGL ES.
+  bool ApiVersionIsAtLeast(const ApiVersion& gl_version,
+                           const ApiVersion& gles_version) const;
+
   MessageConsumer* message_consumer_;
   ApiVersion api_version_;
   std::unordered_map<std::string, const Token&> used_identifiers_;
@@ -134,8 +184,8 @@ class Checker : public CommandVisitor {
   std::unordered_map<std::string, CommandCreateRenderbuffer*>
       created_renderbuffers_;
   std::unordered_map<std::string, CommandCreateSampler*> created_samplers_;
-  std::unordered_map<std::string, CommandCreateEmptyTexture2D*>
-      created_textures_;
+  // Textures are created by CREATE_EMPTY_TEXTURE_2D and CREATE_TEXTURE_2D.
+  std::unordered_map<std::string, Command*> created_textures_;
   std::unordered_map<std::string, std::unique_ptr<glslang::TShader>>
       glslang_shaders_;
   std::unordered_map<std::string, std::unique_ptr<glslang::TProgram>>
@@ -0,0 +1,66 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMMAND_ASSERT_BUFFER_HASH_H
+#define LIBSHADERTRAP_COMMAND_ASSERT_BUFFER_HASH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/command.h"
+#include "libshadertrap/command_dump_buffer_text.h"
+#include "libshadertrap/token.h"
+
+namespace shadertrap {
+
+class CommandAssertBufferHash : public Command {
+ public:
+  // If |format_entries| is non-empty, the bytes covered by its SKIP_BYTES
+  // entries are left out of the hash; its other entries only serve to
+  // describe the sizes of the bytes that are hashed.
+  CommandAssertBufferHash(
+      std::unique_ptr<Token> start_token,
+      std::unique_ptr<Token> buffer_identifier,
+      std::vector<CommandDumpBufferText::FormatEntry> format_entries,
+      std::unique_ptr<Token> expected_hash_token, uint64_t expected_hash);
+
+  bool Accept(CommandVisitor* visitor) override;
+
+  const std::string& GetBufferIdentifier() const {
+    return buffer_identifier_->GetText();
+  }
+
+  const Token& GetBufferIdentifierToken() const { return *buffer_identifier_; }
+
+  const std::vector<CommandDumpBufferText::FormatEntry>& GetFormatEntries()
+      const {
+    return format_entries_;
+  }
+
+  const Token& GetExpectedHashToken() const { return *expected_hash_token_; }
+
+  uint64_t GetExpectedHash() const { return expected_hash_; }
+
+ private:
+  std::unique_ptr<Token> buffer_identifier_;
+  std::vector<CommandDumpBufferText::FormatEntry> format_entries_;
+  std::unique_ptr<Token> expected_hash_token_;
+  uint64_t expected_hash_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMMAND_ASSERT_BUFFER_HASH_H
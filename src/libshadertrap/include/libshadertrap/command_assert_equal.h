@@ -21,6 +21,7 @@
 #include <vector>
 
 #include "libshadertrap/command.h"
+#include "libshadertrap/float_compare.h"
 #include "libshadertrap/token.h"
 
 namespace shadertrap {
@@ -34,16 +35,29 @@ class CommandAssertEqual : public Command {
     size_t count;
   };
   // Constructor used for an assertion about the equality of two buffers.
+  // |tolerance_token| is null if float entries must be bitwise equal, and is
+  // otherwise the TOLERANCE token, with |tolerance| holding the tolerances.
   CommandAssertEqual(std::unique_ptr<Token> start_token,
                      std::unique_ptr<Token> argument_identifier_1,
                      std::unique_ptr<Token> argument_identifier_2,
-                     std::vector<FormatEntry> format_entries);
+                     std::vector<FormatEntry> format_entries,
+                     std::unique_ptr<Token> tolerance_token,
+                     const FloatTolerance& tolerance);
 
   // Constructor used for an assertion about the equality of two renderbuffers.
   CommandAssertEqual(std::unique_ptr<Token> start_token,
                      std::unique_ptr<Token> argument_identifier_1,
                      std::unique_ptr<Token> argument_identifier_2);
 
+  // Constructor used for an assertion that the contents of a buffer are equal
+  // to those of a file.
+  CommandAssertEqual(std::unique_ptr<Token> start_token,
+                     std::unique_ptr<Token> argument_identifier_1,
+                     std::vector<FormatEntry> format_entries,
+                     std::unique_ptr<Token> filename,
+                     std::unique_ptr<Token> tolerance_token,
+                     const FloatTolerance& tolerance);
+
   bool Accept(CommandVisitor* visitor) override;
 
   bool GetArgumentsAreRenderbuffers() const {
@@ -58,6 +72,14 @@ class CommandAssertEqual : public Command {
     return *argument_identifier_1_;
   }
 
+  // True if the buffer is compared with a file rather than with a second
+  // buffer, in which case there is no second argument identifier.
+  bool GetComparesWithFile() const { return filename_ != nullptr; }
+
+  const std::string& GetFilename() const { return filename_->GetText(); }
+
+  const Token& GetFilenameToken() const { return *filename_; }
+
   const std::string& GetArgumentIdentifier2() const {
     return argument_identifier_2_->GetText();
   }
@@ -68,12 +90,23 @@ class CommandAssertEqual : public Command {
 
   std::vector<FormatEntry>& GetFormatEntries() { return format_entries_; }
 
+  // True if float entries are compared within a tolerance, rather than
+  // bitwise.
+  bool HasTolerance() const { return tolerance_token_ != nullptr; }
+
+  const Token& GetToleranceToken() const { return *tolerance_token_; }
+
+  const FloatTolerance& GetTolerance() const { return tolerance_; }
+
  private:
   // true if arguments are renderbuffers, false if arguments are buffers
   bool arguments_are_renderbuffers_;
   std::unique_ptr<Token> argument_identifier_1_;
   std::unique_ptr<Token> argument_identifier_2_;
   std::vector<FormatEntry> format_entries_;
+  std::unique_ptr<Token> filename_;
+  std::unique_ptr<Token> tolerance_token_;
+  FloatTolerance tolerance_;
 };
 
 }  // namespace shadertrap
@@ -0,0 +1,56 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMMAND_ASSERT_RENDERBUFFER_HASH_H
+#define LIBSHADERTRAP_COMMAND_ASSERT_RENDERBUFFER_HASH_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "libshadertrap/command.h"
+#include "libshadertrap/token.h"
+
+namespace shadertrap {
+
+class CommandAssertRenderbufferHash : public Command {
+ public:
+  CommandAssertRenderbufferHash(std::unique_ptr<Token> start_token,
+                                std::unique_ptr<Token> renderbuffer_identifier,
+                                std::unique_ptr<Token> expected_hash_token,
+                                uint64_t expected_hash);
+
+  bool Accept(CommandVisitor* visitor) override;
+
+  const std::string& GetRenderbufferIdentifier() const {
+    return renderbuffer_identifier_->GetText();
+  }
+
+  const Token& GetRenderbufferIdentifierToken() const {
+    return *renderbuffer_identifier_;
+  }
+
+  const Token& GetExpectedHashToken() const { return *expected_hash_token_; }
+
+  uint64_t GetExpectedHash() const { return expected_hash_; }
+
+ private:
+  std::unique_ptr<Token> renderbuffer_identifier_;
+  std::unique_ptr<Token> expected_hash_token_;
+  uint64_t expected_hash_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMMAND_ASSERT_RENDERBUFFER_HASH_H
@@ -0,0 +1,98 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMMAND_ASSERT_SIMILAR_IMAGE_H
+#define LIBSHADERTRAP_COMMAND_ASSERT_SIMILAR_IMAGE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "libshadertrap/command.h"
+#include "libshadertrap/token.h"
+
+namespace shadertrap {
+
+class CommandAssertSimilarImage : public Command {
+ public:
+  // Each of |tolerance_token|, |max_differing_fraction_token|,
+  // |min_ssim_token| and |min_psnr_token| is the token of the corresponding
+  // value, or null if that value is not specified. Differing pixels are only
+  // counted if the channel tolerance or the maximum differing fraction is
+  // specified; the other defaults to 0.
+  CommandAssertSimilarImage(
+      std::unique_ptr<Token> start_token,
+      std::unique_ptr<Token> renderbuffer_identifier_1,
+      std::unique_ptr<Token> renderbuffer_identifier_2,
+      std::unique_ptr<Token> tolerance_token, uint8_t channel_tolerance,
+      std::unique_ptr<Token> max_differing_fraction_token,
+      float max_differing_fraction, std::unique_ptr<Token> min_ssim_token,
+      float min_ssim, std::unique_ptr<Token> min_psnr_token, float min_psnr);
+
+  bool Accept(CommandVisitor* visitor) override;
+
+  const std::string& GetRenderbufferIdentifier1() const {
+    return renderbuffer_identifier_1_->GetText();
+  }
+
+  const Token& GetRenderbufferIdentifier1Token() const {
+    return *renderbuffer_identifier_1_;
+  }
+
+  const std::string& GetRenderbufferIdentifier2() const {
+    return renderbuffer_identifier_2_->GetText();
+  }
+
+  const Token& GetRenderbufferIdentifier2Token() const {
+    return *renderbuffer_identifier_2_;
+  }
+
+  bool CountsDifferingPixels() const {
+    return tolerance_token_ != nullptr ||
+           max_differing_fraction_token_ != nullptr;
+  }
+
+  // The largest difference allowed between corresponding channels of a pixel
+  // that does not count as differing.
+  uint8_t GetChannelTolerance() const { return channel_tolerance_; }
+
+  // The largest allowed fraction of differing pixels.
+  float GetMaxDifferingFraction() const { return max_differing_fraction_; }
+
+  bool HasMinSsim() const { return min_ssim_token_ != nullptr; }
+
+  const Token& GetMinSsimToken() const { return *min_ssim_token_; }
+
+  float GetMinSsim() const { return min_ssim_; }
+
+  bool HasMinPsnr() const { return min_psnr_token_ != nullptr; }
+
+  float GetMinPsnr() const { return min_psnr_; }
+
+ private:
+  std::unique_ptr<Token> renderbuffer_identifier_1_;
+  std::unique_ptr<Token> renderbuffer_identifier_2_;
+  std::unique_ptr<Token> tolerance_token_;
+  uint8_t channel_tolerance_;
+  std::unique_ptr<Token> max_differing_fraction_token_;
+  float max_differing_fraction_;
+  std::unique_ptr<Token> min_ssim_token_;
+  float min_ssim_;
+  std::unique_ptr<Token> min_psnr_token_;
+  float min_psnr_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMMAND_ASSERT_SIMILAR_IMAGE_H
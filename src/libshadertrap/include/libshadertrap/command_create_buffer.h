@@ -29,9 +29,17 @@ namespace shadertrap {
 
 class CommandCreateBuffer : public Command {
  public:
+  // How the buffer's contents are expected to be used, which is passed on to
+  // the driver as a hint to guide where the buffer is allocated:
+  // - kStatic: set once and used many times by shaders
+  // - kDynamic: modified repeatedly and used many times by shaders
+  // - kStream: set once and used a few times by shaders
+  // - kRead: written by shaders and read back repeatedly
+  enum class Usage { kStatic, kDynamic, kStream, kRead };
+
   CommandCreateBuffer(std::unique_ptr<Token> start_token,
                       std::unique_ptr<Token> result_identifier,
-                      const std::vector<ValuesSegment>& values);
+                      const std::vector<ValuesSegment>& values, Usage usage);
 
   bool Accept(CommandVisitor* visitor) override;
 
@@ -45,9 +53,12 @@ class CommandCreateBuffer : public Command {
 
   const std::vector<uint8_t>& GetData() const { return data_; }
 
+  Usage GetUsage() const { return usage_; }
+
  private:
   std::unique_ptr<Token> result_identifier_;
   std::vector<uint8_t> data_;
+  Usage usage_;
 };
 
 }  // namespace shadertrap
@@ -0,0 +1,93 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMMAND_CREATE_TEXTURE_2D_H
+#define LIBSHADERTRAP_COMMAND_CREATE_TEXTURE_2D_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/command.h"
+#include "libshadertrap/token.h"
+#include "libshadertrap/values_segment.h"
+
+namespace shadertrap {
+
+class CommandCreateTexture2D : public Command {
+ public:
+  enum class Format { kRgba8, kR8, kRg16f, kRgba32f, kR32ui };
+
+  // Creates a |width| x |height| texture of the given |format|, initialized
+  // from |values|, whose rows are ordered bottom-to-top.
+  CommandCreateTexture2D(std::unique_ptr<Token> start_token,
+                         std::unique_ptr<Token> result_identifier, size_t width,
+                         size_t height, Format format,
+                         const std::vector<ValuesSegment>& values,
+                         bool generate_mipmaps);
+
+  // Creates an RGBA8 texture initialized from the PNG image named by
+  // |init_file|, whose dimensions are those of the image.
+  CommandCreateTexture2D(std::unique_ptr<Token> start_token,
+                         std::unique_ptr<Token> result_identifier,
+                         std::unique_ptr<Token> init_file,
+                         bool generate_mipmaps);
+
+  bool Accept(CommandVisitor* visitor) override;
+
+  // Returns the number of bytes of initial values that a script provides for
+  // each texel of a texture with the given |format|. Half-float formats are
+  // initialized with 32-bit floats.
+  static size_t GetTexelDataSizeBytes(Format format);
+
+  // Returns the name of |format| as written in scripts.
+  static std::string FormatToString(Format format);
+
+  const std::string& GetResultIdentifier() const {
+    return result_identifier_->GetText();
+  }
+
+  const Token& GetResultIdentifierToken() const { return *result_identifier_; }
+
+  bool HasInitFile() const { return init_file_ != nullptr; }
+
+  const std::string& GetInitFile() const { return init_file_->GetText(); }
+
+  // Only meaningful when the texture is not initialized from a file.
+  size_t GetWidth() const { return width_; }
+
+  // Only meaningful when the texture is not initialized from a file.
+  size_t GetHeight() const { return height_; }
+
+  Format GetFormat() const { return format_; }
+
+  const std::vector<uint8_t>& GetData() const { return data_; }
+
+  bool GetGenerateMipmaps() const { return generate_mipmaps_; }
+
+ private:
+  std::unique_ptr<Token> result_identifier_;
+  std::unique_ptr<Token> init_file_;
+  size_t width_;
+  size_t height_;
+  Format format_;
+  std::vector<uint8_t> data_;
+  bool generate_mipmaps_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMMAND_CREATE_TEXTURE_2D_H
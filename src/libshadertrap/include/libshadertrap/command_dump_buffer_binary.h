@@ -27,7 +27,7 @@ class CommandDumpBufferBinary : public Command {
  public:
   CommandDumpBufferBinary(std::unique_ptr<Token> start_token,
                           std::unique_ptr<Token> buffer_identifier,
-                          std::unique_ptr<Token> filename);
+                          std::unique_ptr<Token> filename, bool compressed);
 
   bool Accept(CommandVisitor* visitor) override;
 
@@ -41,9 +41,14 @@ class CommandDumpBufferBinary : public Command {
 
   const Token& GetFilenameToken() const { return *filename_; }
 
+  // If this holds, the buffer is written in the chunked zlib format described
+  // in compressed_buffer.h rather than as raw bytes.
+  bool GetCompressed() const { return compressed_; }
+
  private:
   std::unique_ptr<Token> buffer_identifier_;
   std::unique_ptr<Token> filename_;
+  bool compressed_;
 };
 
 }  // namespace shadertrap
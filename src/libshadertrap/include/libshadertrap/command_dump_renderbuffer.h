@@ -19,6 +19,7 @@
 #include <string>
 
 #include "libshadertrap/command.h"
+#include "libshadertrap/image_encoder.h"
 #include "libshadertrap/token.h"
 
 namespace shadertrap {
@@ -27,7 +28,8 @@ class CommandDumpRenderbuffer : public Command {
  public:
   CommandDumpRenderbuffer(std::unique_ptr<Token> start_token,
                           std::unique_ptr<Token> renderbuffer_identifier,
-                          std::unique_ptr<Token> filename);
+                          std::unique_ptr<Token> filename, ImageFormat format,
+                          int compression_level);
 
   bool Accept(CommandVisitor* visitor) override;
 
@@ -43,9 +45,17 @@ class CommandDumpRenderbuffer : public Command {
 
   const Token& GetFilenameToken() const { return *filename_; }
 
+  ImageFormat GetFormat() const { return format_; }
+
+  // Either kDefaultPngCompressionLevel, or a PNG compression level between 0
+  // and kMaxPngCompressionLevel.
+  int GetCompressionLevel() const { return compression_level_; }
+
  private:
   std::unique_ptr<Token> renderbuffer_identifier_;
   std::unique_ptr<Token> filename_;
+  ImageFormat format_;
+  int compression_level_;
 };
 
 }  // namespace shadertrap
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "libshadertrap/command.h"
 #include "libshadertrap/token.h"
@@ -28,10 +29,17 @@ class CommandRunCompute : public Command {
  public:
   enum class Topology { kTriangles };
 
+  // The number of work groups in each dimension of a single dispatch.
+  struct NumGroups {
+    size_t x;
+    size_t y;
+    size_t z;
+  };
+
+  // The dispatches in |num_groups| are issued back-to-back, in order.
   CommandRunCompute(std::unique_ptr<Token> start_token,
                     std::unique_ptr<Token> program_identifier,
-                    size_t num_groups_x, size_t num_groups_y,
-                    size_t num_groups_z);
+                    std::vector<NumGroups> num_groups);
 
   bool Accept(CommandVisitor* visitor) override;
 
@@ -43,17 +51,11 @@ class CommandRunCompute : public Command {
     return *program_identifier_;
   }
 
-  size_t GetNumGroupsX() const { return num_groups_x_; }
-
-  size_t GetNumGroupsY() const { return num_groups_y_; }
-
-  size_t GetNumGroupsZ() const { return num_groups_z_; }
+  const std::vector<NumGroups>& GetNumGroups() const { return num_groups_; }
 
  private:
   std::unique_ptr<Token> program_identifier_;
-  size_t num_groups_x_;
-  size_t num_groups_y_;
-  size_t num_groups_z_;
+  std::vector<NumGroups> num_groups_;
 };
 
 }  // namespace shadertrap
@@ -0,0 +1,70 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMMAND_RUN_COMPUTE_INDIRECT_H
+#define LIBSHADERTRAP_COMMAND_RUN_COMPUTE_INDIRECT_H
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/command.h"
+#include "libshadertrap/token.h"
+
+namespace shadertrap {
+
+class CommandRunComputeIndirect : public Command {
+ public:
+  // One dispatch is issued for each offset in |offsets_bytes|, back-to-back
+  // and in order, with the numbers of work groups read from three consecutive
+  // uint values at that offset in the buffer.
+  CommandRunComputeIndirect(std::unique_ptr<Token> start_token,
+                            std::unique_ptr<Token> program_identifier,
+                            std::unique_ptr<Token> buffer_identifier,
+                            std::vector<size_t> offsets_bytes,
+                            std::vector<std::unique_ptr<Token>> offset_tokens);
+
+  bool Accept(CommandVisitor* visitor) override;
+
+  const std::string& GetProgramIdentifier() const {
+    return program_identifier_->GetText();
+  }
+
+  const Token& GetProgramIdentifierToken() const {
+    return *program_identifier_;
+  }
+
+  const std::string& GetBufferIdentifier() const {
+    return buffer_identifier_->GetText();
+  }
+
+  const Token& GetBufferIdentifierToken() const { return *buffer_identifier_; }
+
+  const std::vector<size_t>& GetOffsetsBytes() const { return offsets_bytes_; }
+
+  const Token& GetOffsetToken(size_t index) const {
+    return *offset_tokens_[index];
+  }
+
+ private:
+  std::unique_ptr<Token> program_identifier_;
+  std::unique_ptr<Token> buffer_identifier_;
+  std::vector<size_t> offsets_bytes_;
+  std::vector<std::unique_ptr<Token>> offset_tokens_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMMAND_RUN_COMPUTE_INDIRECT_H
@@ -19,6 +19,7 @@
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "libshadertrap/command.h"
 #include "libshadertrap/token.h"
@@ -34,7 +35,11 @@ class CommandRunGraphics : public Command {
       std::unique_ptr<Token> start_token,
       std::unique_ptr<Token> program_identifier,
       std::unordered_map<size_t, VertexAttributeInfo> vertex_data,
-      std::unique_ptr<Token> index_data_buffer_identifier, size_t vertex_count,
+      std::unique_ptr<Token> index_data_buffer_identifier,
+      size_t index_size_bytes, size_t vertex_count, size_t instance_count,
+      std::unique_ptr<Token> indirect_data_buffer_identifier,
+      std::vector<size_t> indirect_offsets_bytes,
+      std::vector<std::unique_ptr<Token>> indirect_offset_tokens,
       Topology topology,
       std::unordered_map<size_t, std::unique_ptr<Token>>
           framebuffer_attachments);
@@ -53,6 +58,10 @@ class CommandRunGraphics : public Command {
     return vertex_data_;
   }
 
+  // Returns true if vertices are fetched through an index buffer, and false if
+  // they are fetched in order.
+  bool HasIndexData() const { return index_data_buffer_identifier_ != nullptr; }
+
   const std::string& GetIndexDataBufferIdentifier() const {
     return index_data_buffer_identifier_->GetText();
   }
@@ -61,8 +70,37 @@ class CommandRunGraphics : public Command {
     return *index_data_buffer_identifier_;
   }
 
+  // The size of each index in the index buffer: 1, 2 or 4.
+  size_t GetIndexSizeBytes() const { return index_size_bytes_; }
+
+  // Only meaningful if the draw is not indirect.
   size_t GetVertexCount() const { return vertex_count_; }
 
+  // Only meaningful if the draw is not indirect.
+  size_t GetInstanceCount() const { return instance_count_; }
+
+  // Returns true if the draw parameters are read from a buffer, in which case
+  // one draw is issued per offset into that buffer.
+  bool HasIndirectData() const {
+    return indirect_data_buffer_identifier_ != nullptr;
+  }
+
+  const std::string& GetIndirectDataBufferIdentifier() const {
+    return indirect_data_buffer_identifier_->GetText();
+  }
+
+  const Token& GetIndirectDataBufferIdentifierToken() const {
+    return *indirect_data_buffer_identifier_;
+  }
+
+  const std::vector<size_t>& GetIndirectOffsetsBytes() const {
+    return indirect_offsets_bytes_;
+  }
+
+  const Token& GetIndirectOffsetToken(size_t index) const {
+    return *indirect_offset_tokens_[index];
+  }
+
   Topology GetTopology() const { return topology_; }
 
   const std::unordered_map<size_t, std::unique_ptr<Token>>&
@@ -74,7 +112,12 @@ class CommandRunGraphics : public Command {
   std::unique_ptr<Token> program_identifier_;
   std::unordered_map<size_t, VertexAttributeInfo> vertex_data_;
   std::unique_ptr<Token> index_data_buffer_identifier_;
+  size_t index_size_bytes_;
   size_t vertex_count_;
+  size_t instance_count_;
+  std::unique_ptr<Token> indirect_data_buffer_identifier_;
+  std::vector<size_t> indirect_offsets_bytes_;
+  std::vector<std::unique_ptr<Token>> indirect_offset_tokens_;
   Topology topology_;
   std::unordered_map<size_t, std::unique_ptr<Token>> framebuffer_attachments_;
 };
@@ -0,0 +1,59 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMMAND_UPDATE_BUFFER_H
+#define LIBSHADERTRAP_COMMAND_UPDATE_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/command.h"
+#include "libshadertrap/token.h"
+#include "libshadertrap/values_segment.h"
+
+namespace shadertrap {
+
+class CommandUpdateBuffer : public Command {
+ public:
+  CommandUpdateBuffer(std::unique_ptr<Token> start_token,
+                      std::unique_ptr<Token> buffer_identifier,
+                      size_t offset_bytes,
+                      const std::vector<ValuesSegment>& values);
+
+  bool Accept(CommandVisitor* visitor) override;
+
+  const std::string& GetBufferIdentifier() const {
+    return buffer_identifier_->GetText();
+  }
+
+  const Token& GetBufferIdentifierToken() const { return *buffer_identifier_; }
+
+  size_t GetOffsetBytes() const { return offset_bytes_; }
+
+  size_t GetSizeBytes() const { return data_.size(); }
+
+  const std::vector<uint8_t>& GetData() const { return data_; }
+
+ private:
+  std::unique_ptr<Token> buffer_identifier_;
+  size_t offset_bytes_;
+  std::vector<uint8_t> data_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMMAND_UPDATE_BUFFER_H
@@ -15,9 +15,13 @@
 #ifndef LIBSHADERTRAP_COMMAND_VISITOR_H
 #define LIBSHADERTRAP_COMMAND_VISITOR_H
 
+#include "libshadertrap/command_assert_buffer_hash.h"
 #include "libshadertrap/command_assert_equal.h"
+#include "libshadertrap/command_assert_matches_image.h"
 #include "libshadertrap/command_assert_pixels.h"
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
 #include "libshadertrap/command_assert_similar_emd_histogram.h"
+#include "libshadertrap/command_assert_similar_image.h"
 #include "libshadertrap/command_bind_sampler.h"
 #include "libshadertrap/command_bind_shader_storage_buffer.h"
 #include "libshadertrap/command_bind_texture.h"
@@ -28,15 +32,18 @@
 #include "libshadertrap/command_create_program.h"
 #include "libshadertrap/command_create_renderbuffer.h"
 #include "libshadertrap/command_create_sampler.h"
+#include "libshadertrap/command_create_texture_2d.h"
 #include "libshadertrap/command_declare_shader.h"
 #include "libshadertrap/command_dump_buffer_binary.h"
 #include "libshadertrap/command_dump_buffer_text.h"
 #include "libshadertrap/command_dump_renderbuffer.h"
 #include "libshadertrap/command_run_compute.h"
+#include "libshadertrap/command_run_compute_indirect.h"
 #include "libshadertrap/command_run_graphics.h"
 #include "libshadertrap/command_set_sampler_parameter.h"
 #include "libshadertrap/command_set_texture_parameter.h"
 #include "libshadertrap/command_set_uniform.h"
+#include "libshadertrap/command_update_buffer.h"
 #include "libshadertrap/shadertrap_program.h"
 
 namespace shadertrap {
@@ -57,13 +64,25 @@ class CommandVisitor {
 
   bool VisitCommands(ShaderTrapProgram* shader_trap_program);
 
+  virtual bool VisitAssertBufferHash(
+      CommandAssertBufferHash* assert_buffer_hash) = 0;
+
   virtual bool VisitAssertEqual(CommandAssertEqual* assert_equal) = 0;
 
+  virtual bool VisitAssertMatchesImage(
+      CommandAssertMatchesImage* assert_matches_image) = 0;
+
   virtual bool VisitAssertPixels(CommandAssertPixels* assert_pixels) = 0;
 
+  virtual bool VisitAssertRenderbufferHash(
+      CommandAssertRenderbufferHash* assert_renderbuffer_hash) = 0;
+
   virtual bool VisitAssertSimilarEmdHistogram(
       CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) = 0;
 
+  virtual bool VisitAssertSimilarImage(
+      CommandAssertSimilarImage* assert_similar_image) = 0;
+
   virtual bool VisitBindSampler(CommandBindSampler* bind_sampler) = 0;
 
   virtual bool VisitBindShaderStorageBuffer(
@@ -88,6 +107,9 @@ class CommandVisitor {
   virtual bool VisitCreateRenderbuffer(
       CommandCreateRenderbuffer* create_renderbuffer) = 0;
 
+  virtual bool VisitCreateTexture2D(
+      CommandCreateTexture2D* create_texture_2d) = 0;
+
   virtual bool VisitDeclareShader(CommandDeclareShader* declare_shader) = 0;
 
   virtual bool VisitDumpBufferBinary(
@@ -100,6 +122,9 @@ class CommandVisitor {
 
   virtual bool VisitRunCompute(CommandRunCompute* run_compute) = 0;
 
+  virtual bool VisitRunComputeIndirect(
+      CommandRunComputeIndirect* run_compute_indirect) = 0;
+
   virtual bool VisitRunGraphics(CommandRunGraphics* run_graphics) = 0;
 
   virtual bool VisitSetSamplerParameter(
@@ -109,6 +134,86 @@ class CommandVisitor {
       CommandSetTextureParameter* set_texture_parameter) = 0;
 
   virtual bool VisitSetUniform(CommandSetUniform* set_uniform) = 0;
+
+  virtual bool VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) = 0;
+};
+
+// A visitor that accepts every command without doing anything. Passes that
+// only care about a few kinds of command, such as those that plan how a
+// program is executed, derive from this and override just those.
+class DefaultCommandVisitor : public CommandVisitor {
+ public:
+  bool VisitAssertBufferHash(
+      CommandAssertBufferHash* assert_buffer_hash) override;
+
+  bool VisitAssertEqual(CommandAssertEqual* assert_equal) override;
+
+  bool VisitAssertMatchesImage(
+      CommandAssertMatchesImage* assert_matches_image) override;
+
+  bool VisitAssertPixels(CommandAssertPixels* assert_pixels) override;
+
+  bool VisitAssertRenderbufferHash(
+      CommandAssertRenderbufferHash* assert_renderbuffer_hash) override;
+
+  bool VisitAssertSimilarEmdHistogram(
+      CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) override;
+
+  bool VisitAssertSimilarImage(
+      CommandAssertSimilarImage* assert_similar_image) override;
+
+  bool VisitBindSampler(CommandBindSampler* bind_sampler) override;
+
+  bool VisitBindShaderStorageBuffer(
+      CommandBindShaderStorageBuffer* bind_shader_storage_buffer) override;
+
+  bool VisitBindTexture(CommandBindTexture* bind_texture) override;
+
+  bool VisitBindUniformBuffer(
+      CommandBindUniformBuffer* bind_uniform_buffer) override;
+
+  bool VisitCompileShader(CommandCompileShader* compile_shader) override;
+
+  bool VisitCreateBuffer(CommandCreateBuffer* create_buffer) override;
+
+  bool VisitCreateSampler(CommandCreateSampler* create_sampler) override;
+
+  bool VisitCreateEmptyTexture2D(
+      CommandCreateEmptyTexture2D* create_empty_texture_2d) override;
+
+  bool VisitCreateProgram(CommandCreateProgram* create_program) override;
+
+  bool VisitCreateRenderbuffer(
+      CommandCreateRenderbuffer* create_renderbuffer) override;
+
+  bool VisitCreateTexture2D(CommandCreateTexture2D* create_texture_2d) override;
+
+  bool VisitDeclareShader(CommandDeclareShader* declare_shader) override;
+
+  bool VisitDumpBufferBinary(
+      CommandDumpBufferBinary* dump_buffer_binary) override;
+
+  bool VisitDumpBufferText(CommandDumpBufferText* dump_buffer_text) override;
+
+  bool VisitDumpRenderbuffer(
+      CommandDumpRenderbuffer* dump_renderbuffer) override;
+
+  bool VisitRunCompute(CommandRunCompute* run_compute) override;
+
+  bool VisitRunComputeIndirect(
+      CommandRunComputeIndirect* run_compute_indirect) override;
+
+  bool VisitRunGraphics(CommandRunGraphics* run_graphics) override;
+
+  bool VisitSetSamplerParameter(
+      CommandSetSamplerParameter* set_sampler_parameter) override;
+
+  bool VisitSetTextureParameter(
+      CommandSetTextureParameter* set_texture_parameter) override;
+
+  bool VisitSetUniform(CommandSetUniform* set_uniform) override;
+
+  bool VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) override;
 };
 
 }  // namespace shadertrap
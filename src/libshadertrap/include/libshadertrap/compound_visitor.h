@@ -19,9 +19,13 @@
 #include <vector>
 
 #include "libshadertrap/command.h"
+#include "libshadertrap/command_assert_buffer_hash.h"
 #include "libshadertrap/command_assert_equal.h"
+#include "libshadertrap/command_assert_matches_image.h"
 #include "libshadertrap/command_assert_pixels.h"
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
 #include "libshadertrap/command_assert_similar_emd_histogram.h"
+#include "libshadertrap/command_assert_similar_image.h"
 #include "libshadertrap/command_bind_sampler.h"
 #include "libshadertrap/command_bind_shader_storage_buffer.h"
 #include "libshadertrap/command_bind_texture.h"
@@ -32,15 +36,18 @@
 #include "libshadertrap/command_create_program.h"
 #include "libshadertrap/command_create_renderbuffer.h"
 #include "libshadertrap/command_create_sampler.h"
+#include "libshadertrap/command_create_texture_2d.h"
 #include "libshadertrap/command_declare_shader.h"
 #include "libshadertrap/command_dump_buffer_binary.h"
 #include "libshadertrap/command_dump_buffer_text.h"
 #include "libshadertrap/command_dump_renderbuffer.h"
 #include "libshadertrap/command_run_compute.h"
+#include "libshadertrap/command_run_compute_indirect.h"
 #include "libshadertrap/command_run_graphics.h"
 #include "libshadertrap/command_set_sampler_parameter.h"
 #include "libshadertrap/command_set_texture_parameter.h"
 #include "libshadertrap/command_set_uniform.h"
+#include "libshadertrap/command_update_buffer.h"
 #include "libshadertrap/command_visitor.h"
 
 namespace shadertrap {
@@ -50,13 +57,25 @@ class CompoundVisitor : public CommandVisitor {
   explicit CompoundVisitor(
       std::vector<std::unique_ptr<CommandVisitor>> visitors);
 
+  bool VisitAssertBufferHash(
+      CommandAssertBufferHash* assert_buffer_hash) override;
+
   bool VisitAssertEqual(CommandAssertEqual* assert_equal) override;
 
+  bool VisitAssertMatchesImage(
+      CommandAssertMatchesImage* assert_matches_image) override;
+
   bool VisitAssertPixels(CommandAssertPixels* assert_pixels) override;
 
+  bool VisitAssertRenderbufferHash(
+      CommandAssertRenderbufferHash* assert_renderbuffer_hash) override;
+
   bool VisitAssertSimilarEmdHistogram(
       CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) override;
 
+  bool VisitAssertSimilarImage(
+      CommandAssertSimilarImage* assert_similar_image) override;
+
   bool VisitBindSampler(CommandBindSampler* bind_sampler) override;
 
   bool VisitBindShaderStorageBuffer(
@@ -81,6 +100,9 @@ class CompoundVisitor : public CommandVisitor {
   bool VisitCreateRenderbuffer(
       CommandCreateRenderbuffer* create_renderbuffer) override;
 
+  bool VisitCreateTexture2D(
+      CommandCreateTexture2D* create_texture_2d) override;
+
   bool VisitDeclareShader(CommandDeclareShader* declare_shader) override;
 
   bool VisitDumpBufferBinary(
@@ -93,6 +115,9 @@ class CompoundVisitor : public CommandVisitor {
 
   bool VisitRunCompute(CommandRunCompute* run_compute) override;
 
+  bool VisitRunComputeIndirect(
+      CommandRunComputeIndirect* run_compute_indirect) override;
+
   bool VisitRunGraphics(CommandRunGraphics* run_graphics) override;
 
   bool VisitSetSamplerParameter(
@@ -103,6 +128,8 @@ class CompoundVisitor : public CommandVisitor {
 
   bool VisitSetUniform(CommandSetUniform* set_uniform) override;
 
+  bool VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) override;
+
  private:
   bool ApplyVisitors(Command* command);
 
@@ -0,0 +1,74 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_COMPRESSED_BUFFER_H
+#define LIBSHADERTRAP_COMPRESSED_BUFFER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace shadertrap {
+
+// A compressed buffer dump consists of the four characters "STZB", the size of
+// the uncompressed data as a 64-bit little-endian integer, and the size of each
+// chunk of uncompressed data as a 32-bit little-endian integer. Each chunk then
+// follows as its compressed size, a 32-bit little-endian integer, and a zlib
+// stream. Every chunk but the last holds exactly the chunk size of data.
+
+// The size of the chunks in which buffers are compressed, which bounds the
+// memory needed beyond the compressed data itself.
+const size_t kCompressedBufferChunkSizeBytes = 4U << 20U;
+
+// Called by CompressBuffer and DecompressBuffer with each piece of |size| bytes
+// of compressed or decompressed data at |data|, which is only valid during the
+// call. Returns false if the piece could not be written.
+using BufferPieceConsumer =
+    std::function<bool(const uint8_t* data, size_t size)>;
+
+// Compresses the |size| bytes at |data| in chunks of |chunk_size_bytes| using
+// lodepng's zlib compressor, passing the result to |consume_piece| a piece at
+// a time, so that only one compressed chunk is held in memory. Returns false,
+// with a description in |error|, if the data cannot be compressed, which is
+// always the case if ShaderTrap is built without lodepng, or if a piece could
+// not be written.
+bool CompressBuffer(const uint8_t* data, size_t size, size_t chunk_size_bytes,
+                    const BufferPieceConsumer& consume_piece,
+                    std::string* error);
+
+// Compresses the |size| bytes at |data| as above, storing the result in
+// |compressed|.
+bool CompressBuffer(const uint8_t* data, size_t size, size_t chunk_size_bytes,
+                    std::vector<uint8_t>* compressed, std::string* error);
+
+// Decompresses the data read from |compressed|, which must have been produced
+// by CompressBuffer, passing it to |consume_piece| a chunk at a time, so that
+// only one chunk, compressed and decompressed, is held in memory. Returns
+// false, with a description in |error|, if the data is not a valid compressed
+// buffer or if a piece could not be written.
+bool DecompressBuffer(std::istream* compressed,
+                      const BufferPieceConsumer& consume_piece,
+                      std::string* error);
+
+// Decompresses the |size| bytes at |compressed| as above, storing the result
+// in |data|.
+bool DecompressBuffer(const uint8_t* compressed, size_t size,
+                      std::vector<uint8_t>* data, std::string* error);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_COMPRESSED_BUFFER_H
@@ -0,0 +1,44 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_EMD_HISTOGRAM_H
+#define LIBSHADERTRAP_EMD_HISTOGRAM_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace shadertrap {
+
+// The number of bins in the histogram of each channel of an RGBA8 image.
+const size_t kNumHistogramBins = 256;
+
+// Counts the occurrences of each value of each channel among the |num_pixels|
+// RGBA8 pixels in |data|. Element (channel * kNumHistogramBins + value) of the
+// result holds the count for |value| in |channel|. Large images are split
+// between several threads.
+std::vector<uint64_t> ComputeChannelHistograms(const uint8_t* data,
+                                               size_t num_pixels);
+
+// Returns the maximum, over the channels, of the earth mover's distance
+// between the histograms of that channel in |histograms_1| and |histograms_2|,
+// which are laid out as by ComputeChannelHistograms and each count
+// |num_pixels| pixels. The distance is normalized to the range [0, 1].
+double ComputeMaxEmd(const std::vector<uint64_t>& histograms_1,
+                     const std::vector<uint64_t>& histograms_2,
+                     size_t num_pixels);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_EMD_HISTOGRAM_H
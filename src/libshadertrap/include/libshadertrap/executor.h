@@ -23,13 +23,24 @@
 #include <GLES3/gl32.h>
 #endif
 
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
+#include <set>
 #include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
 
 #include "libshadertrap/api_version.h"
+#include "libshadertrap/command_assert_buffer_hash.h"
 #include "libshadertrap/command_assert_equal.h"
+#include "libshadertrap/command_assert_matches_image.h"
 #include "libshadertrap/command_assert_pixels.h"
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
 #include "libshadertrap/command_assert_similar_emd_histogram.h"
+#include "libshadertrap/command_assert_similar_image.h"
 #include "libshadertrap/command_bind_sampler.h"
 #include "libshadertrap/command_bind_shader_storage_buffer.h"
 #include "libshadertrap/command_bind_texture.h"
@@ -40,33 +51,134 @@
 #include "libshadertrap/command_create_program.h"
 #include "libshadertrap/command_create_renderbuffer.h"
 #include "libshadertrap/command_create_sampler.h"
+#include "libshadertrap/command_create_texture_2d.h"
 #include "libshadertrap/command_declare_shader.h"
 #include "libshadertrap/command_dump_buffer_binary.h"
 #include "libshadertrap/command_dump_buffer_text.h"
 #include "libshadertrap/command_dump_renderbuffer.h"
 #include "libshadertrap/command_run_compute.h"
+#include "libshadertrap/command_run_compute_indirect.h"
 #include "libshadertrap/command_run_graphics.h"
 #include "libshadertrap/command_set_sampler_parameter.h"
 #include "libshadertrap/command_set_texture_parameter.h"
 #include "libshadertrap/command_set_uniform.h"
+#include "libshadertrap/command_update_buffer.h"
 #include "libshadertrap/command_visitor.h"
+#include "libshadertrap/gl_error_policy.h"
 #include "libshadertrap/gl_functions.h"
+#include "libshadertrap/image_writer.h"
 #include "libshadertrap/message_consumer.h"
+#include "libshadertrap/output_sink.h"
+#include "libshadertrap/shadertrap_program.h"
+#include "libshadertrap/token.h"
 
 namespace shadertrap {
 
+// Options that control how an Executor runs a program.
+struct ExecutorOptions {
+  // How OpenGL errors are detected.
+  GlErrorPolicy error_policy = GlErrorPolicy::kStrict;
+
+  // When an assertion fails, at most this many of the mismatching elements or
+  // pixels are reported individually, followed by a summary of all of them.
+  size_t max_mismatch_reports = 10;
+
+  // If set, failing assertions on renderbuffers also write a PNG image in which
+  // mismatching pixels are white.
+  bool write_diff_masks = false;
+
+  // If set, ASSERT_EQUAL compares its arguments using a compute shader where
+  // this is supported, only reading them back to the host if they differ.
+  bool compare_on_gpu = false;
+
+  // If set, every compute dispatch is followed by a flush and a barrier on all
+  // memory, rather than by the barriers inferred by PlanMemoryBarriers.
+  bool conservative_barriers = false;
+
+  // If set, small buffers are suballocated from a few large buffer objects once
+  // PlanBufferPools has been called.
+  bool pool_buffers = false;
+};
+
 class Executor : public CommandVisitor {
  public:
+  // The data dumped by DUMP_* commands, and diff masks, are passed to
+  // |output_sink| rather than written to files directly.
   Executor(GlFunctions* gl_functions, MessageConsumer* message_consumer,
-           ApiVersion api_version);
+           OutputSink* output_sink, ApiVersion api_version,
+           const ExecutorOptions& options);
+
+  ~Executor() override;
+
+  // Examines |program|, which is about to be executed, so that consecutive
+  // ASSERT_PIXELS commands on a renderbuffer that is not rendered to in between
+  // can share a single readback of the bounding box of their rectangles. If
+  // this is not called, each ASSERT_PIXELS command reads back just its own
+  // rectangle.
+  void PlanPixelReadbacks(ShaderTrapProgram* program);
+
+  // Examines |program|, which is about to be executed, to find the
+  // renderbuffers that are read back in full after being rendered to, so that
+  // their readbacks can be started as soon as they have been rendered and can
+  // proceed while later commands are issued. If this is not called, each
+  // renderbuffer is read back when a command needs its contents.
+  void PlanRenderbufferReadbacks(ShaderTrapProgram* program);
+
+  // Examines |program|, which is about to be executed, to infer the memory
+  // barriers needed to make buffers written by shaders visible to the later
+  // commands that access them, so that only those barriers are issued. If this
+  // is not called, or barriers are conservative, every compute dispatch is
+  // followed by a flush and a barrier on all memory.
+  void PlanMemoryBarriers(ShaderTrapProgram* program);
+
+  // Examines |program|, which is about to be executed, to find the buffers
+  // that can share a buffer object with others, so that buffers can be pooled.
+  // If this is not called, or buffers are not pooled, each buffer has a buffer
+  // object of its own.
+  void PlanBufferPools(ShaderTrapProgram* program);
+
+  // Describes the storage used by the buffers created so far.
+  struct BufferStatistics {
+    // The number of buffers created by CREATE_BUFFER commands.
+    size_t num_buffers;
+    // The number of GL buffer objects allocated to hold them.
+    size_t num_buffer_objects;
+    // The total size of the buffers, in bytes.
+    size_t buffer_bytes;
+    // The total size of the buffer objects, in bytes.
+    size_t buffer_object_bytes;
+  };
+
+  const BufferStatistics& GetBufferStatistics() const {
+    return buffer_statistics_;
+  }
+
+  // DUMP_RENDERBUFFER commands encode and write their images in the
+  // background. This waits for all such images to be written, reporting any
+  // that could not be, and returns false if there were any. It should be called
+  // once the program has been executed; the destructor also waits for the
+  // images, but can only report failures if the program is still alive.
+  bool FlushImageWrites();
+
+  bool VisitAssertBufferHash(
+      CommandAssertBufferHash* assert_buffer_hash) override;
 
   bool VisitAssertEqual(CommandAssertEqual* assert_equal) override;
 
+  bool VisitAssertMatchesImage(
+      CommandAssertMatchesImage* assert_matches_image) override;
+
   bool VisitAssertPixels(CommandAssertPixels* assert_pixels) override;
 
+  bool VisitAssertRenderbufferHash(
+      CommandAssertRenderbufferHash* assert_renderbuffer_hash) override;
+
   bool VisitAssertSimilarEmdHistogram(
       CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) override;
 
+  bool VisitAssertSimilarImage(
+      CommandAssertSimilarImage* assert_similar_image) override;
+
   bool VisitBindSampler(CommandBindSampler* bind_sampler) override;
 
   bool VisitBindShaderStorageBuffer(
@@ -91,6 +203,9 @@ class Executor : public CommandVisitor {
   bool VisitCreateRenderbuffer(
       CommandCreateRenderbuffer* create_renderbuffer) override;
 
+  bool VisitCreateTexture2D(
+      CommandCreateTexture2D* create_texture_2d) override;
+
   bool VisitDeclareShader(CommandDeclareShader* declare_shader) override;
 
   bool VisitDumpBufferBinary(
@@ -103,6 +218,9 @@ class Executor : public CommandVisitor {
 
   bool VisitRunCompute(CommandRunCompute* run_compute) override;
 
+  bool VisitRunComputeIndirect(
+      CommandRunComputeIndirect* run_compute_indirect) override;
+
   bool VisitRunGraphics(CommandRunGraphics* run_graphics) override;
 
   bool VisitSetSamplerParameter(
@@ -113,21 +231,341 @@ class Executor : public CommandVisitor {
 
   bool VisitSetUniform(CommandSetUniform* set_uniform) override;
 
+  bool VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) override;
+
  private:
+  // Receives GL_KHR_debug messages when the kDebugCallback error policy is in
+  // use; |user_param| is the executor that installed the callback.
+  static void GL_APIENTRY DebugMessageCallback(GLenum source, GLenum type,
+                                               GLuint id, GLenum severity,
+                                               GLsizei length,
+                                               const GLchar* message,
+                                               const void* user_param);
+
+  // Reports any OpenGL errors that were raised during the execution of the
+  // command that starts with |start_token|, returning false if there were any.
+  // Under the kStrict policy errors are reported as soon as they occur, so this
+  // has nothing to do.
+  bool CheckCommandErrors(const Token* start_token);
+
+  // Binds a framebuffer object whose color attachments are the renderbuffers
+  // or textures named in |attachments|, where the attachment at index i is
+  // attached to color attachment i, and an empty name leaves the corresponding
+  // attachment unused. Framebuffer objects are cached, so that completeness is
+  // only checked when one is first created. |command_name| is used when
+  // reporting an incomplete framebuffer.
+  bool BindFramebuffer(const Token* start_token,
+                       const std::string& command_name,
+                       const std::vector<std::string>& attachments);
+
+  // Deletes any cached framebuffer objects that use |identifier| as an
+  // attachment.
+  bool InvalidateFramebuffers(const Token* start_token,
+                              const std::string& identifier);
+
+  // Binds a vertex array object configured with the vertex data and index
+  // buffer of |run_graphics|. Vertex array objects are cached, so that a
+  // repeated draw with the same geometry only needs to bind one object.
+  bool BindVertexArray(CommandRunGraphics* run_graphics);
+
+  // Deletes any cached vertex array objects that use |identifier| as a vertex
+  // or index buffer.
+  bool InvalidateVertexArrays(const Token* start_token,
+                              const std::string& identifier);
+
+  // Issues a read of the contents of the renderbuffer named |identifier| into
+  // a pixel buffer object, guarded by a fence, without waiting for it to
+  // complete. Does nothing if such a read is already in flight or complete and
+  // the renderbuffer has not been rendered to since.
+  bool StartRenderbufferReadback(const Token* start_token,
+                                 const std::string& command_name,
+                                 const std::string& identifier);
+
+  // Deletes the pixel buffer object, if any, into which the renderbuffer named
+  // |identifier| has been read back.
+  bool ReleaseRenderbufferReadback(const Token* start_token,
+                                   const std::string& identifier);
+
+  // Called by ReadRenderbufferBands with the index of the bottom row of a band
+  // of |num_rows| rows, and the RGBA pixels of that band of each renderbuffer,
+  // with rows ordered bottom-to-top as returned by glReadPixels. Returns false
+  // if reading should stop.
+  using RenderbufferBandConsumer = std::function<bool(
+      size_t first_row, size_t num_rows,
+      const std::vector<const std::uint8_t*>& bands)>;
+
+  // Passes the contents of the |width|x|height| renderbuffers named in
+  // |identifiers| to |consume_band| a band of whole rows at a time, from the
+  // top of the renderbuffers down, so that the host memory used is bounded by
+  // the size of a band rather than that of a renderbuffer. Bands are mapped
+  // directly from a readback started by StartRenderbufferReadback where there
+  // is one; otherwise each band is read into one of a pair of pixel buffer
+  // objects, so that the next band is read while the current one is
+  // consumed. The rows below |first_row|, counting from the bottom, are not
+  // read; callers that need every row pass 0.
+  bool ReadRenderbufferBands(const Token* start_token,
+                             const std::string& command_name,
+                             const std::vector<std::string>& identifiers,
+                             size_t width, size_t height, size_t first_row,
+                             const RenderbufferBandConsumer& consume_band);
+
+  // Provides the RGBA contents of the renderbuffer named |identifier| in
+  // |data|, with rows ordered bottom-to-top as returned by glReadPixels,
+  // waiting for a readback started by StartRenderbufferReadback if necessary.
+  bool ReadRenderbuffer(const Token* start_token,
+                        const std::string& command_name,
+                        const std::string& identifier, size_t* width,
+                        size_t* height, std::vector<std::uint8_t>* data);
+
+  // Writes the image dumped by |dump_renderbuffer|, whose format must be
+  // supported by ImageRowEncoder, to the output sink a band at a time as the
+  // renderbuffer is read back, rather than queuing the whole image with the
+  // image writer.
+  bool StreamRenderbufferImage(CommandDumpRenderbuffer* dump_renderbuffer);
+
+  // Waits for a readback started by StartRenderbufferReadback to complete.
+  bool WaitForRenderbufferReadback(const Token* start_token,
+                                   const std::string& identifier);
+
+  // Waits for |fence| to be signalled and then deletes it, reporting a failure
+  // to read |identifier| back if waiting fails or times out.
+  bool WaitForReadbackFence(const Token* start_token,
+                            const std::string& identifier, GLsync fence);
+
+  // A rectangle of pixels, with the y-coordinate measured from the top of the
+  // renderbuffer as in ASSERT_PIXELS.
+  struct PixelRectangle {
+    size_t x;
+    size_t y;
+    size_t width;
+    size_t height;
+
+    // Returns true if every pixel of |other| lies within this rectangle.
+    bool Contains(const PixelRectangle& other) const {
+      return other.x >= x && other.y >= y &&
+             other.x + other.width <= x + width &&
+             other.y + other.height <= y + height;
+    }
+  };
+
+  // Reads the pixels of the renderbuffer named |identifier| that lie within
+  // |rectangle| into the entry for the renderbuffer in |pixel_readbacks_|. A
+  // complete readback of the renderbuffer is used if one is available.
+  bool ReadRenderbufferRectangle(const Token* start_token,
+                                 const std::string& identifier,
+                                 const PixelRectangle& rectangle);
+
+  // Returns true if and only if |actual_hash|, computed from the buffer or
+  // renderbuffer named |identifier|, is |expected_hash|, reporting both
+  // otherwise.
+  bool CheckHash(const Token* start_token, const std::string& identifier,
+                 uint64_t actual_hash, uint64_t expected_hash);
+
+  // Reports a summary, given by |details|, of the |mismatch_count| mismatches
+  // found by the assertion that starts with |start_token|.
+  void ReportMismatchSummary(const Token* start_token, size_t mismatch_count,
+                             const std::string& details);
+
+  // Writes |diff_mask|, a |width| x |height| RGBA image, to a PNG output named
+  // after the line of |start_token|.
+  void WriteDiffMask(const Token* start_token, size_t width, size_t height,
+                     const std::vector<std::uint8_t>& diff_mask);
+
+  // Determines whether compute shaders, required for comparing data on the
+  // GPU, are available.
+  bool SupportsComputeShaders() const;
+
+  // The range of a buffer object that holds the contents of a buffer. Unless
+  // buffers are pooled, this is the whole of a buffer object.
+  struct BufferRange {
+    GLuint buffer;
+    size_t offset_bytes;
+    size_t size_bytes;
+  };
+
+  // Provides in |range| a range of |size_bytes| bytes from the pool of buffer
+  // objects created with |usage|, allocating a new buffer object for the pool
+  // if the current one is full.
+  bool AllocateFromBufferPool(const Token* start_token, GLenum usage,
+                              size_t size_bytes, BufferRange* range);
+
+  // Binds |range| to the indexed binding |binding| of |target|.
+  bool BindIndexedBufferRange(const Token* start_token, GLenum target,
+                              GLuint binding, const BufferRange& range);
+
+  // Counts the 32-bit words that differ between the first |size_bytes| bytes
+  // of |range_1| and |range_2| using a compute shader, without reading the
+  // buffers back to the host. Only the words within the half-open ranges in
+  // |compared_words| are considered. If any differ, the index of the first is
+  // provided in |first_mismatching_word|, so that the buffers only need to be
+  // read back from there to report the mismatches.
+  bool CountMismatchesOnGpu(
+      const Token* start_token, const BufferRange& range_1,
+      const BufferRange& range_2, size_t size_bytes,
+      const std::vector<std::pair<size_t, size_t>>& compared_words,
+      size_t* mismatch_count, size_t* first_mismatching_word);
+
+  // Provides in |program| the compute shader program built from |source|,
+  // building it on first use.
+  bool GetInternalComputeProgram(const Token* start_token,
+                                 const std::string& source, GLuint* program);
+
+  // Rebinds the buffers recorded in |shader_storage_buffer_bindings_| to the
+  // shader storage buffer bindings 0 to 2, which internal compute shaders use.
+  bool RestoreShaderStorageBufferBindings(const Token* start_token);
+
+  // Provides the dimensions of the renderbuffer named |identifier|.
+  bool GetRenderbufferSize(const Token* start_token,
+                           const std::string& identifier, size_t* width,
+                           size_t* height);
+
+  // Reads the |width| x |height| renderbuffers named |identifier_1| and
+  // |identifier_2| into |comparison_pixel_buffers_|, without reading them back
+  // to the host.
+  bool CopyRenderbuffersToComparisonBuffers(const Token* start_token,
+                                            const std::string& command_name,
+                                            const std::string& identifier_1,
+                                            const std::string& identifier_2,
+                                            size_t width, size_t height);
+
+  // Computes the per-channel histograms of the |num_pixels| RGBA pixels held in
+  // each of |comparison_pixel_buffers_| using a compute shader, so that only
+  // the counts are read back. |histograms| receives, for each buffer, counts
+  // laid out as by ComputeChannelHistograms.
+  bool ComputeHistogramsOnGpu(const Token* start_token, size_t num_pixels,
+                              std::vector<std::uint64_t> histograms[2]);
+
+  // Issues the memory barrier needed between two dispatches of |command|,
+  // which issues several.
+  bool IssueBarrierBetweenDispatches(Command* command);
+
+  // Issues the memory barrier needed after the dispatches of |command|.
+  bool IssueBarrierAfterDispatches(Command* command);
+
+  // Issues the memory barrier that PlanMemoryBarriers determined is needed
+  // after |command|, if any.
+  bool IssuePlannedMemoryBarrier(Command* command);
+
   bool CheckEqualBuffers(CommandAssertEqual* assert_equal);
 
+  // Compares the buffer of an ASSERT_EQUAL command with the contents of its
+  // file, which is read in chunks so that large files need not be held in
+  // memory.
+  bool CheckBufferEqualsFile(CommandAssertEqual* assert_equal);
+
   bool CheckEqualRenderbuffers(CommandAssertEqual* assert_equal);
 
+  // Identifies the state of a vertex array object: the index buffer (empty if
+  // there is none), and the (location, buffer, offset, stride, dimension,
+  // divisor) of each vertex attribute, ordered by location.
+  struct VertexArrayKey {
+    std::string index_buffer;
+    std::vector<
+        std::tuple<size_t, std::string, size_t, size_t, size_t, size_t>>
+        attributes;
+
+    bool operator<(const VertexArrayKey& other) const {
+      return std::tie(index_buffer, attributes) <
+             std::tie(other.index_buffer, other.attributes);
+    }
+  };
+
+  // A buffer object from which buffers are suballocated, and the number of
+  // bytes at its start that are in use.
+  struct BufferPool {
+    GLuint buffer;
+    size_t used_bytes;
+  };
+
+  // A pixel buffer object into which a renderbuffer is read back.
+  struct RenderbufferReadback {
+    GLuint pixel_buffer;
+    size_t width;
+    size_t height;
+    // True if a read of the renderbuffer's current contents into
+    // |pixel_buffer| has been issued.
+    bool up_to_date;
+    // Signalled once the read into |pixel_buffer| completes; null if the read
+    // is known to have completed.
+    GLsync fence;
+  };
+
+  // A rectangle of a renderbuffer that has been read back, with |data| holding
+  // its RGBA pixels with rows ordered bottom-to-top.
+  struct PixelReadback {
+    PixelRectangle rectangle;
+    std::vector<std::uint8_t> data;
+  };
+
   GlFunctions* gl_functions_;
   MessageConsumer* message_consumer_;
+  OutputSink* output_sink_;
   ApiVersion api_version_;
+  ExecutorOptions options_;
+  // True if PlanBufferPools has determined which buffers can be pooled; those
+  // that cannot are recorded in |unpooled_buffers_|.
+  bool buffer_pools_planned_;
+  std::set<std::string> unpooled_buffers_;
+  // The pool for each buffer usage hint.
+  std::map<GLenum, BufferPool> buffer_pools_;
+  // The alignment of buffers within a pool, which satisfies the offset
+  // alignment of every buffer binding target; 0 until first needed.
+  size_t buffer_pool_alignment_;
+  BufferStatistics buffer_statistics_;
+  // True if PlanMemoryBarriers has determined the barriers to issue, which are
+  // then recorded in |planned_memory_barriers_| for the commands that need
+  // them.
+  bool memory_barriers_planned_;
+  std::map<const Command*, GLbitfield> planned_memory_barriers_;
+  std::map<const Command*, GLbitfield> planned_barriers_between_dispatches_;
+  // Error messages received via the debug callback that have not yet been
+  // reported.
+  std::vector<std::string> pending_debug_messages_;
+  // Encodes the images dumped by DUMP_RENDERBUFFER commands and passes them to
+  // |output_sink_|.
+  ImageWriter image_writer_;
   std::map<std::string, CommandDeclareShader*> declared_shaders_;
-  std::map<std::string, GLuint> created_buffers_;
+  std::map<std::string, BufferRange> created_buffers_;
   std::map<std::string, GLuint> created_programs_;
   std::map<std::string, GLuint> created_renderbuffers_;
   std::map<std::string, GLuint> created_samplers_;
   std::map<std::string, GLuint> compiled_shaders_;
   std::map<std::string, GLuint> created_textures_;
+  // Maps each shader storage buffer binding to the buffer range bound to it,
+  // so that bindings used internally can be restored.
+  std::map<GLuint, BufferRange> shader_storage_buffer_bindings_;
+  std::map<std::vector<std::string>, GLuint> framebuffer_cache_;
+  std::map<VertexArrayKey, GLuint> vertex_array_cache_;
+  // A renderbuffer has an entry here while a readback of its contents is held
+  // in a pixel buffer object. The entry is removed when the renderbuffer is
+  // rendered to, unless a readback of its new contents is planned.
+  std::map<std::string, RenderbufferReadback> renderbuffer_readbacks_;
+  // The renderbuffers to read back after each RUN_GRAPHICS command, as
+  // determined by PlanRenderbufferReadbacks.
+  std::map<const CommandRunGraphics*, std::set<std::string>>
+      planned_renderbuffer_readbacks_;
+  // The region to read back for each ASSERT_PIXELS command, as determined by
+  // PlanPixelReadbacks.
+  std::map<const CommandAssertPixels*, PixelRectangle> planned_pixel_readbacks_;
+  // The most recently read rectangle of each renderbuffer that has not been
+  // rendered to since.
+  std::map<std::string, PixelReadback> pixel_readbacks_;
+  // Compute shader programs used to compare data on the GPU, keyed by their
+  // source code.
+  std::map<std::string, GLuint> comparison_programs_;
+  // Holds the mismatch count written by a comparison program.
+  GLuint comparison_result_buffer_;
+  // Holds the histogram counts written by the histogram program.
+  GLuint histogram_result_buffer_;
+  // Buffers into which renderbuffers are copied for comparison on the GPU,
+  // and their size in bytes.
+  GLuint comparison_pixel_buffers_[2];
+  size_t comparison_pixel_buffer_size_;
+  // Pixel buffer objects into which ReadRenderbufferBands reads bands of
+  // renderbuffers that are not read back in full, two per renderbuffer, and
+  // the size in bytes of each.
+  std::vector<GLuint> band_pixel_buffers_;
+  size_t band_pixel_buffer_size_;
 };
 
 }  // namespace shadertrap
@@ -0,0 +1,46 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_FILE_OUTPUT_SINK_H
+#define LIBSHADERTRAP_FILE_OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "libshadertrap/output_sink.h"
+
+namespace shadertrap {
+
+// Writes each output to the file that it is named after.
+class FileOutputSink : public OutputSink {
+ public:
+  bool Write(const std::string& name, Kind kind, const uint8_t* data,
+             size_t size) override;
+
+  bool Begin(const std::string& name, Kind kind) override;
+
+  bool Append(const uint8_t* data, size_t size) override;
+
+  bool End() override;
+
+ private:
+  // The file of the output being received in pieces.
+  std::ofstream file_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_FILE_OUTPUT_SINK_H
@@ -0,0 +1,70 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_FLOAT_COMPARE_H
+#define LIBSHADERTRAP_FLOAT_COMPARE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shadertrap {
+
+// The differences allowed between two 32-bit floating-point values that are
+// not bitwise equal. The values match if they are within any one of the
+// tolerances; a tolerance of zero allows no difference.
+struct FloatTolerance {
+  // The largest allowed absolute difference.
+  float absolute;
+  // The largest allowed difference relative to the larger magnitude of the
+  // two values.
+  float relative;
+  // The largest allowed distance in units in the last place, i.e. the number
+  // of representable floats between the two values.
+  uint32_t ulps;
+};
+
+// The largest differences found between pairs of floating-point values that
+// are not NaN.
+struct FloatErrors {
+  float max_absolute;
+  float max_relative;
+  uint32_t max_ulps;
+};
+
+// Returns the index of the first of the |count| pairs of 32-bit floats at
+// |data_1| and |data_2| that do not match within |tolerance|, or |count| if
+// all match. A NaN only matches a bitwise equal NaN. The largest differences
+// between the pairs up to and including the returned index are merged into
+// |errors|, so the differences of a mismatching pair are included.
+//
+// Differences are computed in single precision, four pairs at a time using
+// SSE2 when the target supports it.
+size_t FindFirstFloatOutsideTolerance(const uint8_t* data_1,
+                                      const uint8_t* data_2, size_t count,
+                                      const FloatTolerance& tolerance,
+                                      FloatErrors* errors);
+
+// Behaves as FindFirstFloatOutsideTolerance, but compares one pair at a time
+// without SIMD. FindFirstFloatOutsideTolerance uses this for the pairs that do
+// not fill a vector, and it is exposed so that both paths can be tested and
+// benchmarked.
+size_t FindFirstFloatOutsideToleranceScalar(const uint8_t* data_1,
+                                            const uint8_t* data_2,
+                                            size_t count,
+                                            const FloatTolerance& tolerance,
+                                            FloatErrors* errors);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_FLOAT_COMPARE_H
@@ -0,0 +1,66 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_FRAMED_OUTPUT_SINK_H
+#define LIBSHADERTRAP_FRAMED_OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "libshadertrap/output_sink.h"
+
+namespace shadertrap {
+
+// Writes each output to a stream, typically standard output, so that a caller
+// can collect outputs without files being created. Each output is written as a
+// header line:
+//
+//   SHADERTRAP_OUTPUT kind size name
+//
+// where |kind| is "binary", "text" or "image", followed by exactly |size| bytes
+// of data and a newline. An output received in pieces, whose size is not known
+// when it starts, has "chunked" in place of its size, and is followed by its
+// pieces, each written as a line holding its size followed by exactly that
+// many bytes and a newline, and then by a line holding 0. Other text written
+// to the stream between outputs, such as GL information, is left as it is.
+class FramedOutputSink : public OutputSink {
+ public:
+  explicit FramedOutputSink(std::ostream* stream);
+
+  bool Write(const std::string& name, Kind kind, const uint8_t* data,
+             size_t size) override;
+
+  bool Begin(const std::string& name, Kind kind) override;
+
+  bool Append(const uint8_t* data, size_t size) override;
+
+  bool End() override;
+
+ private:
+  // Outputs are written whole, even if they arrive from several threads.
+  std::mutex mutex_;
+
+  // Holds |mutex_| from Begin to End, so that images written concurrently are
+  // not interleaved with the pieces of an output.
+  std::unique_lock<std::mutex> chunked_lock_;
+
+  std::ostream* stream_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_FRAMED_OUTPUT_SINK_H
@@ -0,0 +1,34 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_GL_ERROR_POLICY_H
+#define LIBSHADERTRAP_GL_ERROR_POLICY_H
+
+namespace shadertrap {
+
+// Determines how the executor detects OpenGL errors.
+//
+// - kStrict: glGetError is called after every GL call, so that an error is
+//   attributed to the exact call that caused it. This is the most precise
+//   policy, but on many drivers each glGetError forces a round trip to the
+//   driver's server thread.
+// - kPerCommand: glGetError is drained once at the end of each command, and any
+//   errors are blamed on the command as a whole.
+// - kDebugCallback: errors are delivered via a GL_KHR_debug message callback
+//   and are reported at the end of each command; glGetError is not polled.
+enum class GlErrorPolicy { kStrict, kPerCommand, kDebugCallback };
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_GL_ERROR_POLICY_H
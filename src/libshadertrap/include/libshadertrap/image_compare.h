@@ -0,0 +1,100 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_IMAGE_COMPARE_H
+#define LIBSHADERTRAP_IMAGE_COMPARE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace shadertrap {
+
+// The width and height of the windows over which SSIM is computed.
+const size_t kSsimWindowSize = 8;
+
+// The differences found by comparing two RGBA8 images of the same size.
+struct ImageDifferences {
+  // The number of pixels with a channel that differs by more than the channel
+  // tolerance.
+  uint64_t num_differing_pixels;
+  // The largest difference between corresponding channels.
+  uint8_t max_channel_difference;
+  // The mean of the squared differences between corresponding channels.
+  double mean_squared_error;
+  // The minimum, over the channels, of the mean structural similarity of the
+  // images in kSsimWindowSize x kSsimWindowSize windows placed every
+  // kSsimWindowSize / 2 pixels in each direction. Pixels in the right and
+  // bottom margins that no window covers are ignored. 1 if SSIM was not
+  // requested or the images are smaller than a window.
+  double ssim;
+};
+
+// Compares two |width| x |height| RGBA8 images that are provided a band of
+// rows at a time, so that neither image need be held in memory whole, finding
+// the same differences as CompareImages.
+class ImageComparer {
+ public:
+  ImageComparer(size_t width, size_t height, uint8_t channel_tolerance,
+                bool compute_ssim);
+
+  // Compares the |num_rows| rows of each image starting at row |first_row|,
+  // which are at |band_1| and |band_2|. Bands must be added from the top of
+  // the images down, with rows counted from the bottom, until every row has
+  // been added once. The bottom kSsimWindowSize rows added so far are kept, so
+  // that the SSIM windows that straddle two or more bands can be computed.
+  // Each band is split into parts that are compared by separate threads.
+  void AddBand(size_t first_row, size_t num_rows, const uint8_t* band_1,
+               const uint8_t* band_2);
+
+  // Returns the differences between the images, once every row has been
+  // added.
+  ImageDifferences GetDifferences() const;
+
+ private:
+  static const size_t kNumRgbaChannels = 4;
+
+  size_t width_;
+  size_t height_;
+  uint8_t channel_tolerance_;
+  // Zero if SSIM is not computed.
+  size_t num_window_rows_;
+  size_t num_window_columns_;
+  // The first row of the most recently added band, or the height of the
+  // images if none has been added.
+  size_t next_end_row_;
+  uint64_t num_differing_pixels_;
+  uint8_t max_channel_difference_;
+  uint64_t sum_squared_errors_;
+  double ssim_sums_[kNumRgbaChannels];
+  // Up to kSsimWindowSize rows of each image, starting at |next_end_row_|.
+  std::vector<uint8_t> overlap_1_;
+  std::vector<uint8_t> overlap_2_;
+};
+
+// Compares the |width| x |height| RGBA8 images in |data_1| and |data_2|,
+// counting the pixels with a channel that differs by more than
+// |channel_tolerance|, and computing SSIM if |compute_ssim| holds. The images
+// are split into bands of rows that are compared by separate threads.
+ImageDifferences CompareImages(const uint8_t* data_1, const uint8_t* data_2,
+                               size_t width, size_t height,
+                               uint8_t channel_tolerance, bool compute_ssim);
+
+// Returns the peak signal-to-noise ratio, in decibels, of 8-bit channels with
+// the given mean squared error, which is infinite if the error is zero.
+double ComputePsnr(double mean_squared_error);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_IMAGE_COMPARE_H
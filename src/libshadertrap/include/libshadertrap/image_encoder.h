@@ -0,0 +1,100 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_IMAGE_ENCODER_H
+#define LIBSHADERTRAP_IMAGE_ENCODER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace shadertrap {
+
+// The file formats in which an RGBA8 image can be written.
+enum class ImageFormat {
+  // PNG, which requires ShaderTrap to be built with PNG support.
+  kPng,
+  // Binary PPM (P6); the alpha channel is discarded.
+  kPpm,
+  // PAM (P7) with tuple type RGB_ALPHA.
+  kPam,
+  // The four characters "RGBA", the width and the height as 32-bit
+  // little-endian integers, and then the pixels.
+  kRaw,
+  // The "Quite OK Image" format, a fast lossless compressed format.
+  kQoi
+};
+
+// Requests lodepng's default PNG encoder settings.
+const int kDefaultPngCompressionLevel = -1;
+
+// The highest PNG compression level; level 0 stores the image uncompressed.
+const int kMaxPngCompressionLevel = 9;
+
+std::string ImageFormatToString(ImageFormat format);
+
+// Encodes the |width|x|height| RGBA8 image in |data|, whose rows are ordered
+// from top to bottom, in |format|, storing the result in |encoded|. For PNG,
+// |compression_level| trades encoding speed for size: it is either
+// kDefaultPngCompressionLevel or between 0 and kMaxPngCompressionLevel.
+// Returns false, with a description in |error|, if the image cannot be
+// encoded.
+bool EncodeImage(const std::vector<std::uint8_t>& data, size_t width,
+                 size_t height, ImageFormat format, int compression_level,
+                 std::vector<std::uint8_t>* encoded, std::string* error);
+
+// Encodes a |width|x|height| RGBA8 image in a format other than PNG a few rows
+// at a time, so that the image need not be held in memory whole. Each method
+// appends the encoding of its part of the image to |encoded|, which the caller
+// may empty between calls.
+class ImageRowEncoder {
+ public:
+  // Returns whether images in |format| can be encoded a few rows at a time;
+  // lodepng only encodes whole PNG images.
+  static bool SupportsFormat(ImageFormat format);
+
+  ImageRowEncoder(ImageFormat format, size_t width, size_t height);
+
+  // Encodes the header of the image.
+  void EncodeHeader(std::vector<std::uint8_t>* encoded);
+
+  // Encodes the |num_rows| rows at |data|, which are ordered from top to
+  // bottom and follow those already encoded.
+  void EncodeRows(const std::uint8_t* data, size_t num_rows,
+                  std::vector<std::uint8_t>* encoded);
+
+  // Encodes whatever follows the last row of the image.
+  void EncodeEnd(std::vector<std::uint8_t>* encoded);
+
+ private:
+  static const size_t kNumRgbaChannels = 4;
+  static const size_t kQoiIndexSize = 64;
+
+  // Follows the QOI specification, version 1.0, at https://qoiformat.org.
+  void EncodeQoiPixels(const std::uint8_t* data, size_t num_pixels,
+                       std::vector<std::uint8_t>* encoded);
+
+  ImageFormat format_;
+  size_t width_;
+  size_t height_;
+  // The state of the QOI encoder, which carries over from row to row.
+  std::uint8_t qoi_previous_[kNumRgbaChannels];
+  std::uint8_t qoi_seen_[kQoiIndexSize][kNumRgbaChannels];
+  size_t qoi_run_length_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_IMAGE_ENCODER_H
@@ -0,0 +1,131 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_IMAGE_WRITER_H
+#define LIBSHADERTRAP_IMAGE_WRITER_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "libshadertrap/image_encoder.h"
+#include "libshadertrap/message_consumer.h"
+#include "libshadertrap/output_sink.h"
+#include "libshadertrap/token.h"
+
+namespace shadertrap {
+
+// Encodes RGBA8 images and passes them to an output sink on a pool of
+// background threads, so that the thread issuing GL commands does not wait for
+// images to be encoded.
+class ImageWriter {
+ public:
+  // Images are written to |output_sink| by up to |num_threads| threads, or by
+  // Write itself if |num_threads| is 0. Write blocks while the images waiting
+  // to be written occupy more than |max_pending_bytes|, so that images that are
+  // produced faster than they can be written do not exhaust host memory.
+  ImageWriter(OutputSink* output_sink, size_t num_threads,
+              size_t max_pending_bytes);
+
+  ImageWriter(const ImageWriter&) = delete;
+
+  ImageWriter& operator=(const ImageWriter&) = delete;
+
+  // Waits for all queued images to be written.
+  ~ImageWriter();
+
+  // Queues the |width|x|height| image in |data| to be written to |filename| in
+  // |format|, using |compression_level| as described for EncodeImage. The rows
+  // of |data| are ordered from bottom to top, as returned by glReadPixels.
+  // Images queued for the same file are written in the order in
+  // which they were queued. If writing fails, this is reported at
+  // |start_token| by the next call to Flush.
+  void Write(const Token* start_token, const std::string& filename,
+             ImageFormat format, int compression_level, size_t width,
+             size_t height, std::vector<std::uint8_t> data);
+
+  // Waits until no image queued for |filename| remains to be written, so that
+  // the file can then be written directly without an earlier image replacing
+  // it. Failures are still reported by the next call to Flush.
+  void WaitForFile(const std::string& filename);
+
+  // Waits until all queued images have been written, reporting those that
+  // could not be written to |message_consumer|. Returns true if and only if
+  // every image was written successfully.
+  bool Flush(MessageConsumer* message_consumer);
+
+ private:
+  struct Job {
+    const Token* start_token;
+    std::string filename;
+    ImageFormat format;
+    int compression_level;
+    size_t width;
+    size_t height;
+    std::vector<std::uint8_t> data;
+  };
+
+  struct Failure {
+    const Token* start_token;
+    std::string message;
+  };
+
+  // Flips and encodes the image of |job|, returning an error message if it
+  // could not be written and an empty string otherwise.
+  std::string WriteImage(const Job& job);
+
+  // Runs queued jobs until the writer is destroyed.
+  void RunWorker();
+
+  // Returns the first queued job whose file is not being written by another
+  // thread, or the end of the queue if there is none. Requires |mutex_|.
+  std::deque<Job>::iterator FindRunnableJob();
+
+  OutputSink* output_sink_;
+
+  std::mutex mutex_;
+
+  // Signalled when a job is queued, or a file stops being written.
+  std::condition_variable job_runnable_;
+
+  // Signalled when a job has been completed.
+  std::condition_variable job_completed_;
+
+  std::deque<Job> queue_;
+
+  std::set<std::string> files_being_written_;
+
+  size_t num_jobs_running_;
+
+  // The size of the images that are queued or being written.
+  size_t pending_bytes_;
+
+  size_t max_pending_bytes_;
+
+  bool shutting_down_;
+
+  std::vector<Failure> failures_;
+
+  std::vector<std::thread> threads_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_IMAGE_WRITER_H
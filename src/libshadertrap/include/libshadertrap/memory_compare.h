@@ -0,0 +1,34 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_MEMORY_COMPARE_H
+#define LIBSHADERTRAP_MEMORY_COMPARE_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace shadertrap {
+
+// Returns the index of the first byte at which the |size|-byte regions
+// |data_1| and |data_2| differ, or |size| if the regions are identical.
+//
+// Identical blocks are skipped using memcmp, and the first mismatch within a
+// differing block is located using SSE2, AVX2 or NEON compares when the target
+// supports them.
+size_t FindFirstMismatch(const uint8_t* data_1, const uint8_t* data_2,
+                         size_t size);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_MEMORY_COMPARE_H
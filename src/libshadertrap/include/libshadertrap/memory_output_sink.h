@@ -0,0 +1,66 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_MEMORY_OUTPUT_SINK_H
+#define LIBSHADERTRAP_MEMORY_OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/output_sink.h"
+
+namespace shadertrap {
+
+// Keeps a copy of each output in memory, for callers that embed libshadertrap
+// and examine the results of a script directly.
+class MemoryOutputSink : public OutputSink {
+ public:
+  struct Output {
+    Kind kind;
+    std::vector<uint8_t> data;
+  };
+
+  bool Write(const std::string& name, Kind kind, const uint8_t* data,
+             size_t size) override;
+
+  bool Begin(const std::string& name, Kind kind) override;
+
+  bool Append(const uint8_t* data, size_t size) override;
+
+  bool End() override;
+
+  // Returns the outputs received so far, keyed by name.
+  std::map<std::string, Output> GetOutputs() const;
+
+  // Returns the outputs received so far, keyed by name, and forgets them.
+  std::map<std::string, Output> TakeOutputs();
+
+ private:
+  mutable std::mutex mutex_;
+
+  std::map<std::string, Output> outputs_;
+
+  // The name and contents so far of the output being received in pieces,
+  // which is added to |outputs_| when it is complete.
+  std::string pending_name_;
+  Output pending_output_;
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_MEMORY_OUTPUT_SINK_H
@@ -0,0 +1,70 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_OUTPUT_SINK_H
+#define LIBSHADERTRAP_OUTPUT_SINK_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace shadertrap {
+
+// Receives the outputs of DUMP_BUFFER_BINARY, DUMP_BUFFER_TEXT and
+// DUMP_RENDERBUFFER commands, and of diff masks, each of which is named by the
+// file that the script gives for it.
+class OutputSink {
+ public:
+  enum class Kind { kBinary, kText, kImage };
+
+  OutputSink() = default;
+
+  OutputSink(const OutputSink&) = delete;
+
+  OutputSink& operator=(const OutputSink&) = delete;
+
+  OutputSink(OutputSink&&) = delete;
+
+  OutputSink& operator=(OutputSink&&) = delete;
+
+  virtual ~OutputSink();
+
+  // Receives the |size| bytes at |data| as the output called |name|. |data|
+  // may point into a mapped GL buffer, so it is only valid during the call. A
+  // later output with the same name replaces an earlier one, as with files.
+  // Images are written on background threads, so this may be called
+  // concurrently. Returns false if the output could not be stored.
+  virtual bool Write(const std::string& name, Kind kind, const uint8_t* data,
+                     size_t size) = 0;
+
+  // Receive the output called |name| a piece at a time, so that an output
+  // that is produced in chunks, such as formatted text, need not be held in
+  // memory whole: Begin starts the output, each call to Append receives its
+  // next |size| bytes at |data|, which are only valid during the call, and End
+  // completes it. End is called after every call to Begin, even if a call
+  // failed. Only one output is received in pieces at a time, but images may be
+  // written concurrently. Each returns false if the output could not be
+  // stored.
+  virtual bool Begin(const std::string& name, Kind kind) = 0;
+
+  virtual bool Append(const uint8_t* data, size_t size) = 0;
+
+  virtual bool End() = 0;
+
+  static const char* KindToString(Kind kind);
+};
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_OUTPUT_SINK_H
@@ -27,6 +27,8 @@
 
 #include "libshadertrap/api_version.h"
 #include "libshadertrap/command.h"
+#include "libshadertrap/command_dump_buffer_text.h"
+#include "libshadertrap/float_compare.h"
 #include "libshadertrap/message_consumer.h"
 #include "libshadertrap/shadertrap_program.h"
 #include "libshadertrap/token.h"
@@ -69,12 +71,20 @@ class Parser {
   bool ParseParameters(
       const std::map<Token::Type, std::function<bool()>>& parameter_parsers);
 
+  bool ParseCommandAssertBufferHash();
+
   bool ParseCommandAssertEqual();
 
+  bool ParseCommandAssertMatchesImage();
+
   bool ParseCommandAssertPixels();
 
+  bool ParseCommandAssertRenderbufferHash();
+
   bool ParseCommandAssertSimilarEmdHistogram();
 
+  bool ParseCommandAssertSimilarImage();
+
   bool ParseCommandBindSampler();
 
   bool ParseCommandBindShaderStorageBuffer();
@@ -95,6 +105,8 @@ class Parser {
 
   bool ParseCommandCreateSampler();
 
+  bool ParseCommandCreateTexture2d();
+
   bool ParseCommandDeclareShader();
 
   bool ParseCommandDumpBufferBinary();
@@ -105,6 +117,8 @@ class Parser {
 
   bool ParseCommandRunCompute();
 
+  bool ParseCommandRunComputeIndirect();
+
   bool ParseCommandRunGraphics();
 
   bool ParseCommandSetSamplerParameter();
@@ -113,6 +127,8 @@ class Parser {
 
   bool ParseCommandSetUniform();
 
+  bool ParseCommandUpdateBuffer();
+
   std::pair<bool, UniformValue> ProcessUniformValue(
       UniformValue::ElementType type,
       const std::pair<bool, size_t>& maybe_array_size,
@@ -124,9 +140,43 @@ class Parser {
 
   std::pair<bool, float> ParseFloat(const std::string& result_name);
 
+  // Parses a float in the range [|min_value|, |max_value|], setting |token| to
+  // a copy of its token.
+  std::pair<bool, float> ParseFloatInRange(const std::string& result_name,
+                                           float min_value, float max_value,
+                                           std::unique_ptr<Token>* token);
+
   std::pair<bool, VertexAttributeInfo> ParseVertexAttributeInfo();
 
-  std::pair<bool, ValuesSegment> ParseValuesSegment();
+  // Parses the entries of a FORMAT parameter, stopping at the first token that
+  // does not start an entry. String entries are only accepted if
+  // |allow_strings| holds.
+  bool ParseFormatEntries(
+      bool allow_strings,
+      std::vector<CommandDumpBufferText::FormatEntry>* format_entries);
+
+  // Parses the tolerances following TOLERANCE: one or more of ABS, REL and
+  // ULP, each followed by its value. |tolerance_token| is set to the first of
+  // these keywords, and tolerances that are not given are left unchanged.
+  bool ParseFloatTolerance(std::unique_ptr<Token>* tolerance_token,
+                           FloatTolerance* tolerance);
+
+  // Parses a string of 16 hexadecimal digits, as printed by
+  // HashToHexString, into |hash|.
+  bool ParseHash(std::unique_ptr<Token>* hash_token, uint64_t* hash);
+
+  // Parses either a single byte offset or a bracketed, comma-separated list of
+  // byte offsets, appending each offset and the token it came from.
+  bool ParseOffsetsBytes(std::vector<size_t>* offsets_bytes,
+                         std::vector<std::unique_ptr<Token>>* offset_tokens);
+
+  // Parses a sequence of typed values segments, stopping at the first token
+  // that does not start a segment. If |whole_words| holds, each sequence of
+  // byte values must fill a whole number of 32-bit words, as is required for
+  // buffer data.
+  bool ParseInitValues(std::vector<ValuesSegment>* values, bool whole_words);
+
+  std::pair<bool, ValuesSegment> ParseValuesSegment(bool whole_words);
 
   std::unique_ptr<Tokenizer> tokenizer_;
 
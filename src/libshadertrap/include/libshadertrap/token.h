@@ -29,9 +29,14 @@ class Token {
     kFloatLiteral,
     kIdentifier,
     kIntLiteral,
+    kKeywordAbs,
+    kKeywordAssertBufferHash,
+    kKeywordAssertMatchesImage,
     kKeywordAssertPixels,
     kKeywordAssertEqual,
+    kKeywordAssertRenderbufferHash,
     kKeywordAssertSimilarEmdHistogram,
+    kKeywordAssertSimilarImage,
     kKeywordBinding,
     kKeywordBindSampler,
     kKeywordBindShaderStorageBuffer,
@@ -40,42 +45,69 @@ class Token {
     kKeywordBuffer,
     kKeywordBuffers,
     kKeywordCompileShader,
+    kKeywordCompressed,
+    kKeywordCompression,
     kKeywordCompute,
     kKeywordCreateBuffer,
     kKeywordCreateEmptyTexture2d,
     kKeywordCreateProgram,
     kKeywordCreateRenderbuffer,
     kKeywordCreateSampler,
+    kKeywordCreateTexture2d,
     kKeywordDeclareShader,
     kKeywordDimension,
+    kKeywordDivisor,
     kKeywordDumpBufferBinary,
     kKeywordDumpBufferText,
     kKeywordDumpRenderbuffer,
+    kKeywordDynamic,
     kKeywordEnd,
     kKeywordExpected,
     kKeywordFile,
     kKeywordFormat,
     kKeywordFragment,
     kKeywordFramebufferAttachments,
+    kKeywordGenerateMipmaps,
     kKeywordGl,
     kKeywordGles,
+    kKeywordHash,
     kKeywordHeight,
     kKeywordIndexData,
+    kKeywordIndexSizeBytes,
+    kKeywordIndirectData,
+    kKeywordInitFile,
     kKeywordInitType,
     kKeywordInitValues,
+    kKeywordInstanceCount,
     kKeywordKind,
     kKeywordLinear,
     kKeywordLocation,
+    kKeywordMaxDifferingFraction,
+    kKeywordMinPsnr,
+    kKeywordMinSsim,
     kKeywordName,
     kKeywordNearest,
     kKeywordNumGroups,
     kKeywordOffsetBytes,
+    kKeywordPam,
     kKeywordParameter,
+    kKeywordPng,
+    kKeywordPpm,
     kKeywordProgram,
+    kKeywordQoi,
+    kKeywordR32ui,
+    kKeywordR8,
+    kKeywordRaw,
+    kKeywordRead,
     kKeywordRectangle,
+    kKeywordRel,
     kKeywordRenderbuffer,
     kKeywordRenderbuffers,
+    kKeywordRg16f,
+    kKeywordRgba32f,
+    kKeywordRgba8,
     kKeywordRunCompute,
+    kKeywordRunComputeIndirect,
     kKeywordRunGraphics,
     kKeywordSampler,
     kKeywordSetSamplerParameter,
@@ -85,6 +117,8 @@ class Token {
     kKeywordShaders,
     kKeywordSizeBytes,
     kKeywordSkipBytes,
+    kKeywordStatic,
+    kKeywordStream,
     kKeywordStrideBytes,
     kKeywordTexture,
     kKeywordTextureMagFilter,
@@ -117,6 +151,9 @@ class Token {
     kKeywordTypeVec2,
     kKeywordTypeVec3,
     kKeywordTypeVec4,
+    kKeywordUlp,
+    kKeywordUpdateBuffer,
+    kKeywordUsage,
     kKeywordValue,
     kKeywordValues,
     kKeywordVertex,
@@ -143,6 +180,11 @@ class Token {
 
   bool IsEOS() const;
 
+  // Returns true for an identifier, and also for a keyword that is only
+  // meaningful as a parameter name or value of particular commands, and that
+  // was added to the language after scripts may have used it as an
+  // identifier. The parser matches such keywords by their position, so
+  // accepting them where an identifier is expected keeps those scripts valid.
   bool IsIdentifier() const;
 
   bool IsIntLiteral() const;
@@ -27,7 +27,7 @@ class VertexAttributeInfo {
  public:
   VertexAttributeInfo(std::unique_ptr<Token> buffer_identifier,
                       size_t offset_bytes, size_t stride_bytes,
-                      size_t dimension);
+                      size_t dimension, size_t divisor);
 
   const std::string& GetBufferIdentifier() const {
     return buffer_identifier_->GetText();
@@ -41,11 +41,16 @@ class VertexAttributeInfo {
 
   size_t GetDimension() const { return dimension_; }
 
+  // The number of instances that share each element of the attribute; 0 if the
+  // attribute advances per vertex rather than per instance.
+  size_t GetDivisor() const { return divisor_; }
+
  private:
   std::unique_ptr<Token> buffer_identifier_;
   size_t offset_bytes_;
   size_t stride_bytes_;
   size_t dimension_;
+  size_t divisor_;
 };
 
 }  // namespace shadertrap
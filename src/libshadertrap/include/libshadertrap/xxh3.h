@@ -0,0 +1,70 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAP_XXH3_H
+#define LIBSHADERTRAP_XXH3_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace shadertrap {
+
+// Computes the 64-bit XXH3 hash, with the default secret and a seed of 0, of
+// the |size| bytes at |data|. The result matches that of the reference
+// implementation of xxHash, e.g. "xxhsum -H3", so that expected hashes can be
+// computed outside ShaderTrap.
+uint64_t Xxh3Hash64(const uint8_t* data, size_t size);
+
+// Computes the same hash as Xxh3Hash64 for input that is provided in pieces, so
+// that data too large to hold in memory at once can be hashed as it arrives.
+class Xxh3Hasher {
+ public:
+  Xxh3Hasher();
+
+  // Appends the |size| bytes at |data| to the input.
+  void Update(const uint8_t* data, size_t size);
+
+  // Returns the hash of all of the input provided so far.
+  uint64_t Digest() const;
+
+ private:
+  static const size_t kShortInputSizeBytes = 240;
+  static const size_t kBufferedStripeSizeBytes = 64;
+  static const size_t kNumHashAccumulators = 8;
+
+  // Accumulates the stripe at |stripe|, scrambling the accumulators if it
+  // completes a block.
+  void ConsumeStripe(const uint8_t* stripe);
+
+  uint64_t accumulators_[kNumHashAccumulators];
+  // The number of stripes of the current block that have been accumulated.
+  size_t num_block_stripes_;
+  uint64_t total_size_;
+  // The start of the input, which is hashed in full if the input is short.
+  uint8_t short_input_[kShortInputSizeBytes];
+  // The most recently accumulated stripe.
+  uint8_t previous_stripe_[kBufferedStripeSizeBytes];
+  // The input that follows |previous_stripe_|; between 1 and a whole stripe
+  // of it once there is any input.
+  uint8_t stripe_[kBufferedStripeSizeBytes];
+  size_t stripe_size_;
+};
+
+// Returns |hash| as 16 lowercase hexadecimal digits, as xxhsum writes it.
+std::string HashToHexString(uint64_t hash);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAP_XXH3_H
@@ -0,0 +1,377 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/buffer_text_writer.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace shadertrap {
+
+namespace {
+
+// Text is accumulated until it reaches this size, and is then written.
+const size_t kChunkSizeBytes = 1U << 20U;
+
+// Enough room for the text of any single value, including the terminating
+// null character that snprintf writes.
+const size_t kMaxValueTextSizeBytes = 32;
+
+// Floats that are whole numbers smaller than this in magnitude are written
+// without an exponent by "%g" with the default precision of 6.
+const float kMaxPlainWholeFloat = 1e6F;
+
+char* FormatUnsigned(uint32_t value, char* out) {
+  char digits[10];
+  size_t num_digits = 0;
+  do {
+    digits[num_digits++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  while (num_digits > 0) {
+    *out++ = digits[--num_digits];
+  }
+  return out;
+}
+
+char* FormatByte(uint8_t value, char* out) {
+  return FormatUnsigned(value, out);
+}
+
+char* FormatSigned(int32_t value, char* out) {
+  if (value < 0) {
+    *out++ = '-';
+    // Negating in unsigned arithmetic is well defined for INT32_MIN.
+    return FormatUnsigned(0U - static_cast<uint32_t>(value), out);
+  }
+  return FormatUnsigned(static_cast<uint32_t>(value), out);
+}
+
+// The fewest and most significant digits with which floats are written; 9
+// digits always suffice for a float to read back as the same value, and 6 is
+// the default precision of "%g" and of output streams.
+const int kMinFloatDigits = 6;
+const int kMaxFloatDigits = 9;
+
+const uint64_t kPowersOfTen[] = {1,         10,         100,     1000,
+                                 10000,     100000,     1000000, 10000000,
+                                 100000000, 1000000000, 10000000000};
+
+// Sets |numerator| / |denominator| to exactly |mantissa| * 2^|binary_exponent|
+// * 10^|decimal_scale|. Returns false if the numerator would not fit in 62 bits
+// or the denominator in 37, which keeps the arithmetic of FormatFloatExactly
+// free of overflow.
+bool ScaleExactly(uint64_t mantissa, int binary_exponent, int decimal_scale,
+                  uint64_t* numerator, uint64_t* denominator) {
+  const uint64_t kMaxNumerator = 1ULL << 62U;
+  const uint64_t kMaxDenominator = 1ULL << 37U;
+  *numerator = mantissa;
+  *denominator = 1;
+  if (binary_exponent >= 0) {
+    if (binary_exponent > 38) {
+      return false;
+    }
+    *numerator <<= static_cast<uint64_t>(binary_exponent);
+  } else {
+    if (binary_exponent < -37) {
+      return false;
+    }
+    *denominator <<= static_cast<uint64_t>(-binary_exponent);
+  }
+  uint64_t* scaled = decimal_scale >= 0 ? numerator : denominator;
+  for (int i = 0; i < std::abs(decimal_scale); i++) {
+    if (*scaled > kMaxNumerator / 10) {
+      return false;
+    }
+    *scaled *= 10;
+  }
+  return *numerator < kMaxNumerator && *denominator < kMaxDenominator;
+}
+
+// Writes the |num_digits| decimal digits of |digits|, which represent a value
+// whose leading digit has decimal exponent |exponent|, as "%g" with a precision
+// of |num_digits| would.
+char* FormatDecimal(uint64_t digits, int num_digits, int exponent, char* out) {
+  const int precision = num_digits;
+  char text[kMaxFloatDigits];
+  for (int i = num_digits - 1; i >= 0; i--) {
+    text[i] = static_cast<char>('0' + digits % 10);
+    digits /= 10;
+  }
+  // "%g" removes trailing zeros.
+  while (num_digits > 1 && text[num_digits - 1] == '0') {
+    num_digits--;
+  }
+  if (exponent < -4 || exponent >= precision) {
+    *out++ = text[0];
+    if (num_digits > 1) {
+      *out++ = '.';
+      out = std::copy(text + 1, text + num_digits, out);
+    }
+    *out++ = 'e';
+    *out++ = exponent < 0 ? '-' : '+';
+    const auto magnitude = static_cast<uint32_t>(std::abs(exponent));
+    if (magnitude < 10) {
+      *out++ = '0';
+    }
+    return FormatUnsigned(magnitude, out);
+  }
+  if (exponent < 0) {
+    *out++ = '0';
+    *out++ = '.';
+    out = std::fill_n(out, -exponent - 1, '0');
+    return std::copy(text, text + num_digits, out);
+  }
+  const int num_integer_digits = exponent + 1;
+  out = std::copy(text, text + std::min(num_digits, num_integer_digits), out);
+  if (num_digits < num_integer_digits) {
+    return std::fill_n(out, num_integer_digits - num_digits, '0');
+  }
+  if (num_digits > num_integer_digits) {
+    *out++ = '.';
+    out = std::copy(text + num_integer_digits, text + num_digits, out);
+  }
+  return out;
+}
+
+// Formats the finite, non-zero |value| as FormatFloat does, but using exact
+// integer arithmetic rather than snprintf and strtof. Returns nullptr if
+// |value| is too large, too small or subnormal for the arithmetic to fit in 64
+// bits, which leaves values between about 1e-3 and 1e16.
+char* FormatFloatExactly(float value, char* out) {
+  uint32_t bits;
+  memcpy(&bits, &value, sizeof(bits));
+  const uint32_t exponent_field = (bits >> 23U) & 0xffU;
+  if (exponent_field == 0) {
+    return nullptr;
+  }
+  // |value| is +/- |mantissa| * 2^|binary_exponent|.
+  const uint64_t mantissa = (bits & 0x7fffffU) | 0x800000U;
+  const int binary_exponent = static_cast<int>(exponent_field) - 150;
+  // The neighbouring float of smaller magnitude is closer than the one of
+  // larger magnitude if |mantissa| is a power of two.
+  const bool closer_below = mantissa == 0x800000U && exponent_field > 1;
+  // Ties between neighbouring floats are broken in favour of even mantissas.
+  const bool ties_read_back = (mantissa & 1U) == 0;
+
+  int exponent = static_cast<int>(std::floor(std::log10(std::fabs(value))));
+  for (int num_digits = kMinFloatDigits; num_digits <= kMaxFloatDigits;
+       num_digits++) {
+    // Find the decimal exponent of the leading digit, correcting the estimate
+    // from log10 if necessary, so that |value| * 10^scale lies in
+    // [10^(num_digits - 1), 10^num_digits).
+    uint64_t numerator;
+    uint64_t denominator;
+    uint64_t truncated;
+    while (true) {
+      if (!ScaleExactly(mantissa, binary_exponent, num_digits - 1 - exponent,
+                        &numerator, &denominator)) {
+        return nullptr;
+      }
+      truncated = numerator / denominator;
+      if (truncated >= kPowersOfTen[num_digits]) {
+        exponent++;
+      } else if (truncated < kPowersOfTen[num_digits - 1]) {
+        exponent--;
+      } else {
+        break;
+      }
+    }
+    // Round to nearest, breaking ties in favour of even digits as snprintf
+    // does.
+    const uint64_t remainder = numerator % denominator;
+    const bool round_up =
+        2 * remainder > denominator ||
+        (2 * remainder == denominator && (truncated & 1U) != 0);
+    const uint64_t digits = round_up ? truncated + 1 : truncated;
+    // The rounded decimal reads back as |value| if it is closer to |value|
+    // than half the gap to the neighbouring float on the same side.
+    const bool below = !round_up;
+    const uint64_t distance = round_up ? denominator - remainder : remainder;
+    const uint64_t scaled_distance =
+        distance * (below && closer_below ? 4 : 2) * mantissa;
+    if (scaled_distance < numerator ||
+        (scaled_distance == numerator && ties_read_back)) {
+      if (std::signbit(value)) {
+        *out++ = '-';
+      }
+      if (digits == kPowersOfTen[num_digits]) {
+        // Rounding carried into a new leading digit.
+        return FormatDecimal(digits / 10, num_digits, exponent + 1, out);
+      }
+      return FormatDecimal(digits, num_digits, exponent, out);
+    }
+  }
+  assert(false && "Nine significant digits should always suffice.");
+  return nullptr;
+}
+
+char* FormatFloat(float value, char* out) {
+  if (std::fabs(value) < kMaxPlainWholeFloat && value == std::trunc(value)) {
+    // Whole numbers are common in buffers, and are formatted most simply;
+    // "%g" writes negative zero as "-0".
+    if (std::signbit(value)) {
+      *out++ = '-';
+    }
+    return FormatUnsigned(static_cast<uint32_t>(std::fabs(value)), out);
+  }
+  if (std::isfinite(value)) {
+    char* end = FormatFloatExactly(value, out);
+    if (end != nullptr) {
+      return end;
+    }
+  }
+  int precision = kMinFloatDigits;
+  int length;
+  while (true) {
+    length = snprintf(out, kMaxValueTextSizeBytes, "%.*g", precision,
+                      static_cast<double>(value));
+    if (precision == kMaxFloatDigits || std::isnan(value) ||
+        std::strtof(out, nullptr) == value) {
+      break;
+    }
+    precision++;
+  }
+  return out + length;
+}
+
+// Gathers text in chunks, passing each chunk to a consumer once it is full.
+class ChunkedTextWriter {
+ public:
+  explicit ChunkedTextWriter(const TextChunkConsumer& consume_chunk)
+      : consume_chunk_(consume_chunk),
+        chunk_(kChunkSizeBytes + kMaxValueTextSizeBytes),
+        used_bytes_(0),
+        failed_(false) {}
+
+  void AppendString(const std::string& text) {
+    for (size_t written = 0; written < text.size();) {
+      size_t count =
+          std::min(text.size() - written, kChunkSizeBytes - used_bytes_);
+      memcpy(chunk_.data() + used_bytes_, text.data() + written, count);
+      used_bytes_ += count;
+      written += count;
+      WriteChunkIfFull();
+    }
+  }
+
+  // Formats the |count| values of type T at |data|, separated by spaces, using
+  // |format|.
+  template <typename T>
+  void AppendValues(const uint8_t* data, size_t count,
+                    char* (*format)(T value, char* out)) {
+    for (size_t i = 0; i < count; i++) {
+      if (i > 0) {
+        chunk_[used_bytes_++] = ' ';
+      }
+      T value;
+      memcpy(&value, data + i * sizeof(T), sizeof(T));
+      char* end = format(value, chunk_.data() + used_bytes_);
+      used_bytes_ = static_cast<size_t>(end - chunk_.data());
+      WriteChunkIfFull();
+    }
+  }
+
+  bool Finish() {
+    WriteChunk();
+    return !failed_;
+  }
+
+ private:
+  // The chunk has room beyond kChunkSizeBytes for the text of one value, so
+  // that a value can be formatted in place without checking for space first.
+  void WriteChunkIfFull() {
+    if (used_bytes_ >= kChunkSizeBytes) {
+      WriteChunk();
+    }
+  }
+
+  // Once a chunk could not be written, the remaining text is discarded.
+  void WriteChunk() {
+    if (!failed_ && used_bytes_ > 0) {
+      failed_ = !consume_chunk_(chunk_.data(), used_bytes_);
+    }
+    used_bytes_ = 0;
+  }
+
+  const TextChunkConsumer& consume_chunk_;
+  std::vector<char> chunk_;
+  size_t used_bytes_;
+  bool failed_;
+};
+
+}  // namespace
+
+bool WriteBufferText(
+    const uint8_t* data,
+    const std::vector<CommandDumpBufferText::FormatEntry>& format_entries,
+    const TextChunkConsumer& consume_chunk) {
+  ChunkedTextWriter writer(consume_chunk);
+  size_t offset = 0;
+  for (const auto& format_entry : format_entries) {
+    switch (format_entry.kind) {
+      case CommandDumpBufferText::FormatEntry::Kind::kSkip:
+        offset += format_entry.count;
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kString:
+        writer.AppendString(format_entry.token->GetText());
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kByte:
+        writer.AppendValues<uint8_t>(data + offset, format_entry.count,
+                                     FormatByte);
+        offset += format_entry.count;
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kInt:
+        writer.AppendValues<int32_t>(data + offset, format_entry.count,
+                                     FormatSigned);
+        offset += format_entry.count * sizeof(int32_t);
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kUint:
+        writer.AppendValues<uint32_t>(data + offset, format_entry.count,
+                                      FormatUnsigned);
+        offset += format_entry.count * sizeof(uint32_t);
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kFloat:
+        writer.AppendValues<float>(data + offset, format_entry.count,
+                                   FormatFloat);
+        offset += format_entry.count * sizeof(float);
+        break;
+    }
+  }
+  return writer.Finish();
+}
+
+bool WriteBufferText(
+    const uint8_t* data,
+    const std::vector<CommandDumpBufferText::FormatEntry>& format_entries,
+    std::ostream* stream) {
+  if (!WriteBufferText(data, format_entries,
+                       [stream](const char* text, size_t size) -> bool {
+                         stream->write(text,
+                                       static_cast<std::streamsize>(size));
+                         return !stream->fail();
+                       })) {
+    return false;
+  }
+  stream->flush();
+  return !stream->fail();
+}
+
+}  // namespace shadertrap
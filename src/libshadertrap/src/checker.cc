@@ -14,14 +14,17 @@
 
 #include "libshadertrap/checker.h"
 
+#include <algorithm>
 #include <cassert>
 #include <cctype>
 #include <cstddef>
+#include <cstdint>
 #include <initializer_list>
 #include <type_traits>  // IWYU pragma: keep
 #include <utility>
 #include <vector>
 
+#include "libshadertrap/image_compare.h"
 #include "libshadertrap/make_unique.h"
 #include "libshadertrap/tokenizer.h"
 #include "libshadertrap/vertex_attribute_info.h"
@@ -143,13 +146,38 @@ const TBuiltInResource kDefaultTBuiltInResource = {
 Checker::Checker(MessageConsumer* message_consumer, ApiVersion api_version)
     : message_consumer_(message_consumer), api_version_(api_version) {}
 
+bool Checker::VisitAssertBufferHash(
+    CommandAssertBufferHash* assert_buffer_hash) {
+  if (created_buffers_.count(assert_buffer_hash->GetBufferIdentifier()) == 0) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &assert_buffer_hash->GetBufferIdentifierToken(),
+        "'" + assert_buffer_hash->GetBufferIdentifier() + "' must be a buffer");
+    return false;
+  }
+  if (assert_buffer_hash->GetFormatEntries().empty()) {
+    return true;
+  }
+  return CheckFormatEntries(
+      assert_buffer_hash->GetFormatEntries(),
+      *created_buffers_.at(assert_buffer_hash->GetBufferIdentifier()));
+}
+
 bool Checker::VisitAssertEqual(CommandAssertEqual* command_assert_equal) {
   const auto& operand1_token =
       command_assert_equal->GetArgumentIdentifier1Token();
-  const auto& operand2_token =
-      command_assert_equal->GetArgumentIdentifier2Token();
   bool found_errors = false;
-  if (command_assert_equal->GetArgumentsAreRenderbuffers()) {
+  if (command_assert_equal->GetComparesWithFile()) {
+    // The size of the file is only known when the command is executed.
+    if (created_buffers_.count(operand1_token.GetText()) == 0) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError, &operand1_token,
+          "'" + operand1_token.GetText() + "' must be a buffer");
+      return false;
+    }
+  } else if (command_assert_equal->GetArgumentsAreRenderbuffers()) {
+    const auto& operand2_token =
+        command_assert_equal->GetArgumentIdentifier2Token();
     for (const auto& operand_token : {operand1_token, operand2_token}) {
       if (created_renderbuffers_.count(operand_token.GetText()) == 0) {
         message_consumer_->Message(
@@ -165,6 +193,8 @@ bool Checker::VisitAssertEqual(CommandAssertEqual* command_assert_equal) {
       return false;
     }
   } else {
+    const auto& operand2_token =
+        command_assert_equal->GetArgumentIdentifier2Token();
     for (const auto& operand_token : {operand1_token, operand2_token}) {
       if (created_buffers_.count(operand_token.GetText()) == 0) {
         message_consumer_->Message(
@@ -227,28 +257,56 @@ bool Checker::VisitAssertEqual(CommandAssertEqual* command_assert_equal) {
     }
 
     auto* buffer1 = created_buffers_.at(operand1_token.GetText());
-    auto* buffer2 = created_buffers_.at(operand2_token.GetText());
     const size_t expected_bytes = buffer1->GetSizeBytes();
+    std::string compared_names = buffer1->GetResultIdentifier();
+    if (!command_assert_equal->GetComparesWithFile()) {
+      compared_names += "(" +
+                        command_assert_equal->GetArgumentIdentifier2() + ")";
+    }
 
     if (total_count_bytes != expected_bytes) {
       message_consumer_->Message(
           MessageConsumer::Severity::kError,
           command_assert_equal->GetFormatEntries()[0].token.get(),
           "The number of bytes specified in the formatting of '" +
-              buffer1->GetResultIdentifier() + "(" +
-              buffer2->GetResultIdentifier() + ")" + "' is " +
-              std::to_string(total_count_bytes) + ", but '" +
-              buffer1->GetResultIdentifier() + "(" +
-              buffer2->GetResultIdentifier() + ")" +
-              "' was declared with size " + std::to_string(expected_bytes) +
-              " byte" + (expected_bytes > 1 ? "s" : "") + " at " +
+              compared_names + "' is " + std::to_string(total_count_bytes) +
+              ", but '" + compared_names + "' was declared with size " +
+              std::to_string(expected_bytes) + " byte" +
+              (expected_bytes > 1 ? "s" : "") + " at " +
               buffer1->GetStartToken().GetLocationString());
       found_errors = true;
     }
   }
+  if (command_assert_equal->HasTolerance() &&
+      std::none_of(format_entries.begin(), format_entries.end(),
+                   [](const CommandAssertEqual::FormatEntry& format_entry) {
+                     return format_entry.kind ==
+                            CommandAssertEqual::FormatEntry::Kind::kFloat;
+                   })) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &command_assert_equal->GetToleranceToken(),
+        "TOLERANCE only applies to 'float' formatting entries, and there are "
+        "none");
+    found_errors = true;
+  }
   return !found_errors;
 }
 
+bool Checker::VisitAssertMatchesImage(
+    CommandAssertMatchesImage* assert_matches_image) {
+  if (created_renderbuffers_.count(
+          assert_matches_image->GetRenderbufferIdentifier()) == 0) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &assert_matches_image->GetRenderbufferIdentifierToken(),
+        "'" + assert_matches_image->GetRenderbufferIdentifier() +
+            "' must be a renderbuffer");
+    return false;
+  }
+  return true;
+}
+
 bool Checker::VisitAssertPixels(CommandAssertPixels* command_assert_pixels) {
   if (created_renderbuffers_.count(
           command_assert_pixels->GetRenderbufferIdentifier()) == 0) {
@@ -302,6 +360,20 @@ bool Checker::VisitAssertPixels(CommandAssertPixels* command_assert_pixels) {
   return !found_errors;
 }
 
+bool Checker::VisitAssertRenderbufferHash(
+    CommandAssertRenderbufferHash* assert_renderbuffer_hash) {
+  if (created_renderbuffers_.count(
+          assert_renderbuffer_hash->GetRenderbufferIdentifier()) == 0) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &assert_renderbuffer_hash->GetRenderbufferIdentifierToken(),
+        "'" + assert_renderbuffer_hash->GetRenderbufferIdentifier() +
+            "' must be a renderbuffer");
+    return false;
+  }
+  return true;
+}
+
 bool Checker::VisitAssertSimilarEmdHistogram(
     CommandAssertSimilarEmdHistogram* command_assert_similar_emd_histogram) {
   bool both_renderbuffers_present = true;
@@ -337,6 +409,44 @@ bool Checker::VisitAssertSimilarEmdHistogram(
       command_assert_similar_emd_histogram->GetRenderbufferIdentifier2Token());
 }
 
+bool Checker::VisitAssertSimilarImage(
+    CommandAssertSimilarImage* command_assert_similar_image) {
+  bool found_errors = false;
+  for (const Token* renderbuffer_token :
+       {&command_assert_similar_image->GetRenderbufferIdentifier1Token(),
+        &command_assert_similar_image->GetRenderbufferIdentifier2Token()}) {
+    if (created_renderbuffers_.count(renderbuffer_token->GetText()) == 0) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError, renderbuffer_token,
+          "'" + renderbuffer_token->GetText() + "' must be a renderbuffer");
+      found_errors = true;
+    }
+  }
+  if (found_errors ||
+      !CheckRenderbufferDimensionsMatch(
+          command_assert_similar_image->GetRenderbufferIdentifier1Token(),
+          command_assert_similar_image->GetRenderbufferIdentifier2Token())) {
+    return false;
+  }
+  const auto* renderbuffer = created_renderbuffers_.at(
+      command_assert_similar_image->GetRenderbufferIdentifier1());
+  if (command_assert_similar_image->HasMinSsim() &&
+      (renderbuffer->GetWidth() < kSsimWindowSize ||
+       renderbuffer->GetHeight() < kSsimWindowSize)) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &command_assert_similar_image->GetMinSsimToken(),
+        "MIN_SSIM requires renderbuffers of at least " +
+            std::to_string(kSsimWindowSize) + "x" +
+            std::to_string(kSsimWindowSize) + " pixels, but '" +
+            command_assert_similar_image->GetRenderbufferIdentifier1() +
+            "' is " + std::to_string(renderbuffer->GetWidth()) + "x" +
+            std::to_string(renderbuffer->GetHeight()));
+    return false;
+  }
+  return true;
+}
+
 bool Checker::VisitBindSampler(CommandBindSampler* command_bind_sampler) {
   if (created_samplers_.count(command_bind_sampler->GetSamplerIdentifier()) ==
       0) {
@@ -592,6 +702,55 @@ bool Checker::VisitCreateRenderbuffer(
   return true;
 }
 
+bool Checker::VisitCreateTexture2D(
+    CommandCreateTexture2D* command_create_texture_2d) {
+  if (!CheckIdentifierIsFresh(
+          command_create_texture_2d->GetResultIdentifierToken())) {
+    return false;
+  }
+  if (command_create_texture_2d->GetFormat() !=
+          CommandCreateTexture2D::Format::kRgba8 &&
+      !ApiVersionIsAtLeast(ApiVersion(ApiVersion::Api::GL, 3, 0),
+                           ApiVersion(ApiVersion::Api::GLES, 3, 0))) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &command_create_texture_2d->GetStartToken(),
+        "Texture format " +
+            CommandCreateTexture2D::FormatToString(
+                command_create_texture_2d->GetFormat()) +
+            " is not supported before OpenGL 3.0 or OpenGL ES 3.0");
+    return false;
+  }
+  if (command_create_texture_2d->GetGenerateMipmaps()) {
+    // Mipmaps can only be generated for formats that are filterable, and on
+    // OpenGL ES the format must also be color-renderable.
+    const CommandCreateTexture2D::Format format =
+        command_create_texture_2d->GetFormat();
+    std::string reason;
+    if (format == CommandCreateTexture2D::Format::kR32ui) {
+      reason = "integer formats are not filterable";
+    } else if (api_version_.GetApi() == ApiVersion::Api::GLES) {
+      if (format == CommandCreateTexture2D::Format::kRgba32f) {
+        reason = "it is not filterable or color-renderable on OpenGL ES";
+      } else if (format == CommandCreateTexture2D::Format::kRg16f &&
+                 api_version_ < ApiVersion(ApiVersion::Api::GLES, 3, 2)) {
+        reason = "it is not color-renderable before OpenGL ES 3.2";
+      }
+    }
+    if (!reason.empty()) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError,
+          &command_create_texture_2d->GetStartToken(),
+          "GENERATE_MIPMAPS cannot be used with texture format " +
+              CommandCreateTexture2D::FormatToString(format) + ": " + reason);
+      return false;
+    }
+  }
+  created_textures_.insert({command_create_texture_2d->GetResultIdentifier(),
+                            command_create_texture_2d});
+  return true;
+}
+
 bool Checker::VisitDeclareShader(CommandDeclareShader* declare_shader) {
   if (!CheckIdentifierIsFresh(declare_shader->GetResultIdentifierToken())) {
     return false;
@@ -675,88 +834,62 @@ bool Checker::VisitDumpBufferText(CommandDumpBufferText* dump_buffer_text) {
         "'" + dump_buffer_text->GetBufferIdentifier() + "' must be a buffer");
     return false;
   }
-  bool errors_found = false;
-  size_t total_count_bytes = 0;
-  for (const auto& format_entry : dump_buffer_text->GetFormatEntries()) {
-    switch (format_entry.kind) {
-      case CommandDumpBufferText::FormatEntry::Kind::kString:
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kByte:
-      case CommandDumpBufferText::FormatEntry::Kind::kSkip:
-        if (format_entry.count == 0) {
-          message_consumer_->Message(
-              MessageConsumer::Severity::kError, format_entry.token.get(),
-              "The count for a formatting entry must be positive");
-          errors_found = true;
-        }
-        if (format_entry.count % 4 != 0) {
-          message_consumer_->Message(
-              MessageConsumer::Severity::kError, format_entry.token.get(),
-              "The count for a '" +
-                  Tokenizer::KeywordToString(
-                      format_entry.kind ==
-                              CommandDumpBufferText::FormatEntry::Kind::kByte
-                          ? Token::Type::kKeywordTypeByte
-                          : Token::Type::kKeywordSkipBytes) +
-                  "' formatting entry must be a multiple of 4; found " +
-                  std::to_string(format_entry.count));
-          errors_found = true;
-        }
-        total_count_bytes += format_entry.count;
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kFloat:
-      case CommandDumpBufferText::FormatEntry::Kind::kInt:
-      case CommandDumpBufferText::FormatEntry::Kind::kUint:
-        if (format_entry.count == 0) {
-          message_consumer_->Message(
-              MessageConsumer::Severity::kError, format_entry.token.get(),
-              "The count for a formatting entry must be positive");
-          errors_found = true;
-        }
-        total_count_bytes += format_entry.count * 4;
-        break;
-    }
-  }
-  auto* buffer = created_buffers_.at(dump_buffer_text->GetBufferIdentifier());
-  const size_t expected_bytes = buffer->GetSizeBytes();
-  if (total_count_bytes != expected_bytes) {
-    message_consumer_->Message(
-        MessageConsumer::Severity::kError,
-        dump_buffer_text->GetFormatEntries()[0].token.get(),
-        "The number of bytes specified in the formatting of '" +
-            buffer->GetResultIdentifier() + "' is " +
-            std::to_string(total_count_bytes) + ", but '" +
-            buffer->GetResultIdentifier() + "' was declared with size " +
-            std::to_string(expected_bytes) + " byte" +
-            (expected_bytes > 1 ? "s" : "") + " at " +
-            buffer->GetStartToken().GetLocationString());
-    errors_found = true;
-  }
-  return !errors_found;
+  return CheckFormatEntries(
+      dump_buffer_text->GetFormatEntries(),
+      *created_buffers_.at(dump_buffer_text->GetBufferIdentifier()));
 }
 
 bool Checker::VisitRunCompute(CommandRunCompute* command_run_compute) {
-  if (created_programs_.count(command_run_compute->GetProgramIdentifier()) ==
-      0) {
-    message_consumer_->Message(
-        MessageConsumer::Severity::kError,
-        &command_run_compute->GetProgramIdentifierToken(),
-        "'" + command_run_compute->GetProgramIdentifier() +
-            "' must be a program");
+  return CheckIsComputeProgram(
+      command_run_compute->GetProgramIdentifierToken());
+}
+
+bool Checker::VisitRunComputeIndirect(
+    CommandRunComputeIndirect* run_compute_indirect) {
+  if (!CheckIsComputeProgram(
+          run_compute_indirect->GetProgramIdentifierToken())) {
     return false;
   }
-  if (created_programs_.at(command_run_compute->GetProgramIdentifier())
-          ->GetNumCompiledShaders() != 1) {
-    // A compute program comprises a single (compute) shader; if there is not
-    // exactly one shader then this must be a graphics program.
+  if (created_buffers_.count(run_compute_indirect->GetBufferIdentifier()) ==
+      0) {
     message_consumer_->Message(
         MessageConsumer::Severity::kError,
-        &command_run_compute->GetProgramIdentifierToken(),
-        "'" + command_run_compute->GetProgramIdentifier() +
-            "' must be a compute program, not a graphics program");
+        &run_compute_indirect->GetBufferIdentifierToken(),
+        "'" + run_compute_indirect->GetBufferIdentifier() +
+            "' must be a buffer");
     return false;
   }
-  return true;
+  const auto* buffer =
+      created_buffers_.at(run_compute_indirect->GetBufferIdentifier());
+  // The numbers of groups are three uint values, which must be aligned.
+  const size_t kNumGroupsSizeBytes = 3 * sizeof(uint32_t);
+  bool errors_found = false;
+  for (size_t index = 0; index < run_compute_indirect->GetOffsetsBytes().size();
+       index++) {
+    const size_t offset = run_compute_indirect->GetOffsetsBytes()[index];
+    if (offset % sizeof(uint32_t) != 0) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError,
+          &run_compute_indirect->GetOffsetToken(index),
+          "The offset " + std::to_string(offset) + " into '" +
+              buffer->GetResultIdentifier() + "' must be a multiple of " +
+              std::to_string(sizeof(uint32_t)));
+      errors_found = true;
+    } else if (offset + kNumGroupsSizeBytes > buffer->GetSizeBytes()) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError,
+          &run_compute_indirect->GetOffsetToken(index),
+          "The numbers of groups at offset " + std::to_string(offset) +
+              " occupy " + std::to_string(kNumGroupsSizeBytes) +
+              " bytes, which overruns '" + buffer->GetResultIdentifier() +
+              "', declared with size " +
+              std::to_string(buffer->GetSizeBytes()) + " byte" +
+              (buffer->GetSizeBytes() > 1 ? "s" : "") + " at " +
+              buffer->GetStartToken().GetLocationString());
+      errors_found = true;
+    }
+  }
+  return !errors_found;
 }
 
 bool Checker::VisitRunGraphics(CommandRunGraphics* command_run_graphics) {
@@ -789,8 +922,18 @@ bool Checker::VisitRunGraphics(CommandRunGraphics* command_run_graphics) {
                                      "' must be a buffer");
       errors_found = true;
     }
+    if (entry.second.GetDivisor() != 0 &&
+        !ApiVersionIsAtLeast(ApiVersion(ApiVersion::Api::GL, 3, 3),
+                             ApiVersion(ApiVersion::Api::GLES, 3, 0))) {
+      message_consumer_->Message(MessageConsumer::Severity::kError,
+                                 &entry.second.GetBufferIdentifierToken(),
+                                 "Vertex attribute divisors are not supported "
+                                 "before OpenGL 3.3 or OpenGL ES 3.0");
+      errors_found = true;
+    }
   }
-  if (created_buffers_.count(
+  if (command_run_graphics->HasIndexData() &&
+      created_buffers_.count(
           command_run_graphics->GetIndexDataBufferIdentifier()) == 0) {
     message_consumer_->Message(
         MessageConsumer::Severity::kError,
@@ -800,6 +943,19 @@ bool Checker::VisitRunGraphics(CommandRunGraphics* command_run_graphics) {
             "' must be a buffer");
     errors_found = true;
   }
+  if (command_run_graphics->GetInstanceCount() != 1 &&
+      !ApiVersionIsAtLeast(ApiVersion(ApiVersion::Api::GL, 3, 1),
+                           ApiVersion(ApiVersion::Api::GLES, 3, 0))) {
+    message_consumer_->Message(MessageConsumer::Severity::kError,
+                               &command_run_graphics->GetStartToken(),
+                               "Instanced draws are not supported before "
+                               "OpenGL 3.1 or OpenGL ES 3.0");
+    errors_found = true;
+  }
+  if (command_run_graphics->HasIndirectData() &&
+      !CheckIndirectDrawParameters(*command_run_graphics)) {
+    errors_found = true;
+  }
   for (const auto& entry : command_run_graphics->GetFramebufferAttachments()) {
     if (api_version_ == ApiVersion(ApiVersion::Api::GLES, 2, 0) &&
         entry.first != 0) {
@@ -863,6 +1019,32 @@ bool Checker::VisitSetUniform(CommandSetUniform* command_set_uniform) {
   return true;
 }
 
+bool Checker::VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) {
+  if (created_buffers_.count(update_buffer->GetBufferIdentifier()) == 0) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        &update_buffer->GetBufferIdentifierToken(),
+        "'" + update_buffer->GetBufferIdentifier() + "' must be a buffer");
+    return false;
+  }
+  const auto* buffer =
+      created_buffers_.at(update_buffer->GetBufferIdentifier());
+  if (update_buffer->GetOffsetBytes() + update_buffer->GetSizeBytes() >
+      buffer->GetSizeBytes()) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, &update_buffer->GetStartToken(),
+        "Updating " + std::to_string(update_buffer->GetSizeBytes()) +
+            " bytes at offset " +
+            std::to_string(update_buffer->GetOffsetBytes()) + " overruns '" +
+            buffer->GetResultIdentifier() + "', declared with size " +
+            std::to_string(buffer->GetSizeBytes()) + " byte" +
+            (buffer->GetSizeBytes() > 1 ? "s" : "") + " at " +
+            buffer->GetStartToken().GetLocationString());
+    return false;
+  }
+  return true;
+}
+
 bool Checker::CheckIdentifierIsFresh(const Token& identifier) {
   if (used_identifiers_.count(identifier.GetText()) > 0) {
     message_consumer_->Message(
@@ -992,4 +1174,146 @@ bool Checker::CheckRenderbufferDimensionsMatch(
   return result;
 }
 
+bool Checker::CheckIsComputeProgram(const Token& program_identifier_token) {
+  const std::string& program_identifier = program_identifier_token.GetText();
+  if (created_programs_.count(program_identifier) == 0) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, &program_identifier_token,
+        "'" + program_identifier + "' must be a program");
+    return false;
+  }
+  if (created_programs_.at(program_identifier)->GetNumCompiledShaders() != 1) {
+    // A compute program comprises a single (compute) shader; if there is not
+    // exactly one shader then this must be a graphics program.
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, &program_identifier_token,
+        "'" + program_identifier +
+            "' must be a compute program, not a graphics program");
+    return false;
+  }
+  return true;
+}
+
+bool Checker::CheckIndirectDrawParameters(
+    const CommandRunGraphics& command_run_graphics) {
+  const Token& buffer_identifier_token =
+      command_run_graphics.GetIndirectDataBufferIdentifierToken();
+  if (!ApiVersionIsAtLeast(ApiVersion(ApiVersion::Api::GL, 4, 0),
+                           ApiVersion(ApiVersion::Api::GLES, 3, 1))) {
+    message_consumer_->Message(MessageConsumer::Severity::kError,
+                               &buffer_identifier_token,
+                               "Indirect draws are not supported before "
+                               "OpenGL 4.0 or OpenGL ES 3.1");
+    return false;
+  }
+  if (created_buffers_.count(buffer_identifier_token.GetText()) == 0) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, &buffer_identifier_token,
+        "indirect data buffer '" + buffer_identifier_token.GetText() +
+            "' must be a buffer");
+    return false;
+  }
+  const auto* buffer = created_buffers_.at(buffer_identifier_token.GetText());
+  // An indexed draw is described by five uint values (count, instance count,
+  // first index, base vertex and base instance); a non-indexed draw by four
+  // (count, instance count, first vertex and base instance).
+  const size_t kDrawParametersSizeBytes =
+      (command_run_graphics.HasIndexData() ? 5 : 4) * sizeof(uint32_t);
+  bool errors_found = false;
+  for (size_t index = 0;
+       index < command_run_graphics.GetIndirectOffsetsBytes().size(); index++) {
+    const size_t offset = command_run_graphics.GetIndirectOffsetsBytes()[index];
+    if (offset % sizeof(uint32_t) != 0) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError,
+          &command_run_graphics.GetIndirectOffsetToken(index),
+          "The offset " + std::to_string(offset) + " into '" +
+              buffer->GetResultIdentifier() + "' must be a multiple of " +
+              std::to_string(sizeof(uint32_t)));
+      errors_found = true;
+    } else if (offset + kDrawParametersSizeBytes > buffer->GetSizeBytes()) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError,
+          &command_run_graphics.GetIndirectOffsetToken(index),
+          "The draw parameters at offset " + std::to_string(offset) +
+              " occupy " + std::to_string(kDrawParametersSizeBytes) +
+              " bytes, which overruns '" + buffer->GetResultIdentifier() +
+              "', declared with size " +
+              std::to_string(buffer->GetSizeBytes()) + " byte" +
+              (buffer->GetSizeBytes() > 1 ? "s" : "") + " at " +
+              buffer->GetStartToken().GetLocationString());
+      errors_found = true;
+    }
+  }
+  return !errors_found;
+}
+
+bool Checker::CheckFormatEntries(
+    const std::vector<CommandDumpBufferText::FormatEntry>& format_entries,
+    const CommandCreateBuffer& buffer) {
+  bool errors_found = false;
+  size_t total_count_bytes = 0;
+  for (const auto& format_entry : format_entries) {
+    switch (format_entry.kind) {
+      case CommandDumpBufferText::FormatEntry::Kind::kString:
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kByte:
+      case CommandDumpBufferText::FormatEntry::Kind::kSkip:
+        if (format_entry.count == 0) {
+          message_consumer_->Message(
+              MessageConsumer::Severity::kError, format_entry.token.get(),
+              "The count for a formatting entry must be positive");
+          errors_found = true;
+        }
+        if (format_entry.count % 4 != 0) {
+          message_consumer_->Message(
+              MessageConsumer::Severity::kError, format_entry.token.get(),
+              "The count for a '" +
+                  Tokenizer::KeywordToString(
+                      format_entry.kind ==
+                              CommandDumpBufferText::FormatEntry::Kind::kByte
+                          ? Token::Type::kKeywordTypeByte
+                          : Token::Type::kKeywordSkipBytes) +
+                  "' formatting entry must be a multiple of 4; found " +
+                  std::to_string(format_entry.count));
+          errors_found = true;
+        }
+        total_count_bytes += format_entry.count;
+        break;
+      case CommandDumpBufferText::FormatEntry::Kind::kFloat:
+      case CommandDumpBufferText::FormatEntry::Kind::kInt:
+      case CommandDumpBufferText::FormatEntry::Kind::kUint:
+        if (format_entry.count == 0) {
+          message_consumer_->Message(
+              MessageConsumer::Severity::kError, format_entry.token.get(),
+              "The count for a formatting entry must be positive");
+          errors_found = true;
+        }
+        total_count_bytes += format_entry.count * 4;
+        break;
+    }
+  }
+  const size_t expected_bytes = buffer.GetSizeBytes();
+  if (total_count_bytes != expected_bytes) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, format_entries[0].token.get(),
+        "The number of bytes specified in the formatting of '" +
+            buffer.GetResultIdentifier() + "' is " +
+            std::to_string(total_count_bytes) + ", but '" +
+            buffer.GetResultIdentifier() + "' was declared with size " +
+            std::to_string(expected_bytes) + " byte" +
+            (expected_bytes > 1 ? "s" : "") + " at " +
+            buffer.GetStartToken().GetLocationString());
+    errors_found = true;
+  }
+  return !errors_found;
+}
+
+bool Checker::ApiVersionIsAtLeast(const ApiVersion& gl_version,
+                                  const ApiVersion& gles_version) const {
+  return api_version_.GetApi() == ApiVersion::Api::GL
+             ? api_version_ >= gl_version
+             : api_version_ >= gles_version;
+}
+
 }  // namespace shadertrap
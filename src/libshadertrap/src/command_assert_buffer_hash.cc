@@ -0,0 +1,38 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/command_assert_buffer_hash.h"
+
+#include <utility>
+
+#include "libshadertrap/command_visitor.h"
+
+namespace shadertrap {
+
+CommandAssertBufferHash::CommandAssertBufferHash(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> buffer_identifier,
+    std::vector<CommandDumpBufferText::FormatEntry> format_entries,
+    std::unique_ptr<Token> expected_hash_token, uint64_t expected_hash)
+    : Command(std::move(start_token)),
+      buffer_identifier_(std::move(buffer_identifier)),
+      format_entries_(std::move(format_entries)),
+      expected_hash_token_(std::move(expected_hash_token)),
+      expected_hash_(expected_hash) {}
+
+bool CommandAssertBufferHash::Accept(CommandVisitor* visitor) {
+  return visitor->VisitAssertBufferHash(this);
+}
+
+}  // namespace shadertrap
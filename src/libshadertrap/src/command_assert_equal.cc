@@ -24,12 +24,15 @@ CommandAssertEqual::CommandAssertEqual(
     std::unique_ptr<Token> start_token,
     std::unique_ptr<Token> argument_identifier_1,
     std::unique_ptr<Token> argument_identifier_2,
-    std::vector<FormatEntry> format_entries)
+    std::vector<FormatEntry> format_entries,
+    std::unique_ptr<Token> tolerance_token, const FloatTolerance& tolerance)
     : Command(std::move(start_token)),
       arguments_are_renderbuffers_(false),
       argument_identifier_1_(std::move(argument_identifier_1)),
       argument_identifier_2_(std::move(argument_identifier_2)),
-      format_entries_(std::move(format_entries)) {}
+      format_entries_(std::move(format_entries)),
+      tolerance_token_(std::move(tolerance_token)),
+      tolerance_(tolerance) {}
 
 CommandAssertEqual::CommandAssertEqual(
     std::unique_ptr<Token> start_token,
@@ -38,7 +41,21 @@ CommandAssertEqual::CommandAssertEqual(
     : Command(std::move(start_token)),
       arguments_are_renderbuffers_(true),
       argument_identifier_1_(std::move(argument_identifier_1)),
-      argument_identifier_2_(std::move(argument_identifier_2)) {}
+      argument_identifier_2_(std::move(argument_identifier_2)),
+      tolerance_({0.0F, 0.0F, 0}) {}
+
+CommandAssertEqual::CommandAssertEqual(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> argument_identifier_1,
+    std::vector<FormatEntry> format_entries, std::unique_ptr<Token> filename,
+    std::unique_ptr<Token> tolerance_token, const FloatTolerance& tolerance)
+    : Command(std::move(start_token)),
+      arguments_are_renderbuffers_(false),
+      argument_identifier_1_(std::move(argument_identifier_1)),
+      format_entries_(std::move(format_entries)),
+      filename_(std::move(filename)),
+      tolerance_token_(std::move(tolerance_token)),
+      tolerance_(tolerance) {}
 
 bool CommandAssertEqual::Accept(CommandVisitor* visitor) {
   return visitor->VisitAssertEqual(this);
@@ -0,0 +1,36 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
+
+#include <utility>
+
+#include "libshadertrap/command_visitor.h"
+
+namespace shadertrap {
+
+CommandAssertRenderbufferHash::CommandAssertRenderbufferHash(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> renderbuffer_identifier,
+    std::unique_ptr<Token> expected_hash_token, uint64_t expected_hash)
+    : Command(std::move(start_token)),
+      renderbuffer_identifier_(std::move(renderbuffer_identifier)),
+      expected_hash_token_(std::move(expected_hash_token)),
+      expected_hash_(expected_hash) {}
+
+bool CommandAssertRenderbufferHash::Accept(CommandVisitor* visitor) {
+  return visitor->VisitAssertRenderbufferHash(this);
+}
+
+}  // namespace shadertrap
@@ -0,0 +1,47 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/command_assert_similar_image.h"
+
+#include <utility>
+
+#include "libshadertrap/command_visitor.h"
+
+namespace shadertrap {
+
+CommandAssertSimilarImage::CommandAssertSimilarImage(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> renderbuffer_identifier_1,
+    std::unique_ptr<Token> renderbuffer_identifier_2,
+    std::unique_ptr<Token> tolerance_token, uint8_t channel_tolerance,
+    std::unique_ptr<Token> max_differing_fraction_token,
+    float max_differing_fraction, std::unique_ptr<Token> min_ssim_token,
+    float min_ssim, std::unique_ptr<Token> min_psnr_token, float min_psnr)
+    : Command(std::move(start_token)),
+      renderbuffer_identifier_1_(std::move(renderbuffer_identifier_1)),
+      renderbuffer_identifier_2_(std::move(renderbuffer_identifier_2)),
+      tolerance_token_(std::move(tolerance_token)),
+      channel_tolerance_(channel_tolerance),
+      max_differing_fraction_token_(std::move(max_differing_fraction_token)),
+      max_differing_fraction_(max_differing_fraction),
+      min_ssim_token_(std::move(min_ssim_token)),
+      min_ssim_(min_ssim),
+      min_psnr_token_(std::move(min_psnr_token)),
+      min_psnr_(min_psnr) {}
+
+bool CommandAssertSimilarImage::Accept(CommandVisitor* visitor) {
+  return visitor->VisitAssertSimilarImage(this);
+}
+
+}  // namespace shadertrap
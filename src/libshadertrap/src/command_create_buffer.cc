@@ -25,9 +25,10 @@ namespace shadertrap {
 CommandCreateBuffer::CommandCreateBuffer(
     std::unique_ptr<Token> start_token,
     std::unique_ptr<Token> result_identifier,
-    const std::vector<ValuesSegment>& values)
+    const std::vector<ValuesSegment>& values, Usage usage)
     : Command(std::move(start_token)),
-      result_identifier_(std::move(result_identifier)) {
+      result_identifier_(std::move(result_identifier)),
+      usage_(usage) {
   size_t size_bytes =
       std::accumulate(values.begin(), values.end(), size_t{0U},
                       [](size_t a, const ValuesSegment& segment) {
@@ -0,0 +1,102 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/command_create_texture_2d.h"
+
+#include <cassert>
+#include <cstring>
+#include <numeric>
+#include <utility>
+
+#include "libshadertrap/command_visitor.h"
+
+namespace shadertrap {
+
+CommandCreateTexture2D::CommandCreateTexture2D(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> result_identifier, size_t width, size_t height,
+    Format format, const std::vector<ValuesSegment>& values,
+    bool generate_mipmaps)
+    : Command(std::move(start_token)),
+      result_identifier_(std::move(result_identifier)),
+      init_file_(nullptr),
+      width_(width),
+      height_(height),
+      format_(format),
+      generate_mipmaps_(generate_mipmaps) {
+  size_t size_bytes =
+      std::accumulate(values.begin(), values.end(), size_t{0U},
+                      [](size_t a, const ValuesSegment& segment) {
+                        return a + segment.GetSizeBytes();
+                      });
+  data_.resize(size_bytes);
+  size_t offset = 0;
+  for (const auto& segment : values) {
+    memcpy(data_.data() + offset, segment.GetData().data(),
+           segment.GetSizeBytes());
+    offset += segment.GetSizeBytes();
+  }
+}
+
+CommandCreateTexture2D::CommandCreateTexture2D(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> result_identifier, std::unique_ptr<Token> init_file,
+    bool generate_mipmaps)
+    : Command(std::move(start_token)),
+      result_identifier_(std::move(result_identifier)),
+      init_file_(std::move(init_file)),
+      width_(0),
+      height_(0),
+      format_(Format::kRgba8),
+      generate_mipmaps_(generate_mipmaps) {}
+
+bool CommandCreateTexture2D::Accept(CommandVisitor* visitor) {
+  return visitor->VisitCreateTexture2D(this);
+}
+
+size_t CommandCreateTexture2D::GetTexelDataSizeBytes(Format format) {
+  switch (format) {
+    case Format::kRgba8:
+      return 4;
+    case Format::kR8:
+      return 1;
+    case Format::kRg16f:
+      return 2 * sizeof(float);
+    case Format::kRgba32f:
+      return 4 * sizeof(float);
+    case Format::kR32ui:
+      return sizeof(uint32_t);
+  }
+  assert(false && "Unknown texture format.");
+  return 0;
+}
+
+std::string CommandCreateTexture2D::FormatToString(Format format) {
+  switch (format) {
+    case Format::kRgba8:
+      return "RGBA8";
+    case Format::kR8:
+      return "R8";
+    case Format::kRg16f:
+      return "RG16F";
+    case Format::kRgba32f:
+      return "RGBA32F";
+    case Format::kR32ui:
+      return "R32UI";
+  }
+  assert(false && "Unknown texture format.");
+  return "";
+}
+
+}  // namespace shadertrap
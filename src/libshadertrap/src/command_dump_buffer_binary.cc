@@ -22,10 +22,12 @@ namespace shadertrap {
 
 CommandDumpBufferBinary::CommandDumpBufferBinary(
     std::unique_ptr<Token> start_token,
-    std::unique_ptr<Token> buffer_identifier, std::unique_ptr<Token> filename)
+    std::unique_ptr<Token> buffer_identifier, std::unique_ptr<Token> filename,
+    bool compressed)
     : Command(std::move(start_token)),
       buffer_identifier_(std::move(buffer_identifier)),
-      filename_(std::move(filename)) {}
+      filename_(std::move(filename)),
+      compressed_(compressed) {}
 
 bool CommandDumpBufferBinary::Accept(CommandVisitor* visitor) {
   return visitor->VisitDumpBufferBinary(this);
@@ -23,10 +23,12 @@ namespace shadertrap {
 CommandDumpRenderbuffer::CommandDumpRenderbuffer(
     std::unique_ptr<Token> start_token,
     std::unique_ptr<Token> renderbuffer_identifier,
-    std::unique_ptr<Token> filename)
+    std::unique_ptr<Token> filename, ImageFormat format, int compression_level)
     : Command(std::move(start_token)),
       renderbuffer_identifier_(std::move(renderbuffer_identifier)),
-      filename_(std::move(filename)) {}
+      filename_(std::move(filename)),
+      format_(format),
+      compression_level_(compression_level) {}
 
 bool CommandDumpRenderbuffer::Accept(CommandVisitor* visitor) {
   return visitor->VisitDumpRenderbuffer(this);
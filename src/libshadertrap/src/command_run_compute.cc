@@ -22,13 +22,10 @@ namespace shadertrap {
 
 CommandRunCompute::CommandRunCompute(std::unique_ptr<Token> start_token,
                                      std::unique_ptr<Token> program_identifier,
-                                     size_t num_groups_x, size_t num_groups_y,
-                                     size_t num_groups_z)
+                                     std::vector<NumGroups> num_groups)
     : Command(std::move(start_token)),
       program_identifier_(std::move(program_identifier)),
-      num_groups_x_(num_groups_x),
-      num_groups_y_(num_groups_y),
-      num_groups_z_(num_groups_z) {}
+      num_groups_(std::move(num_groups)) {}
 
 bool CommandRunCompute::Accept(CommandVisitor* visitor) {
   return visitor->VisitRunCompute(this);
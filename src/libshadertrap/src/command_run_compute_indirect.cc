@@ -0,0 +1,38 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/command_run_compute_indirect.h"
+
+#include <utility>
+
+#include "libshadertrap/command_visitor.h"
+
+namespace shadertrap {
+
+CommandRunComputeIndirect::CommandRunComputeIndirect(
+    std::unique_ptr<Token> start_token,
+    std::unique_ptr<Token> program_identifier,
+    std::unique_ptr<Token> buffer_identifier, std::vector<size_t> offsets_bytes,
+    std::vector<std::unique_ptr<Token>> offset_tokens)
+    : Command(std::move(start_token)),
+      program_identifier_(std::move(program_identifier)),
+      buffer_identifier_(std::move(buffer_identifier)),
+      offsets_bytes_(std::move(offsets_bytes)),
+      offset_tokens_(std::move(offset_tokens)) {}
+
+bool CommandRunComputeIndirect::Accept(CommandVisitor* visitor) {
+  return visitor->VisitRunComputeIndirect(this);
+}
+
+}  // namespace shadertrap
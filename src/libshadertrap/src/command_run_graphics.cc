@@ -24,14 +24,24 @@ CommandRunGraphics::CommandRunGraphics(
     std::unique_ptr<Token> start_token,
     std::unique_ptr<Token> program_identifier,
     std::unordered_map<size_t, VertexAttributeInfo> vertex_data,
-    std::unique_ptr<Token> index_data_buffer_identifier, size_t vertex_count,
+    std::unique_ptr<Token> index_data_buffer_identifier,
+    size_t index_size_bytes, size_t vertex_count, size_t instance_count,
+    std::unique_ptr<Token> indirect_data_buffer_identifier,
+    std::vector<size_t> indirect_offsets_bytes,
+    std::vector<std::unique_ptr<Token>> indirect_offset_tokens,
     Topology topology,
     std::unordered_map<size_t, std::unique_ptr<Token>> framebuffer_attachments)
     : Command(std::move(start_token)),
       program_identifier_(std::move(program_identifier)),
       vertex_data_(std::move(vertex_data)),
       index_data_buffer_identifier_(std::move(index_data_buffer_identifier)),
+      index_size_bytes_(index_size_bytes),
       vertex_count_(vertex_count),
+      instance_count_(instance_count),
+      indirect_data_buffer_identifier_(
+          std::move(indirect_data_buffer_identifier)),
+      indirect_offsets_bytes_(std::move(indirect_offsets_bytes)),
+      indirect_offset_tokens_(std::move(indirect_offset_tokens)),
       topology_(topology),
       framebuffer_attachments_(std::move(framebuffer_attachments)) {}
 
@@ -31,4 +31,149 @@ bool CommandVisitor::VisitCommands(ShaderTrapProgram* program) {
   return true;
 }
 
+bool DefaultCommandVisitor::VisitAssertBufferHash(
+    CommandAssertBufferHash* /*assert_buffer_hash*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitAssertEqual(
+    CommandAssertEqual* /*assert_equal*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitAssertMatchesImage(
+    CommandAssertMatchesImage* /*assert_matches_image*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitAssertPixels(
+    CommandAssertPixels* /*assert_pixels*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitAssertRenderbufferHash(
+    CommandAssertRenderbufferHash* /*assert_renderbuffer_hash*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitAssertSimilarEmdHistogram(
+    CommandAssertSimilarEmdHistogram* /*assert_similar_emd_histogram*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitAssertSimilarImage(
+    CommandAssertSimilarImage* /*assert_similar_image*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitBindSampler(
+    CommandBindSampler* /*bind_sampler*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitBindShaderStorageBuffer(
+    CommandBindShaderStorageBuffer* /*bind_shader_storage_buffer*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitBindTexture(
+    CommandBindTexture* /*bind_texture*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitBindUniformBuffer(
+    CommandBindUniformBuffer* /*bind_uniform_buffer*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCompileShader(
+    CommandCompileShader* /*compile_shader*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCreateBuffer(
+    CommandCreateBuffer* /*create_buffer*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCreateSampler(
+    CommandCreateSampler* /*create_sampler*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCreateEmptyTexture2D(
+    CommandCreateEmptyTexture2D* /*create_empty_texture_2d*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCreateProgram(
+    CommandCreateProgram* /*create_program*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCreateRenderbuffer(
+    CommandCreateRenderbuffer* /*create_renderbuffer*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitCreateTexture2D(
+    CommandCreateTexture2D* /*create_texture_2d*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitDeclareShader(
+    CommandDeclareShader* /*declare_shader*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitDumpBufferBinary(
+    CommandDumpBufferBinary* /*dump_buffer_binary*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitDumpBufferText(
+    CommandDumpBufferText* /*dump_buffer_text*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitDumpRenderbuffer(
+    CommandDumpRenderbuffer* /*dump_renderbuffer*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitRunCompute(
+    CommandRunCompute* /*run_compute*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitRunComputeIndirect(
+    CommandRunComputeIndirect* /*run_compute_indirect*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitRunGraphics(
+    CommandRunGraphics* /*run_graphics*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitSetSamplerParameter(
+    CommandSetSamplerParameter* /*set_sampler_parameter*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitSetTextureParameter(
+    CommandSetTextureParameter* /*set_texture_parameter*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitSetUniform(
+    CommandSetUniform* /*set_uniform*/) {
+  return true;
+}
+
+bool DefaultCommandVisitor::VisitUpdateBuffer(
+    CommandUpdateBuffer* /*update_buffer*/) {
+  return true;
+}
+
 }  // namespace shadertrap
@@ -31,19 +31,39 @@ bool CompoundVisitor::ApplyVisitors(Command* command) {
   return true;
 }
 
+bool CompoundVisitor::VisitAssertBufferHash(
+    CommandAssertBufferHash* assert_buffer_hash) {
+  return ApplyVisitors(assert_buffer_hash);
+}
+
 bool CompoundVisitor::VisitAssertEqual(CommandAssertEqual* assert_equal) {
   return ApplyVisitors(assert_equal);
 }
 
+bool CompoundVisitor::VisitAssertMatchesImage(
+    CommandAssertMatchesImage* assert_matches_image) {
+  return ApplyVisitors(assert_matches_image);
+}
+
 bool CompoundVisitor::VisitAssertPixels(CommandAssertPixels* assert_pixels) {
   return ApplyVisitors(assert_pixels);
 }
 
+bool CompoundVisitor::VisitAssertRenderbufferHash(
+    CommandAssertRenderbufferHash* assert_renderbuffer_hash) {
+  return ApplyVisitors(assert_renderbuffer_hash);
+}
+
 bool CompoundVisitor::VisitAssertSimilarEmdHistogram(
     CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) {
   return ApplyVisitors(assert_similar_emd_histogram);
 }
 
+bool CompoundVisitor::VisitAssertSimilarImage(
+    CommandAssertSimilarImage* assert_similar_image) {
+  return ApplyVisitors(assert_similar_image);
+}
+
 bool CompoundVisitor::VisitBindSampler(CommandBindSampler* bind_sampler) {
   return ApplyVisitors(bind_sampler);
 }
@@ -88,6 +108,11 @@ bool CompoundVisitor::VisitCreateRenderbuffer(
   return ApplyVisitors(create_renderbuffer);
 }
 
+bool CompoundVisitor::VisitCreateTexture2D(
+    CommandCreateTexture2D* create_texture_2d) {
+  return ApplyVisitors(create_texture_2d);
+}
+
 bool CompoundVisitor::VisitDeclareShader(CommandDeclareShader* declare_shader) {
   return ApplyVisitors(declare_shader);
 }
@@ -111,6 +136,11 @@ bool CompoundVisitor::VisitRunCompute(CommandRunCompute* run_compute) {
   return ApplyVisitors(run_compute);
 }
 
+bool CompoundVisitor::VisitRunComputeIndirect(
+    CommandRunComputeIndirect* run_compute_indirect) {
+  return ApplyVisitors(run_compute_indirect);
+}
+
 bool CompoundVisitor::VisitRunGraphics(CommandRunGraphics* run_graphics) {
   return ApplyVisitors(run_graphics);
 }
@@ -129,4 +159,8 @@ bool CompoundVisitor::VisitSetUniform(CommandSetUniform* set_uniform) {
   return ApplyVisitors(set_uniform);
 }
 
+bool CompoundVisitor::VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) {
+  return ApplyVisitors(update_buffer);
+}
+
 }  // namespace shadertrap
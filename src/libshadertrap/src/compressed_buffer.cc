@@ -0,0 +1,231 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/compressed_buffer.h"
+
+#include <algorithm>
+#include <streambuf>
+#include <string>
+
+#ifdef SHADERTRAP_LODEPNG
+#include "lodepng/lodepng.h"
+#endif
+
+namespace shadertrap {
+
+#ifdef SHADERTRAP_LODEPNG
+namespace {
+
+const char kMagic[] = {'S', 'T', 'Z', 'B'};
+
+const size_t kHeaderSizeBytes = sizeof(kMagic) + 8 + 4;
+
+void AppendLittleEndian(uint64_t value, size_t num_bytes,
+                        std::vector<uint8_t>* out) {
+  for (size_t i = 0; i < num_bytes; i++) {
+    out->push_back(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+uint64_t ReadLittleEndian(const uint8_t* in, size_t num_bytes) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < num_bytes; i++) {
+    result |= static_cast<uint64_t>(in[i]) << (8 * i);
+  }
+  return result;
+}
+
+// Reads |size| bytes from |stream| into |out|, returning false if the stream
+// ends first. |out| grows a step at a time, so that a corrupt size in a
+// truncated stream does not lead to a large allocation.
+bool ReadBytes(std::istream* stream, uint64_t size, std::vector<uint8_t>* out) {
+  const uint64_t kStepSizeBytes = 1U << 20U;
+  out->clear();
+  while (out->size() < size) {
+    const size_t read_start = out->size();
+    out->resize(read_start + static_cast<size_t>(std::min(
+                                 kStepSizeBytes, size - read_start)));
+    stream->read(reinterpret_cast<char*>(out->data() + read_start),
+                 static_cast<std::streamsize>(out->size() - read_start));
+    if (!*stream) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+#endif
+
+namespace {
+
+// Reads from memory without copying it.
+class MemoryStreamBuffer : public std::streambuf {
+ public:
+  MemoryStreamBuffer(const uint8_t* data, size_t size) {
+    // The get area is only read from, so casting away const is safe.
+    char* begin = const_cast<char*>(reinterpret_cast<const char*>(data));
+    setg(begin, begin, begin + size);
+  }
+};
+
+}  // namespace
+
+bool CompressBuffer(const uint8_t* data, size_t size, size_t chunk_size_bytes,
+                    const BufferPieceConsumer& consume_piece,
+                    std::string* error) {
+#ifdef SHADERTRAP_LODEPNG
+  if (chunk_size_bytes == 0 || chunk_size_bytes > UINT32_MAX) {
+    *error = "invalid chunk size " + std::to_string(chunk_size_bytes);
+    return false;
+  }
+  std::vector<uint8_t> piece(kMagic, kMagic + sizeof(kMagic));
+  AppendLittleEndian(size, 8, &piece);
+  AppendLittleEndian(chunk_size_bytes, 4, &piece);
+  if (!consume_piece(piece.data(), piece.size())) {
+    *error = "the header could not be written";
+    return false;
+  }
+  // Each chunk is compressed straight from |data|, and passed on after its
+  // compressed size.
+  std::vector<uint8_t> chunk;
+  for (size_t offset = 0; offset < size; offset += chunk_size_bytes) {
+    chunk.clear();
+    unsigned lodepng_error = lodepng::compress(
+        chunk, data + offset, std::min(chunk_size_bytes, size - offset));
+    if (lodepng_error != 0) {
+      *error = lodepng_error_text(lodepng_error);
+      return false;
+    }
+    if (chunk.size() > UINT32_MAX) {
+      *error = "a compressed chunk is too large";
+      return false;
+    }
+    piece.clear();
+    AppendLittleEndian(chunk.size(), 4, &piece);
+    if (!consume_piece(piece.data(), piece.size()) ||
+        !consume_piece(chunk.data(), chunk.size())) {
+      *error = "a compressed chunk could not be written";
+      return false;
+    }
+  }
+  return true;
+#else
+  (void)data;
+  (void)size;
+  (void)chunk_size_bytes;
+  (void)consume_piece;
+  *error = "compression is not available, as lodepng support is not available";
+  return false;
+#endif
+}
+
+bool CompressBuffer(const uint8_t* data, size_t size, size_t chunk_size_bytes,
+                    std::vector<uint8_t>* compressed, std::string* error) {
+  compressed->clear();
+  return CompressBuffer(
+      data, size, chunk_size_bytes,
+      [compressed](const uint8_t* piece, size_t piece_size) -> bool {
+        compressed->insert(compressed->end(), piece, piece + piece_size);
+        return true;
+      },
+      error);
+}
+
+bool DecompressBuffer(std::istream* compressed,
+                      const BufferPieceConsumer& consume_piece,
+                      std::string* error) {
+#ifdef SHADERTRAP_LODEPNG
+  std::vector<uint8_t> compressed_chunk;
+  if (!ReadBytes(compressed, kHeaderSizeBytes, &compressed_chunk) ||
+      !std::equal(kMagic, kMagic + sizeof(kMagic), compressed_chunk.data())) {
+    *error = "not a compressed buffer";
+    return false;
+  }
+  const uint64_t data_size =
+      ReadLittleEndian(compressed_chunk.data() + sizeof(kMagic), 8);
+  const uint64_t chunk_size_bytes =
+      ReadLittleEndian(compressed_chunk.data() + sizeof(kMagic) + 8, 4);
+  if (chunk_size_bytes == 0) {
+    *error = "invalid chunk size 0";
+    return false;
+  }
+  uint64_t offset = kHeaderSizeBytes;
+  uint64_t decompressed_size = 0;
+  std::vector<uint8_t> chunk;
+  while (decompressed_size < data_size) {
+    if (!ReadBytes(compressed, 4, &compressed_chunk)) {
+      *error = "truncated chunk header at offset " + std::to_string(offset);
+      return false;
+    }
+    const uint64_t compressed_chunk_size =
+        ReadLittleEndian(compressed_chunk.data(), 4);
+    offset += 4;
+    if (!ReadBytes(compressed, compressed_chunk_size, &compressed_chunk)) {
+      *error = "truncated chunk at offset " + std::to_string(offset);
+      return false;
+    }
+    chunk.clear();
+    unsigned lodepng_error = lodepng::decompress(
+        chunk, compressed_chunk.data(), compressed_chunk.size());
+    const uint64_t expected_chunk_size =
+        std::min(chunk_size_bytes, data_size - decompressed_size);
+    if (lodepng_error != 0) {
+      *error = "chunk at offset " + std::to_string(offset) +
+               " could not be decompressed: " +
+               lodepng_error_text(lodepng_error);
+      return false;
+    }
+    if (chunk.size() != expected_chunk_size) {
+      *error = "chunk at offset " + std::to_string(offset) + " holds " +
+               std::to_string(chunk.size()) + " bytes; expected " +
+               std::to_string(expected_chunk_size);
+      return false;
+    }
+    if (!consume_piece(chunk.data(), chunk.size())) {
+      *error = "a decompressed chunk could not be written";
+      return false;
+    }
+    decompressed_size += chunk.size();
+    offset += compressed_chunk_size;
+  }
+  if (compressed->peek() != std::istream::traits_type::eof()) {
+    *error = "unexpected data at offset " + std::to_string(offset);
+    return false;
+  }
+  return true;
+#else
+  (void)compressed;
+  (void)consume_piece;
+  *error =
+      "decompression is not available, as lodepng support is not available";
+  return false;
+#endif
+}
+
+bool DecompressBuffer(const uint8_t* compressed, size_t size,
+                      std::vector<uint8_t>* data, std::string* error) {
+  MemoryStreamBuffer stream_buffer(compressed, size);
+  std::istream stream(&stream_buffer);
+  data->clear();
+  return DecompressBuffer(
+      &stream,
+      [data](const uint8_t* piece, size_t piece_size) -> bool {
+        data->insert(data->end(), piece, piece + piece_size);
+        return true;
+      },
+      error);
+}
+
+}  // namespace shadertrap
@@ -0,0 +1,118 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/emd_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace shadertrap {
+
+namespace {
+
+const size_t kNumRgbaChannels = 4;
+
+// Below this number of pixels, starting threads costs more than it saves.
+const size_t kMinPixelsPerThread = 1U << 18U;
+
+// Adds the channel values of the |num_pixels| pixels in |data| to
+// |histograms|, which has kNumRgbaChannels * kNumHistogramBins elements.
+void AccumulateChannelHistograms(const uint8_t* data, size_t num_pixels,
+                                 uint64_t* histograms) {
+  uint64_t* histogram_r = histograms;
+  uint64_t* histogram_g = histograms + kNumHistogramBins;
+  uint64_t* histogram_b = histograms + 2 * kNumHistogramBins;
+  uint64_t* histogram_a = histograms + 3 * kNumHistogramBins;
+  for (size_t pixel = 0; pixel < num_pixels; pixel++) {
+    const uint8_t* start_of_pixel = data + pixel * kNumRgbaChannels;
+    histogram_r[start_of_pixel[0]]++;
+    histogram_g[start_of_pixel[1]]++;
+    histogram_b[start_of_pixel[2]]++;
+    histogram_a[start_of_pixel[3]]++;
+  }
+}
+
+}  // namespace
+
+std::vector<uint64_t> ComputeChannelHistograms(const uint8_t* data,
+                                               size_t num_pixels) {
+  const size_t histograms_size = kNumRgbaChannels * kNumHistogramBins;
+  const size_t num_threads = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          num_pixels / kMinPixelsPerThread));
+  // Each thread accumulates into its own histograms, which are then summed, so
+  // that no synchronization is needed.
+  std::vector<uint64_t> thread_histograms(num_threads * histograms_size, 0);
+  std::vector<std::thread> threads;
+  const size_t pixels_per_thread = num_pixels / num_threads;
+  for (size_t thread = 1; thread < num_threads; thread++) {
+    const size_t first_pixel = thread * pixels_per_thread;
+    threads.emplace_back(AccumulateChannelHistograms,
+                         data + first_pixel * kNumRgbaChannels,
+                         thread == num_threads - 1 ? num_pixels - first_pixel
+                                                   : pixels_per_thread,
+                         &thread_histograms[thread * histograms_size]);
+  }
+  AccumulateChannelHistograms(
+      data, num_threads == 1 ? num_pixels : pixels_per_thread,
+      thread_histograms.data());
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  std::vector<uint64_t> result(thread_histograms.begin(),
+                               thread_histograms.begin() + histograms_size);
+  for (size_t thread = 1; thread < num_threads; thread++) {
+    for (size_t index = 0; index < histograms_size; index++) {
+      result[index] += thread_histograms[thread * histograms_size + index];
+    }
+  }
+  return result;
+}
+
+double ComputeMaxEmd(const std::vector<uint64_t>& histograms_1,
+                     const std::vector<uint64_t>& histograms_2,
+                     size_t num_pixels) {
+  // Earth movers's distance: Calculate the minimal cost of moving "earth" to
+  // transform the first histogram into the second, where each bin of the
+  // histogram can be thought of as a column of units of earth. The cost is the
+  // amount of earth moved times the distance carried (the distance is the
+  // number of adjacent bins over which the earth is carried). Calculate this
+  // using the cumulative difference of the bins, which works as long as both
+  // histograms have the same amount of earth. Sum the absolute values of the
+  // cumulative difference to get the final cost of how much (and how far) the
+  // earth was moved.
+  double max_emd = 0;
+
+  for (size_t channel = 0; channel < kNumRgbaChannels; ++channel) {
+    double diff_total = 0;
+    double diff_accum = 0;
+
+    for (size_t i = 0; i < kNumHistogramBins; ++i) {
+      const size_t index = channel * kNumHistogramBins + i;
+      double hist_normalized_0 = static_cast<double>(histograms_1[index]) /
+                                 static_cast<double>(num_pixels);
+      double hist_normalized_1 = static_cast<double>(histograms_2[index]) /
+                                 static_cast<double>(num_pixels);
+      diff_accum += hist_normalized_0 - hist_normalized_1;
+      diff_total += std::fabs(diff_accum);
+    }
+    // Normalize to range 0..1
+    double emd = diff_total / kNumHistogramBins;
+    max_emd = std::max(max_emd, emd);
+  }
+  return max_emd;
+}
+
+}  // namespace shadertrap
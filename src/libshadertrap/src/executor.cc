@@ -19,21 +19,36 @@
 #include <cmath>
 #include <cstddef>
 #include <cstdint>
+#include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <functional>
 #include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <map>
 #include <memory>
+#include <set>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "libshadertrap/buffer_text_writer.h"
+#include "libshadertrap/compressed_buffer.h"
+#include "libshadertrap/emd_histogram.h"
+#include "libshadertrap/float_compare.h"
+#include "libshadertrap/image_compare.h"
 #include "libshadertrap/make_unique.h"
+#include "libshadertrap/memory_compare.h"
 #include "libshadertrap/texture_parameter.h"
 #include "libshadertrap/token.h"
 #include "libshadertrap/uniform_value.h"
 #include "libshadertrap/vertex_attribute_info.h"
+#include "libshadertrap/xxh3.h"
 #ifdef SHADERTRAP_LODEPNG
 #include "lodepng/lodepng.h"
 #endif
@@ -63,34 +78,870 @@ std::string OpenglErrorString(GLenum err) {
   }
 }
 
-template <typename T>
-void DumpFormatEntry(const char* data,
-                     const CommandDumpBufferText::FormatEntry& format_entry,
-                     std::ofstream* text_file, size_t* index) {
-  std::vector<T> values(format_entry.count);
-  const size_t size_bytes = format_entry.count * sizeof(T);
-  memcpy(values.data(), &data[*index], size_bytes);
-  for (auto it = values.begin(); it != values.end(); it++) {
-    *text_file << *it;
-    if (it != values.end() - 1) {
-      *text_file << " ";
+// Returns the offset of the first |element_size|-byte element in the range
+// [|from|, |end|) that differs between |data_1| and |data_2|, or |end| if all
+// the elements match. |from| must be the offset of an element.
+size_t FindFirstMismatchingElement(const uint8_t* data_1,
+                                   const uint8_t* data_2, size_t from,
+                                   size_t end, size_t element_size) {
+  const size_t mismatch =
+      FindFirstMismatch(data_1 + from, data_2 + from, end - from);
+  return from + mismatch - mismatch % element_size;
+}
+
+// Returns an opaque black |width| x |height| RGBA image, in which pixels can be
+// marked using SetDiffMaskPixel.
+std::vector<uint8_t> MakeDiffMask(size_t width, size_t height) {
+  std::vector<uint8_t> diff_mask(width * height * kNumRgbaChannels, 0);
+  for (size_t index = kNumRgbaChannels - 1; index < diff_mask.size();
+       index += kNumRgbaChannels) {
+    diff_mask[index] = 255;
+  }
+  return diff_mask;
+}
+
+// Marks the pixel at (x, y) of a diff mask of width |width| as mismatching, by
+// making it white.
+void SetDiffMaskPixel(size_t x, size_t y, size_t width,
+                      std::vector<uint8_t>* diff_mask) {
+  std::fill_n(diff_mask->begin() + static_cast<std::ptrdiff_t>(
+                                       (y * width + x) * kNumRgbaChannels),
+              kNumRgbaChannels, 255);
+}
+
+// The number of invocations in each work group of a comparison shader.
+const size_t kComparisonWorkGroupSize = 64;
+
+// Returns the source of a compute shader that counts the 32-bit words that
+// differ between two shader storage buffers, considering only the words within
+// the half-open ranges in |compared_words|, and records the index of the first
+// of them. The buffers are bound to a window of the data being compared; the
+// uniform |first_word| is the index of the window's first word within the
+// data, which is added to indices within the window so that the ranges are
+// tested and the first mismatch is recorded relative to the start of the
+// data, and the uniform |num_words| is the length of the window in words.
+std::string MakeComparisonShaderSource(
+    const ApiVersion& api_version,
+    const std::vector<std::pair<size_t, size_t>>& compared_words) {
+  std::stringstream stringstream;
+  stringstream << (api_version.GetApi() == ApiVersion::Api::GLES
+                       ? "#version 310 es\n"
+                       : "#version 430\n");
+  stringstream << "layout(local_size_x = " << kComparisonWorkGroupSize
+               << ") in;\n"
+                  "layout(std430, binding = 0) readonly buffer Data1 {\n"
+                  "  uint data_1[];\n"
+                  "};\n"
+                  "layout(std430, binding = 1) readonly buffer Data2 {\n"
+                  "  uint data_2[];\n"
+                  "};\n"
+                  "layout(std430, binding = 2) buffer Result {\n"
+                  "  uint mismatch_count;\n"
+                  "  uint first_mismatch;\n"
+                  "};\n"
+                  "layout(location = 0) uniform uint first_word;\n"
+                  "layout(location = 1) uniform uint num_words;\n"
+                  "bool IsCompared(uint word) {\n"
+                  "  return false";
+  for (const auto& range : compared_words) {
+    stringstream << "\n      || (word >= " << range.first
+                 << "u && word < " << range.second << "u)";
+  }
+  stringstream << ";\n"
+                  "}\n"
+                  "void main() {\n"
+                  "  uint stride = gl_NumWorkGroups.x * gl_WorkGroupSize.x;\n"
+                  "  uint count = 0u;\n"
+                  "  uint first = 0u;\n"
+                  "  for (uint i = gl_GlobalInvocationID.x; i < num_words;\n"
+                  "       i += stride) {\n"
+                  "    if (IsCompared(first_word + i) && "
+                  "data_1[i] != data_2[i]) {\n"
+                  "      if (count == 0u) {\n"
+                  "        first = first_word + i;\n"
+                  "      }\n"
+                  "      count++;\n"
+                  "    }\n"
+                  "  }\n"
+                  "  if (count > 0u) {\n"
+                  "    atomicAdd(mismatch_count, count);\n"
+                  "    atomicMin(first_mismatch, first);\n"
+                  "  }\n"
+                  "}\n";
+  return stringstream.str();
+}
+
+// The number of invocations in each work group of the histogram shader.
+const size_t kHistogramWorkGroupSize = 256;
+
+// Returns the source of a compute shader that adds the per-channel histograms
+// of the first |num_pixels| RGBA pixels of two shader storage buffers to a
+// third, with the y-coordinate of the work group selecting the input buffer.
+// Each work group accumulates into shared memory so that only one atomic
+// operation per bin and work group touches the result buffer.
+std::string MakeHistogramShaderSource(const ApiVersion& api_version) {
+  std::stringstream stringstream;
+  stringstream << (api_version.GetApi() == ApiVersion::Api::GLES
+                       ? "#version 310 es\n"
+                       : "#version 430\n");
+  const size_t num_bins = kNumRgbaChannels * kNumHistogramBins;
+  stringstream << "layout(local_size_x = " << kHistogramWorkGroupSize
+               << ") in;\n"
+                  "layout(std430, binding = 0) readonly buffer Pixels1 {\n"
+                  "  uint pixels_1[];\n"
+                  "};\n"
+                  "layout(std430, binding = 1) readonly buffer Pixels2 {\n"
+                  "  uint pixels_2[];\n"
+                  "};\n"
+                  "layout(std430, binding = 2) buffer Histograms {\n"
+                  "  uint histograms["
+               << 2 * num_bins
+               << "];\n"
+                  "};\n"
+                  "layout(location = 0) uniform uint num_pixels;\n"
+                  "shared uint local_histograms["
+               << num_bins
+               << "];\n"
+                  "void main() {\n"
+                  "  for (uint i = gl_LocalInvocationIndex; i < "
+               << num_bins
+               << "u;\n"
+                  "       i += gl_WorkGroupSize.x) {\n"
+                  "    local_histograms[i] = 0u;\n"
+                  "  }\n"
+                  "  memoryBarrierShared();\n"
+                  "  barrier();\n"
+                  "  uint stride = gl_NumWorkGroups.x * gl_WorkGroupSize.x;\n"
+                  "  for (uint i = gl_GlobalInvocationID.x; i < num_pixels;\n"
+                  "       i += stride) {\n"
+                  "    uint pixel = gl_WorkGroupID.y == 0u ? pixels_1[i] "
+                  ": pixels_2[i];\n"
+                  "    for (uint channel = 0u; channel < "
+               << kNumRgbaChannels
+               << "u; channel++) {\n"
+                  "      atomicAdd(local_histograms[channel * "
+               << kNumHistogramBins
+               << "u\n"
+                  "                                 + ((pixel >> (8u * "
+                  "channel)) & 255u)],\n"
+                  "                1u);\n"
+                  "    }\n"
+                  "  }\n"
+                  "  memoryBarrierShared();\n"
+                  "  barrier();\n"
+                  "  for (uint i = gl_LocalInvocationIndex; i < "
+               << num_bins
+               << "u;\n"
+                  "       i += gl_WorkGroupSize.x) {\n"
+                  "    if (local_histograms[i] > 0u) {\n"
+                  "      atomicAdd(histograms[gl_WorkGroupID.y * "
+               << num_bins
+               << "u + i],\n"
+                  "                local_histograms[i]);\n"
+                  "    }\n"
+                  "  }\n"
+                  "}\n";
+  return stringstream.str();
+}
+
+// Accumulates statistics about the pixels found to differ by an assertion, so
+// that they can be summarized without reporting each one.
+class PixelMismatchSummary {
+ public:
+  PixelMismatchSummary()
+      : count_(0),
+        min_x_(0),
+        min_y_(0),
+        max_x_(0),
+        max_y_(0),
+        max_channel_error_{0, 0, 0, 0} {}
+
+  // Records that the RGBA values |pixel_1| and |pixel_2| differ at (x, y).
+  void Add(size_t x, size_t y, const uint8_t* pixel_1, const uint8_t* pixel_2) {
+    if (count_ == 0) {
+      min_x_ = max_x_ = x;
+      min_y_ = max_y_ = y;
+    } else {
+      min_x_ = std::min(min_x_, x);
+      min_y_ = std::min(min_y_, y);
+      max_x_ = std::max(max_x_, x);
+      max_y_ = std::max(max_y_, y);
+    }
+    for (size_t channel = 0; channel < kNumRgbaChannels; channel++) {
+      max_channel_error_[channel] = std::max(
+          max_channel_error_[channel],
+          static_cast<uint32_t>(std::abs(static_cast<int>(pixel_1[channel]) -
+                                         static_cast<int>(pixel_2[channel]))));
     }
+    count_++;
   }
-  *index += size_bytes;
+
+  size_t GetCount() const { return count_; }
+
+  std::string ToString() const {
+    std::stringstream stringstream;
+    stringstream << count_ << " mismatching pixel" << (count_ == 1 ? "" : "s")
+                 << " within the rectangle with top-left coordinate ("
+                 << min_x_ << ", " << min_y_ << "), width "
+                 << max_x_ - min_x_ + 1 << " and height "
+                 << max_y_ - min_y_ + 1
+                 << "; maximum differences per channel: ("
+                 << max_channel_error_[0] << ", " << max_channel_error_[1]
+                 << ", " << max_channel_error_[2] << ", "
+                 << max_channel_error_[3] << ")";
+    return stringstream.str();
+  }
+
+ private:
+  size_t count_;
+  size_t min_x_;
+  size_t min_y_;
+  size_t max_x_;
+  size_t max_y_;
+  uint32_t max_channel_error_[kNumRgbaChannels];
+};
+
+// Accumulates statistics about the buffer elements found to differ by an
+// assertion, so that they can be summarized without reporting each one.
+class ElementMismatchSummary {
+ public:
+  ElementMismatchSummary()
+      : count_(0),
+        first_byte_index_(0),
+        last_byte_index_(0),
+        compared_with_tolerance_(false),
+        float_errors_({0.0F, 0.0F, 0}) {}
+
+  // Records that the elements starting at |byte_index| differ.
+  void Add(size_t byte_index) {
+    if (count_ == 0) {
+      first_byte_index_ = byte_index;
+    }
+    last_byte_index_ = byte_index;
+    count_++;
+  }
+
+  // Records the largest differences between float elements that were
+  // compared within a tolerance.
+  void AddFloatErrors(const FloatErrors& float_errors) {
+    compared_with_tolerance_ = true;
+    float_errors_.max_absolute =
+        std::max(float_errors_.max_absolute, float_errors.max_absolute);
+    float_errors_.max_relative =
+        std::max(float_errors_.max_relative, float_errors.max_relative);
+    float_errors_.max_ulps =
+        std::max(float_errors_.max_ulps, float_errors.max_ulps);
+  }
+
+  size_t GetCount() const { return count_; }
+
+  std::string ToString() const {
+    std::stringstream stringstream;
+    stringstream << count_ << " mismatching element"
+                 << (count_ == 1 ? "" : "s") << " starting at byte indices "
+                 << first_byte_index_ << " to " << last_byte_index_;
+    if (compared_with_tolerance_) {
+      stringstream << "; maximum float differences: absolute "
+                   << float_errors_.max_absolute << ", relative "
+                   << float_errors_.max_relative << ", ULPs "
+                   << float_errors_.max_ulps;
+    }
+    return stringstream.str();
+  }
+
+ private:
+  size_t count_;
+  size_t first_byte_index_;
+  size_t last_byte_index_;
+  bool compared_with_tolerance_;
+  FloatErrors float_errors_;
+};
+
+// Compares row |y|, counting from the top, of two |width| x |height| RGBA
+// images named |name_1| and |name_2|, whose pixels for the row are at |row_1|
+// and |row_2|. Mismatching pixels are recorded in |summary|, reported while no
+// more than |max_mismatch_reports| have been found, and, if |diff_mask| is not
+// null, marked in |diff_mask|, which is created on the first mismatch.
+void ComparePixelRow(MessageConsumer* message_consumer,
+                     size_t max_mismatch_reports, const Token* start_token,
+                     const std::string& name_1, const std::string& name_2,
+                     size_t y, size_t width, size_t height,
+                     const uint8_t* row_1, const uint8_t* row_2,
+                     PixelMismatchSummary* summary,
+                     std::vector<uint8_t>* diff_mask) {
+  const size_t row_size_bytes = width * kNumRgbaChannels;
+  for (size_t offset = 0; offset < row_size_bytes;
+       offset += kNumRgbaChannels) {
+    offset = FindFirstMismatchingElement(row_1, row_2, offset, row_size_bytes,
+                                         kNumRgbaChannels);
+    if (offset == row_size_bytes) {
+      break;
+    }
+    const size_t x = offset / kNumRgbaChannels;
+    summary->Add(x, y, row_1 + offset, row_2 + offset);
+    if (diff_mask != nullptr) {
+      if (diff_mask->empty()) {
+        *diff_mask = MakeDiffMask(width, height);
+      }
+      SetDiffMaskPixel(x, y, width, diff_mask);
+    }
+    if (summary->GetCount() > max_mismatch_reports) {
+      continue;
+    }
+    std::stringstream stringstream;
+    stringstream << "Pixel mismatch at position (" << x << ", " << y
+                 << "): " << name_1 << "[" << x << "][" << y << "] == ("
+                 << static_cast<uint32_t>(row_1[offset]) << ", "
+                 << static_cast<uint32_t>(row_1[offset + 1]) << ", "
+                 << static_cast<uint32_t>(row_1[offset + 2]) << ", "
+                 << static_cast<uint32_t>(row_1[offset + 3]) << "), vs. "
+                 << name_2 << "[" << x << "][" << y << "] == ("
+                 << static_cast<uint32_t>(row_2[offset]) << ", "
+                 << static_cast<uint32_t>(row_2[offset + 1]) << ", "
+                 << static_cast<uint32_t>(row_2[offset + 2]) << ", "
+                 << static_cast<uint32_t>(row_2[offset + 3]) << ")";
+    message_consumer->Message(MessageConsumer::Severity::kError, start_token,
+                              stringstream.str());
+  }
+}
+
+// Describes a mismatch between the elements of kind |kind| at byte index
+// |index| of the buffers, or buffer and file, named |name_1| and |name_2|,
+// whose bytes are at |element_1| and |element_2|.
+std::string DescribeElementMismatch(CommandAssertEqual::FormatEntry::Kind kind,
+                                    size_t index, const std::string& name_1,
+                                    const std::string& name_2,
+                                    const uint8_t* element_1,
+                                    const uint8_t* element_2) {
+  std::stringstream stringstream;
+  switch (kind) {
+    case CommandAssertEqual::FormatEntry::Kind::kByte:
+    case CommandAssertEqual::FormatEntry::Kind::kSkip:
+      stringstream << "Byte mismatch at index " << index << ": " << name_1
+                   << "[" << index
+                   << "] == " << static_cast<uint32_t>(*element_1) << ", "
+                   << name_2 << "[" << index
+                   << "] == " << static_cast<uint32_t>(*element_2);
+      break;
+    case CommandAssertEqual::FormatEntry::Kind::kFloat: {
+      float value_1;
+      float value_2;
+      memcpy(&value_1, element_1, sizeof(float));
+      memcpy(&value_2, element_2, sizeof(float));
+      stringstream << "Float mismatch at byte index " << index << ": "
+                   << name_1 << "[" << index << "] == " << value_1 << ", "
+                   << name_2 << "[" << index << "] == " << value_2;
+      break;
+    }
+    case CommandAssertEqual::FormatEntry::Kind::kInt: {
+      int32_t value_1;
+      int32_t value_2;
+      memcpy(&value_1, element_1, sizeof(int32_t));
+      memcpy(&value_2, element_2, sizeof(int32_t));
+      stringstream << "Integer mismatch at byte_index " << index << ": "
+                   << name_1 << "[" << index << "] == " << value_1 << ", "
+                   << name_2 << "[" << index << "] == " << value_2;
+      break;
+    }
+    case CommandAssertEqual::FormatEntry::Kind::kUint: {
+      uint32_t value_1;
+      uint32_t value_2;
+      memcpy(&value_1, element_1, sizeof(uint32_t));
+      memcpy(&value_2, element_2, sizeof(uint32_t));
+      stringstream << "Unsigned integer mismatch at byte index " << index
+                   << ": " << name_1 << "[" << index << "] == " << value_1
+                   << ", " << name_2 << "[" << index << "] == " << value_2;
+      break;
+    }
+  }
+  return stringstream.str();
 }
 
+// Compares the bytes at offsets [|begin|, |end|) of the data named |name_1|
+// and |name_2|, laid out as described by |format_entries|, or as bytes if
+// there are none. |data_1| and |data_2| point to the bytes at offset |begin|,
+// so that long data can be compared in chunks; |begin| must be a multiple of
+// 4. Data is compared at the byte level to look for mismatches, which are then
+// reported at the level of the element type. This avoids performing
+// floating-point comparisons, and associated issues related to special values,
+// unless |tolerance| is not null, in which case float elements that are within
+// |tolerance| of one another match.
+void CompareFormattedBytes(
+    MessageConsumer* message_consumer, size_t max_mismatch_reports,
+    const Token* start_token,
+    const std::vector<CommandAssertEqual::FormatEntry>& format_entries,
+    const FloatTolerance* tolerance, const std::string& name_1,
+    const std::string& name_2, size_t begin, size_t end, const uint8_t* data_1,
+    const uint8_t* data_2, ElementMismatchSummary* summary) {
+  FloatErrors float_errors = {0.0F, 0.0F, 0};
+  size_t entry_begin = 0;
+  auto compare_entry = [&](CommandAssertEqual::FormatEntry::Kind kind,
+                           size_t count) -> void {
+    const size_t element_size =
+        kind == CommandAssertEqual::FormatEntry::Kind::kByte ||
+                kind == CommandAssertEqual::FormatEntry::Kind::kSkip
+            ? 1
+            : sizeof(uint32_t);
+    const size_t entry_end = entry_begin + count * element_size;
+    const size_t from = std::max(entry_begin, begin) - begin;
+    entry_begin = entry_end;
+    if (kind == CommandAssertEqual::FormatEntry::Kind::kSkip ||
+        entry_end <= begin) {
+      return;
+    }
+    const size_t to = std::min(entry_end, end) - begin;
+    const bool use_tolerance =
+        tolerance != nullptr &&
+        kind == CommandAssertEqual::FormatEntry::Kind::kFloat;
+    for (size_t index = from; index < to; index += element_size) {
+      if (use_tolerance) {
+        index += element_size * FindFirstFloatOutsideTolerance(
+                                    data_1 + index, data_2 + index,
+                                    (to - index) / element_size, *tolerance,
+                                    &float_errors);
+      } else {
+        index = FindFirstMismatchingElement(data_1, data_2, index, to,
+                                            element_size);
+      }
+      if (index == to) {
+        break;
+      }
+      summary->Add(begin + index);
+      if (summary->GetCount() > max_mismatch_reports) {
+        continue;
+      }
+      message_consumer->Message(
+          MessageConsumer::Severity::kError, start_token,
+          DescribeElementMismatch(kind, begin + index, name_1, name_2,
+                                  data_1 + index, data_2 + index));
+    }
+  };
+  if (format_entries.empty()) {
+    compare_entry(CommandAssertEqual::FormatEntry::Kind::kByte, end);
+    return;
+  }
+  for (const auto& format_entry : format_entries) {
+    if (entry_begin >= end) {
+      break;
+    }
+    compare_entry(format_entry.kind, format_entry.count);
+  }
+  if (tolerance != nullptr) {
+    summary->AddFloatErrors(float_errors);
+  }
+}
+
+// Groups the ASSERT_PIXELS commands of a program so that the commands in each
+// group refer to the same renderbuffer, and the renderbuffer is not rendered to
+// between the first and last commands of the group.
+class PixelAssertGrouper : public DefaultCommandVisitor {
+ public:
+  bool VisitAssertPixels(CommandAssertPixels* assert_pixels) override {
+    const std::string& identifier = assert_pixels->GetRenderbufferIdentifier();
+    auto open_group = open_groups_.find(identifier);
+    if (open_group == open_groups_.end()) {
+      open_group = open_groups_.insert({identifier, groups_.size()}).first;
+      groups_.emplace_back();
+    }
+    groups_[open_group->second].push_back(assert_pixels);
+    return true;
+  }
+
+  bool VisitCreateRenderbuffer(
+      CommandCreateRenderbuffer* create_renderbuffer) override {
+    open_groups_.erase(create_renderbuffer->GetResultIdentifier());
+    return true;
+  }
+
+  bool VisitRunGraphics(CommandRunGraphics* run_graphics) override {
+    for (const auto& entry : run_graphics->GetFramebufferAttachments()) {
+      open_groups_.erase(entry.second->GetText());
+    }
+    return true;
+  }
+
+  const std::vector<std::vector<CommandAssertPixels*>>& GetGroups() const {
+    return groups_;
+  }
+
+ private:
+  std::vector<std::vector<CommandAssertPixels*>> groups_;
+  // Maps each renderbuffer to the group that further ASSERT_PIXELS commands on
+  // it should join, until it is rendered to.
+  std::map<std::string, size_t> open_groups_;
+};
+
+// Finds, for each RUN_GRAPHICS command, the renderbuffers it renders to that a
+// later command reads back in full before they are next rendered to, so that
+// their readbacks can be started as soon as they have been rendered.
+// ASSERT_PIXELS commands are not counted, as they only read the rectangles that
+// they check.
+class RenderbufferReadbackPlanner : public DefaultCommandVisitor {
+ public:
+  // |histograms_on_gpu| and |compare_on_gpu| hold if, respectively,
+  // ASSERT_SIMILAR_EMD_HISTOGRAM and ASSERT_EQUAL on renderbuffers examine the
+  // renderbuffers where they live rather than reading them back.
+  RenderbufferReadbackPlanner(bool histograms_on_gpu, bool compare_on_gpu)
+      : histograms_on_gpu_(histograms_on_gpu),
+        compare_on_gpu_(compare_on_gpu) {}
+
+  bool VisitAssertEqual(CommandAssertEqual* assert_equal) override {
+    if (assert_equal->GetArgumentsAreRenderbuffers() && !compare_on_gpu_) {
+      RecordRead(assert_equal->GetArgumentIdentifier1());
+      RecordRead(assert_equal->GetArgumentIdentifier2());
+    }
+    return true;
+  }
+
+  bool VisitAssertMatchesImage(
+      CommandAssertMatchesImage* assert_matches_image) override {
+    RecordRead(assert_matches_image->GetRenderbufferIdentifier());
+    return true;
+  }
+
+  bool VisitAssertRenderbufferHash(
+      CommandAssertRenderbufferHash* assert_renderbuffer_hash) override {
+    RecordRead(assert_renderbuffer_hash->GetRenderbufferIdentifier());
+    return true;
+  }
+
+  bool VisitAssertSimilarEmdHistogram(
+      CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) override {
+    if (!histograms_on_gpu_) {
+      RecordRead(assert_similar_emd_histogram->GetRenderbufferIdentifier1());
+      RecordRead(assert_similar_emd_histogram->GetRenderbufferIdentifier2());
+    }
+    return true;
+  }
+
+  bool VisitAssertSimilarImage(
+      CommandAssertSimilarImage* assert_similar_image) override {
+    RecordRead(assert_similar_image->GetRenderbufferIdentifier1());
+    RecordRead(assert_similar_image->GetRenderbufferIdentifier2());
+    return true;
+  }
+
+  bool VisitCreateRenderbuffer(
+      CommandCreateRenderbuffer* create_renderbuffer) override {
+    last_writers_.erase(create_renderbuffer->GetResultIdentifier());
+    return true;
+  }
+
+  bool VisitDumpRenderbuffer(
+      CommandDumpRenderbuffer* dump_renderbuffer) override {
+    RecordRead(dump_renderbuffer->GetRenderbufferIdentifier());
+    return true;
+  }
+
+  bool VisitRunGraphics(CommandRunGraphics* run_graphics) override {
+    for (const auto& entry : run_graphics->GetFramebufferAttachments()) {
+      last_writers_[entry.second->GetText()] = run_graphics;
+    }
+    return true;
+  }
+
+  // Maps each RUN_GRAPHICS command to the renderbuffers whose readbacks should
+  // be started after it.
+  const std::map<const CommandRunGraphics*, std::set<std::string>>&
+  GetReadbacks() const {
+    return readbacks_;
+  }
+
+ private:
+  // Records that the renderbuffer named |identifier| is read back in full by
+  // the current command.
+  void RecordRead(const std::string& identifier) {
+    auto last_writer = last_writers_.find(identifier);
+    if (last_writer == last_writers_.end()) {
+      return;
+    }
+    readbacks_[last_writer->second].insert(identifier);
+    last_writers_.erase(last_writer);
+  }
+
+  bool histograms_on_gpu_;
+  bool compare_on_gpu_;
+  // Maps each renderbuffer that has been rendered to, and not read back in
+  // full since, to the last RUN_GRAPHICS command that rendered to it.
+  std::map<std::string, const CommandRunGraphics*> last_writers_;
+  std::map<const CommandRunGraphics*, std::set<std::string>> readbacks_;
+};
+
+// Infers, for each command that runs shaders, the memory barrier bits that
+// must be issued after it so that buffers it writes are visible to later
+// commands that access them. Shaders can only write to buffers via shader
+// storage buffer bindings, so every buffer bound to one when a dispatch or draw
+// is issued is assumed to be written.
+class MemoryBarrierPlanner : public DefaultCommandVisitor {
+ public:
+  explicit MemoryBarrierPlanner(bool compare_on_gpu)
+      : compare_on_gpu_(compare_on_gpu) {}
+
+  bool VisitAssertBufferHash(
+      CommandAssertBufferHash* assert_buffer_hash) override {
+    RequireBarrier(assert_buffer_hash->GetBufferIdentifier(),
+                   GL_BUFFER_UPDATE_BARRIER_BIT);
+    return true;
+  }
+
+  bool VisitAssertEqual(CommandAssertEqual* assert_equal) override {
+    if (assert_equal->GetArgumentsAreRenderbuffers()) {
+      return true;
+    }
+    if (assert_equal->GetComparesWithFile()) {
+      // The buffer is mapped and compared on the host.
+      RequireBarrier(assert_equal->GetArgumentIdentifier1(),
+                     GL_BUFFER_UPDATE_BARRIER_BIT);
+      return true;
+    }
+    // The buffers are mapped, and with --compare-on-gpu are first read by a
+    // compute shader unless there is a tolerance.
+    GLbitfield bits = GL_BUFFER_UPDATE_BARRIER_BIT;
+    if (compare_on_gpu_ && !assert_equal->HasTolerance()) {
+      bits |= GL_SHADER_STORAGE_BARRIER_BIT;
+    }
+    RequireBarrier(assert_equal->GetArgumentIdentifier1(), bits);
+    RequireBarrier(assert_equal->GetArgumentIdentifier2(), bits);
+    return true;
+  }
+
+  bool VisitBindShaderStorageBuffer(
+      CommandBindShaderStorageBuffer* bind_shader_storage_buffer) override {
+    shader_storage_buffer_bindings_[bind_shader_storage_buffer->GetBinding()] =
+        bind_shader_storage_buffer->GetBufferIdentifier();
+    return true;
+  }
+
+  bool VisitBindUniformBuffer(
+      CommandBindUniformBuffer* bind_uniform_buffer) override {
+    uniform_buffer_bindings_[bind_uniform_buffer->GetBinding()] =
+        bind_uniform_buffer->GetBufferIdentifier();
+    return true;
+  }
+
+  bool VisitDumpBufferBinary(
+      CommandDumpBufferBinary* dump_buffer_binary) override {
+    RequireBarrier(dump_buffer_binary->GetBufferIdentifier(),
+                   GL_BUFFER_UPDATE_BARRIER_BIT);
+    return true;
+  }
+
+  bool VisitDumpBufferText(CommandDumpBufferText* dump_buffer_text) override {
+    RequireBarrier(dump_buffer_text->GetBufferIdentifier(),
+                   GL_BUFFER_UPDATE_BARRIER_BIT);
+    return true;
+  }
+
+  bool VisitRunCompute(CommandRunCompute* run_compute) override {
+    RequireBarriersForBoundBuffers();
+    if (run_compute->GetNumGroups().size() > 1) {
+      PlanBarrierBetweenDispatches(run_compute, "");
+    }
+    RecordWrites(run_compute);
+    return true;
+  }
+
+  bool VisitRunComputeIndirect(
+      CommandRunComputeIndirect* run_compute_indirect) override {
+    RequireBarriersForBoundBuffers();
+    RequireBarrier(run_compute_indirect->GetBufferIdentifier(),
+                   GL_COMMAND_BARRIER_BIT);
+    if (run_compute_indirect->GetOffsetsBytes().size() > 1) {
+      PlanBarrierBetweenDispatches(run_compute_indirect,
+                                   run_compute_indirect->GetBufferIdentifier());
+    }
+    RecordWrites(run_compute_indirect);
+    return true;
+  }
+
+  bool VisitRunGraphics(CommandRunGraphics* run_graphics) override {
+    RequireBarriersForBoundBuffers();
+    for (const auto& entry : run_graphics->GetVertexData()) {
+      RequireBarrier(entry.second.GetBufferIdentifier(),
+                     GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT);
+    }
+    if (run_graphics->HasIndexData()) {
+      RequireBarrier(run_graphics->GetIndexDataBufferIdentifier(),
+                     GL_ELEMENT_ARRAY_BARRIER_BIT);
+    }
+    if (run_graphics->HasIndirectData()) {
+      RequireBarrier(run_graphics->GetIndirectDataBufferIdentifier(),
+                     GL_COMMAND_BARRIER_BIT);
+    }
+    RecordWrites(run_graphics);
+    return true;
+  }
+
+  bool VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) override {
+    RequireBarrier(update_buffer->GetBufferIdentifier(),
+                   GL_BUFFER_UPDATE_BARRIER_BIT);
+    return true;
+  }
+
+  // Maps each command after which a barrier is needed to the barrier's bits.
+  const std::map<const Command*, GLbitfield>& GetBarriers() const {
+    return barriers_;
+  }
+
+  // Maps each command that issues several dispatches, between which a barrier
+  // is needed, to the barrier's bits.
+  const std::map<const Command*, GLbitfield>& GetBarriersBetweenDispatches()
+      const {
+    return barriers_between_dispatches_;
+  }
+
+ private:
+  // A buffer that may have been written by a shader, identified by the index
+  // in |writers_| of the last command that may have written it, together with
+  // the barrier bits that are already planned to be issued after that write.
+  struct PendingWrite {
+    size_t writer;
+    GLbitfield planned_bits;
+  };
+
+  // Ensures that a barrier including |bits| is issued between the last write
+  // to |buffer| by a shader, if any, and the current command.
+  void RequireBarrier(const std::string& buffer, GLbitfield bits) {
+    auto pending_write = pending_writes_.find(buffer);
+    if (pending_write == pending_writes_.end()) {
+      return;
+    }
+    const GLbitfield missing_bits = bits & ~pending_write->second.planned_bits;
+    if (missing_bits == 0) {
+      return;
+    }
+    const size_t writer = pending_write->second.writer;
+    barriers_[writers_[writer]] |= missing_bits;
+    // The barrier also covers every earlier write.
+    for (auto& entry : pending_writes_) {
+      if (entry.second.writer <= writer) {
+        entry.second.planned_bits |= missing_bits;
+      }
+    }
+  }
+
+  // Requires barriers for the buffers that the current command's shaders may
+  // access through buffer bindings.
+  void RequireBarriersForBoundBuffers() {
+    for (const auto& entry : shader_storage_buffer_bindings_) {
+      RequireBarrier(entry.second, GL_SHADER_STORAGE_BARRIER_BIT);
+    }
+    for (const auto& entry : uniform_buffer_bindings_) {
+      RequireBarrier(entry.second, GL_UNIFORM_BARRIER_BIT);
+    }
+  }
+
+  // Plans the barrier needed between successive dispatches of |command|, each
+  // of which may read what the previous one wrote to the buffers bound to
+  // shader storage buffer bindings. |indirect_buffer|, if not empty, is the
+  // buffer from which the dispatches read their numbers of groups.
+  void PlanBarrierBetweenDispatches(const Command* command,
+                                    const std::string& indirect_buffer) {
+    GLbitfield bits = 0;
+    for (const auto& written : shader_storage_buffer_bindings_) {
+      bits |= GL_SHADER_STORAGE_BARRIER_BIT;
+      for (const auto& read : uniform_buffer_bindings_) {
+        if (read.second == written.second) {
+          bits |= GL_UNIFORM_BARRIER_BIT;
+        }
+      }
+      if (written.second == indirect_buffer) {
+        bits |= GL_COMMAND_BARRIER_BIT;
+      }
+    }
+    if (bits != 0) {
+      barriers_between_dispatches_[command] = bits;
+    }
+  }
+
+  // Records that |command| may write every buffer bound to a shader storage
+  // buffer binding.
+  void RecordWrites(const Command* command) {
+    if (shader_storage_buffer_bindings_.empty()) {
+      return;
+    }
+    for (const auto& entry : shader_storage_buffer_bindings_) {
+      pending_writes_[entry.second] = {writers_.size(), 0};
+    }
+    writers_.push_back(command);
+  }
+
+  bool compare_on_gpu_;
+  std::map<size_t, std::string> shader_storage_buffer_bindings_;
+  std::map<size_t, std::string> uniform_buffer_bindings_;
+  std::vector<const Command*> writers_;
+  std::map<std::string, PendingWrite> pending_writes_;
+  std::map<const Command*, GLbitfield> barriers_;
+  std::map<const Command*, GLbitfield> barriers_between_dispatches_;
+};
+
+// Buffers no larger than this are suballocated from a pool when buffers are
+// pooled; larger buffers gain little from sharing a buffer object.
+const size_t kMaxPooledBufferSizeBytes = 16 * 1024;
+
+// The size of each buffer object from which pooled buffers are suballocated.
+const size_t kBufferPoolSizeBytes = 256 * 1024;
+
+// Finds the buffers that must each have a buffer object of their own, because
+// they are used in a way that cannot take account of the offset of a buffer
+// within a pool. This is the case for the index buffer of an indirect draw, as
+// the first index given in the indirect data is relative to the start of the
+// buffer object.
+class UnpooledBufferFinder : public DefaultCommandVisitor {
+ public:
+  bool VisitRunGraphics(CommandRunGraphics* run_graphics) override {
+    if (run_graphics->HasIndirectData() && run_graphics->HasIndexData()) {
+      unpooled_buffers_.insert(run_graphics->GetIndexDataBufferIdentifier());
+    }
+    return true;
+  }
+
+  const std::set<std::string>& GetUnpooledBuffers() const {
+    return unpooled_buffers_;
+  }
+
+ private:
+  std::set<std::string> unpooled_buffers_;
+};
+
+// Texture data of at least this size is uploaded via a pixel unpack buffer, so
+// that the transfer to the texture can proceed while later commands are
+// issued.
+const size_t kMinStreamedTextureSizeBytes = 64 * 1024;
+
+// Renderbuffers of up to this size are read back in full into a pixel buffer
+// object, so that the readback can overlap with later commands; larger
+// renderbuffers are only ever read back a band at a time.
+const size_t kMaxFullReadbackSizeBytes = 64 * 1024 * 1024;
+
+// The size of the bands of rows in which renderbuffers are read back.
+const size_t kReadbackBandSizeBytes = 4 * 1024 * 1024;
+
+// A readback is waited for in periods of this length, up to this many times,
+// before it is reported to have timed out.
+const GLuint64 kReadbackWaitTimeoutNanoseconds = 1000000000;
+const size_t kMaxReadbackWaits = 60;
+
+// The number of threads that encode and write dumped renderbuffers. If the
+// images waiting to be written occupy more than the given number of bytes,
+// DUMP_RENDERBUFFER waits for earlier images to be written.
+const size_t kMaxImageWriterThreads = 4;
+const size_t kMaxPendingImageBytes = 256 * 1024 * 1024;
+
 }  // namespace
 
-#define GL_CHECKERR(token, function_name)                 \
-  do {                                                    \
-    GLenum __err = gl_functions_->glGetError_();          \
-    if (__err != GL_NO_ERROR) {                           \
-      message_consumer_->Message(                         \
-          MessageConsumer::Severity::kError, token,       \
-          "OpenGL error: " + std::string(function_name) + \
-              "(): " + OpenglErrorString(__err));         \
-      return false;                                       \
-    }                                                     \
+#define GL_CHECKERR(token, function_name)                   \
+  do {                                                      \
+    if (options_.error_policy == GlErrorPolicy::kStrict) {  \
+      GLenum __err = gl_functions_->glGetError_();          \
+      if (__err != GL_NO_ERROR) {                           \
+        message_consumer_->Message(                         \
+            MessageConsumer::Severity::kError, token,       \
+            "OpenGL error: " + std::string(function_name) + \
+                "(): " + OpenglErrorString(__err));         \
+        return false;                                       \
+      }                                                     \
+    }                                                       \
   } while (0)
 
 #define GL_SAFECALL(token, function, ...)    \
@@ -106,65 +957,422 @@ void DumpFormatEntry(const char* data,
   } while (0)
 
 Executor::Executor(GlFunctions* gl_functions, MessageConsumer* message_consumer,
-                   ApiVersion api_version)
+                   OutputSink* output_sink, ApiVersion api_version,
+                   const ExecutorOptions& options)
     : gl_functions_(gl_functions),
       message_consumer_(message_consumer),
-      api_version_(api_version) {}
+      output_sink_(output_sink),
+      api_version_(api_version),
+      options_(options),
+      buffer_pools_planned_(false),
+      buffer_pool_alignment_(0),
+      buffer_statistics_{0, 0, 0, 0},
+      memory_barriers_planned_(false),
+      image_writer_(output_sink,
+                    std::min<size_t>(kMaxImageWriterThreads,
+                                     std::thread::hardware_concurrency()),
+                    kMaxPendingImageBytes),
+      comparison_result_buffer_(0),
+      histogram_result_buffer_(0),
+      comparison_pixel_buffers_{0, 0},
+      comparison_pixel_buffer_size_(0),
+      band_pixel_buffer_size_(0) {
+  if (options_.error_policy == GlErrorPolicy::kDebugCallback) {
+    // Synchronous output ensures that the callback is invoked on this thread,
+    // during the GL call that caused the message, so that the message can be
+    // associated with the command being executed.
+    gl_functions_->glEnable_(GL_DEBUG_OUTPUT);
+    gl_functions_->glEnable_(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+    gl_functions_->glDebugMessageCallback_(DebugMessageCallback, this);
+    // Only errors are of interest; other kinds of message, such as performance
+    // warnings, are disabled.
+    gl_functions_->glDebugMessageControl_(GL_DONT_CARE, GL_DONT_CARE,
+                                          GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    gl_functions_->glDebugMessageControl_(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR,
+                                          GL_DONT_CARE, 0, nullptr, GL_TRUE);
+  }
+}
+
+Executor::~Executor() {
+  image_writer_.Flush(message_consumer_);
+  for (const auto& entry : comparison_programs_) {
+    gl_functions_->glDeleteProgram_(entry.second);
+  }
+  if (comparison_result_buffer_ != 0) {
+    gl_functions_->glDeleteBuffers_(1, &comparison_result_buffer_);
+  }
+  if (histogram_result_buffer_ != 0) {
+    gl_functions_->glDeleteBuffers_(1, &histogram_result_buffer_);
+  }
+  if (comparison_pixel_buffer_size_ != 0) {
+    gl_functions_->glDeleteBuffers_(2, comparison_pixel_buffers_);
+  }
+  if (!band_pixel_buffers_.empty()) {
+    gl_functions_->glDeleteBuffers_(
+        static_cast<GLsizei>(band_pixel_buffers_.size()),
+        band_pixel_buffers_.data());
+  }
+  for (const auto& entry : framebuffer_cache_) {
+    gl_functions_->glDeleteFramebuffers_(1, &entry.second);
+  }
+  for (const auto& entry : vertex_array_cache_) {
+    gl_functions_->glDeleteVertexArrays_(1, &entry.second);
+  }
+  for (const auto& entry : renderbuffer_readbacks_) {
+    if (entry.second.fence != nullptr) {
+      gl_functions_->glDeleteSync_(entry.second.fence);
+    }
+    gl_functions_->glDeleteBuffers_(1, &entry.second.pixel_buffer);
+  }
+  if (options_.error_policy == GlErrorPolicy::kDebugCallback) {
+    gl_functions_->glDebugMessageCallback_(nullptr, nullptr);
+  }
+}
+
+void Executor::PlanPixelReadbacks(ShaderTrapProgram* program) {
+  PixelAssertGrouper grouper;
+  grouper.VisitCommands(program);
+  for (const auto& group : grouper.GetGroups()) {
+    size_t min_x = group[0]->GetRectangleX();
+    size_t min_y = group[0]->GetRectangleY();
+    size_t max_x = min_x + group[0]->GetRectangleWidth();
+    size_t max_y = min_y + group[0]->GetRectangleHeight();
+    for (const auto* assert_pixels : group) {
+      min_x = std::min(min_x, assert_pixels->GetRectangleX());
+      min_y = std::min(min_y, assert_pixels->GetRectangleY());
+      max_x = std::max(max_x, assert_pixels->GetRectangleX() +
+                                  assert_pixels->GetRectangleWidth());
+      max_y = std::max(max_y, assert_pixels->GetRectangleY() +
+                                  assert_pixels->GetRectangleHeight());
+    }
+    for (const auto* assert_pixels : group) {
+      planned_pixel_readbacks_[assert_pixels] = {min_x, min_y, max_x - min_x,
+                                                 max_y - min_y};
+    }
+  }
+}
+
+void Executor::PlanRenderbufferReadbacks(ShaderTrapProgram* program) {
+  if (api_version_ == ApiVersion(ApiVersion::Api::GLES, 2, 0)) {
+    // Readbacks cannot be started ahead of time in OpenGL ES 2.0.
+    return;
+  }
+  RenderbufferReadbackPlanner planner(
+      SupportsComputeShaders(),
+      SupportsComputeShaders() && options_.compare_on_gpu);
+  planner.VisitCommands(program);
+  planned_renderbuffer_readbacks_ = planner.GetReadbacks();
+}
+
+void Executor::PlanMemoryBarriers(ShaderTrapProgram* program) {
+  if (options_.conservative_barriers) {
+    return;
+  }
+  MemoryBarrierPlanner planner(options_.compare_on_gpu);
+  planner.VisitCommands(program);
+  planned_memory_barriers_ = planner.GetBarriers();
+  planned_barriers_between_dispatches_ =
+      planner.GetBarriersBetweenDispatches();
+  memory_barriers_planned_ = true;
+}
+
+void Executor::PlanBufferPools(ShaderTrapProgram* program) {
+  if (!options_.pool_buffers) {
+    return;
+  }
+  UnpooledBufferFinder finder;
+  finder.VisitCommands(program);
+  unpooled_buffers_ = finder.GetUnpooledBuffers();
+  buffer_pools_planned_ = true;
+}
+
+void GL_APIENTRY Executor::DebugMessageCallback(GLenum /*source*/, GLenum type,
+                                                GLuint /*id*/,
+                                                GLenum /*severity*/,
+                                                GLsizei length,
+                                                const GLchar* message,
+                                                const void* user_param) {
+  if (type != GL_DEBUG_TYPE_ERROR) {
+    return;
+  }
+  // GLDEBUGPROC passes back the user parameter as a pointer to const.
+  auto* executor = static_cast<Executor*>(const_cast<void*>(user_param));
+  executor->pending_debug_messages_.emplace_back(
+      length < 0 ? std::string(message)
+                 : std::string(message, static_cast<size_t>(length)));
+}
+
+bool Executor::CheckCommandErrors(const Token* start_token) {
+  bool result = true;
+  switch (options_.error_policy) {
+    case GlErrorPolicy::kStrict:
+      break;
+    case GlErrorPolicy::kPerCommand: {
+      // Several error flags may be set; glGetError returns and clears one at a
+      // time. The number of iterations is bounded in case an implementation
+      // keeps reporting an error, e.g. after a context loss.
+      const size_t kMaxErrorFlags = 16;
+      for (size_t i = 0; i < kMaxErrorFlags; i++) {
+        GLenum err = gl_functions_->glGetError_();
+        if (err == GL_NO_ERROR) {
+          break;
+        }
+        message_consumer_->Message(MessageConsumer::Severity::kError,
+                                   start_token,
+                                   "OpenGL error: " + OpenglErrorString(err));
+        result = false;
+      }
+      break;
+    }
+    case GlErrorPolicy::kDebugCallback:
+      for (const auto& message : pending_debug_messages_) {
+        message_consumer_->Message(MessageConsumer::Severity::kError,
+                                   start_token, "OpenGL error: " + message);
+        result = false;
+      }
+      pending_debug_messages_.clear();
+      break;
+  }
+  return result;
+}
+
+bool Executor::FlushImageWrites() {
+  return image_writer_.Flush(message_consumer_);
+}
+
+bool Executor::VisitAssertBufferHash(
+    CommandAssertBufferHash* assert_buffer_hash) {
+  const Token* start_token = &assert_buffer_hash->GetStartToken();
+  const BufferRange& range =
+      created_buffers_.at(assert_buffer_hash->GetBufferIdentifier());
+  GL_SAFECALL(start_token, glBindBuffer, GL_ARRAY_BUFFER, range.buffer);
+  const auto* mapped_buffer =
+      static_cast<const uint8_t*>(gl_functions_->glMapBufferRange_(
+          GL_ARRAY_BUFFER, static_cast<GLintptr>(range.offset_bytes),
+          static_cast<GLsizeiptr>(range.size_bytes), GL_MAP_READ_BIT));
+  if (mapped_buffer == nullptr) {
+    GL_CHECKERR(start_token, "glMapBufferRange");
+    CheckCommandErrors(start_token);
+    return false;
+  }
+  // Without skipped bytes the mapped buffer is hashed in one go; otherwise
+  // each range of bytes that is not skipped is fed to the hasher in turn.
+  const auto& format_entries = assert_buffer_hash->GetFormatEntries();
+  bool skips_bytes = false;
+  for (const auto& format_entry : format_entries) {
+    skips_bytes |=
+        format_entry.kind == CommandDumpBufferText::FormatEntry::Kind::kSkip;
+  }
+  uint64_t hash;
+  if (!skips_bytes) {
+    hash = Xxh3Hash64(mapped_buffer, range.size_bytes);
+  } else {
+    Xxh3Hasher hasher;
+    size_t offset_bytes = 0;
+    for (const auto& format_entry : format_entries) {
+      using Kind = CommandDumpBufferText::FormatEntry::Kind;
+      const size_t count_bytes =
+          format_entry.kind == Kind::kByte || format_entry.kind == Kind::kSkip
+              ? format_entry.count
+              : format_entry.count * sizeof(uint32_t);
+      if (format_entry.kind != Kind::kSkip) {
+        hasher.Update(mapped_buffer + offset_bytes, count_bytes);
+      }
+      offset_bytes += count_bytes;
+    }
+    hash = hasher.Digest();
+  }
+  GL_SAFECALL(start_token, glUnmapBuffer, GL_ARRAY_BUFFER);
+  return CheckCommandErrors(start_token) &&
+         CheckHash(start_token, assert_buffer_hash->GetBufferIdentifier(), hash,
+                   assert_buffer_hash->GetExpectedHash());
+}
 
 bool Executor::VisitAssertEqual(CommandAssertEqual* assert_equal) {
+  bool result;
   if (assert_equal->GetArgumentsAreRenderbuffers()) {
-    return CheckEqualRenderbuffers(assert_equal);
+    result = CheckEqualRenderbuffers(assert_equal);
+  } else if (assert_equal->GetComparesWithFile()) {
+    result = CheckBufferEqualsFile(assert_equal);
+  } else {
+    result = CheckEqualBuffers(assert_equal);
   }
-  return CheckEqualBuffers(assert_equal);
+  return CheckCommandErrors(&assert_equal->GetStartToken()) && result;
 }
 
-bool Executor::VisitAssertPixels(CommandAssertPixels* assert_pixels) {
-  GLuint framebuffer_object_id;
-  GL_SAFECALL(&assert_pixels->GetStartToken(), glGenFramebuffers, 1,
-              &framebuffer_object_id);
-  GL_SAFECALL(&assert_pixels->GetStartToken(), glBindFramebuffer,
-              GL_FRAMEBUFFER, framebuffer_object_id);
-  GL_SAFECALL(
-      &assert_pixels->GetStartToken(), glFramebufferRenderbuffer,
-      GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
-      created_renderbuffers_.at(assert_pixels->GetRenderbufferIdentifier()));
-  size_t width;
-  size_t height;
-  {
-    GLint temp_width;
-    GL_SAFECALL(&assert_pixels->GetStartToken(), glGetRenderbufferParameteriv,
-                GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &temp_width);
-    GLint temp_height;
-    GL_SAFECALL(&assert_pixels->GetStartToken(), glGetRenderbufferParameteriv,
-                GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &temp_height);
-    width = static_cast<size_t>(temp_width);
-    height = static_cast<size_t>(temp_height);
+bool Executor::VisitAssertMatchesImage(
+    CommandAssertMatchesImage* assert_matches_image) {
+  const Token* start_token = &assert_matches_image->GetStartToken();
+  const std::string& identifier =
+      assert_matches_image->GetRenderbufferIdentifier();
+  const std::string& filename = assert_matches_image->GetFilename();
+
+  // The image may have been written by an earlier DUMP_RENDERBUFFER command.
+  if (!FlushImageWrites()) {
+    return false;
+  }
+  size_t width = 0;
+  size_t height = 0;
+  if (!GetRenderbufferSize(start_token, identifier, &width, &height)) {
+    return false;
   }
 
-  GLenum status = gl_functions_->glCheckFramebufferStatus_(GL_FRAMEBUFFER);
-  if (status != GL_FRAMEBUFFER_COMPLETE) {
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               "Could not open '" + filename + "'");
+    return false;
+  }
+  // A RAW image is compared row by row as it is read; any other image is
+  // decoded as a PNG image in full.
+  uint8_t header[12] = {};
+  file.read(reinterpret_cast<char*>(header), sizeof(header));
+  const bool is_raw = file.gcount() == sizeof(header) &&
+                      std::equal(header, header + 4, "RGBA");
+  size_t image_width = 0;
+  size_t image_height = 0;
+  std::vector<std::uint8_t> decoded;
+  if (is_raw) {
+    for (size_t index = 0; index < 4; index++) {
+      image_width |= static_cast<size_t>(header[4 + index]) << (8 * index);
+      image_height |= static_cast<size_t>(header[8 + index]) << (8 * index);
+    }
+  } else {
+#ifdef SHADERTRAP_LODEPNG
+    file.clear();
+    file.seekg(0);
+    std::vector<unsigned char> png_data(
+        (std::istreambuf_iterator<char>(file)),
+        std::istreambuf_iterator<char>());
+    unsigned int png_width = 0;
+    unsigned int png_height = 0;
+    unsigned png_error =
+        lodepng::decode(decoded, png_width, png_height, png_data);
+    if (png_error != 0) {
+      message_consumer_->Message(MessageConsumer::Severity::kError,
+                                 start_token,
+                                 "'" + filename +
+                                     "' is neither a RAW nor a PNG image: " +
+                                     lodepng_error_text(png_error));
+      return false;
+    }
+    image_width = png_width;
+    image_height = png_height;
+#else
     message_consumer_->Message(
-        MessageConsumer::Severity::kError, &assert_pixels->GetStartToken(),
-        "Incomplete framebuffer found for 'ASSERT_PIXELS' command; "
-        "glCheckFramebufferStatus returned status " +
-            std::to_string(status));
+        MessageConsumer::Severity::kError, start_token,
+        "'" + filename +
+            "' is not a RAW image, and cannot be read as a PNG image as PNG "
+            "support is not available");
     return false;
+#endif
   }
 
-  std::vector<std::uint8_t> data(width * height * kNumRgbaChannels);
-  if (api_version_.GetApi() == ApiVersion::Api::GL ||
-      api_version_ >= ApiVersion(ApiVersion::Api::GLES, 3, 0)) {
-    // OpenGL ES did not support glReadBuffer before 3.0, and reads will always
-    // occur from color attachment 0 in OpenGL ES 2.0. Where the facility to
-    // specify a read buffer is available, we explicitly specify that we would
-    // like color attachment 0.
-    GL_SAFECALL(&assert_pixels->GetStartToken(), glReadBuffer,
-                GL_COLOR_ATTACHMENT0);
+  if (width != image_width) {
+    std::stringstream stringstream;
+    stringstream << "The widths of " << identifier << " and '" << filename
+                 << "' do not match: " << width << " vs. " << image_width;
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    return false;
   }
-  GL_SAFECALL(&assert_pixels->GetStartToken(), glReadPixels, 0, 0,
-              static_cast<GLint>(width), static_cast<GLint>(height), GL_RGBA,
-              GL_UNSIGNED_BYTE, data.data());
-  bool result = true;
+
+  if (height != image_height) {
+    std::stringstream stringstream;
+    stringstream << "The heights of " << identifier << " and '" << filename
+                 << "' do not match: " << height << " vs. " << image_height;
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    return false;
+  }
+
+  PixelMismatchSummary summary;
+  std::vector<std::uint8_t> diff_mask;
+  const size_t row_size_bytes = width * kNumRgbaChannels;
+  std::vector<std::uint8_t> raw_row(is_raw ? row_size_bytes : 0);
+  if (!ReadRenderbufferBands(
+          start_token, "ASSERT_MATCHES_IMAGE", {identifier}, width, height, 0,
+          [&](size_t first_row, size_t num_rows,
+              const std::vector<const std::uint8_t*>& bands) -> bool {
+            for (size_t row = num_rows; row-- > 0;) {
+              // Image rows are ordered from the top down, and renderbuffer
+              // rows from the bottom up.
+              const size_t y = height - (first_row + row) - 1;
+              const uint8_t* image_row = raw_row.data();
+              if (!is_raw) {
+                image_row = decoded.data() + y * row_size_bytes;
+              } else if (!file.read(
+                             reinterpret_cast<char*>(raw_row.data()),
+                             static_cast<std::streamsize>(row_size_bytes))) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, start_token,
+                    "'" + filename +
+                        "' holds fewer pixels than its header describes");
+                return false;
+              }
+              ComparePixelRow(message_consumer_, options_.max_mismatch_reports,
+                              start_token, identifier, filename, y, width,
+                              height, bands[0] + row * row_size_bytes,
+                              image_row, &summary,
+                              options_.write_diff_masks ? &diff_mask : nullptr);
+            }
+            return true;
+          })) {
+    return false;
+  }
+  if (summary.GetCount() == 0) {
+    return CheckCommandErrors(start_token);
+  }
+  ReportMismatchSummary(
+      start_token, summary.GetCount(),
+      "'" + identifier + "' and '" + filename + "' have " + summary.ToString());
+  if (options_.write_diff_masks) {
+    WriteDiffMask(start_token, width, height, diff_mask);
+  }
+  CheckCommandErrors(start_token);
+  return false;
+}
+
+bool Executor::VisitAssertPixels(CommandAssertPixels* assert_pixels) {
+  const std::string& identifier = assert_pixels->GetRenderbufferIdentifier();
+  PixelRectangle rectangle = {
+      assert_pixels->GetRectangleX(), assert_pixels->GetRectangleY(),
+      assert_pixels->GetRectangleWidth(), assert_pixels->GetRectangleHeight()};
+  auto readback = pixel_readbacks_.find(identifier);
+  if (readback == pixel_readbacks_.end() ||
+      !readback->second.rectangle.Contains(rectangle)) {
+    // The pixels have not been read back already, so read back the region
+    // shared by this and any subsequent ASSERT_PIXELS commands on the
+    // renderbuffer. The planned region is only used if it lies within the
+    // renderbuffer and covers this command's rectangle; otherwise just the
+    // rectangle is read.
+    PixelRectangle region = rectangle;
+    auto planned = planned_pixel_readbacks_.find(assert_pixels);
+    if (planned != planned_pixel_readbacks_.end() &&
+        planned->second.Contains(rectangle)) {
+      size_t width;
+      size_t height;
+      if (!GetRenderbufferSize(&assert_pixels->GetStartToken(), identifier,
+                               &width, &height)) {
+        return false;
+      }
+      if (PixelRectangle{0, 0, width, height}.Contains(planned->second)) {
+        region = planned->second;
+      }
+    }
+    if (!ReadRenderbufferRectangle(&assert_pixels->GetStartToken(), identifier,
+                                   region)) {
+      return false;
+    }
+    readback = pixel_readbacks_.find(identifier);
+  }
+  const PixelRectangle& region = readback->second.rectangle;
+  const std::vector<std::uint8_t>& data = readback->second.data;
+  const uint8_t expected[kNumRgbaChannels] = {
+      assert_pixels->GetExpectedR(), assert_pixels->GetExpectedG(),
+      assert_pixels->GetExpectedB(), assert_pixels->GetExpectedA()};
+  PixelMismatchSummary summary;
+  std::vector<std::uint8_t> diff_mask;
   for (size_t y = assert_pixels->GetRectangleY();
        y < assert_pixels->GetRectangleY() + assert_pixels->GetRectangleHeight();
        y++) {
@@ -172,67 +1380,99 @@ bool Executor::VisitAssertPixels(CommandAssertPixels* assert_pixels) {
          x <
          assert_pixels->GetRectangleX() + assert_pixels->GetRectangleWidth();
          x++) {
-      uint8_t* start_of_pixel = &data[(height - y - 1) * width * 4 + x * 4];
-      uint8_t r = start_of_pixel[0];
-      uint8_t g = start_of_pixel[1];
-      uint8_t b = start_of_pixel[2];
-      uint8_t a = start_of_pixel[3];
-      if (assert_pixels->GetExpectedR() != r ||
-          assert_pixels->GetExpectedG() != g ||
-          assert_pixels->GetExpectedB() != b ||
-          assert_pixels->GetExpectedA() != a) {
-        std::stringstream stringstream;
-        stringstream << "Expected pixel ("
-                     << static_cast<uint32_t>(assert_pixels->GetExpectedR())
-                     << ", "
-                     << static_cast<uint32_t>(assert_pixels->GetExpectedG())
-                     << ", "
-                     << static_cast<uint32_t>(assert_pixels->GetExpectedB())
-                     << ", "
-                     << static_cast<uint32_t>(assert_pixels->GetExpectedA())
-                     << "), got (" << static_cast<uint32_t>(r) << ", "
-                     << static_cast<uint32_t>(g) << ", "
-                     << static_cast<uint32_t>(b) << ", "
-                     << static_cast<uint32_t>(a) << ") at "
-                     << assert_pixels->GetRenderbufferIdentifier() << "[" << x
-                     << "][" << y << "]";
-        message_consumer_->Message(MessageConsumer::Severity::kError,
-                                   &assert_pixels->GetStartToken(),
-                                   stringstream.str());
-        result = false;
+      const uint8_t* start_of_pixel =
+          &data[((region.y + region.height - y - 1) * region.width + x -
+                 region.x) *
+                kNumRgbaChannels];
+      if (memcmp(start_of_pixel, expected, kNumRgbaChannels) == 0) {
+        continue;
       }
+      summary.Add(x, y, expected, start_of_pixel);
+      if (options_.write_diff_masks) {
+        if (diff_mask.empty()) {
+          diff_mask = MakeDiffMask(rectangle.width, rectangle.height);
+        }
+        SetDiffMaskPixel(x - rectangle.x, y - rectangle.y, rectangle.width,
+                         &diff_mask);
+      }
+      if (summary.GetCount() > options_.max_mismatch_reports) {
+        continue;
+      }
+      std::stringstream stringstream;
+      stringstream << "Expected pixel ("
+                   << static_cast<uint32_t>(assert_pixels->GetExpectedR())
+                   << ", "
+                   << static_cast<uint32_t>(assert_pixels->GetExpectedG())
+                   << ", "
+                   << static_cast<uint32_t>(assert_pixels->GetExpectedB())
+                   << ", "
+                   << static_cast<uint32_t>(assert_pixels->GetExpectedA())
+                   << "), got (" << static_cast<uint32_t>(start_of_pixel[0])
+                   << ", " << static_cast<uint32_t>(start_of_pixel[1]) << ", "
+                   << static_cast<uint32_t>(start_of_pixel[2]) << ", "
+                   << static_cast<uint32_t>(start_of_pixel[3]) << ") at "
+                   << identifier << "[" << x << "][" << y << "]";
+      message_consumer_->Message(MessageConsumer::Severity::kError,
+                                 &assert_pixels->GetStartToken(),
+                                 stringstream.str());
     }
   }
-  return result;
+  bool result = summary.GetCount() == 0;
+  if (!result) {
+    ReportMismatchSummary(&assert_pixels->GetStartToken(), summary.GetCount(),
+                          "'" + identifier + "' has " + summary.ToString());
+    if (options_.write_diff_masks) {
+      WriteDiffMask(&assert_pixels->GetStartToken(), rectangle.width,
+                    rectangle.height, diff_mask);
+    }
+  }
+  return CheckCommandErrors(&assert_pixels->GetStartToken()) && result;
+}
+
+bool Executor::VisitAssertRenderbufferHash(
+    CommandAssertRenderbufferHash* assert_renderbuffer_hash) {
+  const Token* start_token = &assert_renderbuffer_hash->GetStartToken();
+  const std::string& identifier =
+      assert_renderbuffer_hash->GetRenderbufferIdentifier();
+  size_t width;
+  size_t height;
+  if (!GetRenderbufferSize(start_token, identifier, &width, &height)) {
+    return false;
+  }
+  // The rows are hashed top-to-bottom, the order in which DUMP_RENDERBUFFER
+  // writes them, so that the hash can be computed from a RAW dump.
+  const size_t row_bytes = width * kNumRgbaChannels;
+  Xxh3Hasher hasher;
+  if (!ReadRenderbufferBands(
+          start_token, "ASSERT_RENDERBUFFER_HASH", {identifier}, width, height,
+          0,
+          [&hasher, row_bytes](
+              size_t /*first_row*/, size_t num_rows,
+              const std::vector<const std::uint8_t*>& bands) -> bool {
+            for (size_t row = num_rows; row-- > 0;) {
+              hasher.Update(bands[0] + row * row_bytes, row_bytes);
+            }
+            return true;
+          })) {
+    return false;
+  }
+  return CheckCommandErrors(start_token) &&
+         CheckHash(start_token, identifier, hasher.Digest(),
+                   assert_renderbuffer_hash->GetExpectedHash());
 }
 
 bool Executor::VisitAssertSimilarEmdHistogram(
     CommandAssertSimilarEmdHistogram* assert_similar_emd_histogram) {
-  GLuint renderbuffers[2];
-  renderbuffers[0] = created_renderbuffers_.at(
-      assert_similar_emd_histogram->GetRenderbufferIdentifier1());
-  renderbuffers[1] = created_renderbuffers_.at(
-      assert_similar_emd_histogram->GetRenderbufferIdentifier2());
-
+  const Token* start_token = &assert_similar_emd_histogram->GetStartToken();
+  const std::string* identifiers[2] = {
+      &assert_similar_emd_histogram->GetRenderbufferIdentifier1(),
+      &assert_similar_emd_histogram->GetRenderbufferIdentifier2()};
   size_t width[2] = {0, 0};
   size_t height[2] = {0, 0};
-
   for (auto index : {0, 1}) {
-    {
-      GLint temp_width;
-      GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(),
-                  glBindRenderbuffer, GL_RENDERBUFFER, renderbuffers[index]);
-      GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(),
-                  glGetRenderbufferParameteriv, GL_RENDERBUFFER,
-                  GL_RENDERBUFFER_WIDTH, &temp_width);
-      width[index] = static_cast<size_t>(temp_width);
-    }
-    {
-      GLint temp_height;
-      GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(),
-                  glGetRenderbufferParameteriv, GL_RENDERBUFFER,
-                  GL_RENDERBUFFER_HEIGHT, &temp_height);
-      height[index] = static_cast<size_t>(temp_height);
+    if (!GetRenderbufferSize(start_token, *identifiers[index], &width[index],
+                             &height[index])) {
+      return false;
     }
   }
 
@@ -243,8 +1483,7 @@ bool Executor::VisitAssertSimilarEmdHistogram(
                  << " and "
                  << assert_similar_emd_histogram->GetRenderbufferIdentifier2()
                  << " do not match: " << width[0] << " vs. " << width[1];
-    message_consumer_->Message(MessageConsumer::Severity::kError,
-                               &assert_similar_emd_histogram->GetStartToken(),
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
                                stringstream.str());
     return false;
   }
@@ -256,117 +1495,184 @@ bool Executor::VisitAssertSimilarEmdHistogram(
                  << " and "
                  << assert_similar_emd_histogram->GetRenderbufferIdentifier2()
                  << " do not match: " << height[0] << " vs. " << height[1];
-    message_consumer_->Message(MessageConsumer::Severity::kError,
-                               &assert_similar_emd_histogram->GetStartToken(),
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
                                stringstream.str());
     return false;
   }
 
-  GLuint framebuffer_object_id;
-  GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(), glGenFramebuffers,
-              1, &framebuffer_object_id);
-  GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(), glBindFramebuffer,
-              GL_FRAMEBUFFER, framebuffer_object_id);
-  for (auto index : {0, 1}) {
-    GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(),
-                glFramebufferRenderbuffer, GL_FRAMEBUFFER,
-                GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index),
-                GL_RENDERBUFFER, renderbuffers[index]);
+  const size_t num_pixels = width[0] * height[0];
+  std::vector<uint64_t> histograms[2];
+  if (SupportsComputeShaders()) {
+    // The histograms are computed where the pixels live, so that only the
+    // counts are read back.
+    if (!CopyRenderbuffersToComparisonBuffers(
+            start_token, "ASSERT_SIMILAR_EMD_HISTOGRAM", *identifiers[0],
+            *identifiers[1], width[0], height[0]) ||
+        !ComputeHistogramsOnGpu(start_token, num_pixels, histograms)) {
+      return false;
+    }
+  } else {
+    // The histograms of each band are added to those of the bands above it.
+    for (auto index : {0, 1}) {
+      histograms[index].assign(kNumRgbaChannels * kNumHistogramBins, 0);
+    }
+    const size_t row_pixels = width[0];
+    if (!ReadRenderbufferBands(
+            start_token, "ASSERT_SIMILAR_EMD_HISTOGRAM",
+            {*identifiers[0], *identifiers[1]}, width[0], height[0], 0,
+            [&histograms, row_pixels](
+                size_t /*first_row*/, size_t num_rows,
+                const std::vector<const std::uint8_t*>& bands) -> bool {
+              for (auto index : {0, 1}) {
+                const std::vector<uint64_t> band_histograms =
+                    ComputeChannelHistograms(bands[index],
+                                             num_rows * row_pixels);
+                for (size_t bin = 0; bin < band_histograms.size(); bin++) {
+                  histograms[index][bin] += band_histograms[bin];
+                }
+              }
+              return true;
+            })) {
+      return false;
+    }
   }
-  GLenum status = gl_functions_->glCheckFramebufferStatus_(GL_FRAMEBUFFER);
-  if (status != GL_FRAMEBUFFER_COMPLETE) {
+
+  const double max_emd =
+      ComputeMaxEmd(histograms[0], histograms[1], num_pixels);
+  if (max_emd >
+      static_cast<double>(assert_similar_emd_histogram->GetTolerance())) {
     message_consumer_->Message(
-        MessageConsumer::Severity::kError,
-        &assert_similar_emd_histogram->GetStartToken(),
-        "Incomplete framebuffer found for 'ASSERT_SIMILAR_EMD_HISTOGRAM' "
-        "command; glCheckFramebufferStatus returned status " +
-            std::to_string(status));
+        MessageConsumer::Severity::kError, start_token,
+        "Histogram EMD value of " + std::to_string(max_emd) +
+            " is greater than tolerance of " +
+            std::to_string(assert_similar_emd_histogram->GetTolerance()));
+    CheckCommandErrors(start_token);
     return false;
   }
+  return CheckCommandErrors(start_token);
+}
 
-  std::vector<std::uint8_t> data[2];
+bool Executor::VisitAssertSimilarImage(
+    CommandAssertSimilarImage* assert_similar_image) {
+  const Token* start_token = &assert_similar_image->GetStartToken();
+  const std::string* identifiers[2] = {
+      &assert_similar_image->GetRenderbufferIdentifier1(),
+      &assert_similar_image->GetRenderbufferIdentifier2()};
+  // Both readbacks are issued before either is waited for.
   for (auto index : {0, 1}) {
-    data[index].resize(width[index] * height[index] * kNumRgbaChannels);
-    GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(), glReadBuffer,
-                GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(index));
-    GL_SAFECALL(&assert_similar_emd_histogram->GetStartToken(), glReadPixels, 0,
-                0, static_cast<GLint>(width[index]),
-                static_cast<GLint>(height[index]), GL_RGBA, GL_UNSIGNED_BYTE,
-                data[index].data());
+    if (!StartRenderbufferReadback(start_token, "ASSERT_SIMILAR_IMAGE",
+                                   *identifiers[index])) {
+      return false;
+    }
   }
-
-  const size_t num_bins = 256;
-
-  std::vector<std::vector<uint64_t>> histogram[2];
+  size_t width[2] = {0, 0};
+  size_t height[2] = {0, 0};
   for (auto index : {0, 1}) {
-    for (size_t channel = 0; channel < 4; channel++) {
-      histogram[index].emplace_back(std::vector<uint64_t>(num_bins, 0));
-    }
-    for (size_t y = 0; y < height[index]; y++) {
-      for (size_t x = 0; x < width[index]; x++) {
-        for (size_t channel = 0; channel < 4; channel++) {
-          histogram[index][channel]
-                   [data[index][y * width[index] * 4 + x * 4 + channel]]++;
-        }
-      }
+    if (!GetRenderbufferSize(start_token, *identifiers[index], &width[index],
+                             &height[index])) {
+      return false;
     }
   }
-
-  // Earth movers's distance: Calculate the minimal cost of moving "earth" to
-  // transform the first histogram into the second, where each bin of the
-  // histogram can be thought of as a column of units of earth. The cost is the
-  // amount of earth moved times the distance carried (the distance is the
-  // number of adjacent bins over which the earth is carried). Calculate this
-  // using the cumulative difference of the bins, which works as long as both
-  // histograms have the same amount of earth. Sum the absolute values of the
-  // cumulative difference to get the final cost of how much (and how far) the
-  // earth was moved.
-  double max_emd = 0;
-
-  for (size_t channel = 0; channel < 4; ++channel) {
-    double diff_total = 0;
-    double diff_accum = 0;
-
-    for (size_t i = 0; i < num_bins; ++i) {
-      double hist_normalized_0 = static_cast<double>(histogram[0][channel][i]) /
-                                 static_cast<double>(width[0] * height[0]);
-      double hist_normalized_1 = static_cast<double>(histogram[1][channel][i]) /
-                                 static_cast<double>(width[1] * height[1]);
-      diff_accum += hist_normalized_0 - hist_normalized_1;
-      diff_total += std::fabs(diff_accum);
-    }
-    // Normalize to range 0..1
-    double emd = diff_total / num_bins;
-    max_emd = std::max(max_emd, emd);
+  if (width[0] != width[1] || height[0] != height[1]) {
+    std::stringstream stringstream;
+    stringstream << "The dimensions of " << *identifiers[0] << " and "
+                 << *identifiers[1] << " do not match: " << width[0] << "x"
+                 << height[0] << " vs. " << width[1] << "x" << height[1];
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    return false;
   }
 
-  if (max_emd >
-      static_cast<double>(assert_similar_emd_histogram->GetTolerance())) {
-    message_consumer_->Message(
-        MessageConsumer::Severity::kError,
-        &assert_similar_emd_histogram->GetStartToken(),
-        "Histogram EMD value of " + std::to_string(max_emd) +
-            " is greater than tolerance of " +
-            std::to_string(assert_similar_emd_histogram->GetTolerance()));
+  // The renderbuffers are compared a band at a time as they are read back, so
+  // that neither is held in host memory whole.
+  ImageComparer comparer(width[0], height[0],
+                         assert_similar_image->GetChannelTolerance(),
+                         assert_similar_image->HasMinSsim());
+  if (!ReadRenderbufferBands(
+          start_token, "ASSERT_SIMILAR_IMAGE",
+          {*identifiers[0], *identifiers[1]}, width[0], height[0], 0,
+          [&comparer](size_t first_row, size_t num_rows,
+                      const std::vector<const std::uint8_t*>& bands) -> bool {
+            comparer.AddBand(first_row, num_rows, bands[0], bands[1]);
+            return true;
+          })) {
+    return false;
   }
-  return true;
+  const ImageDifferences differences = comparer.GetDifferences();
+  bool similar = true;
+  const size_t num_pixels = width[0] * height[0];
+  const double differing_fraction =
+      num_pixels == 0 ? 0.0
+                      : static_cast<double>(differences.num_differing_pixels) /
+                            static_cast<double>(num_pixels);
+  const auto max_differing_fraction =
+      static_cast<double>(assert_similar_image->GetMaxDifferingFraction());
+  if (assert_similar_image->CountsDifferingPixels() &&
+      differing_fraction > max_differing_fraction) {
+    std::stringstream stringstream;
+    stringstream << differences.num_differing_pixels << " of " << num_pixels
+                 << " pixels (" << differing_fraction * 100.0
+                 << "%) differ by more than "
+                 << static_cast<uint32_t>(
+                        assert_similar_image->GetChannelTolerance())
+                 << " in some channel, which exceeds the maximum differing "
+                    "fraction of "
+                 << max_differing_fraction
+                 << "; the largest channel difference is "
+                 << static_cast<uint32_t>(differences.max_channel_difference);
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    similar = false;
+  }
+  if (assert_similar_image->HasMinSsim() &&
+      differences.ssim <
+          static_cast<double>(assert_similar_image->GetMinSsim())) {
+    std::stringstream stringstream;
+    stringstream << "SSIM of " << differences.ssim
+                 << " is less than the minimum of "
+                 << assert_similar_image->GetMinSsim();
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    similar = false;
+  }
+  const double psnr = ComputePsnr(differences.mean_squared_error);
+  if (assert_similar_image->HasMinPsnr() &&
+      psnr < static_cast<double>(assert_similar_image->GetMinPsnr())) {
+    std::stringstream stringstream;
+    stringstream << "PSNR of " << psnr << " dB is less than the minimum of "
+                 << assert_similar_image->GetMinPsnr() << " dB";
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    similar = false;
+  }
+  if (!similar) {
+    CheckCommandErrors(start_token);
+    return false;
+  }
+  return CheckCommandErrors(start_token);
 }
 
 bool Executor::VisitBindSampler(CommandBindSampler* bind_sampler) {
   GL_SAFECALL(&bind_sampler->GetStartToken(), glBindSampler,
               static_cast<GLuint>(bind_sampler->GetTextureUnit()),
               created_samplers_.at(bind_sampler->GetSamplerIdentifier()));
-  return true;
+  return CheckCommandErrors(&bind_sampler->GetStartToken());
 }
 
 bool Executor::VisitBindShaderStorageBuffer(
     CommandBindShaderStorageBuffer* bind_shader_storage_buffer) {
-  GL_SAFECALL(
-      &bind_shader_storage_buffer->GetStartToken(), glBindBufferBase,
-      GL_SHADER_STORAGE_BUFFER,
-      static_cast<GLuint>(bind_shader_storage_buffer->GetBinding()),
-      created_buffers_.at(bind_shader_storage_buffer->GetBufferIdentifier()));
-  return true;
+  const BufferRange& range =
+      created_buffers_.at(bind_shader_storage_buffer->GetBufferIdentifier());
+  if (!BindIndexedBufferRange(
+          &bind_shader_storage_buffer->GetStartToken(),
+          GL_SHADER_STORAGE_BUFFER,
+          static_cast<GLuint>(bind_shader_storage_buffer->GetBinding()),
+          range)) {
+    return false;
+  }
+  shader_storage_buffer_bindings_[static_cast<GLuint>(
+      bind_shader_storage_buffer->GetBinding())] = range;
+  return CheckCommandErrors(&bind_shader_storage_buffer->GetStartToken());
 }
 
 bool Executor::VisitBindTexture(CommandBindTexture* bind_texture) {
@@ -375,16 +1681,19 @@ bool Executor::VisitBindTexture(CommandBindTexture* bind_texture) {
       GL_TEXTURE0 + static_cast<GLenum>(bind_texture->GetTextureUnit()));
   GL_SAFECALL(&bind_texture->GetStartToken(), glBindTexture, GL_TEXTURE_2D,
               created_textures_.at(bind_texture->GetTextureIdentifier()));
-  return true;
+  return CheckCommandErrors(&bind_texture->GetStartToken());
 }
 
 bool Executor::VisitBindUniformBuffer(
     CommandBindUniformBuffer* bind_uniform_buffer) {
-  GL_SAFECALL(&bind_uniform_buffer->GetStartToken(), glBindBufferBase,
-              GL_UNIFORM_BUFFER,
-              static_cast<GLuint>(bind_uniform_buffer->GetBinding()),
-              created_buffers_.at(bind_uniform_buffer->GetBufferIdentifier()));
-  return true;
+  const BufferRange& range =
+      created_buffers_.at(bind_uniform_buffer->GetBufferIdentifier());
+  if (!BindIndexedBufferRange(
+          &bind_uniform_buffer->GetStartToken(), GL_UNIFORM_BUFFER,
+          static_cast<GLuint>(bind_uniform_buffer->GetBinding()), range)) {
+    return false;
+  }
+  return CheckCommandErrors(&bind_uniform_buffer->GetStartToken());
 }
 
 bool Executor::VisitCompileShader(CommandCompileShader* compile_shader) {
@@ -434,27 +1743,70 @@ bool Executor::VisitCompileShader(CommandCompileShader* compile_shader) {
     return false;
   }
   compiled_shaders_.insert({compile_shader->GetResultIdentifier(), shader});
-  return true;
+  return CheckCommandErrors(&compile_shader->GetStartToken());
 }
 
 bool Executor::VisitCreateBuffer(CommandCreateBuffer* create_buffer) {
-  GLuint buffer;
-  GL_SAFECALL(&create_buffer->GetStartToken(), glGenBuffers, 1, &buffer);
-  // We arbitrarily bind to the ARRAY_BUFFER target.
-  GL_SAFECALL(&create_buffer->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
-              buffer);
-  GL_SAFECALL(&create_buffer->GetStartToken(), glBufferData, GL_ARRAY_BUFFER,
-              static_cast<GLsizeiptr>(create_buffer->GetSizeBytes()),
-              create_buffer->GetData().data(), GL_STREAM_DRAW);
-  created_buffers_.insert({create_buffer->GetResultIdentifier(), buffer});
-  return true;
+  if (!InvalidateVertexArrays(&create_buffer->GetStartToken(),
+                              create_buffer->GetResultIdentifier())) {
+    return false;
+  }
+  GLenum usage = GL_STREAM_DRAW;
+  switch (create_buffer->GetUsage()) {
+    case CommandCreateBuffer::Usage::kStatic:
+      usage = GL_STATIC_DRAW;
+      break;
+    case CommandCreateBuffer::Usage::kDynamic:
+      usage = GL_DYNAMIC_DRAW;
+      break;
+    case CommandCreateBuffer::Usage::kStream:
+      usage = GL_STREAM_DRAW;
+      break;
+    case CommandCreateBuffer::Usage::kRead:
+      // GL_DYNAMIC_READ is not available in OpenGL ES 2.0, where the closest
+      // hint is used instead.
+      usage = api_version_ == ApiVersion(ApiVersion::Api::GLES, 2, 0)
+                  ? GL_DYNAMIC_DRAW
+                  : GL_DYNAMIC_READ;
+      break;
+  }
+  const size_t size_bytes = create_buffer->GetSizeBytes();
+  BufferRange range{0, 0, size_bytes};
+  if (buffer_pools_planned_ && size_bytes > 0 &&
+      size_bytes <= kMaxPooledBufferSizeBytes &&
+      unpooled_buffers_.count(create_buffer->GetResultIdentifier()) == 0) {
+    if (!AllocateFromBufferPool(&create_buffer->GetStartToken(), usage,
+                                size_bytes, &range)) {
+      return false;
+    }
+    // The pool's buffer object is bound to the ARRAY_BUFFER target.
+    GL_SAFECALL(&create_buffer->GetStartToken(), glBufferSubData,
+                GL_ARRAY_BUFFER, static_cast<GLintptr>(range.offset_bytes),
+                static_cast<GLsizeiptr>(size_bytes),
+                create_buffer->GetData().data());
+  } else {
+    GL_SAFECALL(&create_buffer->GetStartToken(), glGenBuffers, 1,
+                &range.buffer);
+    // We arbitrarily bind to the ARRAY_BUFFER target.
+    GL_SAFECALL(&create_buffer->GetStartToken(), glBindBuffer,
+                GL_ARRAY_BUFFER, range.buffer);
+    GL_SAFECALL(&create_buffer->GetStartToken(), glBufferData,
+                GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(size_bytes),
+                create_buffer->GetData().data(), usage);
+    buffer_statistics_.num_buffer_objects++;
+    buffer_statistics_.buffer_object_bytes += size_bytes;
+  }
+  buffer_statistics_.num_buffers++;
+  buffer_statistics_.buffer_bytes += size_bytes;
+  created_buffers_.insert({create_buffer->GetResultIdentifier(), range});
+  return CheckCommandErrors(&create_buffer->GetStartToken());
 }
 
 bool Executor::VisitCreateSampler(CommandCreateSampler* create_sampler) {
   GLuint sampler;
   GL_SAFECALL(&create_sampler->GetStartToken(), glGenSamplers, 1, &sampler);
   created_samplers_.insert({create_sampler->GetResultIdentifier(), sampler});
-  return true;
+  return CheckCommandErrors(&create_sampler->GetStartToken());
 }
 
 bool Executor::VisitCreateEmptyTexture2D(
@@ -469,9 +1821,13 @@ bool Executor::VisitCreateEmptyTexture2D(
               static_cast<GLsizei>(create_empty_texture_2d->GetWidth()),
               static_cast<GLsizei>(create_empty_texture_2d->GetHeight()), 0,
               GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+  if (!InvalidateFramebuffers(&create_empty_texture_2d->GetStartToken(),
+                              create_empty_texture_2d->GetResultIdentifier())) {
+    return false;
+  }
   created_textures_.insert(
       {create_empty_texture_2d->GetResultIdentifier(), texture});
-  return true;
+  return CheckCommandErrors(&create_empty_texture_2d->GetStartToken());
 }
 
 bool Executor::VisitCreateProgram(CommandCreateProgram* create_program) {
@@ -517,7 +1873,7 @@ bool Executor::VisitCreateProgram(CommandCreateProgram* create_program) {
     return false;
   }
   created_programs_.insert({create_program->GetResultIdentifier(), program});
-  return true;
+  return CheckCommandErrors(&create_program->GetStartToken());
 }
 
 bool Executor::VisitCreateRenderbuffer(
@@ -532,9 +1888,161 @@ bool Executor::VisitCreateRenderbuffer(
               GL_RENDERBUFFER, GL_RGBA8,
               static_cast<GLsizei>(create_renderbuffer->GetWidth()),
               static_cast<GLsizei>(create_renderbuffer->GetHeight()));
+  if (!InvalidateFramebuffers(&create_renderbuffer->GetStartToken(),
+                              create_renderbuffer->GetResultIdentifier())) {
+    return false;
+  }
   created_renderbuffers_.insert(
       {create_renderbuffer->GetResultIdentifier(), render_buffer});
-  return true;
+  return CheckCommandErrors(&create_renderbuffer->GetStartToken());
+}
+
+bool Executor::VisitCreateTexture2D(
+    CommandCreateTexture2D* create_texture_2d) {
+  const Token* start_token = &create_texture_2d->GetStartToken();
+  size_t width = create_texture_2d->GetWidth();
+  size_t height = create_texture_2d->GetHeight();
+  const std::uint8_t* source = create_texture_2d->GetData().data();
+  size_t size_bytes = create_texture_2d->GetData().size();
+  // PNG rows are ordered top-to-bottom, while texture data is ordered
+  // bottom-to-top; the rows of an image are flipped as it is copied for upload,
+  // so that it appears the same way up as in a PNG written by
+  // DUMP_RENDERBUFFER.
+  bool flip_rows = false;
+  std::vector<std::uint8_t> png_data;
+  if (create_texture_2d->HasInitFile()) {
+    // The file may have been written by an earlier DUMP_RENDERBUFFER command.
+    if (!FlushImageWrites()) {
+      return false;
+    }
+#ifdef SHADERTRAP_LODEPNG
+    unsigned int png_width = 0;
+    unsigned int png_height = 0;
+    unsigned png_error = lodepng::decode(png_data, png_width, png_height,
+                                         create_texture_2d->GetInitFile());
+    if (png_error != 0) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError, start_token,
+          "Reading PNG data from '" + create_texture_2d->GetInitFile() +
+              "' failed: " + lodepng_error_text(png_error));
+      return false;
+    }
+    width = png_width;
+    height = png_height;
+    source = png_data.data();
+    size_bytes = png_data.size();
+    flip_rows = true;
+#else
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, start_token,
+        "A texture cannot be initialized from '" +
+            create_texture_2d->GetInitFile() +
+            "', as PNG support is not available");
+    return false;
+#endif
+  }
+  // Copies the texture data, ready for upload, to |destination|.
+  auto copy_data = [source, size_bytes, flip_rows, width,
+                    height](std::uint8_t* destination) -> void {
+    if (!flip_rows) {
+      std::copy_n(source, size_bytes, destination);
+      return;
+    }
+    const size_t row_size_bytes = width * kNumRgbaChannels;
+    for (size_t h = 0; h < height; h++) {
+      std::copy_n(source + (height - h - 1) * row_size_bytes, row_size_bytes,
+                  destination + h * row_size_bytes);
+    }
+  };
+
+  const bool is_gles_2 =
+      api_version_ == ApiVersion(ApiVersion::Api::GLES, 2, 0);
+  GLint internal_format = GL_RGBA8;
+  GLenum format = GL_RGBA;
+  GLenum type = GL_UNSIGNED_BYTE;
+  switch (create_texture_2d->GetFormat()) {
+    case CommandCreateTexture2D::Format::kRgba8:
+      // OpenGL ES 2.0 does not support sized internal formats.
+      internal_format = is_gles_2 ? GL_RGBA : GL_RGBA8;
+      break;
+    case CommandCreateTexture2D::Format::kR8:
+      internal_format = GL_R8;
+      format = GL_RED;
+      break;
+    case CommandCreateTexture2D::Format::kRg16f:
+      // The data is given as 32-bit floats, which are converted to half-floats
+      // during the upload.
+      internal_format = GL_RG16F;
+      format = GL_RG;
+      type = GL_FLOAT;
+      break;
+    case CommandCreateTexture2D::Format::kRgba32f:
+      internal_format = GL_RGBA32F;
+      type = GL_FLOAT;
+      break;
+    case CommandCreateTexture2D::Format::kR32ui:
+      internal_format = GL_R32UI;
+      format = GL_RED_INTEGER;
+      type = GL_UNSIGNED_INT;
+      break;
+  }
+
+  GLuint texture;
+  GL_SAFECALL(start_token, glGenTextures, 1, &texture);
+  GL_SAFECALL(start_token, glBindTexture, GL_TEXTURE_2D, texture);
+  // Rows of single-byte texels are not padded to a multiple of 4 bytes.
+  GL_SAFECALL(start_token, glPixelStorei, GL_UNPACK_ALIGNMENT, 1);
+  if (!is_gles_2 && size_bytes >= kMinStreamedTextureSizeBytes) {
+    // The data is decoded or copied straight into a mapped pixel unpack
+    // buffer, from which the texture is filled without the application
+    // waiting for the transfer. Invalidating the buffer on mapping means that
+    // the GL need not preserve or synchronize its previous contents. The
+    // buffer is deleted straight away; the GL keeps it alive until the
+    // transfer is complete.
+    GLuint pixel_buffer;
+    GL_SAFECALL(start_token, glGenBuffers, 1, &pixel_buffer);
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_UNPACK_BUFFER,
+                pixel_buffer);
+    GL_SAFECALL(start_token, glBufferData, GL_PIXEL_UNPACK_BUFFER,
+                static_cast<GLsizeiptr>(size_bytes), nullptr, GL_STREAM_DRAW);
+    auto* mapped = static_cast<std::uint8_t*>(gl_functions_->glMapBufferRange_(
+        GL_PIXEL_UNPACK_BUFFER, 0, static_cast<GLsizeiptr>(size_bytes),
+        GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+    if (mapped == nullptr) {
+      gl_functions_->glBindBuffer_(GL_PIXEL_UNPACK_BUFFER, 0);
+      gl_functions_->glDeleteBuffers_(1, &pixel_buffer);
+      GL_CHECKERR(start_token, "glMapBufferRange");
+      CheckCommandErrors(start_token);
+      return false;
+    }
+    copy_data(mapped);
+    GL_SAFECALL(start_token, glUnmapBuffer, GL_PIXEL_UNPACK_BUFFER);
+    GL_SAFECALL(start_token, glTexImage2D, GL_TEXTURE_2D, 0, internal_format,
+                static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0,
+                format, type, nullptr);
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_UNPACK_BUFFER, 0);
+    GL_SAFECALL(start_token, glDeleteBuffers, 1, &pixel_buffer);
+  } else {
+    std::vector<std::uint8_t> flipped;
+    if (flip_rows) {
+      flipped.resize(size_bytes);
+      copy_data(flipped.data());
+      source = flipped.data();
+    }
+    GL_SAFECALL(start_token, glTexImage2D, GL_TEXTURE_2D, 0, internal_format,
+                static_cast<GLsizei>(width), static_cast<GLsizei>(height), 0,
+                format, type, source);
+  }
+  GL_SAFECALL(start_token, glPixelStorei, GL_UNPACK_ALIGNMENT, 4);
+  if (create_texture_2d->GetGenerateMipmaps()) {
+    GL_SAFECALL(start_token, glGenerateMipmap, GL_TEXTURE_2D);
+  }
+  if (!InvalidateFramebuffers(start_token,
+                              create_texture_2d->GetResultIdentifier())) {
+    return false;
+  }
+  created_textures_.insert({create_texture_2d->GetResultIdentifier(), texture});
+  return CheckCommandErrors(start_token);
 }
 
 bool Executor::VisitDeclareShader(CommandDeclareShader* declare_shader) {
@@ -547,187 +2055,190 @@ bool Executor::VisitDeclareShader(CommandDeclareShader* declare_shader) {
 
 bool Executor::VisitDumpRenderbuffer(
     CommandDumpRenderbuffer* dump_renderbuffer) {
-  GLuint framebuffer_object_id;
-  GL_SAFECALL(&dump_renderbuffer->GetStartToken(), glGenFramebuffers, 1,
-              &framebuffer_object_id);
-  GL_SAFECALL(&dump_renderbuffer->GetStartToken(), glBindFramebuffer,
-              GL_FRAMEBUFFER, framebuffer_object_id);
-  GL_SAFECALL(&dump_renderbuffer->GetStartToken(), glFramebufferRenderbuffer,
-              GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
-              created_renderbuffers_.at(
-                  dump_renderbuffer->GetRenderbufferIdentifier()));
-  size_t width;
-  size_t height;
-  {
-    GLint temp_width;
-    GL_SAFECALL(&dump_renderbuffer->GetStartToken(),
-                glGetRenderbufferParameteriv, GL_RENDERBUFFER,
-                GL_RENDERBUFFER_WIDTH, &temp_width);
-    GLint temp_height;
-    GL_SAFECALL(&dump_renderbuffer->GetStartToken(),
-                glGetRenderbufferParameteriv, GL_RENDERBUFFER,
-                GL_RENDERBUFFER_HEIGHT, &temp_height);
-    width = static_cast<size_t>(temp_width);
-    height = static_cast<size_t>(temp_height);
-  }
-
-  GLenum status = gl_functions_->glCheckFramebufferStatus_(GL_FRAMEBUFFER);
-  if (status != GL_FRAMEBUFFER_COMPLETE) {
-    message_consumer_->Message(
-        MessageConsumer::Severity::kError, &dump_renderbuffer->GetStartToken(),
-        "Incomplete framebuffer found for 'DUMP_RENDERBUFFER' command; "
-        "glCheckFramebufferStatus returned status " +
-            std::to_string(status));
-    return false;
-  }
-
-  std::vector<std::uint8_t> data(width * height * kNumRgbaChannels);
-  GL_SAFECALL(&dump_renderbuffer->GetStartToken(), glReadBuffer,
-              GL_COLOR_ATTACHMENT0);
-  GL_SAFECALL(&dump_renderbuffer->GetStartToken(), glReadPixels, 0, 0,
-              static_cast<GLint>(width), static_cast<GLint>(height), GL_RGBA,
-              GL_UNSIGNED_BYTE, data.data());
-  std::vector<std::uint8_t> flipped_data(width * height * kNumRgbaChannels);
-  for (size_t h = 0; h < height; h++) {
-    for (size_t col = 0; col < width * kNumRgbaChannels; col++) {
-      flipped_data[h * width * kNumRgbaChannels + col] =
-          data[(height - h - 1) * width * kNumRgbaChannels + col];
-    }
+  if (ImageRowEncoder::SupportsFormat(dump_renderbuffer->GetFormat())) {
+    return StreamRenderbufferImage(dump_renderbuffer);
   }
-#ifdef SHADERTRAP_LODEPNG
-  unsigned png_error = lodepng::encode(
-      dump_renderbuffer->GetFilename(), flipped_data,
-      static_cast<unsigned int>(width), static_cast<unsigned int>(height));
-  if (png_error != 0) {
-    message_consumer_->Message(
-        MessageConsumer::Severity::kError, &dump_renderbuffer->GetStartToken(),
-        "Writing PNG data to '" + dump_renderbuffer->GetFilename() +
-            "' failed");
+  size_t width;
+  size_t height;
+  std::vector<std::uint8_t> data;
+  if (!ReadRenderbuffer(&dump_renderbuffer->GetStartToken(),
+                        "DUMP_RENDERBUFFER",
+                        dump_renderbuffer->GetRenderbufferIdentifier(), &width,
+                        &height, &data)) {
+    return false;
   }
-  GL_SAFECALL(&dump_renderbuffer->GetStartToken(), glDeleteFramebuffers, 1,
-              &framebuffer_object_id);
-#endif
-  return true;
+  image_writer_.Write(&dump_renderbuffer->GetStartToken(),
+                      dump_renderbuffer->GetFilename(),
+                      dump_renderbuffer->GetFormat(),
+                      dump_renderbuffer->GetCompressionLevel(), width, height,
+                      std::move(data));
+  return CheckCommandErrors(&dump_renderbuffer->GetStartToken());
 }
 
 bool Executor::VisitDumpBufferBinary(
     CommandDumpBufferBinary* dump_buffer_binary) {
-  GLuint buffer =
+  const BufferRange& range =
       created_buffers_.at(dump_buffer_binary->GetBufferIdentifier());
-  GLint64 buffer_size;
   GL_SAFECALL(&dump_buffer_binary->GetStartToken(), glBindBuffer,
-              GL_ARRAY_BUFFER, buffer);
-  GL_SAFECALL(&dump_buffer_binary->GetStartToken(), glGetBufferParameteri64v,
-              GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &buffer_size);
+              GL_ARRAY_BUFFER, range.buffer);
   const auto* mapped_buffer =
       static_cast<char*>(gl_functions_->glMapBufferRange_(
-          GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(buffer_size),
-          GL_MAP_READ_BIT));
+          GL_ARRAY_BUFFER, static_cast<GLintptr>(range.offset_bytes),
+          static_cast<GLsizeiptr>(range.size_bytes), GL_MAP_READ_BIT));
   if (mapped_buffer == nullptr) {
     GL_CHECKERR(&dump_buffer_binary->GetStartToken(), "glMapBufferRange");
+    CheckCommandErrors(&dump_buffer_binary->GetStartToken());
     return false;
   }
-  std::ofstream binary_file(dump_buffer_binary->GetFilename(),
-                            std::ios::out | std::ios::binary);
-  binary_file.write(mapped_buffer, buffer_size);
+  // The sink receives the mapped buffer itself, so that it is not copied on
+  // the way to a file or stream. A compressed buffer is compressed a chunk at
+  // a time straight from the mapping, and each compressed chunk is passed to
+  // the sink in turn, so that the compressed data is not held in host memory
+  // whole either.
+  const auto* data = reinterpret_cast<const uint8_t*>(mapped_buffer);
+  bool written = false;
+  // A failure to compress the data is reported instead of a failure to write
+  // it.
+  bool compression_failed = false;
+  if (dump_buffer_binary->GetCompressed()) {
+    std::string error;
+    bool appended = true;
+    written = output_sink_->Begin(dump_buffer_binary->GetFilename(),
+                                  OutputSink::Kind::kBinary);
+    if (written &&
+        !CompressBuffer(
+            data, range.size_bytes, kCompressedBufferChunkSizeBytes,
+            [this, &appended](const uint8_t* piece, size_t size) -> bool {
+              appended = output_sink_->Append(piece, size);
+              return appended;
+            },
+            &error)) {
+      written = false;
+      compression_failed = appended;
+      if (compression_failed) {
+        message_consumer_->Message(MessageConsumer::Severity::kError,
+                                   &dump_buffer_binary->GetStartToken(),
+                                   "Compressing binary data for '" +
+                                       dump_buffer_binary->GetFilename() +
+                                       "' failed: " + error);
+      }
+    }
+    written = output_sink_->End() && written;
+  } else {
+    written = output_sink_->Write(dump_buffer_binary->GetFilename(),
+                                  OutputSink::Kind::kBinary, data,
+                                  range.size_bytes);
+  }
+  if (!written && !compression_failed) {
+    message_consumer_->Message(MessageConsumer::Severity::kError,
+                               &dump_buffer_binary->GetStartToken(),
+                               "Writing binary data to '" +
+                                   dump_buffer_binary->GetFilename() +
+                                   "' failed");
+  }
   GL_SAFECALL(&dump_buffer_binary->GetStartToken(), glUnmapBuffer,
               GL_ARRAY_BUFFER);
-  return true;
+  return CheckCommandErrors(&dump_buffer_binary->GetStartToken()) && written;
 }
 
 bool Executor::VisitDumpBufferText(CommandDumpBufferText* dump_buffer_text) {
-  GLuint buffer = created_buffers_.at(dump_buffer_text->GetBufferIdentifier());
-  GLint64 buffer_size;
+  const BufferRange& range =
+      created_buffers_.at(dump_buffer_text->GetBufferIdentifier());
   GL_SAFECALL(&dump_buffer_text->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
-              buffer);
-  GL_SAFECALL(&dump_buffer_text->GetStartToken(), glGetBufferParameteri64v,
-              GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &buffer_size);
+              range.buffer);
   const auto* mapped_buffer =
       static_cast<char*>(gl_functions_->glMapBufferRange_(
-          GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(buffer_size),
-          GL_MAP_READ_BIT));
+          GL_ARRAY_BUFFER, static_cast<GLintptr>(range.offset_bytes),
+          static_cast<GLsizeiptr>(range.size_bytes), GL_MAP_READ_BIT));
   if (mapped_buffer == nullptr) {
     GL_CHECKERR(&dump_buffer_text->GetStartToken(), "glMapBufferRange");
+    CheckCommandErrors(&dump_buffer_text->GetStartToken());
     return false;
   }
-  std::ofstream text_file(dump_buffer_text->GetFilename(), std::ios::out);
-  size_t index = 0;
-  for (const auto& format_entry : dump_buffer_text->GetFormatEntries()) {
-    switch (format_entry.kind) {
-      case CommandDumpBufferText::FormatEntry::Kind::kSkip:
-        index += format_entry.count;
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kString:
-        text_file << format_entry.token->GetText();
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kByte:
-        DumpFormatEntry<uint8_t>(mapped_buffer, format_entry, &text_file,
-                                 &index);
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kInt:
-        DumpFormatEntry<int32_t>(mapped_buffer, format_entry, &text_file,
-                                 &index);
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kUint:
-        DumpFormatEntry<uint32_t>(mapped_buffer, format_entry, &text_file,
-                                  &index);
-        break;
-      case CommandDumpBufferText::FormatEntry::Kind::kFloat:
-        DumpFormatEntry<float>(mapped_buffer, format_entry, &text_file, &index);
-        break;
-    }
+  // The text is passed to the sink a chunk at a time as it is formatted, so
+  // that it is never held in host memory whole.
+  bool written = output_sink_->Begin(dump_buffer_text->GetFilename(),
+                                     OutputSink::Kind::kText);
+  if (written) {
+    written = WriteBufferText(
+        reinterpret_cast<const uint8_t*>(mapped_buffer),
+        dump_buffer_text->GetFormatEntries(),
+        [this](const char* text, size_t size) -> bool {
+          return output_sink_->Append(reinterpret_cast<const uint8_t*>(text),
+                                      size);
+        });
+  }
+  written = output_sink_->End() && written;
+  if (!written) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, &dump_buffer_text->GetStartToken(),
+        "Writing text to '" + dump_buffer_text->GetFilename() + "' failed");
   }
   GL_SAFECALL(&dump_buffer_text->GetStartToken(), glUnmapBuffer,
               GL_ARRAY_BUFFER);
-  return true;
+  return CheckCommandErrors(&dump_buffer_text->GetStartToken()) && written;
 }
 
 bool Executor::VisitRunCompute(CommandRunCompute* run_compute) {
   GL_SAFECALL(&run_compute->GetStartToken(), glUseProgram,
               created_programs_.at(run_compute->GetProgramIdentifier()));
 
-  GL_SAFECALL(&run_compute->GetStartToken(), glDispatchCompute,
-              static_cast<GLuint>(run_compute->GetNumGroupsX()),
-              static_cast<GLuint>(run_compute->GetNumGroupsY()),
-              static_cast<GLuint>(run_compute->GetNumGroupsZ()));
+  bool first_dispatch = true;
+  for (const auto& num_groups : run_compute->GetNumGroups()) {
+    if (!first_dispatch && !IssueBarrierBetweenDispatches(run_compute)) {
+      return false;
+    }
+    first_dispatch = false;
+    GL_SAFECALL(&run_compute->GetStartToken(), glDispatchCompute,
+                static_cast<GLuint>(num_groups.x),
+                static_cast<GLuint>(num_groups.y),
+                static_cast<GLuint>(num_groups.z));
+  }
 
-  GL_SAFECALL_NO_ARGS(&run_compute->GetStartToken(), glFlush);
+  if (!IssueBarrierAfterDispatches(run_compute)) {
+    return false;
+  }
+  return CheckCommandErrors(&run_compute->GetStartToken());
+}
 
-  // Issue a memory barrier to ensure that future commands will see the effects
-  // of this compute operation.
-  GL_SAFECALL(&run_compute->GetStartToken(), glMemoryBarrier,
-              GL_ALL_BARRIER_BITS);
+bool Executor::VisitRunComputeIndirect(
+    CommandRunComputeIndirect* run_compute_indirect) {
+  GL_SAFECALL(
+      &run_compute_indirect->GetStartToken(), glUseProgram,
+      created_programs_.at(run_compute_indirect->GetProgramIdentifier()));
+  const BufferRange& indirect_range =
+      created_buffers_.at(run_compute_indirect->GetBufferIdentifier());
+  GL_SAFECALL(&run_compute_indirect->GetStartToken(), glBindBuffer,
+              GL_DISPATCH_INDIRECT_BUFFER, indirect_range.buffer);
+
+  bool first_dispatch = true;
+  for (size_t offset : run_compute_indirect->GetOffsetsBytes()) {
+    if (!first_dispatch &&
+        !IssueBarrierBetweenDispatches(run_compute_indirect)) {
+      return false;
+    }
+    first_dispatch = false;
+    GL_SAFECALL(&run_compute_indirect->GetStartToken(),
+                glDispatchComputeIndirect,
+                static_cast<GLintptr>(indirect_range.offset_bytes + offset));
+  }
+  GL_SAFECALL(&run_compute_indirect->GetStartToken(), glBindBuffer,
+              GL_DISPATCH_INDIRECT_BUFFER, 0);
 
-  return true;
+  if (!IssueBarrierAfterDispatches(run_compute_indirect)) {
+    return false;
+  }
+  return CheckCommandErrors(&run_compute_indirect->GetStartToken());
 }
 
 bool Executor::VisitRunGraphics(CommandRunGraphics* run_graphics) {
-  GLuint vao;
-  GL_SAFECALL(&run_graphics->GetStartToken(), glGenVertexArrays, 1, &vao);
-  GL_SAFECALL(&run_graphics->GetStartToken(), glBindVertexArray, vao);
-
-  const auto& vertex_data = run_graphics->GetVertexData();
-  for (const auto& entry : vertex_data) {
-    GL_SAFECALL(&run_graphics->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
-                created_buffers_.at(entry.second.GetBufferIdentifier()));
-    GL_SAFECALL(&run_graphics->GetStartToken(), glEnableVertexAttribArray,
-                static_cast<GLuint>(entry.first));
-    GL_SAFECALL(&run_graphics->GetStartToken(), glVertexAttribPointer,
-                static_cast<GLuint>(entry.first),
-                static_cast<GLsizei>(entry.second.GetDimension()), GL_FLOAT,
-                GL_FALSE, static_cast<GLsizei>(entry.second.GetStrideBytes()),
-                reinterpret_cast<void*>(entry.second.GetOffsetBytes()));
+  if (!BindVertexArray(run_graphics)) {
+    return false;
   }
 
   GL_SAFECALL(&run_graphics->GetStartToken(), glUseProgram,
               created_programs_.at(run_graphics->GetProgramIdentifier()));
 
-  GLuint framebuffer_object_id;
-  GL_SAFECALL(&run_graphics->GetStartToken(), glGenFramebuffers, 1,
-              &framebuffer_object_id);
-  GL_SAFECALL(&run_graphics->GetStartToken(), glBindFramebuffer, GL_FRAMEBUFFER,
-              framebuffer_object_id);
-
   const auto& framebuffer_attachments =
       run_graphics->GetFramebufferAttachments();
   assert(framebuffer_attachments.size() <= 32 && "Too many renderbuffers.");
@@ -735,73 +2246,157 @@ bool Executor::VisitRunGraphics(CommandRunGraphics* run_graphics) {
   for (const auto& entry : framebuffer_attachments) {
     max_location = std::max(max_location, entry.first);
   }
-  std::vector<GLenum> draw_buffers;
-  for (size_t i = 0; i <= max_location; i++) {
-    if (framebuffer_attachments.count(i) > 0) {
-      GLenum color_attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
-      auto framebuffer_attachment = framebuffer_attachments.at(i)->GetText();
-      if (created_renderbuffers_.count(framebuffer_attachment) != 0) {
-        GL_SAFECALL(&run_graphics->GetStartToken(), glFramebufferRenderbuffer,
-                    GL_FRAMEBUFFER, color_attachment, GL_RENDERBUFFER,
-                    created_renderbuffers_.at(framebuffer_attachment));
-      } else {
-        GL_SAFECALL(&run_graphics->GetStartToken(), glFramebufferTexture2D,
-                    GL_FRAMEBUFFER, color_attachment, GL_TEXTURE_2D,
-                    created_textures_.at(framebuffer_attachment), 0);
-      }
-      draw_buffers.push_back(color_attachment);
-    } else {
-      draw_buffers.push_back(GL_NONE);
-    }
+  std::vector<std::string> attachments(max_location + 1);
+  for (const auto& entry : framebuffer_attachments) {
+    attachments[entry.first] = entry.second->GetText();
   }
-
-  GLenum status = gl_functions_->glCheckFramebufferStatus_(GL_FRAMEBUFFER);
-  if (status != GL_FRAMEBUFFER_COMPLETE) {
-    message_consumer_->Message(
-        MessageConsumer::Severity::kError, &run_graphics->GetStartToken(),
-        "Incomplete framebuffer found for 'RUN_GRAPHICS' comment; "
-        "glCheckFramebufferStatus returned status " +
-            std::to_string(status));
+  if (!BindFramebuffer(&run_graphics->GetStartToken(), "RUN_GRAPHICS",
+                       attachments)) {
     return false;
   }
 
-  if (api_version_ != ApiVersion(ApiVersion::Api::GLES, 2, 0)) {
-    // glDrawBuffers is not available in OpenGL ES 2.0, but for this API version
-    // only color attachment 0 may be used, and the checker enforces this. Thus
-    // this call can be skipped.
-    GL_SAFECALL(&run_graphics->GetStartToken(), glDrawBuffers,
-                static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
-  }
-
   GL_SAFECALL(&run_graphics->GetStartToken(), glClearColor, 0.0F, 0.0F, 0.0F,
               1.0F);
   GL_SAFECALL(&run_graphics->GetStartToken(), glClear, GL_COLOR_BUFFER_BIT);
 
-  GL_SAFECALL(
-      &run_graphics->GetStartToken(), glBindBuffer, GL_ELEMENT_ARRAY_BUFFER,
-      created_buffers_.at(run_graphics->GetIndexDataBufferIdentifier()));
   GLenum topology = GL_NONE;
   switch (run_graphics->GetTopology()) {
     case CommandRunGraphics::Topology::kTriangles:
       topology = GL_TRIANGLES;
       break;
   }
-  GL_SAFECALL(&run_graphics->GetStartToken(), glDrawElements, topology,
-              static_cast<GLsizei>(run_graphics->GetVertexCount()),
-              GL_UNSIGNED_INT, reinterpret_cast<GLvoid*>(0));
+  GLenum index_type = GL_UNSIGNED_INT;
+  switch (run_graphics->GetIndexSizeBytes()) {
+    case 1:
+      index_type = GL_UNSIGNED_BYTE;
+      break;
+    case 2:
+      index_type = GL_UNSIGNED_SHORT;
+      break;
+    default:
+      assert(run_graphics->GetIndexSizeBytes() == 4 && "Bad index size.");
+      break;
+  }
+  if (run_graphics->HasIndirectData()) {
+    // Multi-draw indirect entry points are not available in all of the
+    // supported API versions, so one indirect draw is issued per offset.
+    const BufferRange& indirect_range =
+        created_buffers_.at(run_graphics->GetIndirectDataBufferIdentifier());
+    GL_SAFECALL(&run_graphics->GetStartToken(), glBindBuffer,
+                GL_DRAW_INDIRECT_BUFFER, indirect_range.buffer);
+    for (size_t offset : run_graphics->GetIndirectOffsetsBytes()) {
+      const auto* indirect =
+          reinterpret_cast<const void*>(indirect_range.offset_bytes + offset);
+      if (run_graphics->HasIndexData()) {
+        GL_SAFECALL(&run_graphics->GetStartToken(), glDrawElementsIndirect,
+                    topology, index_type, indirect);
+      } else {
+        GL_SAFECALL(&run_graphics->GetStartToken(), glDrawArraysIndirect,
+                    topology, indirect);
+      }
+    }
+    GL_SAFECALL(&run_graphics->GetStartToken(), glBindBuffer,
+                GL_DRAW_INDIRECT_BUFFER, 0);
+  } else {
+    const auto vertex_count =
+        static_cast<GLsizei>(run_graphics->GetVertexCount());
+    const auto instance_count =
+        static_cast<GLsizei>(run_graphics->GetInstanceCount());
+    // The non-instanced entry points are used where possible, as they are
+    // available in every supported API version.
+    // The indices start at the offset of the index buffer within its buffer
+    // object, which is nonzero if buffers are pooled.
+    const auto* indices = reinterpret_cast<GLvoid*>(
+        run_graphics->HasIndexData()
+            ? created_buffers_.at(run_graphics->GetIndexDataBufferIdentifier())
+                  .offset_bytes
+            : 0);
+    if (run_graphics->HasIndexData() && instance_count == 1) {
+      GL_SAFECALL(&run_graphics->GetStartToken(), glDrawElements, topology,
+                  vertex_count, index_type, indices);
+    } else if (run_graphics->HasIndexData()) {
+      GL_SAFECALL(&run_graphics->GetStartToken(), glDrawElementsInstanced,
+                  topology, vertex_count, index_type, indices, instance_count);
+    } else if (instance_count == 1) {
+      GL_SAFECALL(&run_graphics->GetStartToken(), glDrawArrays, topology, 0,
+                  vertex_count);
+    } else {
+      GL_SAFECALL(&run_graphics->GetStartToken(), glDrawArraysInstanced,
+                  topology, 0, vertex_count, instance_count);
+    }
+  }
+
+  // The element array buffer binding is part of the vertex array object's
+  // state, so the cached object is unbound to protect it from later changes.
+  GL_SAFECALL(&run_graphics->GetStartToken(), glBindVertexArray, 0);
+
+  if (memory_barriers_planned_ && !IssuePlannedMemoryBarrier(run_graphics)) {
+    return false;
+  }
+
+  // Readbacks of the renderbuffers that were rendered to are now stale. Where
+  // PlanRenderbufferReadbacks found that a renderbuffer will be read back
+  // before it is next rendered to, a readback of its new contents is started
+  // now, so that it proceeds while subsequent commands are issued; otherwise
+  // the pixel buffer object holding the stale readback is released, and a
+  // command that needs the contents reads them when it runs.
+  auto planned_readbacks = planned_renderbuffer_readbacks_.find(run_graphics);
+  for (const auto& entry : framebuffer_attachments) {
+    const std::string& identifier = entry.second->GetText();
+    pixel_readbacks_.erase(identifier);
+    if (planned_readbacks == planned_renderbuffer_readbacks_.end() ||
+        planned_readbacks->second.count(identifier) == 0) {
+      if (!ReleaseRenderbufferReadback(&run_graphics->GetStartToken(),
+                                       identifier)) {
+        return false;
+      }
+      continue;
+    }
+    auto readback = renderbuffer_readbacks_.find(identifier);
+    if (readback != renderbuffer_readbacks_.end()) {
+      readback->second.up_to_date = false;
+    }
+    if (!StartRenderbufferReadback(&run_graphics->GetStartToken(),
+                                   "RUN_GRAPHICS", identifier)) {
+      return false;
+    }
+  }
 
   GL_SAFECALL_NO_ARGS(&run_graphics->GetStartToken(), glFlush);
+  return CheckCommandErrors(&run_graphics->GetStartToken());
+}
 
-  for (const auto& entry : run_graphics->GetVertexData()) {
-    GL_SAFECALL(&run_graphics->GetStartToken(), glDisableVertexAttribArray,
-                static_cast<GLuint>(entry.first));
+bool Executor::IssueBarrierBetweenDispatches(Command* command) {
+  GLbitfield bits = GL_ALL_BARRIER_BITS;
+  if (memory_barriers_planned_) {
+    auto planned_barrier = planned_barriers_between_dispatches_.find(command);
+    if (planned_barrier == planned_barriers_between_dispatches_.end()) {
+      return true;
+    }
+    bits = planned_barrier->second;
   }
+  GL_SAFECALL(&command->GetStartToken(), glMemoryBarrier, bits);
+  return true;
+}
 
-  GL_SAFECALL(&run_graphics->GetStartToken(), glBindVertexArray, 0);
-  GL_SAFECALL(&run_graphics->GetStartToken(), glDeleteVertexArrays, 1, &vao);
+bool Executor::IssueBarrierAfterDispatches(Command* command) {
+  if (memory_barriers_planned_) {
+    return IssuePlannedMemoryBarrier(command);
+  }
+  GL_SAFECALL_NO_ARGS(&command->GetStartToken(), glFlush);
+
+  // Issue a memory barrier to ensure that future commands will see the effects
+  // of this compute operation.
+  GL_SAFECALL(&command->GetStartToken(), glMemoryBarrier, GL_ALL_BARRIER_BITS);
+  return true;
+}
 
-  GL_SAFECALL(&run_graphics->GetStartToken(), glDeleteFramebuffers, 1,
-              &framebuffer_object_id);
+bool Executor::IssuePlannedMemoryBarrier(Command* command) {
+  auto planned_barrier = planned_memory_barriers_.find(command);
+  if (planned_barrier != planned_memory_barriers_.end()) {
+    GL_SAFECALL(&command->GetStartToken(), glMemoryBarrier,
+                planned_barrier->second);
+  }
   return true;
 }
 
@@ -832,7 +2427,7 @@ bool Executor::VisitSetSamplerParameter(
       &set_sampler_parameter->GetStartToken(), glSamplerParameteri,
       created_samplers_.at(set_sampler_parameter->GetSamplerIdentifier()),
       parameter, parameter_value);
-  return true;
+  return CheckCommandErrors(&set_sampler_parameter->GetStartToken());
 }
 
 bool Executor::VisitSetTextureParameter(
@@ -863,7 +2458,7 @@ bool Executor::VisitSetTextureParameter(
       created_textures_.at(set_texture_parameter->GetTextureIdentifier()));
   GL_SAFECALL(&set_texture_parameter->GetStartToken(), glTexParameteri,
               GL_TEXTURE_2D, parameter, parameter_value);
-  return true;
+  return CheckCommandErrors(&set_texture_parameter->GetStartToken());
 }
 
 bool Executor::VisitSetUniform(CommandSetUniform* set_uniform) {
@@ -1009,38 +2604,999 @@ bool Executor::VisitSetUniform(CommandSetUniform* set_uniform) {
                     uniform_location, uniform_value.GetUintData()[0],
                     uniform_value.GetUintData()[1]);
       }
-      break;
-    case UniformValue::ElementType::kUvec3:
-      if (uniform_value.IsArray()) {
-        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform3uiv,
-                    program, uniform_location,
-                    static_cast<GLsizei>(uniform_value.GetArraySize()),
-                    uniform_value.GetUintData());
-      } else {
-        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform3ui, program,
-                    uniform_location, uniform_value.GetUintData()[0],
-                    uniform_value.GetUintData()[1],
-                    uniform_value.GetUintData()[2]);
+      break;
+    case UniformValue::ElementType::kUvec3:
+      if (uniform_value.IsArray()) {
+        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform3uiv,
+                    program, uniform_location,
+                    static_cast<GLsizei>(uniform_value.GetArraySize()),
+                    uniform_value.GetUintData());
+      } else {
+        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform3ui, program,
+                    uniform_location, uniform_value.GetUintData()[0],
+                    uniform_value.GetUintData()[1],
+                    uniform_value.GetUintData()[2]);
+      }
+      break;
+    case UniformValue::ElementType::kUvec4:
+      if (uniform_value.IsArray()) {
+        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform4uiv,
+                    program, uniform_location,
+                    static_cast<GLsizei>(uniform_value.GetArraySize()),
+                    uniform_value.GetUintData());
+      } else {
+        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform4ui, program,
+                    uniform_location, uniform_value.GetUintData()[0],
+                    uniform_value.GetUintData()[1],
+                    uniform_value.GetUintData()[2],
+                    uniform_value.GetUintData()[3]);
+      }
+      break;
+    default:
+      assert(false && "Unhandled uniform type.");
+      break;
+  }
+  return CheckCommandErrors(&set_uniform->GetStartToken());
+}
+
+bool Executor::VisitUpdateBuffer(CommandUpdateBuffer* update_buffer) {
+  // The buffer is updated in place, so that objects referring to it, such as
+  // cached vertex array objects and buffer bindings, remain valid.
+  const BufferRange& range =
+      created_buffers_.at(update_buffer->GetBufferIdentifier());
+  GL_SAFECALL(&update_buffer->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
+              range.buffer);
+  GL_SAFECALL(&update_buffer->GetStartToken(), glBufferSubData,
+              GL_ARRAY_BUFFER,
+              static_cast<GLintptr>(range.offset_bytes +
+                                    update_buffer->GetOffsetBytes()),
+              static_cast<GLsizeiptr>(update_buffer->GetSizeBytes()),
+              update_buffer->GetData().data());
+  return CheckCommandErrors(&update_buffer->GetStartToken());
+}
+
+bool Executor::BindFramebuffer(const Token* start_token,
+                               const std::string& command_name,
+                               const std::vector<std::string>& attachments) {
+  auto cached = framebuffer_cache_.find(attachments);
+  if (cached != framebuffer_cache_.end()) {
+    GL_SAFECALL(start_token, glBindFramebuffer, GL_FRAMEBUFFER, cached->second);
+    return true;
+  }
+
+  GLuint framebuffer_object_id;
+  GL_SAFECALL(start_token, glGenFramebuffers, 1, &framebuffer_object_id);
+  GL_SAFECALL(start_token, glBindFramebuffer, GL_FRAMEBUFFER,
+              framebuffer_object_id);
+  std::vector<GLenum> draw_buffers;
+  for (size_t i = 0; i < attachments.size(); i++) {
+    if (attachments[i].empty()) {
+      draw_buffers.push_back(GL_NONE);
+      continue;
+    }
+    GLenum color_attachment = GL_COLOR_ATTACHMENT0 + static_cast<GLenum>(i);
+    if (created_renderbuffers_.count(attachments[i]) != 0) {
+      GL_SAFECALL(start_token, glFramebufferRenderbuffer, GL_FRAMEBUFFER,
+                  color_attachment, GL_RENDERBUFFER,
+                  created_renderbuffers_.at(attachments[i]));
+    } else {
+      GL_SAFECALL(start_token, glFramebufferTexture2D, GL_FRAMEBUFFER,
+                  color_attachment, GL_TEXTURE_2D,
+                  created_textures_.at(attachments[i]), 0);
+    }
+    draw_buffers.push_back(color_attachment);
+  }
+
+  GLenum status = gl_functions_->glCheckFramebufferStatus_(GL_FRAMEBUFFER);
+  if (status != GL_FRAMEBUFFER_COMPLETE) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, start_token,
+        "Incomplete framebuffer found for '" + command_name +
+            "' command; glCheckFramebufferStatus returned status " +
+            std::to_string(status));
+    GL_SAFECALL(start_token, glDeleteFramebuffers, 1, &framebuffer_object_id);
+    return false;
+  }
+
+  if (api_version_ != ApiVersion(ApiVersion::Api::GLES, 2, 0)) {
+    // The draw buffers are part of the framebuffer object's state, so they are
+    // set once, when the framebuffer object is created. glDrawBuffers is not
+    // available in OpenGL ES 2.0, but for this API version only color
+    // attachment 0 may be used, and the checker enforces this. Thus this call
+    // can be skipped.
+    GL_SAFECALL(start_token, glDrawBuffers,
+                static_cast<GLsizei>(draw_buffers.size()), draw_buffers.data());
+  }
+
+  framebuffer_cache_.insert({attachments, framebuffer_object_id});
+  return true;
+}
+
+bool Executor::InvalidateFramebuffers(const Token* start_token,
+                                      const std::string& identifier) {
+  for (auto it = framebuffer_cache_.begin(); it != framebuffer_cache_.end();) {
+    if (std::find(it->first.begin(), it->first.end(), identifier) ==
+        it->first.end()) {
+      ++it;
+      continue;
+    }
+    GL_SAFECALL(start_token, glDeleteFramebuffers, 1, &it->second);
+    it = framebuffer_cache_.erase(it);
+  }
+  return true;
+}
+
+bool Executor::BindVertexArray(CommandRunGraphics* run_graphics) {
+  VertexArrayKey key;
+  if (run_graphics->HasIndexData()) {
+    key.index_buffer = run_graphics->GetIndexDataBufferIdentifier();
+  }
+  for (const auto& entry : run_graphics->GetVertexData()) {
+    key.attributes.emplace_back(
+        entry.first, entry.second.GetBufferIdentifier(),
+        entry.second.GetOffsetBytes(), entry.second.GetStrideBytes(),
+        entry.second.GetDimension(), entry.second.GetDivisor());
+  }
+  std::sort(key.attributes.begin(), key.attributes.end());
+
+  auto cached = vertex_array_cache_.find(key);
+  if (cached != vertex_array_cache_.end()) {
+    GL_SAFECALL(&run_graphics->GetStartToken(), glBindVertexArray,
+                cached->second);
+    return true;
+  }
+
+  GLuint vao;
+  GL_SAFECALL(&run_graphics->GetStartToken(), glGenVertexArrays, 1, &vao);
+  GL_SAFECALL(&run_graphics->GetStartToken(), glBindVertexArray, vao);
+  for (const auto& entry : run_graphics->GetVertexData()) {
+    const BufferRange& range =
+        created_buffers_.at(entry.second.GetBufferIdentifier());
+    GL_SAFECALL(&run_graphics->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
+                range.buffer);
+    GL_SAFECALL(&run_graphics->GetStartToken(), glEnableVertexAttribArray,
+                static_cast<GLuint>(entry.first));
+    GL_SAFECALL(&run_graphics->GetStartToken(), glVertexAttribPointer,
+                static_cast<GLuint>(entry.first),
+                static_cast<GLsizei>(entry.second.GetDimension()), GL_FLOAT,
+                GL_FALSE, static_cast<GLsizei>(entry.second.GetStrideBytes()),
+                reinterpret_cast<void*>(range.offset_bytes +
+                                        entry.second.GetOffsetBytes()));
+    if (entry.second.GetDivisor() != 0) {
+      GL_SAFECALL(&run_graphics->GetStartToken(), glVertexAttribDivisor,
+                  static_cast<GLuint>(entry.first),
+                  static_cast<GLuint>(entry.second.GetDivisor()));
+    }
+  }
+  if (run_graphics->HasIndexData()) {
+    GL_SAFECALL(
+        &run_graphics->GetStartToken(), glBindBuffer, GL_ELEMENT_ARRAY_BUFFER,
+        created_buffers_.at(run_graphics->GetIndexDataBufferIdentifier())
+            .buffer);
+  }
+  vertex_array_cache_.insert({key, vao});
+  return true;
+}
+
+bool Executor::InvalidateVertexArrays(const Token* start_token,
+                                      const std::string& identifier) {
+  for (auto it = vertex_array_cache_.begin();
+       it != vertex_array_cache_.end();) {
+    bool uses_identifier = it->first.index_buffer == identifier;
+    for (const auto& attribute : it->first.attributes) {
+      if (std::get<1>(attribute) == identifier) {
+        uses_identifier = true;
+      }
+    }
+    if (!uses_identifier) {
+      ++it;
+      continue;
+    }
+    GL_SAFECALL(start_token, glDeleteVertexArrays, 1, &it->second);
+    it = vertex_array_cache_.erase(it);
+  }
+  return true;
+}
+
+bool Executor::StartRenderbufferReadback(const Token* start_token,
+                                         const std::string& command_name,
+                                         const std::string& identifier) {
+  if (api_version_ == ApiVersion(ApiVersion::Api::GLES, 2, 0)) {
+    // Pixel buffer objects and fences are not available in OpenGL ES 2.0, so
+    // ReadRenderbuffer reads synchronously instead.
+    return true;
+  }
+  auto readback = renderbuffer_readbacks_.find(identifier);
+  if (readback == renderbuffer_readbacks_.end()) {
+    RenderbufferReadback new_readback{0, 0, 0, false, nullptr};
+    if (!GetRenderbufferSize(start_token, identifier, &new_readback.width,
+                             &new_readback.height)) {
+      return false;
+    }
+    if (new_readback.width * new_readback.height * kNumRgbaChannels >
+        kMaxFullReadbackSizeBytes) {
+      // ReadRenderbufferBands reads the renderbuffer a band at a time instead.
+      return true;
+    }
+    GL_SAFECALL(start_token, glGenBuffers, 1, &new_readback.pixel_buffer);
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER,
+                new_readback.pixel_buffer);
+    GL_SAFECALL(start_token, glBufferData, GL_PIXEL_PACK_BUFFER,
+                static_cast<GLsizeiptr>(new_readback.width *
+                                        new_readback.height *
+                                        kNumRgbaChannels),
+                nullptr, GL_STREAM_READ);
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
+    readback = renderbuffer_readbacks_.insert({identifier, new_readback}).first;
+  } else if (readback->second.up_to_date) {
+    return true;
+  }
+
+  if (!BindFramebuffer(start_token, command_name, {identifier})) {
+    return false;
+  }
+  GL_SAFECALL(start_token, glReadBuffer, GL_COLOR_ATTACHMENT0);
+  GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER,
+              readback->second.pixel_buffer);
+  GL_SAFECALL(start_token, glReadPixels, 0, 0,
+              static_cast<GLsizei>(readback->second.width),
+              static_cast<GLsizei>(readback->second.height), GL_RGBA,
+              GL_UNSIGNED_BYTE, nullptr);
+  GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
+  if (readback->second.fence != nullptr) {
+    // A previous read is still in flight; the new read supersedes it.
+    GL_SAFECALL(start_token, glDeleteSync, readback->second.fence);
+  }
+  readback->second.fence =
+      gl_functions_->glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  GL_CHECKERR(start_token, "glFenceSync");
+  readback->second.up_to_date = true;
+  return true;
+}
+
+bool Executor::ReleaseRenderbufferReadback(const Token* start_token,
+                                           const std::string& identifier) {
+  auto readback = renderbuffer_readbacks_.find(identifier);
+  if (readback == renderbuffer_readbacks_.end()) {
+    return true;
+  }
+  if (readback->second.fence != nullptr) {
+    GL_SAFECALL(start_token, glDeleteSync, readback->second.fence);
+  }
+  GL_SAFECALL(start_token, glDeleteBuffers, 1, &readback->second.pixel_buffer);
+  renderbuffer_readbacks_.erase(readback);
+  return true;
+}
+
+bool Executor::ReadRenderbufferBands(
+    const Token* start_token, const std::string& command_name,
+    const std::vector<std::string>& identifiers, size_t width, size_t height,
+    size_t first_row, const RenderbufferBandConsumer& consume_band) {
+  const size_t row_size_bytes = width * kNumRgbaChannels;
+  if (row_size_bytes == 0 || first_row >= height) {
+    return true;
+  }
+  const size_t rows_per_band =
+      std::max<size_t>(1, kReadbackBandSizeBytes / row_size_bytes);
+  const size_t num_read_rows = height - first_row;
+  const size_t num_bands = (num_read_rows + rows_per_band - 1) / rows_per_band;
+  // Bands are numbered from the top of the renderbuffers down; all are full
+  // apart from the last, which holds the bottom rows that are read.
+  auto band_num_rows = [num_read_rows, rows_per_band](size_t band) -> size_t {
+    return std::min(rows_per_band, num_read_rows - band * rows_per_band);
+  };
+  auto band_first_row = [height, rows_per_band,
+                         &band_num_rows](size_t band) -> size_t {
+    return height - band * rows_per_band - band_num_rows(band);
+  };
+  std::vector<const std::uint8_t*> bands(identifiers.size(), nullptr);
+
+  if (api_version_ == ApiVersion(ApiVersion::Api::GLES, 2, 0)) {
+    // Pixel buffer objects are not available in OpenGL ES 2.0, so each band is
+    // read synchronously. glReadBuffer is not supported either, but reads
+    // always occur from color attachment 0, which is what is needed.
+    std::vector<std::vector<std::uint8_t>> host_bands(identifiers.size());
+    for (size_t band = 0; band < num_bands; band++) {
+      for (size_t index = 0; index < identifiers.size(); index++) {
+        if (!BindFramebuffer(start_token, command_name,
+                             {identifiers[index]})) {
+          return false;
+        }
+        host_bands[index].resize(band_num_rows(band) * row_size_bytes);
+        GL_SAFECALL(start_token, glReadPixels, 0,
+                    static_cast<GLint>(band_first_row(band)),
+                    static_cast<GLsizei>(width),
+                    static_cast<GLsizei>(band_num_rows(band)), GL_RGBA,
+                    GL_UNSIGNED_BYTE, host_bands[index].data());
+        bands[index] = host_bands[index].data();
+      }
+      if (!consume_band(band_first_row(band), band_num_rows(band), bands)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  // Renderbuffers that are small enough are read back in full, and their bands
+  // are mapped from that readback; the others are read into band buffers.
+  std::vector<GLuint> full_readback_buffers(identifiers.size(), 0);
+  // A renderbuffer that is named more than once is only read once; each
+  // naming shares the band of the first.
+  std::vector<size_t> first_naming(identifiers.size());
+  for (size_t index = 0; index < identifiers.size(); index++) {
+    first_naming[index] = static_cast<size_t>(
+        std::find(identifiers.begin(), identifiers.end(), identifiers[index]) -
+        identifiers.begin());
+  }
+  bool reads_bands = false;
+  for (size_t index = 0; index < identifiers.size(); index++) {
+    if (!StartRenderbufferReadback(start_token, command_name,
+                                   identifiers[index])) {
+      return false;
+    }
+    auto readback = renderbuffer_readbacks_.find(identifiers[index]);
+    if (readback == renderbuffer_readbacks_.end()) {
+      reads_bands = true;
+    } else {
+      full_readback_buffers[index] = readback->second.pixel_buffer;
+    }
+  }
+  const size_t band_size_bytes = rows_per_band * row_size_bytes;
+  const size_t num_band_buffers = 2 * identifiers.size();
+  if (reads_bands && (band_pixel_buffers_.size() < num_band_buffers ||
+                      band_pixel_buffer_size_ < band_size_bytes)) {
+    const size_t num_existing_buffers = band_pixel_buffers_.size();
+    if (num_existing_buffers < num_band_buffers) {
+      band_pixel_buffers_.resize(num_band_buffers);
+      GL_SAFECALL(start_token, glGenBuffers,
+                  static_cast<GLsizei>(num_band_buffers - num_existing_buffers),
+                  &band_pixel_buffers_[num_existing_buffers]);
+    }
+    band_pixel_buffer_size_ =
+        std::max(band_pixel_buffer_size_, band_size_bytes);
+    for (GLuint buffer : band_pixel_buffers_) {
+      GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, buffer);
+      GL_SAFECALL(start_token, glBufferData, GL_PIXEL_PACK_BUFFER,
+                  static_cast<GLsizeiptr>(band_pixel_buffer_size_), nullptr,
+                  GL_STREAM_READ);
+    }
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
+  }
+
+  // Band buffer 2 * index + (band % 2) holds the band of renderbuffer |index|,
+  // and is guarded by the corresponding fence until the read into it is known
+  // to have completed.
+  std::vector<GLsync> band_fences(num_band_buffers, nullptr);
+  auto delete_band_fences = [this, &band_fences]() -> void {
+    for (GLsync& fence : band_fences) {
+      if (fence != nullptr) {
+        gl_functions_->glDeleteSync_(fence);
+        fence = nullptr;
+      }
+    }
+  };
+  auto read_band = [&](size_t band) -> bool {
+    for (size_t index = 0; index < identifiers.size(); index++) {
+      if (full_readback_buffers[index] != 0 || first_naming[index] != index) {
+        continue;
+      }
+      if (!BindFramebuffer(start_token, command_name, {identifiers[index]})) {
+        return false;
+      }
+      GL_SAFECALL(start_token, glReadBuffer, GL_COLOR_ATTACHMENT0);
+      GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER,
+                  band_pixel_buffers_[2 * index + band % 2]);
+      GL_SAFECALL(start_token, glReadPixels, 0,
+                  static_cast<GLint>(band_first_row(band)),
+                  static_cast<GLsizei>(width),
+                  static_cast<GLsizei>(band_num_rows(band)), GL_RGBA,
+                  GL_UNSIGNED_BYTE, nullptr);
+      band_fences[2 * index + band % 2] =
+          gl_functions_->glFenceSync_(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+      GL_CHECKERR(start_token, "glFenceSync");
+    }
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+  };
+
+  if (!read_band(0)) {
+    delete_band_fences();
+    return false;
+  }
+  for (size_t index = 0; index < identifiers.size(); index++) {
+    if (full_readback_buffers[index] != 0 &&
+        !WaitForRenderbufferReadback(start_token, identifiers[index])) {
+      delete_band_fences();
+      return false;
+    }
+  }
+  for (size_t band = 0; band < num_bands; band++) {
+    // The next band is read while this one is consumed.
+    if (band + 1 < num_bands && !read_band(band + 1)) {
+      delete_band_fences();
+      return false;
+    }
+    const size_t band_row = band_first_row(band);
+    const size_t band_bytes = band_num_rows(band) * row_size_bytes;
+    std::vector<GLuint> mapped_buffers;
+    auto unmap_band = [this, &mapped_buffers]() -> void {
+      for (GLuint buffer : mapped_buffers) {
+        gl_functions_->glBindBuffer_(GL_PIXEL_PACK_BUFFER, buffer);
+        gl_functions_->glUnmapBuffer_(GL_PIXEL_PACK_BUFFER);
+      }
+      gl_functions_->glBindBuffer_(GL_PIXEL_PACK_BUFFER, 0);
+    };
+    for (size_t index = 0; index < identifiers.size(); index++) {
+      if (first_naming[index] != index) {
+        bands[index] = bands[first_naming[index]];
+        continue;
       }
-      break;
-    case UniformValue::ElementType::kUvec4:
-      if (uniform_value.IsArray()) {
-        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform4uiv,
-                    program, uniform_location,
-                    static_cast<GLsizei>(uniform_value.GetArraySize()),
-                    uniform_value.GetUintData());
-      } else {
-        GL_SAFECALL(&set_uniform->GetStartToken(), glProgramUniform4ui, program,
-                    uniform_location, uniform_value.GetUintData()[0],
-                    uniform_value.GetUintData()[1],
-                    uniform_value.GetUintData()[2],
-                    uniform_value.GetUintData()[3]);
+      GLuint buffer = full_readback_buffers[index];
+      size_t offset_bytes = band_row * row_size_bytes;
+      if (buffer == 0) {
+        buffer = band_pixel_buffers_[2 * index + band % 2];
+        offset_bytes = 0;
+        GLsync fence = band_fences[2 * index + band % 2];
+        band_fences[2 * index + band % 2] = nullptr;
+        if (!WaitForReadbackFence(start_token, identifiers[index], fence)) {
+          unmap_band();
+          delete_band_fences();
+          return false;
+        }
       }
-      break;
-    default:
-      assert(false && "Unhandled uniform type.");
-      break;
+      GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, buffer);
+      bands[index] = static_cast<const std::uint8_t*>(
+          gl_functions_->glMapBufferRange_(
+              GL_PIXEL_PACK_BUFFER, static_cast<GLintptr>(offset_bytes),
+              static_cast<GLsizeiptr>(band_bytes), GL_MAP_READ_BIT));
+      if (bands[index] == nullptr) {
+        unmap_band();
+        delete_band_fences();
+        GL_CHECKERR(start_token, "glMapBufferRange");
+        CheckCommandErrors(start_token);
+        return false;
+      }
+      mapped_buffers.push_back(buffer);
+    }
+    const bool consumed = consume_band(band_row, band_num_rows(band), bands);
+    unmap_band();
+    if (!consumed) {
+      delete_band_fences();
+      return false;
+    }
+    GL_CHECKERR(start_token, "glUnmapBuffer");
+  }
+  return true;
+}
+
+bool Executor::ReadRenderbuffer(const Token* start_token,
+                                const std::string& command_name,
+                                const std::string& identifier, size_t* width,
+                                size_t* height,
+                                std::vector<std::uint8_t>* data) {
+  if (!GetRenderbufferSize(start_token, identifier, width, height)) {
+    return false;
+  }
+  const size_t row_size_bytes = *width * kNumRgbaChannels;
+  data->resize(*height * row_size_bytes);
+  return ReadRenderbufferBands(
+      start_token, command_name, {identifier}, *width, *height, 0,
+      [data, row_size_bytes](
+          size_t first_row, size_t num_rows,
+          const std::vector<const std::uint8_t*>& bands) -> bool {
+        memcpy(data->data() + first_row * row_size_bytes, bands[0],
+               num_rows * row_size_bytes);
+        return true;
+      });
+}
+
+bool Executor::StreamRenderbufferImage(
+    CommandDumpRenderbuffer* dump_renderbuffer) {
+  const Token* start_token = &dump_renderbuffer->GetStartToken();
+  const std::string& filename = dump_renderbuffer->GetFilename();
+  size_t width;
+  size_t height;
+  if (!GetRenderbufferSize(start_token,
+                           dump_renderbuffer->GetRenderbufferIdentifier(),
+                           &width, &height)) {
+    return false;
+  }
+  // An image queued earlier for the same file must not replace this one.
+  image_writer_.WaitForFile(filename);
+  ImageRowEncoder encoder(dump_renderbuffer->GetFormat(), width, height);
+  std::vector<std::uint8_t> encoded;
+  encoder.EncodeHeader(&encoded);
+  bool written = output_sink_->Begin(filename, OutputSink::Kind::kImage) &&
+                 output_sink_->Append(encoded.data(), encoded.size());
+  const size_t row_size_bytes = width * kNumRgbaChannels;
+  const bool read =
+      !written ||
+      ReadRenderbufferBands(
+          start_token, "DUMP_RENDERBUFFER",
+          {dump_renderbuffer->GetRenderbufferIdentifier()}, width, height, 0,
+          [this, &encoder, &encoded, &written, row_size_bytes](
+              size_t /*first_row*/, size_t num_rows,
+              const std::vector<const std::uint8_t*>& bands) -> bool {
+            // Images are encoded from the top row down, the reverse of the
+            // order of the rows in a band.
+            encoded.clear();
+            for (size_t row = num_rows; row > 0; row--) {
+              encoder.EncodeRows(bands[0] + (row - 1) * row_size_bytes, 1,
+                                 &encoded);
+            }
+            written = output_sink_->Append(encoded.data(), encoded.size());
+            return written;
+          });
+  if (written && read) {
+    encoded.clear();
+    encoder.EncodeEnd(&encoded);
+    written = output_sink_->Append(encoded.data(), encoded.size());
+  }
+  written = output_sink_->End() && written;
+  if (!written) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, start_token,
+        "Writing " + ImageFormatToString(dump_renderbuffer->GetFormat()) +
+            " data to '" + filename + "' failed");
+    return false;
+  }
+  if (!read) {
+    return false;
+  }
+  return CheckCommandErrors(start_token);
+}
+
+bool Executor::WaitForRenderbufferReadback(const Token* start_token,
+                                           const std::string& identifier) {
+  RenderbufferReadback& readback = renderbuffer_readbacks_.at(identifier);
+  GLsync fence = readback.fence;
+  readback.fence = nullptr;
+  return WaitForReadbackFence(start_token, identifier, fence);
+}
+
+bool Executor::WaitForReadbackFence(const Token* start_token,
+                                    const std::string& identifier,
+                                    GLsync fence) {
+  if (fence == nullptr) {
+    return true;
+  }
+  GLenum wait_result = GL_TIMEOUT_EXPIRED;
+  for (size_t i = 0;
+       i < kMaxReadbackWaits && wait_result == GL_TIMEOUT_EXPIRED; i++) {
+    wait_result = gl_functions_->glClientWaitSync_(
+        fence, GL_SYNC_FLUSH_COMMANDS_BIT, kReadbackWaitTimeoutNanoseconds);
+  }
+  gl_functions_->glDeleteSync_(fence);
+  GL_CHECKERR(start_token, "glClientWaitSync");
+  if (wait_result == GL_TIMEOUT_EXPIRED) {
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               "Timed out waiting for the readback of '" +
+                                   identifier + "'");
+    return false;
+  }
+  if (wait_result == GL_WAIT_FAILED) {
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               "Waiting for the readback of '" + identifier +
+                                   "' failed");
+    return false;
+  }
+  return true;
+}
+
+bool Executor::ReadRenderbufferRectangle(const Token* start_token,
+                                         const std::string& identifier,
+                                         const PixelRectangle& rectangle) {
+  PixelReadback pixel_readback;
+  pixel_readback.rectangle = rectangle;
+  pixel_readback.data.resize(rectangle.width * rectangle.height *
+                             kNumRgbaChannels);
+  const size_t row_size_bytes = rectangle.width * kNumRgbaChannels;
+
+  auto full_readback = renderbuffer_readbacks_.find(identifier);
+  if (full_readback != renderbuffer_readbacks_.end() &&
+      full_readback->second.up_to_date &&
+      PixelRectangle{0, 0, full_readback->second.width,
+                     full_readback->second.height}
+          .Contains(rectangle)) {
+    // The whole renderbuffer is already being read back, so the rectangle is
+    // copied out of the pixel buffer object rather than read again.
+    if (!WaitForRenderbufferReadback(start_token, identifier)) {
+      return false;
+    }
+    const RenderbufferReadback& readback = full_readback->second;
+    const size_t first_row = readback.height - rectangle.y - rectangle.height;
+    const size_t full_row_size_bytes = readback.width * kNumRgbaChannels;
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER,
+                readback.pixel_buffer);
+    const auto* mapped_buffer =
+        static_cast<std::uint8_t*>(gl_functions_->glMapBufferRange_(
+            GL_PIXEL_PACK_BUFFER,
+            static_cast<GLintptr>(first_row * full_row_size_bytes),
+            static_cast<GLsizeiptr>(rectangle.height * full_row_size_bytes),
+            GL_MAP_READ_BIT));
+    if (mapped_buffer == nullptr) {
+      GL_CHECKERR(start_token, "glMapBufferRange");
+      CheckCommandErrors(start_token);
+      return false;
+    }
+    for (size_t row = 0; row < rectangle.height; row++) {
+      memcpy(&pixel_readback.data[row * row_size_bytes],
+             &mapped_buffer[row * full_row_size_bytes +
+                            rectangle.x * kNumRgbaChannels],
+             row_size_bytes);
+    }
+    GL_SAFECALL(start_token, glUnmapBuffer, GL_PIXEL_PACK_BUFFER);
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
+  } else {
+    if (!BindFramebuffer(start_token, "ASSERT_PIXELS", {identifier})) {
+      return false;
+    }
+    GL_SAFECALL(start_token, glBindRenderbuffer, GL_RENDERBUFFER,
+                created_renderbuffers_.at(identifier));
+    GLint temp_height;
+    GL_SAFECALL(start_token, glGetRenderbufferParameteriv, GL_RENDERBUFFER,
+                GL_RENDERBUFFER_HEIGHT, &temp_height);
+    if (api_version_ != ApiVersion(ApiVersion::Api::GLES, 2, 0)) {
+      // OpenGL ES 2.0 does not support glReadBuffer, but reads always occur
+      // from color attachment 0, which is what is needed.
+      GL_SAFECALL(start_token, glReadBuffer, GL_COLOR_ATTACHMENT0);
+    }
+    GL_SAFECALL(
+        start_token, glReadPixels, static_cast<GLint>(rectangle.x),
+        static_cast<GLint>(static_cast<size_t>(temp_height) - rectangle.y -
+                           rectangle.height),
+        static_cast<GLsizei>(rectangle.width),
+        static_cast<GLsizei>(rectangle.height), GL_RGBA, GL_UNSIGNED_BYTE,
+        pixel_readback.data.data());
+  }
+  pixel_readbacks_[identifier] = std::move(pixel_readback);
+  return true;
+}
+
+bool Executor::SupportsComputeShaders() const {
+  return api_version_ >= ApiVersion(ApiVersion::Api::GLES, 3, 1) ||
+         api_version_ >= ApiVersion(ApiVersion::Api::GL, 4, 3);
+}
+
+bool Executor::AllocateFromBufferPool(const Token* start_token,
+                                      GLenum usage, size_t size_bytes,
+                                      BufferRange* range) {
+  if (buffer_pool_alignment_ == 0) {
+    // Vertex data and indirect commands need 4-byte alignment; buffers that
+    // may be bound as uniform or shader storage buffers also need the offset
+    // alignment of those targets.
+    buffer_pool_alignment_ = sizeof(GLuint);
+    if (api_version_ >= ApiVersion(ApiVersion::Api::GLES, 3, 0) ||
+        api_version_ >= ApiVersion(ApiVersion::Api::GL, 3, 1)) {
+      GLint alignment = 1;
+      GL_SAFECALL(start_token, glGetIntegerv,
+                  GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+      buffer_pool_alignment_ =
+          std::max(buffer_pool_alignment_, static_cast<size_t>(alignment));
+    }
+    if (SupportsComputeShaders()) {
+      GLint alignment = 1;
+      GL_SAFECALL(start_token, glGetIntegerv,
+                  GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+      buffer_pool_alignment_ =
+          std::max(buffer_pool_alignment_, static_cast<size_t>(alignment));
+    }
+  }
+
+  auto pool = buffer_pools_.find(usage);
+  size_t offset_bytes = 0;
+  if (pool != buffer_pools_.end()) {
+    offset_bytes = (pool->second.used_bytes + buffer_pool_alignment_ - 1) /
+                   buffer_pool_alignment_ * buffer_pool_alignment_;
+  }
+  if (pool == buffer_pools_.end() ||
+      offset_bytes + size_bytes > kBufferPoolSizeBytes) {
+    // The buffer object of a full pool is not deleted, as the buffers
+    // suballocated from it remain in use.
+    GLuint buffer;
+    GL_SAFECALL(start_token, glGenBuffers, 1, &buffer);
+    GL_SAFECALL(start_token, glBindBuffer, GL_ARRAY_BUFFER, buffer);
+    GL_SAFECALL(start_token, glBufferData, GL_ARRAY_BUFFER,
+                static_cast<GLsizeiptr>(kBufferPoolSizeBytes), nullptr, usage);
+    buffer_statistics_.num_buffer_objects++;
+    buffer_statistics_.buffer_object_bytes += kBufferPoolSizeBytes;
+    pool = buffer_pools_.insert({usage, BufferPool()}).first;
+    pool->second = {buffer, 0};
+    offset_bytes = 0;
+  } else {
+    GL_SAFECALL(start_token, glBindBuffer, GL_ARRAY_BUFFER,
+                pool->second.buffer);
+  }
+  pool->second.used_bytes = offset_bytes + size_bytes;
+  *range = {pool->second.buffer, offset_bytes, size_bytes};
+  return true;
+}
+
+bool Executor::BindIndexedBufferRange(const Token* start_token, GLenum target,
+                                      GLuint binding,
+                                      const BufferRange& range) {
+  // A range cannot be bound for an empty buffer; such a buffer is never
+  // pooled, so its buffer object is bound in full.
+  if (range.size_bytes == 0) {
+    GL_SAFECALL(start_token, glBindBufferBase, target, binding, range.buffer);
+    return true;
+  }
+  GL_SAFECALL(start_token, glBindBufferRange, target, binding, range.buffer,
+              static_cast<GLintptr>(range.offset_bytes),
+              static_cast<GLsizeiptr>(range.size_bytes));
+  return true;
+}
+
+bool Executor::CountMismatchesOnGpu(
+    const Token* start_token, const BufferRange& range_1,
+    const BufferRange& range_2, size_t size_bytes,
+    const std::vector<std::pair<size_t, size_t>>& compared_words,
+    size_t* mismatch_count, size_t* first_mismatching_word) {
+  GLuint program = 0;
+  if (!GetInternalComputeProgram(
+          start_token, MakeComparisonShaderSource(api_version_, compared_words),
+          &program)) {
+    return false;
+  }
+
+  // No mismatches have been counted, and the first is beyond any word.
+  const GLuint kInitialResult[2] = {0, std::numeric_limits<GLuint>::max()};
+  if (comparison_result_buffer_ == 0) {
+    GL_SAFECALL(start_token, glGenBuffers, 1, &comparison_result_buffer_);
+    GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER,
+                comparison_result_buffer_);
+    GL_SAFECALL(start_token, glBufferData, GL_SHADER_STORAGE_BUFFER,
+                sizeof(kInitialResult), kInitialResult, GL_DYNAMIC_READ);
+  } else {
+    GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER,
+                comparison_result_buffer_);
+    GL_SAFECALL(start_token, glBufferSubData, GL_SHADER_STORAGE_BUFFER, 0,
+                sizeof(kInitialResult), kInitialResult);
+  }
+  GL_SAFECALL(start_token, glBindBufferBase, GL_SHADER_STORAGE_BUFFER, 2,
+              comparison_result_buffer_);
+  GL_SAFECALL(start_token, glUseProgram, program);
+
+  // A shader storage block may be smaller than the buffers, in which case
+  // they are compared a window at a time. The offsets of pooled buffers meet
+  // the offset alignment, so the windows of both buffers remain aligned.
+  GLint64 max_block_size = 0;
+  GL_SAFECALL(start_token, glGetInteger64v, GL_MAX_SHADER_STORAGE_BLOCK_SIZE,
+              &max_block_size);
+  GLint offset_alignment = 1;
+  GL_SAFECALL(start_token, glGetIntegerv,
+              GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+  const size_t window_alignment =
+      std::max(static_cast<size_t>(offset_alignment), sizeof(GLuint));
+  const size_t window_size_bytes =
+      static_cast<size_t>(max_block_size) / window_alignment *
+      window_alignment;
+  const size_t kMaxWorkGroups = 1024;
+  for (size_t window_start = 0; window_start < size_bytes;
+       window_start += window_size_bytes) {
+    const size_t window_bytes =
+        std::min(window_size_bytes, size_bytes - window_start);
+    const size_t window_words = window_bytes / sizeof(GLuint);
+    GL_SAFECALL(start_token, glBindBufferRange, GL_SHADER_STORAGE_BUFFER, 0,
+                range_1.buffer,
+                static_cast<GLintptr>(range_1.offset_bytes + window_start),
+                static_cast<GLsizeiptr>(window_bytes));
+    GL_SAFECALL(start_token, glBindBufferRange, GL_SHADER_STORAGE_BUFFER, 1,
+                range_2.buffer,
+                static_cast<GLintptr>(range_2.offset_bytes + window_start),
+                static_cast<GLsizeiptr>(window_bytes));
+    GL_SAFECALL(start_token, glProgramUniform1ui, program, 0,
+                static_cast<GLuint>(window_start / sizeof(GLuint)));
+    GL_SAFECALL(start_token, glProgramUniform1ui, program, 1,
+                static_cast<GLuint>(window_words));
+    GL_SAFECALL(start_token, glDispatchCompute,
+                static_cast<GLuint>(std::min(
+                    kMaxWorkGroups,
+                    (window_words + kComparisonWorkGroupSize - 1) /
+                        kComparisonWorkGroupSize)),
+                1, 1);
+  }
+  GL_SAFECALL(start_token, glMemoryBarrier, GL_BUFFER_UPDATE_BARRIER_BIT);
+
+  if (!RestoreShaderStorageBufferBindings(start_token)) {
+    return false;
+  }
+
+  GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER,
+              comparison_result_buffer_);
+  const auto* mapped_result = static_cast<GLuint*>(
+      gl_functions_->glMapBufferRange_(GL_SHADER_STORAGE_BUFFER, 0,
+                                       sizeof(kInitialResult),
+                                       GL_MAP_READ_BIT));
+  if (mapped_result == nullptr) {
+    GL_CHECKERR(start_token, "glMapBufferRange");
+    CheckCommandErrors(start_token);
+    return false;
+  }
+  *mismatch_count = mapped_result[0];
+  *first_mismatching_word = mapped_result[1];
+  GL_SAFECALL(start_token, glUnmapBuffer, GL_SHADER_STORAGE_BUFFER);
+  GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER, 0);
+  return true;
+}
+
+bool Executor::GetInternalComputeProgram(const Token* start_token,
+                                         const std::string& source,
+                                         GLuint* program) {
+  auto cached_program = comparison_programs_.find(source);
+  if (cached_program == comparison_programs_.end()) {
+    const char* temp = source.c_str();
+    GLuint new_program =
+        gl_functions_->glCreateShaderProgramv_(GL_COMPUTE_SHADER, 1, &temp);
+    GL_CHECKERR(start_token, "glCreateShaderProgramv");
+    GLint status = 0;
+    GL_SAFECALL(start_token, glGetProgramiv, new_program, GL_LINK_STATUS,
+                &status);
+    if (status == 0) {
+      GL_SAFECALL(start_token, glDeleteProgram, new_program);
+      message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                                 "Building an internal compute shader failed");
+      return false;
+    }
+    cached_program = comparison_programs_.insert({source, new_program}).first;
+  }
+  *program = cached_program->second;
+  return true;
+}
+
+bool Executor::RestoreShaderStorageBufferBindings(const Token* start_token) {
+  // The bindings used internally are restored, as later commands may rely on
+  // them.
+  for (GLuint binding : {0U, 1U, 2U}) {
+    auto bound_buffer = shader_storage_buffer_bindings_.find(binding);
+    if (bound_buffer == shader_storage_buffer_bindings_.end()) {
+      GL_SAFECALL(start_token, glBindBufferBase, GL_SHADER_STORAGE_BUFFER,
+                  binding, 0);
+      continue;
+    }
+    if (!BindIndexedBufferRange(start_token, GL_SHADER_STORAGE_BUFFER, binding,
+                                bound_buffer->second)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool Executor::GetRenderbufferSize(const Token* start_token,
+                                   const std::string& identifier,
+                                   size_t* width, size_t* height) {
+  GLint dimensions[2] = {0, 0};
+  GL_SAFECALL(start_token, glBindRenderbuffer, GL_RENDERBUFFER,
+              created_renderbuffers_.at(identifier));
+  GL_SAFECALL(start_token, glGetRenderbufferParameteriv, GL_RENDERBUFFER,
+              GL_RENDERBUFFER_WIDTH, &dimensions[0]);
+  GL_SAFECALL(start_token, glGetRenderbufferParameteriv, GL_RENDERBUFFER,
+              GL_RENDERBUFFER_HEIGHT, &dimensions[1]);
+  *width = static_cast<size_t>(dimensions[0]);
+  *height = static_cast<size_t>(dimensions[1]);
+  return true;
+}
+
+bool Executor::CopyRenderbuffersToComparisonBuffers(
+    const Token* start_token, const std::string& command_name,
+    const std::string& identifier_1, const std::string& identifier_2,
+    size_t width, size_t height) {
+  const size_t size_bytes = width * height * kNumRgbaChannels;
+  if (size_bytes > comparison_pixel_buffer_size_) {
+    if (comparison_pixel_buffer_size_ == 0) {
+      GL_SAFECALL(start_token, glGenBuffers, 2, comparison_pixel_buffers_);
+    }
+    for (auto index : {0, 1}) {
+      GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER,
+                  comparison_pixel_buffers_[index]);
+      GL_SAFECALL(start_token, glBufferData, GL_PIXEL_PACK_BUFFER,
+                  static_cast<GLsizeiptr>(size_bytes), nullptr,
+                  GL_DYNAMIC_COPY);
+    }
+    comparison_pixel_buffer_size_ = size_bytes;
+  }
+  const std::string* identifiers[2] = {&identifier_1, &identifier_2};
+  for (auto index : {0, 1}) {
+    if (!BindFramebuffer(start_token, command_name, {*identifiers[index]})) {
+      return false;
+    }
+    GL_SAFECALL(start_token, glReadBuffer, GL_COLOR_ATTACHMENT0);
+    GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER,
+                comparison_pixel_buffers_[index]);
+    GL_SAFECALL(start_token, glReadPixels, 0, 0, static_cast<GLsizei>(width),
+                static_cast<GLsizei>(height), GL_RGBA, GL_UNSIGNED_BYTE,
+                nullptr);
+  }
+  GL_SAFECALL(start_token, glBindBuffer, GL_PIXEL_PACK_BUFFER, 0);
+  return true;
+}
+
+bool Executor::ComputeHistogramsOnGpu(
+    const Token* start_token, size_t num_pixels,
+    std::vector<std::uint64_t> histograms[2]) {
+  GLuint program = 0;
+  if (!GetInternalComputeProgram(start_token,
+                                 MakeHistogramShaderSource(api_version_),
+                                 &program)) {
+    return false;
+  }
+
+  const size_t num_bins = kNumRgbaChannels * kNumHistogramBins;
+  const std::vector<GLuint> zeros(2 * num_bins, 0);
+  const auto result_size_bytes =
+      static_cast<GLsizeiptr>(zeros.size() * sizeof(GLuint));
+  if (histogram_result_buffer_ == 0) {
+    GL_SAFECALL(start_token, glGenBuffers, 1, &histogram_result_buffer_);
+    GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER,
+                histogram_result_buffer_);
+    GL_SAFECALL(start_token, glBufferData, GL_SHADER_STORAGE_BUFFER,
+                result_size_bytes, zeros.data(), GL_DYNAMIC_READ);
+  } else {
+    GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER,
+                histogram_result_buffer_);
+    GL_SAFECALL(start_token, glBufferSubData, GL_SHADER_STORAGE_BUFFER, 0,
+                result_size_bytes, zeros.data());
+  }
+  GL_SAFECALL(start_token, glBindBufferBase, GL_SHADER_STORAGE_BUFFER, 2,
+              histogram_result_buffer_);
+  GL_SAFECALL(start_token, glUseProgram, program);
+
+  // As in CountMismatchesOnGpu, the pixels are processed a window at a time
+  // if a shader storage block cannot hold them all.
+  GLint64 max_block_size = 0;
+  GL_SAFECALL(start_token, glGetInteger64v, GL_MAX_SHADER_STORAGE_BLOCK_SIZE,
+              &max_block_size);
+  GLint offset_alignment = 1;
+  GL_SAFECALL(start_token, glGetIntegerv,
+              GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &offset_alignment);
+  const size_t window_alignment =
+      std::max(static_cast<size_t>(offset_alignment), sizeof(GLuint));
+  const size_t window_size_bytes =
+      static_cast<size_t>(max_block_size) / window_alignment *
+      window_alignment;
+  const size_t size_bytes = num_pixels * kNumRgbaChannels;
+  const size_t kMaxWorkGroups = 256;
+  for (size_t window_start = 0; window_start < size_bytes;
+       window_start += window_size_bytes) {
+    const size_t window_bytes =
+        std::min(window_size_bytes, size_bytes - window_start);
+    const size_t window_pixels = window_bytes / kNumRgbaChannels;
+    for (GLuint binding : {0U, 1U}) {
+      GL_SAFECALL(start_token, glBindBufferRange, GL_SHADER_STORAGE_BUFFER,
+                  binding, comparison_pixel_buffers_[binding],
+                  static_cast<GLintptr>(window_start),
+                  static_cast<GLsizeiptr>(window_bytes));
+    }
+    GL_SAFECALL(start_token, glProgramUniform1ui, program, 0,
+                static_cast<GLuint>(window_pixels));
+    GL_SAFECALL(start_token, glDispatchCompute,
+                static_cast<GLuint>(std::min(
+                    kMaxWorkGroups,
+                    (window_pixels + kHistogramWorkGroupSize - 1) /
+                        kHistogramWorkGroupSize)),
+                2, 1);
+  }
+  GL_SAFECALL(start_token, glMemoryBarrier, GL_BUFFER_UPDATE_BARRIER_BIT);
+  if (!RestoreShaderStorageBufferBindings(start_token)) {
+    return false;
+  }
+
+  GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER,
+              histogram_result_buffer_);
+  const auto* mapped_result = static_cast<GLuint*>(
+      gl_functions_->glMapBufferRange_(GL_SHADER_STORAGE_BUFFER, 0,
+                                       result_size_bytes, GL_MAP_READ_BIT));
+  if (mapped_result == nullptr) {
+    GL_CHECKERR(start_token, "glMapBufferRange");
+    CheckCommandErrors(start_token);
+    return false;
   }
+  for (auto index : {0, 1}) {
+    histograms[index].assign(mapped_result + index * num_bins,
+                             mapped_result + (index + 1) * num_bins);
+  }
+  GL_SAFECALL(start_token, glUnmapBuffer, GL_SHADER_STORAGE_BUFFER);
+  GL_SAFECALL(start_token, glBindBuffer, GL_SHADER_STORAGE_BUFFER, 0);
   return true;
 }
 
@@ -1054,29 +3610,50 @@ bool Executor::CheckEqualRenderbuffers(CommandAssertEqual* assert_equal) {
              0 &&
          "Expected a renderbuffer");
 
-  GLuint renderbuffers[2];
-  renderbuffers[0] =
-      created_renderbuffers_.at(assert_equal->GetArgumentIdentifier1());
-  renderbuffers[1] =
-      created_renderbuffers_.at(assert_equal->GetArgumentIdentifier2());
+  const std::string* identifiers[2] = {
+      &assert_equal->GetArgumentIdentifier1(),
+      &assert_equal->GetArgumentIdentifier2()};
 
   size_t width[2] = {0, 0};
   size_t height[2] = {0, 0};
-
   for (auto index : {0, 1}) {
-    {
-      GLint temp_width;
-      GL_SAFECALL(&assert_equal->GetStartToken(), glBindRenderbuffer,
-                  GL_RENDERBUFFER, renderbuffers[index]);
-      GL_SAFECALL(&assert_equal->GetStartToken(), glGetRenderbufferParameteriv,
-                  GL_RENDERBUFFER, GL_RENDERBUFFER_WIDTH, &temp_width);
-      width[index] = static_cast<size_t>(temp_width);
+    if (!GetRenderbufferSize(&assert_equal->GetStartToken(),
+                             *identifiers[index], &width[index],
+                             &height[index])) {
+      return false;
     }
-    {
-      GLint temp_height;
-      GL_SAFECALL(&assert_equal->GetStartToken(), glGetRenderbufferParameteriv,
-                  GL_RENDERBUFFER, GL_RENDERBUFFER_HEIGHT, &temp_height);
-      height[index] = static_cast<size_t>(temp_height);
+  }
+
+  // The row, counting from the bottom, from which the renderbuffers need to be
+  // compared on the host; the rows below it are known to match.
+  size_t compared_from_row = 0;
+  if (options_.compare_on_gpu && SupportsComputeShaders()) {
+    // The renderbuffers are copied into buffers in GPU memory and compared
+    // there. They are only read back to the host, below, if they differ.
+    if (width[0] == width[1] && height[0] == height[1]) {
+      const size_t size_bytes = width[0] * height[0] * kNumRgbaChannels;
+      if (!CopyRenderbuffersToComparisonBuffers(
+              &assert_equal->GetStartToken(), "ASSERT_EQUAL", *identifiers[0],
+              *identifiers[1], width[0], height[0])) {
+        return false;
+      }
+      size_t mismatch_count = 0;
+      size_t first_mismatching_word = 0;
+      if (!CountMismatchesOnGpu(
+              &assert_equal->GetStartToken(),
+              {comparison_pixel_buffers_[0], 0, size_bytes},
+              {comparison_pixel_buffers_[1], 0, size_bytes}, size_bytes,
+              {{0, size_bytes / sizeof(GLuint)}}, &mismatch_count,
+              &first_mismatching_word)) {
+        return false;
+      }
+      if (mismatch_count == 0) {
+        return true;
+      }
+      // Each word is a pixel, and the rows are ordered bottom-to-top as read
+      // by glReadPixels, so only the rows from that of the first mismatch
+      // upwards are read back.
+      compared_from_row = first_mismatching_word / width[0];
     }
   }
 
@@ -1102,72 +3679,99 @@ bool Executor::CheckEqualRenderbuffers(CommandAssertEqual* assert_equal) {
     return false;
   }
 
-  std::vector<std::uint8_t> data[2];
-  for (auto index : {0, 1}) {
-    GLuint framebuffer_object_id;
-    GL_SAFECALL(&assert_equal->GetStartToken(), glGenFramebuffers, 1,
-                &framebuffer_object_id);
-    GL_SAFECALL(&assert_equal->GetStartToken(), glBindFramebuffer,
-                GL_FRAMEBUFFER, framebuffer_object_id);
-    GL_SAFECALL(&assert_equal->GetStartToken(), glFramebufferRenderbuffer,
-                GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
-                renderbuffers[index]);
-    GLenum status = gl_functions_->glCheckFramebufferStatus_(GL_FRAMEBUFFER);
-    if (status != GL_FRAMEBUFFER_COMPLETE) {
-      message_consumer_->Message(
-          MessageConsumer::Severity::kError, &assert_equal->GetStartToken(),
-          "Incomplete framebuffer found for 'ASSERT_EQUAL' command; "
-          "glCheckFramebufferStatus returned status " +
-              std::to_string(status));
-      return false;
-    }
-    data[index].resize(width[index] * height[index] * kNumRgbaChannels);
-    GL_SAFECALL(&assert_equal->GetStartToken(), glReadBuffer,
-                GL_COLOR_ATTACHMENT0);
-    GL_SAFECALL(&assert_equal->GetStartToken(), glReadPixels, 0, 0,
-                static_cast<GLsizei>(width[index]),
-                static_cast<GLsizei>(height[index]), GL_RGBA, GL_UNSIGNED_BYTE,
-                data[index].data());
-    GL_SAFECALL(&assert_equal->GetStartToken(), glDeleteFramebuffers, 1,
-                &framebuffer_object_id);
+  PixelMismatchSummary summary;
+  std::vector<std::uint8_t> diff_mask;
+  const size_t row_size_bytes = width[0] * kNumRgbaChannels;
+  if (!ReadRenderbufferBands(
+          &assert_equal->GetStartToken(), "ASSERT_EQUAL",
+          {*identifiers[0], *identifiers[1]}, width[0], height[0],
+          compared_from_row,
+          [&](size_t first_row, size_t num_rows,
+              const std::vector<const std::uint8_t*>& bands) -> bool {
+            for (size_t row = num_rows; row-- > 0;) {
+              // Rows are read back from the bottom up.
+              const size_t y = height[0] - (first_row + row) - 1;
+              ComparePixelRow(message_consumer_, options_.max_mismatch_reports,
+                              &assert_equal->GetStartToken(), *identifiers[0],
+                              *identifiers[1], y, width[0], height[0],
+                              bands[0] + row * row_size_bytes,
+                              bands[1] + row * row_size_bytes, &summary,
+                              options_.write_diff_masks ? &diff_mask : nullptr);
+            }
+            return true;
+          })) {
+    return false;
+  }
+  if (summary.GetCount() == 0) {
+    return true;
   }
+  ReportMismatchSummary(&assert_equal->GetStartToken(), summary.GetCount(),
+                        "'" + *identifiers[0] + "' and '" + *identifiers[1] +
+                            "' have " + summary.ToString());
+  if (options_.write_diff_masks) {
+    WriteDiffMask(&assert_equal->GetStartToken(), width[0], height[0],
+                  diff_mask);
+  }
+  return false;
+}
 
-  bool result = true;
-  for (size_t y = 0; y < static_cast<size_t>(height[0]); y++) {
-    for (size_t x = 0; x < static_cast<size_t>(width[0]); x++) {
-      size_t offset = (static_cast<size_t>(height[0]) - y - 1) *
-                          static_cast<size_t>(width[0]) * 4 +
-                      x * 4;
-      bool all_match = true;
-      for (size_t component = 0; component < 4; component++) {
-        if (data[0][offset + component] != data[1][offset + component]) {
-          all_match = false;
-          break;
-        }
-      }
-      if (!all_match) {
-        std::stringstream stringstream;
-        stringstream << "Pixel mismatch at position (" << x << ", " << y
-                     << "): " << assert_equal->GetArgumentIdentifier1() << "["
-                     << x << "][" << y << "] == ("
-                     << static_cast<uint32_t>(data[0][offset]) << ", "
-                     << static_cast<uint32_t>(data[0][offset + 1]) << ", "
-                     << static_cast<uint32_t>(data[0][offset + 2]) << ", "
-                     << static_cast<uint32_t>(data[0][offset + 3]) << "), vs. "
-                     << assert_equal->GetArgumentIdentifier2() << "[" << x
-                     << "][" << y << "] == ("
-                     << static_cast<uint32_t>(data[1][offset]) << ", "
-                     << static_cast<uint32_t>(data[1][offset + 1]) << ", "
-                     << static_cast<uint32_t>(data[1][offset + 2]) << ", "
-                     << static_cast<uint32_t>(data[1][offset + 3]) << ")";
-        message_consumer_->Message(MessageConsumer::Severity::kError,
-                                   &assert_equal->GetStartToken(),
-                                   stringstream.str());
-        result = false;
-      }
-    }
+bool Executor::CheckHash(const Token* start_token,
+                         const std::string& identifier, uint64_t actual_hash,
+                         uint64_t expected_hash) {
+  if (actual_hash == expected_hash) {
+    return true;
   }
-  return result;
+  message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                             "Hash of '" + identifier + "' is \"" +
+                                 HashToHexString(actual_hash) +
+                                 "\", expected \"" +
+                                 HashToHexString(expected_hash) + "\"");
+  return false;
+}
+
+void Executor::ReportMismatchSummary(const Token* start_token,
+                                     size_t mismatch_count,
+                                     const std::string& details) {
+  std::stringstream stringstream;
+  stringstream << details;
+  if (options_.max_mismatch_reports == 0) {
+    stringstream << " (mismatches are not reported individually)";
+  } else if (mismatch_count > options_.max_mismatch_reports) {
+    stringstream << " (only the first " << options_.max_mismatch_reports
+                 << " mismatches are reported individually)";
+  }
+  message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                             stringstream.str());
+}
+
+void Executor::WriteDiffMask(const Token* start_token, size_t width,
+                             size_t height,
+                             const std::vector<std::uint8_t>& diff_mask) {
+#ifdef SHADERTRAP_LODEPNG
+  const std::string filename =
+      "diff_mask_" + std::to_string(start_token->GetLine()) + ".png";
+  std::vector<unsigned char> png_data;
+  unsigned png_error = lodepng::encode(png_data, diff_mask,
+                                       static_cast<unsigned int>(width),
+                                       static_cast<unsigned int>(height));
+  if (png_error != 0 ||
+      !output_sink_->Write(filename, OutputSink::Kind::kImage, png_data.data(),
+                           png_data.size())) {
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               "Writing PNG data to '" + filename + "' failed");
+    return;
+  }
+  message_consumer_->Message(
+      MessageConsumer::Severity::kWarning, start_token,
+      "Mismatching pixels are shown in white in '" + filename + "'");
+#else
+  (void)width;
+  (void)height;
+  (void)diff_mask;
+  message_consumer_->Message(
+      MessageConsumer::Severity::kWarning, start_token,
+      "A diff mask was not written, as PNG support is not available");
+#endif
 }
 
 bool Executor::CheckEqualBuffers(CommandAssertEqual* assert_equal) {
@@ -1178,17 +3782,10 @@ bool Executor::CheckEqualBuffers(CommandAssertEqual* assert_equal) {
   assert(created_buffers_.count(assert_equal->GetArgumentIdentifier2()) != 0 &&
          "Expected a buffer");
 
-  GLuint buffers[2];
-  buffers[0] = created_buffers_.at(assert_equal->GetArgumentIdentifier1());
-  buffers[1] = created_buffers_.at(assert_equal->GetArgumentIdentifier2());
-
-  GLint64 buffer_size[2]{0, 0};
-  for (auto index : {0, 1}) {
-    GL_SAFECALL(&assert_equal->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
-                buffers[index]);
-    GL_SAFECALL(&assert_equal->GetStartToken(), glGetBufferParameteri64v,
-                GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &buffer_size[index]);
-  }
+  const BufferRange ranges[2]{
+      created_buffers_.at(assert_equal->GetArgumentIdentifier1()),
+      created_buffers_.at(assert_equal->GetArgumentIdentifier2())};
+  const size_t buffer_size[2]{ranges[0].size_bytes, ranges[1].size_bytes};
 
   if (buffer_size[0] != buffer_size[1]) {
     std::stringstream stringstream;
@@ -1202,175 +3799,213 @@ bool Executor::CheckEqualBuffers(CommandAssertEqual* assert_equal) {
     return false;
   }
 
+  // The offset from which the buffers need to be compared on the host; the
+  // bytes before it are known to match.
+  size_t compared_from = 0;
+  // The comparison shader is bitwise, so with a tolerance, under which
+  // differing floats may match, the buffers are only compared on the host.
+  if (options_.compare_on_gpu && SupportsComputeShaders() &&
+      !assert_equal->HasTolerance()) {
+    // Determine the words that the format entries require to be compared,
+    // merging adjacent ranges so that the comparison shader stays small. The
+    // comparison is bitwise for all kinds of entry, including floats, matching
+    // the comparison performed on the host.
+    const size_t size_bytes = buffer_size[0];
+    std::vector<std::pair<size_t, size_t>> compared_bytes;
+    if (assert_equal->GetFormatEntries().empty()) {
+      compared_bytes.emplace_back(0, size_bytes);
+    }
+    size_t offset = 0;
+    for (const auto& format_entry : assert_equal->GetFormatEntries()) {
+      size_t entry_size_bytes = format_entry.count;
+      switch (format_entry.kind) {
+        case CommandAssertEqual::FormatEntry::Kind::kSkip:
+        case CommandAssertEqual::FormatEntry::Kind::kByte:
+          break;
+        case CommandAssertEqual::FormatEntry::Kind::kFloat:
+        case CommandAssertEqual::FormatEntry::Kind::kInt:
+        case CommandAssertEqual::FormatEntry::Kind::kUint:
+          entry_size_bytes *= sizeof(uint32_t);
+          break;
+      }
+      if (format_entry.kind != CommandAssertEqual::FormatEntry::Kind::kSkip) {
+        if (!compared_bytes.empty() && compared_bytes.back().second == offset) {
+          compared_bytes.back().second += entry_size_bytes;
+        } else {
+          compared_bytes.emplace_back(offset, offset + entry_size_bytes);
+        }
+      }
+      offset += entry_size_bytes;
+    }
+    // The shader works on whole words, and its size grows with the number of
+    // ranges; in other cases the buffers are compared on the host.
+    const size_t kMaxComparedRanges = 64;
+    bool word_aligned = size_bytes % sizeof(GLuint) == 0;
+    for (const auto& range : compared_bytes) {
+      word_aligned = word_aligned && range.first % sizeof(GLuint) == 0 &&
+                     range.second % sizeof(GLuint) == 0;
+    }
+    if (word_aligned && compared_bytes.size() <= kMaxComparedRanges) {
+      std::vector<std::pair<size_t, size_t>> compared_words;
+      for (const auto& range : compared_bytes) {
+        compared_words.emplace_back(range.first / sizeof(GLuint),
+                                    range.second / sizeof(GLuint));
+      }
+      size_t mismatch_count = 0;
+      size_t first_mismatching_word = 0;
+      if (!CountMismatchesOnGpu(&assert_equal->GetStartToken(), ranges[0],
+                                ranges[1], size_bytes, compared_words,
+                                &mismatch_count, &first_mismatching_word)) {
+        return false;
+      }
+      if (mismatch_count == 0) {
+        return true;
+      }
+      // Only the data from the first mismatch onwards is read back.
+      compared_from = first_mismatching_word * sizeof(GLuint);
+    }
+  }
+
+  // A buffer object cannot be mapped twice at once, so if both buffers are
+  // held in the same buffer object, as pooled buffers can be, a single range
+  // spanning both of them is mapped.
+  const bool same_buffer_object = ranges[0].buffer == ranges[1].buffer;
   uint8_t* mapped_buffer[2]{nullptr, nullptr};
   for (auto index : {0, 1}) {
+    if (same_buffer_object && index == 1) {
+      break;
+    }
+    size_t map_start = ranges[index].offset_bytes + compared_from;
+    size_t map_end = ranges[index].offset_bytes + ranges[index].size_bytes;
+    if (same_buffer_object) {
+      map_start = std::min(ranges[0].offset_bytes, ranges[1].offset_bytes) +
+                  compared_from;
+      map_end = std::max(ranges[0].offset_bytes + ranges[0].size_bytes,
+                         ranges[1].offset_bytes + ranges[1].size_bytes);
+    }
     GL_SAFECALL(&assert_equal->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
-                buffers[index]);
-    mapped_buffer[index] =
-        static_cast<uint8_t*>(gl_functions_->glMapBufferRange_(
-            GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(buffer_size[index]),
-            GL_MAP_READ_BIT));
-    if (mapped_buffer[index] == nullptr) {
+                ranges[index].buffer);
+    auto* mapped = static_cast<uint8_t*>(gl_functions_->glMapBufferRange_(
+        GL_ARRAY_BUFFER, static_cast<GLintptr>(map_start),
+        static_cast<GLsizeiptr>(map_end - map_start), GL_MAP_READ_BIT));
+    if (mapped == nullptr) {
+      if (index == 1) {
+        // The first buffer is unmapped so that it remains usable. Errors from
+        // unmapping it are not checked, so that the error from mapping the
+        // second buffer is the one reported.
+        gl_functions_->glBindBuffer_(GL_ARRAY_BUFFER, ranges[0].buffer);
+        gl_functions_->glUnmapBuffer_(GL_ARRAY_BUFFER);
+      }
       GL_CHECKERR(&assert_equal->GetStartToken(), "glMapBufferRange");
       return false;
     }
+    for (auto other : {0, 1}) {
+      if (other == index || same_buffer_object) {
+        mapped_buffer[other] =
+            mapped + (ranges[other].offset_bytes + compared_from - map_start);
+      }
+    }
   }
 
-  std::vector<CommandAssertEqual::FormatEntry>& format_entries =
-      assert_equal->GetFormatEntries();
+  ElementMismatchSummary summary;
+  CompareFormattedBytes(message_consumer_, options_.max_mismatch_reports,
+                        &assert_equal->GetStartToken(),
+                        assert_equal->GetFormatEntries(),
+                        assert_equal->HasTolerance()
+                            ? &assert_equal->GetTolerance()
+                            : nullptr,
+                        assert_equal->GetArgumentIdentifier1(),
+                        assert_equal->GetArgumentIdentifier2(), compared_from,
+                        buffer_size[0], mapped_buffer[0], mapped_buffer[1],
+                        &summary);
 
-  if (format_entries.empty()) {
-    // No format entries were specified, so a default byte-based format entry,
-    // based on the size of the buffers, is used.
-    const Token& start_token = assert_equal->GetStartToken();
-    format_entries.push_back(
-        {MakeUnique<Token>(start_token.GetType(), start_token.GetLine(), 0U),
-         CommandAssertEqual::FormatEntry::Kind::kByte,
-         static_cast<size_t>(buffer_size[0])});
+  for (auto index : {0, 1}) {
+    if (same_buffer_object && index == 1) {
+      break;
+    }
+    GL_SAFECALL(&assert_equal->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
+                ranges[index].buffer);
+    GL_SAFECALL(&assert_equal->GetStartToken(), glUnmapBuffer, GL_ARRAY_BUFFER);
   }
+  if (summary.GetCount() == 0) {
+    return true;
+  }
+  ReportMismatchSummary(&assert_equal->GetStartToken(), summary.GetCount(),
+                        "'" + assert_equal->GetArgumentIdentifier1() +
+                            "' and '" + assert_equal->GetArgumentIdentifier2() +
+                            "' have " + summary.ToString());
+  return false;
+}
 
-  bool result = true;
-  size_t offset = 0;
-
-  for (auto& format_entry : format_entries) {
-    switch (format_entry.kind) {
-      case CommandAssertEqual::FormatEntry::Kind::kSkip:
-        offset += format_entry.count;
-        break;
-      case CommandAssertEqual::FormatEntry::Kind::kByte: {
-        for (size_t index = offset; index < format_entry.count; index++) {
-          // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-          uint8_t value_1 = mapped_buffer[0][index];
-          // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-          uint8_t value_2 = mapped_buffer[1][index];
-          if (value_1 != value_2) {
-            std::stringstream stringstream;
-            stringstream << "Byte mismatch at index " << index << ": "
-                         << assert_equal->GetArgumentIdentifier1() << "["
-                         << index << "] == " << static_cast<uint32_t>(value_1)
-                         << ", " << assert_equal->GetArgumentIdentifier2()
-                         << "[" << index
-                         << "] == " << static_cast<uint32_t>(value_2);
-            message_consumer_->Message(MessageConsumer::Severity::kError,
-                                       &assert_equal->GetStartToken(),
-                                       stringstream.str());
-            result = false;
-          }
-        }
-        offset += format_entry.count;
-        break;
-      }
-      case CommandAssertEqual::FormatEntry::Kind::kFloat: {
-        float* float_region[2]{nullptr, nullptr};
-        for (auto index : {0, 1}) {
-          float_region[index] =
-              // cppcheck-suppress invalidPointerCast
-              reinterpret_cast<float*>(mapped_buffer[index] + offset);
-        }
-
-        for (size_t index = 0; index < format_entry.count; index++) {
-          if (float_region[0] != nullptr && float_region[1] != nullptr) {
-            // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-            float value_1 = float_region[0][index];
-            // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-            float value_2 = float_region[1][index];
-            // We compare data using memcmp to look for byte-level mismatches,
-            // and then report any mismatches at the floating-point level. This
-            // avoids performing floating-point comparisons, and associated
-            // issues related to special values.
-            if (std::memcmp(&float_region[0][index], &float_region[1][index],
-                            sizeof(float)) != 0) {
-              std::stringstream stringstream;
-              size_t float_index = sizeof(float) * index + offset;
-              stringstream << "Float mismatch at byte index " << float_index
-                           << ": " << assert_equal->GetArgumentIdentifier1()
-                           << "[" << float_index
-                           << "] == " << static_cast<float>(value_1) << ", "
-                           << assert_equal->GetArgumentIdentifier2() << "["
-                           << float_index
-                           << "] == " << static_cast<float>(value_2);
-              message_consumer_->Message(MessageConsumer::Severity::kError,
-                                         &assert_equal->GetStartToken(),
-                                         stringstream.str());
-              result = false;
-            }
-          }
-        }
-        offset += format_entry.count * sizeof(float);
-        break;
-      }
-      case CommandAssertEqual::FormatEntry::Kind::kInt: {
-        int32_t* int_region[2]{nullptr, nullptr};
-        for (auto index : {0, 1}) {
-          int_region[index] =
-              reinterpret_cast<int32_t*>(mapped_buffer[index] + offset);
-        }
+bool Executor::CheckBufferEqualsFile(CommandAssertEqual* assert_equal) {
+  assert(assert_equal->GetComparesWithFile() &&
+         "The buffer must be compared with a file");
+  const Token* start_token = &assert_equal->GetStartToken();
+  const std::string& identifier = assert_equal->GetArgumentIdentifier1();
+  const std::string& filename = assert_equal->GetFilename();
+  assert(created_buffers_.count(identifier) != 0 && "Expected a buffer");
+  const BufferRange& range = created_buffers_.at(identifier);
+
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  if (!file) {
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               "Could not open '" + filename + "'");
+    return false;
+  }
+  const auto file_size = static_cast<size_t>(file.tellg());
+  file.seekg(0);
+  if (file_size != range.size_bytes) {
+    std::stringstream stringstream;
+    stringstream << "The lengths of " << identifier << " and '" << filename
+                 << "' do not match: " << range.size_bytes << " vs. "
+                 << file_size;
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               stringstream.str());
+    return false;
+  }
 
-        for (size_t index = 0; index < format_entry.count; index++) {
-          // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-          int32_t value_1 = int_region[0][index];
-          // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-          int32_t value_2 = int_region[1][index];
-          if (value_1 != value_2) {
-            size_t int_index = index * sizeof(int32_t) + offset;
-            std::stringstream stringstream;
-            stringstream << "Integer mismatch at byte_index " << int_index
-                         << ": " << assert_equal->GetArgumentIdentifier1()
-                         << "[" << int_index
-                         << "] == " << static_cast<int32_t>(value_1) << ", "
-                         << assert_equal->GetArgumentIdentifier2() << "["
-                         << int_index
-                         << "] == " << static_cast<int32_t>(value_2);
-            message_consumer_->Message(MessageConsumer::Severity::kError,
-                                       &assert_equal->GetStartToken(),
-                                       stringstream.str());
-            result = false;
-          }
-        }
-        offset += format_entry.count * sizeof(int32_t);
-        break;
-      }
-      case CommandAssertEqual::FormatEntry::Kind::kUint: {
-        uint32_t* uint_region[2]{nullptr, nullptr};
-        for (auto index : {0, 1}) {
-          uint_region[index] =
-              reinterpret_cast<uint32_t*>(mapped_buffer[index] + offset);
-        }
+  GL_SAFECALL(start_token, glBindBuffer, GL_ARRAY_BUFFER, range.buffer);
+  auto* mapped = static_cast<uint8_t*>(gl_functions_->glMapBufferRange_(
+      GL_ARRAY_BUFFER, static_cast<GLintptr>(range.offset_bytes),
+      static_cast<GLsizeiptr>(range.size_bytes), GL_MAP_READ_BIT));
+  if (mapped == nullptr) {
+    GL_CHECKERR(start_token, "glMapBufferRange");
+    return false;
+  }
 
-        for (size_t index = 0; index < format_entry.count; index++) {
-          // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-          uint32_t value_1 = uint_region[0][index];
-          // NOLINTNEXTLINE(clang-analyzer-core.NullDereference)
-          uint32_t value_2 = uint_region[1][index];
-          if (value_1 != value_2) {
-            size_t uint_index = index * sizeof(uint32_t) + offset;
-            std::stringstream stringstream;
-            stringstream << "Unsigned integer mismatch at byte index "
-                         << uint_index << ": "
-                         << assert_equal->GetArgumentIdentifier1() << "["
-                         << uint_index
-                         << "] == " << static_cast<uint32_t>(value_1) << ", "
-                         << assert_equal->GetArgumentIdentifier2() << "["
-                         << uint_index
-                         << "] == " << static_cast<uint32_t>(value_2);
-            message_consumer_->Message(MessageConsumer::Severity::kError,
-                                       &assert_equal->GetStartToken(),
-                                       stringstream.str());
-            result = false;
-          }
-        }
-        offset += format_entry.count * sizeof(uint32_t);
-        break;
-      }
+  // Chunks are a multiple of the size of every kind of format entry.
+  const size_t kChunkSizeBytes = 1 << 20;
+  std::vector<uint8_t> chunk(std::min(kChunkSizeBytes, file_size));
+  ElementMismatchSummary summary;
+  bool read_file = true;
+  for (size_t begin = 0; begin < file_size; begin += chunk.size()) {
+    const size_t end = std::min(begin + chunk.size(), file_size);
+    if (!file.read(reinterpret_cast<char*>(chunk.data()),
+                   static_cast<std::streamsize>(end - begin))) {
+      read_file = false;
+      break;
     }
+    CompareFormattedBytes(message_consumer_, options_.max_mismatch_reports,
+                          start_token, assert_equal->GetFormatEntries(),
+                          assert_equal->HasTolerance()
+                              ? &assert_equal->GetTolerance()
+                              : nullptr,
+                          identifier, filename, begin, end, mapped + begin,
+                          chunk.data(), &summary);
   }
-
-  for (auto index : {0, 1}) {
-    GL_SAFECALL(&assert_equal->GetStartToken(), glBindBuffer, GL_ARRAY_BUFFER,
-                buffers[index]);
-    GL_SAFECALL(&assert_equal->GetStartToken(), glUnmapBuffer, GL_ARRAY_BUFFER);
+  GL_SAFECALL(start_token, glUnmapBuffer, GL_ARRAY_BUFFER);
+  if (!read_file) {
+    message_consumer_->Message(MessageConsumer::Severity::kError, start_token,
+                               "Could not read '" + filename + "'");
+    return false;
   }
-  return result;
+  if (summary.GetCount() == 0) {
+    return true;
+  }
+  ReportMismatchSummary(
+      start_token, summary.GetCount(),
+      "'" + identifier + "' and '" + filename + "' have " + summary.ToString());
+  return false;
 }
 
 }  // namespace shadertrap
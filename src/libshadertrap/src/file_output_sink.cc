@@ -0,0 +1,53 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/file_output_sink.h"
+
+namespace shadertrap {
+
+bool FileOutputSink::Write(const std::string& name, Kind kind,
+                           const uint8_t* data, size_t size) {
+  std::ofstream file(name, kind == Kind::kText
+                               ? std::ios::out
+                               : std::ios::out | std::ios::binary);
+  file.write(reinterpret_cast<const char*>(data),
+             static_cast<std::streamsize>(size));
+  file.close();
+  return !file.fail();
+}
+
+bool FileOutputSink::Begin(const std::string& name, Kind kind) {
+  file_.open(name, kind == Kind::kText ? std::ios::out
+                                       : std::ios::out | std::ios::binary);
+  return !file_.fail();
+}
+
+bool FileOutputSink::Append(const uint8_t* data, size_t size) {
+  file_.write(reinterpret_cast<const char*>(data),
+              static_cast<std::streamsize>(size));
+  return !file_.fail();
+}
+
+bool FileOutputSink::End() {
+  if (!file_.is_open()) {
+    file_.clear();
+    return false;
+  }
+  file_.close();
+  const bool written = !file_.fail();
+  file_.clear();
+  return written;
+}
+
+}  // namespace shadertrap
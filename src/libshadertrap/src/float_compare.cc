@@ -0,0 +1,210 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/float_compare.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHADERTRAP_FLOAT_COMPARE_SSE2
+#endif
+
+namespace shadertrap {
+
+namespace {
+
+const uint32_t kSignBit = 0x80000000U;
+
+// Maps the bits of a float to an integer such that adjacent floats map to
+// adjacent integers, and +0 and -0 both map to 0.
+int32_t ToOrderedInteger(uint32_t bits) {
+  const auto magnitude = static_cast<int32_t>(bits & ~kSignBit);
+  return (bits & kSignBit) != 0 ? -magnitude : magnitude;
+}
+
+// Returns true if and only if the floats with bits |bits_1| and |bits_2|
+// match within |tolerance|, merging their differences into |errors| unless
+// either is NaN. Performs the same operations as the SSE2 loop below, so that
+// both give the same results.
+bool IsWithinTolerance(uint32_t bits_1, uint32_t bits_2,
+                       const FloatTolerance& tolerance, FloatErrors* errors) {
+  if (bits_1 == bits_2) {
+    return true;
+  }
+  float value_1;
+  float value_2;
+  memcpy(&value_1, &bits_1, sizeof(float));
+  memcpy(&value_2, &bits_2, sizeof(float));
+  if (std::isnan(value_1) || std::isnan(value_2)) {
+    return false;
+  }
+  // Equal infinities are bitwise equal, so the absolute difference is not NaN.
+  const float absolute = std::fabs(value_1 - value_2);
+  const float magnitude = std::max(std::fabs(value_1), std::fabs(value_2));
+  // The relative difference between an infinity and a finite value is NaN.
+  const float relative =
+      absolute / std::max(magnitude, std::numeric_limits<float>::min());
+  const int32_t ordered_1 = ToOrderedInteger(bits_1);
+  const int32_t ordered_2 = ToOrderedInteger(bits_2);
+  // The distance can exceed INT32_MAX, so it is computed without overflow in
+  // unsigned arithmetic.
+  const uint32_t ulps =
+      ordered_1 > ordered_2
+          ? static_cast<uint32_t>(ordered_1) - static_cast<uint32_t>(ordered_2)
+          : static_cast<uint32_t>(ordered_2) - static_cast<uint32_t>(ordered_1);
+  errors->max_absolute = std::max(errors->max_absolute, absolute);
+  if (!std::isnan(relative)) {
+    errors->max_relative = std::max(errors->max_relative, relative);
+  }
+  errors->max_ulps = std::max(errors->max_ulps, ulps);
+  return absolute <= tolerance.absolute || relative <= tolerance.relative ||
+         ulps <= tolerance.ulps;
+}
+
+#if defined(SHADERTRAP_FLOAT_COMPARE_SSE2)
+
+// Returns the lanes of |a| or |b| selected by the all-ones or all-zeros lanes
+// of |mask|.
+__m128i Select(__m128i mask, __m128i a, __m128i b) {
+  return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// Returns the maximum of the four floats in |vector|.
+float HorizontalMax(__m128 vector) {
+  vector = _mm_max_ps(vector, _mm_shuffle_ps(vector, vector, 0x4E));
+  vector = _mm_max_ps(vector, _mm_shuffle_ps(vector, vector, 0xB1));
+  return _mm_cvtss_f32(vector);
+}
+
+#endif
+
+}  // namespace
+
+size_t FindFirstFloatOutsideTolerance(const uint8_t* data_1,
+                                      const uint8_t* data_2, size_t count,
+                                      const FloatTolerance& tolerance,
+                                      FloatErrors* errors) {
+  size_t index = 0;
+#if defined(SHADERTRAP_FLOAT_COMPARE_SSE2)
+  // Whole vectors are compared until one with a pair outside the tolerance is
+  // found; the scalar loop below then locates the pair within it. SSE2 has no
+  // unsigned 32-bit comparisons, so unsigned values are compared as signed
+  // values after flipping their sign bits.
+  const size_t kVectorSize = 4;
+  const __m128i sign_bit = _mm_set1_epi32(static_cast<int32_t>(kSignBit));
+  const __m128i magnitude_bits =
+      _mm_set1_epi32(static_cast<int32_t>(~kSignBit));
+  const __m128 magnitude_mask = _mm_castsi128_ps(magnitude_bits);
+  const __m128 smallest_normal =
+      _mm_set1_ps(std::numeric_limits<float>::min());
+  const __m128 absolute_tolerance = _mm_set1_ps(tolerance.absolute);
+  const __m128 relative_tolerance = _mm_set1_ps(tolerance.relative);
+  const __m128i flipped_ulp_tolerance =
+      _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(tolerance.ulps)),
+                    sign_bit);
+  __m128 max_absolute = _mm_set1_ps(errors->max_absolute);
+  __m128 max_relative = _mm_set1_ps(errors->max_relative);
+  __m128i flipped_max_ulps = _mm_xor_si128(
+      _mm_set1_epi32(static_cast<int32_t>(errors->max_ulps)), sign_bit);
+  for (; index + kVectorSize <= count; index += kVectorSize) {
+    const __m128 value_1 = _mm_loadu_ps(static_cast<const float*>(
+        static_cast<const void*>(data_1 + index * sizeof(float))));
+    const __m128 value_2 = _mm_loadu_ps(static_cast<const float*>(
+        static_cast<const void*>(data_2 + index * sizeof(float))));
+    const __m128i bits_1 = _mm_castps_si128(value_1);
+    const __m128i bits_2 = _mm_castps_si128(value_2);
+    const __m128i bitwise_equal = _mm_cmpeq_epi32(bits_1, bits_2);
+    const __m128i neither_is_nan =
+        _mm_castps_si128(_mm_cmpord_ps(value_1, value_2));
+
+    const __m128 absolute =
+        _mm_and_ps(_mm_sub_ps(value_1, value_2), magnitude_mask);
+    const __m128 magnitude = _mm_max_ps(_mm_and_ps(value_1, magnitude_mask),
+                                        _mm_and_ps(value_2, magnitude_mask));
+    const __m128 relative =
+        _mm_div_ps(absolute, _mm_max_ps(magnitude, smallest_normal));
+
+    // Negates the magnitudes of negative floats to order them as integers.
+    const __m128i sign_1 = _mm_srai_epi32(bits_1, 31);
+    const __m128i sign_2 = _mm_srai_epi32(bits_2, 31);
+    const __m128i ordered_1 = _mm_sub_epi32(
+        _mm_xor_si128(_mm_and_si128(bits_1, magnitude_bits), sign_1), sign_1);
+    const __m128i ordered_2 = _mm_sub_epi32(
+        _mm_xor_si128(_mm_and_si128(bits_2, magnitude_bits), sign_2), sign_2);
+    const __m128i ulps = Select(_mm_cmpgt_epi32(ordered_1, ordered_2),
+                                _mm_sub_epi32(ordered_1, ordered_2),
+                                _mm_sub_epi32(ordered_2, ordered_1));
+    const __m128i flipped_ulps = _mm_xor_si128(ulps, sign_bit);
+
+    const __m128i within_any = _mm_or_si128(
+        _mm_or_si128(
+            _mm_castps_si128(_mm_cmple_ps(absolute, absolute_tolerance)),
+            _mm_castps_si128(_mm_cmple_ps(relative, relative_tolerance))),
+        _mm_andnot_si128(
+            _mm_cmpgt_epi32(flipped_ulps, flipped_ulp_tolerance),
+            _mm_set1_epi32(-1)));
+    const __m128i within = _mm_or_si128(
+        bitwise_equal, _mm_and_si128(neither_is_nan, within_any));
+    if (_mm_movemask_ps(_mm_castsi128_ps(within)) != 0xF) {
+      break;
+    }
+
+    // NaN lanes are zeroed. _mm_max_ps returns its second operand if either
+    // is NaN, which leaves out the NaN differences of equal infinities and
+    // the NaN relative differences of infinities and finite values.
+    const __m128 counted = _mm_castsi128_ps(neither_is_nan);
+    max_absolute = _mm_max_ps(_mm_and_ps(absolute, counted), max_absolute);
+    max_relative = _mm_max_ps(_mm_and_ps(relative, counted), max_relative);
+    const __m128i flipped_counted_ulps =
+        _mm_xor_si128(_mm_and_si128(ulps, neither_is_nan), sign_bit);
+    flipped_max_ulps =
+        Select(_mm_cmpgt_epi32(flipped_counted_ulps, flipped_max_ulps),
+               flipped_counted_ulps, flipped_max_ulps);
+  }
+  errors->max_absolute = HorizontalMax(max_absolute);
+  errors->max_relative = HorizontalMax(max_relative);
+  uint32_t lanes[kVectorSize];
+  _mm_storeu_si128(static_cast<__m128i*>(static_cast<void*>(lanes)),
+                   _mm_xor_si128(flipped_max_ulps, sign_bit));
+  errors->max_ulps = *std::max_element(lanes, lanes + kVectorSize);
+#endif
+  return index + FindFirstFloatOutsideToleranceScalar(
+                     data_1 + index * sizeof(float),
+                     data_2 + index * sizeof(float), count - index, tolerance,
+                     errors);
+}
+
+size_t FindFirstFloatOutsideToleranceScalar(const uint8_t* data_1,
+                                            const uint8_t* data_2,
+                                            size_t count,
+                                            const FloatTolerance& tolerance,
+                                            FloatErrors* errors) {
+  for (size_t index = 0; index < count; index++) {
+    uint32_t bits_1;
+    uint32_t bits_2;
+    memcpy(&bits_1, data_1 + index * sizeof(float), sizeof(uint32_t));
+    memcpy(&bits_2, data_2 + index * sizeof(float), sizeof(uint32_t));
+    if (!IsWithinTolerance(bits_1, bits_2, tolerance, errors)) {
+      return index;
+    }
+  }
+  return count;
+}
+
+}  // namespace shadertrap
@@ -0,0 +1,73 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/framed_output_sink.h"
+
+namespace shadertrap {
+
+FramedOutputSink::FramedOutputSink(std::ostream* stream) : stream_(stream) {}
+
+bool FramedOutputSink::Write(const std::string& name, Kind kind,
+                             const uint8_t* data, size_t size) {
+  if (name.find('\n') != std::string::npos) {
+    // The name would break the header line.
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(mutex_);
+  *stream_ << "SHADERTRAP_OUTPUT " << KindToString(kind) << " " << size << " "
+           << name << "\n";
+  stream_->write(reinterpret_cast<const char*>(data),
+                 static_cast<std::streamsize>(size));
+  *stream_ << "\n";
+  stream_->flush();
+  return !stream_->fail();
+}
+
+bool FramedOutputSink::Begin(const std::string& name, Kind kind) {
+  if (name.find('\n') != std::string::npos) {
+    // The name would break the header line.
+    return false;
+  }
+  chunked_lock_ = std::unique_lock<std::mutex>(mutex_);
+  *stream_ << "SHADERTRAP_OUTPUT " << KindToString(kind) << " chunked " << name
+           << "\n";
+  return !stream_->fail();
+}
+
+bool FramedOutputSink::Append(const uint8_t* data, size_t size) {
+  if (!chunked_lock_.owns_lock()) {
+    return false;
+  }
+  if (size == 0) {
+    // An empty piece would end the output.
+    return true;
+  }
+  *stream_ << size << "\n";
+  stream_->write(reinterpret_cast<const char*>(data),
+                 static_cast<std::streamsize>(size));
+  *stream_ << "\n";
+  return !stream_->fail();
+}
+
+bool FramedOutputSink::End() {
+  if (!chunked_lock_.owns_lock()) {
+    return false;
+  }
+  *stream_ << "0\n";
+  stream_->flush();
+  chunked_lock_.unlock();
+  return !stream_->fail();
+}
+
+}  // namespace shadertrap
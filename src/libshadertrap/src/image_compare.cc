@@ -0,0 +1,584 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/image_compare.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <thread>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define SHADERTRAP_IMAGE_COMPARE_SSE2
+#endif
+
+namespace shadertrap {
+
+namespace {
+
+const size_t kNumRgbaChannels = 4;
+
+// SSIM windows are made of 2 x 2 blocks, so that the sums over each block are
+// shared by the four windows that overlap it.
+const size_t kBlockSize = kSsimWindowSize / 2;
+
+// Below this number of pixels, starting threads costs more than it saves.
+const size_t kMinPixelsPerThread = 1U << 16U;
+
+// The constants that stabilize the SSIM of windows with small means or
+// variances: (0.01 * 255)^2 and (0.03 * 255)^2.
+const double kSsimC1 = 6.5025;
+const double kSsimC2 = 58.5225;
+
+// Sums, for each channel, of the channel values in a block of both images, of
+// their squares, and of their products.
+struct BlockSums {
+  uint32_t sum_1[kNumRgbaChannels];
+  uint32_t sum_2[kNumRgbaChannels];
+  uint32_t sum_squares_1[kNumRgbaChannels];
+  uint32_t sum_squares_2[kNumRgbaChannels];
+  uint32_t sum_products[kNumRgbaChannels];
+};
+
+// Consecutive rows of the images being compared, shared by all threads.
+struct ImageRows {
+  // Row |first_row| of each image.
+  const uint8_t* data_1;
+  const uint8_t* data_2;
+  size_t first_row;
+  size_t width;
+  uint8_t channel_tolerance;
+  size_t num_window_columns;
+};
+
+// The differences found by one thread.
+struct BandDifferences {
+  uint64_t num_differing_pixels;
+  uint8_t max_channel_difference;
+  uint64_t sum_squared_errors;
+  double ssim_sums[kNumRgbaChannels];
+};
+
+#if defined(SHADERTRAP_IMAGE_COMPARE_SSE2)
+
+__m128i LoadVector(const void* data) {
+  return _mm_loadu_si128(static_cast<const __m128i*>(data));
+}
+
+void StoreVector(void* data, __m128i vector) {
+  _mm_storeu_si128(static_cast<__m128i*>(data), vector);
+}
+
+#endif
+
+// Adds the differences between the |num_pixels| pixels at |data_1| and
+// |data_2| to |differences|.
+void AccumulatePixelDifferences(const uint8_t* data_1, const uint8_t* data_2,
+                                size_t num_pixels, uint8_t channel_tolerance,
+                                BandDifferences* differences) {
+  size_t pixel = 0;
+#if defined(SHADERTRAP_IMAGE_COMPARE_SSE2)
+  // Four pixels are compared per iteration. A pixel differs if subtracting
+  // the tolerance from its channel differences, with saturation, leaves any
+  // of them non-zero.
+  const size_t kPixelsPerVector = sizeof(__m128i) / kNumRgbaChannels;
+  const int kNumSetBits[16] = {0, 1, 1, 2, 1, 2, 2, 3,
+                               1, 2, 2, 3, 2, 3, 3, 4};
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i tolerance =
+      _mm_set1_epi8(static_cast<char>(channel_tolerance));
+  __m128i max_difference = zero;
+  __m128i sum_squared_errors = zero;
+  for (; pixel + kPixelsPerVector <= num_pixels; pixel += kPixelsPerVector) {
+    const __m128i pixels_1 = LoadVector(data_1 + pixel * kNumRgbaChannels);
+    const __m128i pixels_2 = LoadVector(data_2 + pixel * kNumRgbaChannels);
+    const __m128i difference = _mm_or_si128(_mm_subs_epu8(pixels_1, pixels_2),
+                                            _mm_subs_epu8(pixels_2, pixels_1));
+    max_difference = _mm_max_epu8(max_difference, difference);
+    const __m128i within = _mm_cmpeq_epi32(
+        _mm_subs_epu8(difference, tolerance), zero);
+    differences->num_differing_pixels +=
+        kPixelsPerVector -
+        kNumSetBits[_mm_movemask_ps(_mm_castsi128_ps(within))];
+    const __m128i low = _mm_unpacklo_epi8(difference, zero);
+    const __m128i high = _mm_unpackhi_epi8(difference, zero);
+    const __m128i squares =
+        _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high));
+    sum_squared_errors = _mm_add_epi64(
+        _mm_add_epi64(sum_squared_errors, _mm_unpacklo_epi32(squares, zero)),
+        _mm_unpackhi_epi32(squares, zero));
+  }
+  uint8_t max_differences[sizeof(__m128i)];
+  StoreVector(max_differences, max_difference);
+  differences->max_channel_difference = std::max(
+      differences->max_channel_difference,
+      *std::max_element(max_differences,
+                        max_differences + sizeof(max_differences)));
+  uint64_t sums[2];
+  StoreVector(sums, sum_squared_errors);
+  differences->sum_squared_errors += sums[0] + sums[1];
+#endif
+  for (; pixel < num_pixels; pixel++) {
+    bool differs = false;
+    for (size_t channel = 0; channel < kNumRgbaChannels; channel++) {
+      const size_t index = pixel * kNumRgbaChannels + channel;
+      const auto difference = static_cast<uint8_t>(
+          std::max(data_1[index], data_2[index]) -
+          std::min(data_1[index], data_2[index]));
+      differs = differs || difference > channel_tolerance;
+      differences->max_channel_difference =
+          std::max(differences->max_channel_difference, difference);
+      differences->sum_squared_errors +=
+          static_cast<uint64_t>(difference) * difference;
+    }
+    if (differs) {
+      differences->num_differing_pixels++;
+    }
+  }
+}
+
+#if defined(SHADERTRAP_IMAGE_COMPARE_SSE2)
+
+// Rearranges the 16-bit channels r0 g0 b0 a0 r1 g1 b1 a1 of two pixels into
+// r0 r1 g0 g1 b0 b1 a0 a1, so that _mm_madd_epi16 adds the results for the
+// same channel of both pixels.
+__m128i PairChannels(__m128i pixels) {
+  return _mm_unpacklo_epi16(pixels, _mm_srli_si128(pixels, 8));
+}
+
+#endif
+
+// Computes the sums of the |num_blocks| blocks that start at |data_1| and
+// |data_2| and lie side by side, in images whose rows are |row_size| bytes.
+void ComputeBlockSums(const uint8_t* data_1, const uint8_t* data_2,
+                      size_t row_size, size_t num_blocks, BlockSums* sums) {
+  const size_t block_row_size = kBlockSize * kNumRgbaChannels;
+  for (size_t block = 0; block < num_blocks; block++) {
+#if defined(SHADERTRAP_IMAGE_COMPARE_SSE2)
+    // A row of a block is exactly one vector of four pixels.
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i sum_1 = zero;
+    __m128i sum_2 = zero;
+    __m128i sum_squares_1 = zero;
+    __m128i sum_squares_2 = zero;
+    __m128i sum_products = zero;
+    for (size_t y = 0; y < kBlockSize; y++) {
+      const size_t offset = y * row_size + block * block_row_size;
+      const __m128i pixels_1 = LoadVector(data_1 + offset);
+      const __m128i pixels_2 = LoadVector(data_2 + offset);
+      const __m128i halves_1[2] = {
+          PairChannels(_mm_unpacklo_epi8(pixels_1, zero)),
+          PairChannels(_mm_unpackhi_epi8(pixels_1, zero))};
+      const __m128i halves_2[2] = {
+          PairChannels(_mm_unpacklo_epi8(pixels_2, zero)),
+          PairChannels(_mm_unpackhi_epi8(pixels_2, zero))};
+      for (size_t half = 0; half < 2; half++) {
+        sum_1 = _mm_add_epi32(sum_1, _mm_madd_epi16(halves_1[half], ones));
+        sum_2 = _mm_add_epi32(sum_2, _mm_madd_epi16(halves_2[half], ones));
+        sum_squares_1 = _mm_add_epi32(
+            sum_squares_1, _mm_madd_epi16(halves_1[half], halves_1[half]));
+        sum_squares_2 = _mm_add_epi32(
+            sum_squares_2, _mm_madd_epi16(halves_2[half], halves_2[half]));
+        sum_products = _mm_add_epi32(
+            sum_products, _mm_madd_epi16(halves_1[half], halves_2[half]));
+      }
+    }
+    BlockSums* block_sums = &sums[block];
+    StoreVector(block_sums->sum_1, sum_1);
+    StoreVector(block_sums->sum_2, sum_2);
+    StoreVector(block_sums->sum_squares_1, sum_squares_1);
+    StoreVector(block_sums->sum_squares_2, sum_squares_2);
+    StoreVector(block_sums->sum_products, sum_products);
+#else
+    BlockSums* block_sums = &sums[block];
+    *block_sums = BlockSums();
+    for (size_t y = 0; y < kBlockSize; y++) {
+      for (size_t index = 0; index < block_row_size; index++) {
+        const size_t offset = y * row_size + block * block_row_size + index;
+        const uint32_t value_1 = data_1[offset];
+        const uint32_t value_2 = data_2[offset];
+        const size_t channel = index % kNumRgbaChannels;
+        block_sums->sum_1[channel] += value_1;
+        block_sums->sum_2[channel] += value_2;
+        block_sums->sum_squares_1[channel] += value_1 * value_1;
+        block_sums->sum_squares_2[channel] += value_2 * value_2;
+        block_sums->sum_products[channel] += value_1 * value_2;
+      }
+    }
+#endif
+  }
+}
+
+#if defined(SHADERTRAP_IMAGE_COMPARE_SSE2)
+
+// Returns the sums of the unsigned 32-bit lanes of |a|, |b|, |c| and |d| as
+// doubles, with the sums of lanes 0 and 1 in |low| and of lanes 2 and 3 in
+// |high|.
+void SumAsDoubles(const uint32_t* a, const uint32_t* b, const uint32_t* c,
+                  const uint32_t* d, __m128d* low, __m128d* high) {
+  // Each sum is below 2^31, so it can be converted as a signed integer.
+  const __m128i sum = _mm_add_epi32(
+      _mm_add_epi32(LoadVector(a), LoadVector(b)),
+      _mm_add_epi32(LoadVector(c), LoadVector(d)));
+  *low = _mm_cvtepi32_pd(sum);
+  *high = _mm_cvtepi32_pd(_mm_srli_si128(sum, 8));
+}
+
+// Returns the SSIM of a window for two channels at once, computed as by
+// ComputeSsim.
+__m128d ComputeSsimPair(__m128d sum_1, __m128d sum_2, __m128d sum_squares_1,
+                        __m128d sum_squares_2, __m128d sum_products) {
+  const double n = kSsimWindowSize * kSsimWindowSize;
+  const __m128d window_area = _mm_set1_pd(n);
+  const __m128d c1 = _mm_set1_pd(kSsimC1 * n * n);
+  const __m128d c2 = _mm_set1_pd(kSsimC2 * n * n);
+  const __m128d two = _mm_set1_pd(2.0);
+  const __m128d product_of_sums = _mm_mul_pd(sum_1, sum_2);
+  const __m128d sum_of_squared_sums =
+      _mm_add_pd(_mm_mul_pd(sum_1, sum_1), _mm_mul_pd(sum_2, sum_2));
+  const __m128d numerator = _mm_mul_pd(
+      _mm_add_pd(_mm_mul_pd(two, product_of_sums), c1),
+      _mm_add_pd(
+          _mm_mul_pd(two, _mm_sub_pd(_mm_mul_pd(window_area, sum_products),
+                                     product_of_sums)),
+          c2));
+  const __m128d denominator = _mm_mul_pd(
+      _mm_add_pd(sum_of_squared_sums, c1),
+      _mm_add_pd(
+          _mm_sub_pd(_mm_mul_pd(window_area,
+                                _mm_add_pd(sum_squares_1, sum_squares_2)),
+                     sum_of_squared_sums),
+          c2));
+  return _mm_div_pd(numerator, denominator);
+}
+
+#else
+
+// Returns the SSIM of a window from the sums over its pixels of the values of
+// a channel in both images, of their squares and of their products.
+// Multiplying the numerator and denominator of the usual definition by n^4,
+// for a window of n pixels, leaves only integers below 2^53 to be added and
+// subtracted, so the variances and covariance are computed exactly.
+double ComputeSsim(double sum_1, double sum_2, double sum_squares_1,
+                   double sum_squares_2, double sum_products) {
+  const double n = kSsimWindowSize * kSsimWindowSize;
+  const double product_of_sums = sum_1 * sum_2;
+  const double sum_of_squared_sums = sum_1 * sum_1 + sum_2 * sum_2;
+  return ((2.0 * product_of_sums + kSsimC1 * n * n) *
+          (2.0 * (n * sum_products - product_of_sums) + kSsimC2 * n * n)) /
+         ((sum_of_squared_sums + kSsimC1 * n * n) *
+          (n * (sum_squares_1 + sum_squares_2) - sum_of_squared_sums +
+           kSsimC2 * n * n));
+}
+
+#endif
+
+// Adds, for each channel, the SSIM of the window made of the blocks whose sums
+// are |top_left|, |top_right|, |bottom_left| and |bottom_right| to
+// |ssim_sums|.
+void AccumulateWindowSsim(const BlockSums& top_left, const BlockSums& top_right,
+                          const BlockSums& bottom_left,
+                          const BlockSums& bottom_right, double* ssim_sums) {
+#if defined(SHADERTRAP_IMAGE_COMPARE_SSE2)
+  // Lanes 0 and 1 hold channels 0 and 1, and lanes 2 and 3 channels 2 and 3.
+  __m128d sums[5][2];
+  SumAsDoubles(top_left.sum_1, top_right.sum_1, bottom_left.sum_1,
+               bottom_right.sum_1, &sums[0][0], &sums[0][1]);
+  SumAsDoubles(top_left.sum_2, top_right.sum_2, bottom_left.sum_2,
+               bottom_right.sum_2, &sums[1][0], &sums[1][1]);
+  SumAsDoubles(top_left.sum_squares_1, top_right.sum_squares_1,
+               bottom_left.sum_squares_1, bottom_right.sum_squares_1,
+               &sums[2][0], &sums[2][1]);
+  SumAsDoubles(top_left.sum_squares_2, top_right.sum_squares_2,
+               bottom_left.sum_squares_2, bottom_right.sum_squares_2,
+               &sums[3][0], &sums[3][1]);
+  SumAsDoubles(top_left.sum_products, top_right.sum_products,
+               bottom_left.sum_products, bottom_right.sum_products,
+               &sums[4][0], &sums[4][1]);
+  for (size_t half = 0; half < 2; half++) {
+    _mm_storeu_pd(
+        ssim_sums + 2 * half,
+        _mm_add_pd(_mm_loadu_pd(ssim_sums + 2 * half),
+                   ComputeSsimPair(sums[0][half], sums[1][half], sums[2][half],
+                                   sums[3][half], sums[4][half])));
+  }
+#else
+  const BlockSums* blocks[4] = {&top_left, &top_right, &bottom_left,
+                                &bottom_right};
+  for (size_t channel = 0; channel < kNumRgbaChannels; channel++) {
+    uint32_t sum_1 = 0;
+    uint32_t sum_2 = 0;
+    uint32_t sum_squares_1 = 0;
+    uint32_t sum_squares_2 = 0;
+    uint32_t sum_products = 0;
+    for (const BlockSums* block : blocks) {
+      sum_1 += block->sum_1[channel];
+      sum_2 += block->sum_2[channel];
+      sum_squares_1 += block->sum_squares_1[channel];
+      sum_squares_2 += block->sum_squares_2[channel];
+      sum_products += block->sum_products[channel];
+    }
+    ssim_sums[channel] += ComputeSsim(sum_1, sum_2, sum_squares_1,
+                                      sum_squares_2, sum_products);
+  }
+#endif
+}
+
+// Adds the SSIM of the windows whose upper halves are the blocks in
+// |upper_blocks| and lower halves those in |lower_blocks| to |differences|.
+void AccumulateWindowRowSsim(const ImageRows& rows,
+                             const std::vector<BlockSums>& upper_blocks,
+                             const std::vector<BlockSums>& lower_blocks,
+                             BandDifferences* differences) {
+  for (size_t column = 0; column < rows.num_window_columns; column++) {
+    AccumulateWindowSsim(upper_blocks[column], upper_blocks[column + 1],
+                         lower_blocks[column], lower_blocks[column + 1],
+                         differences->ssim_sums);
+  }
+}
+
+// Compares the image rows [begin_row, end_row) of |rows|, and computes the
+// SSIM of the window rows [begin_window_row, end_window_row), all of whose
+// pixels must be in |rows|. Each block row's sums are computed just after its
+// pixels are compared, while they are still cached, and are used for the
+// window rows above and below it.
+void CompareBand(const ImageRows* rows, size_t begin_row, size_t end_row,
+                 size_t begin_window_row, size_t end_window_row,
+                 BandDifferences* differences) {
+  const size_t row_size = rows->width * kNumRgbaChannels;
+  auto row_offset = [rows, row_size](size_t row) -> size_t {
+    return (row - rows->first_row) * row_size;
+  };
+  const bool has_windows = begin_window_row < end_window_row;
+  size_t first_block_row = begin_row / kBlockSize;
+  size_t end_block_row = (end_row + kBlockSize - 1) / kBlockSize;
+  if (begin_row == end_row) {
+    first_block_row = begin_window_row;
+    end_block_row = begin_window_row;
+  }
+  if (has_windows) {
+    // Window row i is made of block rows i and i + 1.
+    first_block_row = std::min(first_block_row, begin_window_row);
+    end_block_row = std::max(end_block_row, end_window_row + 1);
+  }
+  const size_t num_block_columns = rows->num_window_columns + 1;
+  std::vector<BlockSums> upper_blocks(has_windows ? num_block_columns : 0);
+  std::vector<BlockSums> lower_blocks(has_windows ? num_block_columns : 0);
+  for (size_t block_row = first_block_row; block_row < end_block_row;
+       block_row++) {
+    for (size_t row = std::max(begin_row, block_row * kBlockSize);
+         row < std::min(end_row, (block_row + 1) * kBlockSize); row++) {
+      AccumulatePixelDifferences(rows->data_1 + row_offset(row),
+                                 rows->data_2 + row_offset(row), rows->width,
+                                 rows->channel_tolerance, differences);
+    }
+    if (has_windows && block_row >= begin_window_row &&
+        block_row <= end_window_row) {
+      const size_t offset = row_offset(block_row * kBlockSize);
+      ComputeBlockSums(rows->data_1 + offset, rows->data_2 + offset, row_size,
+                       num_block_columns, lower_blocks.data());
+      if (block_row > begin_window_row) {
+        AccumulateWindowRowSsim(*rows, upper_blocks, lower_blocks,
+                                differences);
+      }
+      std::swap(upper_blocks, lower_blocks);
+    }
+  }
+}
+
+// Does the work of CompareBand, splitting the block rows that hold the image
+// rows [begin_row, end_row) between threads, each of which compares its own
+// rows and computes the SSIM of the windows whose bottom edges are in them.
+// The results of the threads are then added to |differences|, so that no
+// synchronization is needed.
+void CompareBandInParallel(const ImageRows& rows, size_t begin_row,
+                           size_t end_row, size_t begin_window_row,
+                           size_t end_window_row,
+                           BandDifferences* differences) {
+  const size_t first_block_row = begin_row / kBlockSize;
+  const size_t num_block_rows =
+      (end_row + kBlockSize - 1) / kBlockSize - first_block_row;
+  const size_t num_threads = std::max<size_t>(
+      1, std::min<size_t>(std::thread::hardware_concurrency(),
+                          (end_row - begin_row) * rows.width /
+                              kMinPixelsPerThread));
+  std::vector<BandDifferences> thread_differences(num_threads,
+                                                  BandDifferences());
+  auto compare_part = [&rows, begin_row, end_row, begin_window_row,
+                       end_window_row, first_block_row, num_block_rows,
+                       num_threads, &thread_differences](size_t thread) {
+    const size_t part_begin =
+        first_block_row + num_block_rows * thread / num_threads;
+    const size_t part_end =
+        first_block_row + num_block_rows * (thread + 1) / num_threads;
+    const size_t part_begin_row =
+        std::max(begin_row, part_begin * kBlockSize);
+    const size_t part_end_row =
+        std::max(part_begin_row, std::min(end_row, part_end * kBlockSize));
+    const size_t part_begin_window_row =
+        std::max(begin_window_row, part_begin);
+    const size_t part_end_window_row = std::max(
+        part_begin_window_row, std::min(end_window_row, part_end));
+    CompareBand(&rows, part_begin_row, part_end_row, part_begin_window_row,
+                part_end_window_row, &thread_differences[thread]);
+  };
+  std::vector<std::thread> threads;
+  for (size_t thread = 1; thread < num_threads; thread++) {
+    threads.emplace_back(compare_part, thread);
+  }
+  compare_part(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (const auto& part : thread_differences) {
+    differences->num_differing_pixels += part.num_differing_pixels;
+    differences->max_channel_difference = std::max(
+        differences->max_channel_difference, part.max_channel_difference);
+    differences->sum_squared_errors += part.sum_squared_errors;
+    for (size_t channel = 0; channel < kNumRgbaChannels; channel++) {
+      differences->ssim_sums[channel] += part.ssim_sums[channel];
+    }
+  }
+}
+
+}  // namespace
+
+ImageComparer::ImageComparer(size_t width, size_t height,
+                             uint8_t channel_tolerance, bool compute_ssim)
+    : width_(width),
+      height_(height),
+      channel_tolerance_(channel_tolerance),
+      num_window_rows_(0),
+      num_window_columns_(0),
+      next_end_row_(height),
+      num_differing_pixels_(0),
+      max_channel_difference_(0),
+      sum_squared_errors_(0),
+      ssim_sums_{0.0, 0.0, 0.0, 0.0} {
+  if (compute_ssim && width >= kSsimWindowSize && height >= kSsimWindowSize) {
+    num_window_rows_ = (height - kSsimWindowSize) / kBlockSize + 1;
+    num_window_columns_ = (width - kSsimWindowSize) / kBlockSize + 1;
+  }
+}
+
+void ImageComparer::AddBand(size_t first_row, size_t num_rows,
+                            const uint8_t* band_1, const uint8_t* band_2) {
+  assert(first_row + num_rows == next_end_row_ &&
+         "Bands must be added from the top of the images down.");
+  const size_t end_row = first_row + num_rows;
+  const size_t row_size = width_ * kNumRgbaChannels;
+  // The windows whose bottom edges are in the band are computed now; those
+  // that also extend above it use the rows kept from the bands above.
+  const size_t begin_window_row = std::min(
+      (first_row + kBlockSize - 1) / kBlockSize, num_window_rows_);
+  const size_t end_window_row =
+      std::min((end_row + kBlockSize - 1) / kBlockSize, num_window_rows_);
+  const size_t end_inner_window_row =
+      end_row < kSsimWindowSize
+          ? begin_window_row
+          : std::max(begin_window_row,
+                     std::min(end_window_row,
+                              (end_row - kSsimWindowSize) / kBlockSize + 1));
+  BandDifferences differences = BandDifferences();
+  const ImageRows band = {band_1, band_2,
+                          first_row, width_,
+                          channel_tolerance_, num_window_columns_};
+  CompareBandInParallel(band, first_row, end_row, begin_window_row,
+                        end_inner_window_row, &differences);
+  if (end_inner_window_row < end_window_row) {
+    // The top rows of the band are joined to the rows kept from above it.
+    const size_t joined_first_row = end_inner_window_row * kBlockSize;
+    const size_t band_offset = (joined_first_row - first_row) * row_size;
+    std::vector<uint8_t> joined_1(band_1 + band_offset,
+                                  band_1 + num_rows * row_size);
+    std::vector<uint8_t> joined_2(band_2 + band_offset,
+                                  band_2 + num_rows * row_size);
+    joined_1.insert(joined_1.end(), overlap_1_.begin(), overlap_1_.end());
+    joined_2.insert(joined_2.end(), overlap_2_.begin(), overlap_2_.end());
+    const ImageRows joined = {joined_1.data(), joined_2.data(),
+                              joined_first_row, width_,
+                              channel_tolerance_, num_window_columns_};
+    CompareBand(&joined, joined_first_row, joined_first_row,
+                end_inner_window_row, end_window_row, &differences);
+  }
+  num_differing_pixels_ += differences.num_differing_pixels;
+  max_channel_difference_ =
+      std::max(max_channel_difference_, differences.max_channel_difference);
+  sum_squared_errors_ += differences.sum_squared_errors;
+  for (size_t channel = 0; channel < kNumRgbaChannels; channel++) {
+    ssim_sums_[channel] += differences.ssim_sums[channel];
+  }
+  if (num_window_rows_ > 0 && first_row > 0) {
+    // The rows kept are the bottom rows of the band, followed by the bottom
+    // rows kept from above it if the band is shorter than a window.
+    const size_t kept_band_bytes =
+        std::min<size_t>(num_rows, kSsimWindowSize) * row_size;
+    const size_t kept_overlap_bytes =
+        std::min(overlap_1_.size(),
+                 kSsimWindowSize * row_size - kept_band_bytes);
+    std::vector<uint8_t> overlap_1(band_1, band_1 + kept_band_bytes);
+    std::vector<uint8_t> overlap_2(band_2, band_2 + kept_band_bytes);
+    overlap_1.insert(overlap_1.end(), overlap_1_.begin(),
+                     overlap_1_.begin() +
+                         static_cast<std::ptrdiff_t>(kept_overlap_bytes));
+    overlap_2.insert(overlap_2.end(), overlap_2_.begin(),
+                     overlap_2_.begin() +
+                         static_cast<std::ptrdiff_t>(kept_overlap_bytes));
+    overlap_1_.swap(overlap_1);
+    overlap_2_.swap(overlap_2);
+  }
+  next_end_row_ = first_row;
+}
+
+ImageDifferences ImageComparer::GetDifferences() const {
+  assert(next_end_row_ == 0 && "Not every row has been added.");
+  ImageDifferences result = {num_differing_pixels_, max_channel_difference_,
+                             0.0, 1.0};
+  const size_t num_pixels = width_ * height_;
+  if (num_pixels > 0) {
+    result.mean_squared_error =
+        static_cast<double>(sum_squared_errors_) /
+        static_cast<double>(num_pixels * kNumRgbaChannels);
+  }
+  if (num_window_rows_ > 0) {
+    const auto num_windows =
+        static_cast<double>(num_window_rows_ * num_window_columns_);
+    for (double ssim_sum : ssim_sums_) {
+      result.ssim = std::min(result.ssim, ssim_sum / num_windows);
+    }
+  }
+  return result;
+}
+
+ImageDifferences CompareImages(const uint8_t* data_1, const uint8_t* data_2,
+                               size_t width, size_t height,
+                               uint8_t channel_tolerance, bool compute_ssim) {
+  ImageComparer comparer(width, height, channel_tolerance, compute_ssim);
+  comparer.AddBand(0, height, data_1, data_2);
+  return comparer.GetDifferences();
+}
+
+double ComputePsnr(double mean_squared_error) {
+  if (mean_squared_error == 0.0) {
+    return std::numeric_limits<double>::infinity();
+  }
+  return 10.0 * std::log10(255.0 * 255.0 / mean_squared_error);
+}
+
+}  // namespace shadertrap
@@ -0,0 +1,295 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/image_encoder.h"
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef SHADERTRAP_LODEPNG
+#include "lodepng/lodepng.h"
+#endif
+
+namespace shadertrap {
+
+namespace {
+
+const size_t kNumRgbaChannels = 4;
+
+void AppendString(const std::string& text, std::vector<std::uint8_t>* encoded) {
+  encoded->insert(encoded->end(), text.begin(), text.end());
+}
+
+void AppendUint32LittleEndian(uint32_t value,
+                              std::vector<std::uint8_t>* encoded) {
+  for (size_t i = 0; i < 4; i++) {
+    encoded->push_back(static_cast<std::uint8_t>(value >> (8 * i)));
+  }
+}
+
+void AppendUint32BigEndian(uint32_t value, std::vector<std::uint8_t>* encoded) {
+  for (size_t i = 0; i < 4; i++) {
+    encoded->push_back(static_cast<std::uint8_t>(value >> (8 * (3 - i))));
+  }
+}
+
+#ifdef SHADERTRAP_LODEPNG
+bool EncodePng(const std::vector<std::uint8_t>& data, size_t width,
+               size_t height, int compression_level,
+               std::vector<std::uint8_t>* encoded, std::string* error) {
+  lodepng::State state;
+  if (compression_level != kDefaultPngCompressionLevel) {
+    const auto level = static_cast<unsigned int>(compression_level);
+    // Choosing a smaller color type and choosing a filter for each row both
+    // take extra passes over the image, so are left to the higher levels.
+    state.encoder.auto_convert = level >= 6 ? 1U : 0U;
+    state.encoder.filter_strategy = level >= 3 ? LFS_MINSUM : LFS_ZERO;
+    LodePNGCompressSettings& zlib_settings = state.encoder.zlibsettings;
+    if (level == 0) {
+      // Stored deflate blocks, with no compression at all.
+      zlib_settings.btype = 0;
+      zlib_settings.use_lz77 = 0;
+    } else {
+      zlib_settings.btype = 2;
+      zlib_settings.use_lz77 = 1;
+      zlib_settings.windowsize = std::min(32768U, 256U << level);
+      zlib_settings.nicematch = std::min(258U, 32U * level);
+      zlib_settings.lazymatching = level >= 4 ? 1U : 0U;
+    }
+  }
+  unsigned png_error =
+      lodepng::encode(*encoded, data, static_cast<unsigned int>(width),
+                      static_cast<unsigned int>(height), state);
+  if (png_error != 0) {
+    *error = lodepng_error_text(png_error);
+    return false;
+  }
+  return true;
+}
+#endif
+
+}  // namespace
+
+std::string ImageFormatToString(ImageFormat format) {
+  switch (format) {
+    case ImageFormat::kPng:
+      return "PNG";
+    case ImageFormat::kPpm:
+      return "PPM";
+    case ImageFormat::kPam:
+      return "PAM";
+    case ImageFormat::kRaw:
+      return "RAW";
+    case ImageFormat::kQoi:
+      return "QOI";
+  }
+  assert(false && "Unknown image format.");
+  return "";
+}
+
+bool EncodeImage(const std::vector<std::uint8_t>& data, size_t width,
+                 size_t height, ImageFormat format, int compression_level,
+                 std::vector<std::uint8_t>* encoded, std::string* error) {
+  assert(data.size() == width * height * kNumRgbaChannels &&
+         "Image data has the wrong size.");
+  encoded->clear();
+  switch (format) {
+    case ImageFormat::kPng:
+#ifdef SHADERTRAP_LODEPNG
+      return EncodePng(data, width, height, compression_level, encoded, error);
+#else
+      (void)compression_level;
+      *error = "PNG support is not available";
+      return false;
+#endif
+    case ImageFormat::kPpm:
+    case ImageFormat::kPam:
+    case ImageFormat::kRaw:
+    case ImageFormat::kQoi: {
+      ImageRowEncoder encoder(format, width, height);
+      encoder.EncodeHeader(encoded);
+      encoder.EncodeRows(data.data(), height, encoded);
+      encoder.EncodeEnd(encoded);
+      return true;
+    }
+  }
+  assert(false && "Unknown image format.");
+  return false;
+}
+
+bool ImageRowEncoder::SupportsFormat(ImageFormat format) {
+  return format != ImageFormat::kPng;
+}
+
+ImageRowEncoder::ImageRowEncoder(ImageFormat format, size_t width,
+                                 size_t height)
+    : format_(format),
+      width_(width),
+      height_(height),
+      qoi_previous_{0, 0, 0, 255},
+      qoi_seen_{},
+      qoi_run_length_(0) {
+  assert(SupportsFormat(format) && "Unsupported image format.");
+}
+
+void ImageRowEncoder::EncodeHeader(std::vector<std::uint8_t>* encoded) {
+  switch (format_) {
+    case ImageFormat::kPpm:
+      AppendString("P6\n" + std::to_string(width_) + " " +
+                       std::to_string(height_) + "\n255\n",
+                   encoded);
+      return;
+    case ImageFormat::kPam:
+      AppendString("P7\nWIDTH " + std::to_string(width_) + "\nHEIGHT " +
+                       std::to_string(height_) +
+                       "\nDEPTH 4\nMAXVAL 255\nTUPLTYPE RGB_ALPHA\nENDHDR\n",
+                   encoded);
+      return;
+    case ImageFormat::kRaw:
+      AppendString("RGBA", encoded);
+      AppendUint32LittleEndian(static_cast<uint32_t>(width_), encoded);
+      AppendUint32LittleEndian(static_cast<uint32_t>(height_), encoded);
+      return;
+    case ImageFormat::kQoi:
+      AppendString("qoif", encoded);
+      AppendUint32BigEndian(static_cast<uint32_t>(width_), encoded);
+      AppendUint32BigEndian(static_cast<uint32_t>(height_), encoded);
+      // Four channels, in the sRGB color space with linear alpha.
+      encoded->push_back(4);
+      encoded->push_back(0);
+      return;
+    case ImageFormat::kPng:
+      break;
+  }
+  assert(false && "Unsupported image format.");
+}
+
+void ImageRowEncoder::EncodeRows(const std::uint8_t* data, size_t num_rows,
+                                 std::vector<std::uint8_t>* encoded) {
+  const size_t num_pixels = width_ * num_rows;
+  switch (format_) {
+    case ImageFormat::kPpm: {
+      // The alpha channel is discarded.
+      const size_t start = encoded->size();
+      encoded->resize(start + num_pixels * 3);
+      std::uint8_t* output = encoded->data() + start;
+      for (size_t pixel = 0; pixel < num_pixels; pixel++) {
+        const std::uint8_t* input = data + pixel * kNumRgbaChannels;
+        output[0] = input[0];
+        output[1] = input[1];
+        output[2] = input[2];
+        output += 3;
+      }
+      return;
+    }
+    case ImageFormat::kPam:
+    case ImageFormat::kRaw:
+      encoded->insert(encoded->end(), data,
+                      data + num_pixels * kNumRgbaChannels);
+      return;
+    case ImageFormat::kQoi:
+      EncodeQoiPixels(data, num_pixels, encoded);
+      return;
+    case ImageFormat::kPng:
+      break;
+  }
+  assert(false && "Unsupported image format.");
+}
+
+void ImageRowEncoder::EncodeEnd(std::vector<std::uint8_t>* encoded) {
+  if (format_ != ImageFormat::kQoi) {
+    return;
+  }
+  const std::uint8_t kOpRun = 0xc0;
+  if (qoi_run_length_ > 0) {
+    encoded->push_back(
+        static_cast<std::uint8_t>(kOpRun | (qoi_run_length_ - 1)));
+    qoi_run_length_ = 0;
+  }
+  // The end marker.
+  encoded->insert(encoded->end(), {0, 0, 0, 0, 0, 0, 0, 1});
+}
+
+void ImageRowEncoder::EncodeQoiPixels(const std::uint8_t* data,
+                                      size_t num_pixels,
+                                      std::vector<std::uint8_t>* encoded) {
+  const std::uint8_t kOpIndex = 0x00;
+  const std::uint8_t kOpDiff = 0x40;
+  const std::uint8_t kOpLuma = 0x80;
+  const std::uint8_t kOpRun = 0xc0;
+  const std::uint8_t kOpRgb = 0xfe;
+  const std::uint8_t kOpRgba = 0xff;
+  const size_t kMaxRunLength = 62;
+
+  // The output is usually much smaller than the raw pixels, so half of their
+  // size is reserved rather than the worst case of 5 bytes per pixel; the
+  // vector grows if more is needed.
+  encoded->reserve(encoded->size() + num_pixels * kNumRgbaChannels / 2);
+
+  std::uint8_t* previous = qoi_previous_;
+  for (size_t pixel = 0; pixel < num_pixels; pixel++) {
+    const std::uint8_t* current = data + pixel * kNumRgbaChannels;
+    if (std::equal(current, current + kNumRgbaChannels, previous)) {
+      qoi_run_length_++;
+      if (qoi_run_length_ == kMaxRunLength) {
+        encoded->push_back(
+            static_cast<std::uint8_t>(kOpRun | (qoi_run_length_ - 1)));
+        qoi_run_length_ = 0;
+      }
+      continue;
+    }
+    if (qoi_run_length_ > 0) {
+      encoded->push_back(
+          static_cast<std::uint8_t>(kOpRun | (qoi_run_length_ - 1)));
+      qoi_run_length_ = 0;
+    }
+    const size_t hash = (current[0] * 3U + current[1] * 5U + current[2] * 7U +
+                         current[3] * 11U) %
+                        kQoiIndexSize;
+    if (std::equal(current, current + kNumRgbaChannels, qoi_seen_[hash])) {
+      encoded->push_back(static_cast<std::uint8_t>(kOpIndex | hash));
+    } else {
+      std::copy(current, current + kNumRgbaChannels, qoi_seen_[hash]);
+      if (current[3] == previous[3]) {
+        // Channel differences wrap around, as the specification requires.
+        const auto diff_r = static_cast<int8_t>(current[0] - previous[0]);
+        const auto diff_g = static_cast<int8_t>(current[1] - previous[1]);
+        const auto diff_b = static_cast<int8_t>(current[2] - previous[2]);
+        const int diff_r_g = diff_r - diff_g;
+        const int diff_b_g = diff_b - diff_g;
+        if (diff_r >= -2 && diff_r <= 1 && diff_g >= -2 && diff_g <= 1 &&
+            diff_b >= -2 && diff_b <= 1) {
+          encoded->push_back(static_cast<std::uint8_t>(
+              kOpDiff | ((diff_r + 2) << 4) | ((diff_g + 2) << 2) |
+              (diff_b + 2)));
+        } else if (diff_r_g >= -8 && diff_r_g <= 7 && diff_g >= -32 &&
+                   diff_g <= 31 && diff_b_g >= -8 && diff_b_g <= 7) {
+          encoded->push_back(
+              static_cast<std::uint8_t>(kOpLuma | (diff_g + 32)));
+          encoded->push_back(static_cast<std::uint8_t>(((diff_r_g + 8) << 4) |
+                                                       (diff_b_g + 8)));
+        } else {
+          encoded->push_back(kOpRgb);
+          encoded->insert(encoded->end(), current, current + 3);
+        }
+      } else {
+        encoded->push_back(kOpRgba);
+        encoded->insert(encoded->end(), current, current + kNumRgbaChannels);
+      }
+    }
+    std::copy(current, current + kNumRgbaChannels, previous);
+  }
+}
+
+}  // namespace shadertrap
@@ -0,0 +1,171 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/image_writer.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace shadertrap {
+
+namespace {
+
+const size_t kNumRgbaChannels = 4;
+
+}  // namespace
+
+ImageWriter::ImageWriter(OutputSink* output_sink, size_t num_threads,
+                         size_t max_pending_bytes)
+    : output_sink_(output_sink),
+      num_jobs_running_(0),
+      pending_bytes_(0),
+      max_pending_bytes_(max_pending_bytes),
+      shutting_down_(false) {
+  for (size_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back(&ImageWriter::RunWorker, this);
+  }
+}
+
+ImageWriter::~ImageWriter() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    shutting_down_ = true;
+  }
+  job_runnable_.notify_all();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void ImageWriter::Write(const Token* start_token, const std::string& filename,
+                        ImageFormat format, int compression_level, size_t width,
+                        size_t height, std::vector<std::uint8_t> data) {
+  Job job{start_token, filename, format, compression_level,
+          width,       height,   std::move(data)};
+  if (threads_.empty()) {
+    std::string error = WriteImage(job);
+    if (!error.empty()) {
+      failures_.push_back({start_token, error});
+    }
+    return;
+  }
+  const size_t size_bytes = job.data.size();
+  std::unique_lock<std::mutex> lock(mutex_);
+  // An image larger than the limit is still accepted once nothing else is
+  // pending.
+  job_completed_.wait(lock, [this, size_bytes]() -> bool {
+    return pending_bytes_ == 0 ||
+           pending_bytes_ + size_bytes <= max_pending_bytes_;
+  });
+  pending_bytes_ += size_bytes;
+  queue_.push_back(std::move(job));
+  lock.unlock();
+  job_runnable_.notify_one();
+}
+
+void ImageWriter::WaitForFile(const std::string& filename) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  job_completed_.wait(lock, [this, &filename]() -> bool {
+    return files_being_written_.count(filename) == 0 &&
+           std::none_of(queue_.begin(), queue_.end(),
+                        [&filename](const Job& job) -> bool {
+                          return job.filename == filename;
+                        });
+  });
+}
+
+bool ImageWriter::Flush(MessageConsumer* message_consumer) {
+  std::vector<Failure> failures;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    job_completed_.wait(lock, [this]() -> bool {
+      return queue_.empty() && num_jobs_running_ == 0;
+    });
+    failures.swap(failures_);
+  }
+  for (const auto& failure : failures) {
+    message_consumer->Message(MessageConsumer::Severity::kError,
+                              failure.start_token, failure.message);
+  }
+  return failures.empty();
+}
+
+std::string ImageWriter::WriteImage(const Job& job) {
+#ifndef SHADERTRAP_LODEPNG
+  if (job.format == ImageFormat::kPng) {
+    // Without PNG support, PNG images are not written.
+    return "";
+  }
+#endif
+  const size_t row_bytes = job.width * kNumRgbaChannels;
+  std::vector<std::uint8_t> flipped_data(job.data.size());
+  for (size_t row = 0; row < job.height; row++) {
+    const std::uint8_t* source_row =
+        job.data.data() + (job.height - row - 1) * row_bytes;
+    std::copy(source_row, source_row + row_bytes,
+              flipped_data.data() + row * row_bytes);
+  }
+  const std::string format_name = ImageFormatToString(job.format);
+  std::vector<std::uint8_t> encoded;
+  std::string error;
+  if (!EncodeImage(flipped_data, job.width, job.height, job.format,
+                   job.compression_level, &encoded, &error)) {
+    return "Encoding " + format_name + " data for '" + job.filename +
+           "' failed: " + error;
+  }
+  if (!output_sink_->Write(job.filename, OutputSink::Kind::kImage,
+                           encoded.data(), encoded.size())) {
+    return "Writing " + format_name + " data to '" + job.filename + "' failed";
+  }
+  return "";
+}
+
+void ImageWriter::RunWorker() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    auto runnable_job = FindRunnableJob();
+    if (runnable_job == queue_.end()) {
+      if (shutting_down_ && queue_.empty()) {
+        return;
+      }
+      job_runnable_.wait(lock);
+      continue;
+    }
+    Job job = std::move(*runnable_job);
+    queue_.erase(runnable_job);
+    files_being_written_.insert(job.filename);
+    num_jobs_running_++;
+    lock.unlock();
+    std::string error = WriteImage(job);
+    lock.lock();
+    if (!error.empty()) {
+      failures_.push_back({job.start_token, error});
+    }
+    files_being_written_.erase(job.filename);
+    num_jobs_running_--;
+    pending_bytes_ -= job.data.size();
+    job_completed_.notify_all();
+    // A job that was waiting for the same file may now be able to run.
+    job_runnable_.notify_all();
+  }
+}
+
+std::deque<ImageWriter::Job>::iterator ImageWriter::FindRunnableJob() {
+  return std::find_if(queue_.begin(), queue_.end(),
+                      [this](const Job& job) -> bool {
+                        return files_being_written_.count(job.filename) == 0;
+                      });
+}
+
+}  // namespace shadertrap
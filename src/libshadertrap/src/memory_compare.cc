@@ -0,0 +1,110 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/memory_compare.h"
+
+#include <algorithm>
+#include <cstring>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define SHADERTRAP_MEMORY_COMPARE_X86
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define SHADERTRAP_MEMORY_COMPARE_NEON
+#endif
+
+namespace shadertrap {
+
+namespace {
+
+// Large enough for the cost of a memcmp call to be negligible, and small
+// enough that a differing block is cheap to scan.
+const size_t kBlockSize = 4096;
+
+// Returns the index of the first mismatching byte in the |size|-byte regions
+// |data_1| and |data_2|, or |size| if there is none.
+size_t FindFirstMismatchInBlock(const uint8_t* data_1, const uint8_t* data_2,
+                                size_t size) {
+  size_t index = 0;
+  // Whole vectors are compared until one that differs is found; the scalar
+  // loops below then locate the mismatch within it.
+#if defined(SHADERTRAP_MEMORY_COMPARE_X86) && defined(__AVX2__)
+  const size_t kVectorSize = sizeof(__m256i);
+  for (; index + kVectorSize <= size; index += kVectorSize) {
+    __m256i vector_1 = _mm256_loadu_si256(
+        static_cast<const __m256i*>(static_cast<const void*>(data_1 + index)));
+    __m256i vector_2 = _mm256_loadu_si256(
+        static_cast<const __m256i*>(static_cast<const void*>(data_2 + index)));
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(vector_1, vector_2)) != -1) {
+      break;
+    }
+  }
+#elif defined(SHADERTRAP_MEMORY_COMPARE_X86)
+  const size_t kVectorSize = sizeof(__m128i);
+  const int kAllBytesEqual = 0xFFFF;
+  for (; index + kVectorSize <= size; index += kVectorSize) {
+    __m128i vector_1 = _mm_loadu_si128(
+        static_cast<const __m128i*>(static_cast<const void*>(data_1 + index)));
+    __m128i vector_2 = _mm_loadu_si128(
+        static_cast<const __m128i*>(static_cast<const void*>(data_2 + index)));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(vector_1, vector_2)) !=
+        kAllBytesEqual) {
+      break;
+    }
+  }
+#elif defined(SHADERTRAP_MEMORY_COMPARE_NEON)
+  const size_t kVectorSize = sizeof(uint8x16_t);
+  for (; index + kVectorSize <= size; index += kVectorSize) {
+    uint64x2_t equal = vreinterpretq_u64_u8(
+        vceqq_u8(vld1q_u8(data_1 + index), vld1q_u8(data_2 + index)));
+    if ((vgetq_lane_u64(equal, 0) & vgetq_lane_u64(equal, 1)) != ~0ULL) {
+      break;
+    }
+  }
+#endif
+  for (; index + sizeof(uint64_t) <= size; index += sizeof(uint64_t)) {
+    uint64_t word_1;
+    uint64_t word_2;
+    memcpy(&word_1, data_1 + index, sizeof(uint64_t));
+    memcpy(&word_2, data_2 + index, sizeof(uint64_t));
+    if (word_1 != word_2) {
+      break;
+    }
+  }
+  for (; index < size; index++) {
+    if (data_1[index] != data_2[index]) {
+      return index;
+    }
+  }
+  return size;
+}
+
+}  // namespace
+
+size_t FindFirstMismatch(const uint8_t* data_1, const uint8_t* data_2,
+                         size_t size) {
+  for (size_t block_start = 0; block_start < size; block_start += kBlockSize) {
+    const size_t block_size = std::min(kBlockSize, size - block_start);
+    if (memcmp(data_1 + block_start, data_2 + block_start, block_size) != 0) {
+      return block_start + FindFirstMismatchInBlock(data_1 + block_start,
+                                                    data_2 + block_start,
+                                                    block_size);
+    }
+  }
+  return size;
+}
+
+}  // namespace shadertrap
@@ -0,0 +1,61 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/memory_output_sink.h"
+
+#include <utility>
+
+namespace shadertrap {
+
+bool MemoryOutputSink::Write(const std::string& name, Kind kind,
+                             const uint8_t* data, size_t size) {
+  Output output{kind, std::vector<uint8_t>(data, data + size)};
+  std::lock_guard<std::mutex> lock(mutex_);
+  outputs_[name] = std::move(output);
+  return true;
+}
+
+bool MemoryOutputSink::Begin(const std::string& name, Kind kind) {
+  pending_name_ = name;
+  pending_output_ = {kind, {}};
+  return true;
+}
+
+bool MemoryOutputSink::Append(const uint8_t* data, size_t size) {
+  pending_output_.data.insert(pending_output_.data.end(), data, data + size);
+  return true;
+}
+
+bool MemoryOutputSink::End() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  outputs_[pending_name_] = std::move(pending_output_);
+  pending_output_.data.clear();
+  return true;
+}
+
+std::map<std::string, MemoryOutputSink::Output> MemoryOutputSink::GetOutputs()
+    const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return outputs_;
+}
+
+std::map<std::string, MemoryOutputSink::Output>
+MemoryOutputSink::TakeOutputs() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<std::string, Output> result;
+  result.swap(outputs_);
+  return result;
+}
+
+}  // namespace shadertrap
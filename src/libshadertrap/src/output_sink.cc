@@ -0,0 +1,36 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/output_sink.h"
+
+#include <cassert>
+
+namespace shadertrap {
+
+OutputSink::~OutputSink() = default;
+
+const char* OutputSink::KindToString(Kind kind) {
+  switch (kind) {
+    case Kind::kBinary:
+      return "binary";
+    case Kind::kText:
+      return "text";
+    case Kind::kImage:
+      return "image";
+  }
+  assert(false && "Unknown output kind.");
+  return nullptr;
+}
+
+}  // namespace shadertrap
@@ -23,9 +23,13 @@
 #include <unordered_map>
 #include <utility>
 
+#include "libshadertrap/command_assert_buffer_hash.h"
 #include "libshadertrap/command_assert_equal.h"
+#include "libshadertrap/command_assert_matches_image.h"
 #include "libshadertrap/command_assert_pixels.h"
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
 #include "libshadertrap/command_assert_similar_emd_histogram.h"
+#include "libshadertrap/command_assert_similar_image.h"
 #include "libshadertrap/command_bind_sampler.h"
 #include "libshadertrap/command_bind_shader_storage_buffer.h"
 #include "libshadertrap/command_bind_texture.h"
@@ -36,15 +40,19 @@
 #include "libshadertrap/command_create_program.h"
 #include "libshadertrap/command_create_renderbuffer.h"
 #include "libshadertrap/command_create_sampler.h"
+#include "libshadertrap/command_create_texture_2d.h"
 #include "libshadertrap/command_declare_shader.h"
 #include "libshadertrap/command_dump_buffer_binary.h"
 #include "libshadertrap/command_dump_buffer_text.h"
 #include "libshadertrap/command_dump_renderbuffer.h"
 #include "libshadertrap/command_run_compute.h"
+#include "libshadertrap/command_run_compute_indirect.h"
 #include "libshadertrap/command_run_graphics.h"
 #include "libshadertrap/command_set_sampler_parameter.h"
 #include "libshadertrap/command_set_texture_parameter.h"
 #include "libshadertrap/command_set_uniform.h"
+#include "libshadertrap/command_update_buffer.h"
+#include "libshadertrap/image_encoder.h"
 #include "libshadertrap/make_unique.h"
 #include "libshadertrap/texture_parameter.h"
 #include "libshadertrap/token.h"
@@ -154,12 +162,20 @@ bool Parser::ParseApiVersion() {
 bool Parser::ParseCommand() {
   auto token = tokenizer_->PeekNextToken();
   switch (token->GetType()) {
+    case Token::Type::kKeywordAssertBufferHash:
+      return ParseCommandAssertBufferHash();
     case Token::Type::kKeywordAssertEqual:
       return ParseCommandAssertEqual();
+    case Token::Type::kKeywordAssertMatchesImage:
+      return ParseCommandAssertMatchesImage();
     case Token::Type::kKeywordAssertPixels:
       return ParseCommandAssertPixels();
+    case Token::Type::kKeywordAssertRenderbufferHash:
+      return ParseCommandAssertRenderbufferHash();
     case Token::Type::kKeywordAssertSimilarEmdHistogram:
       return ParseCommandAssertSimilarEmdHistogram();
+    case Token::Type::kKeywordAssertSimilarImage:
+      return ParseCommandAssertSimilarImage();
     case Token::Type::kKeywordBindSampler:
       return ParseCommandBindSampler();
     case Token::Type::kKeywordBindShaderStorageBuffer:
@@ -180,6 +196,8 @@ bool Parser::ParseCommand() {
       return ParseCommandCreateSampler();
     case Token::Type::kKeywordCreateRenderbuffer:
       return ParseCommandCreateRenderbuffer();
+    case Token::Type::kKeywordCreateTexture2d:
+      return ParseCommandCreateTexture2d();
     case Token::Type::kKeywordDeclareShader:
       return ParseCommandDeclareShader();
     case Token::Type::kKeywordDumpBufferBinary:
@@ -190,6 +208,8 @@ bool Parser::ParseCommand() {
       return ParseCommandDumpRenderbuffer();
     case Token::Type::kKeywordRunCompute:
       return ParseCommandRunCompute();
+    case Token::Type::kKeywordRunComputeIndirect:
+      return ParseCommandRunComputeIndirect();
     case Token::Type::kKeywordRunGraphics:
       return ParseCommandRunGraphics();
     case Token::Type::kKeywordSetSamplerParameter:
@@ -198,6 +218,8 @@ bool Parser::ParseCommand() {
       return ParseCommandSetTextureParameter();
     case Token::Type::kKeywordSetUniform:
       return ParseCommandSetUniform();
+    case Token::Type::kKeywordUpdateBuffer:
+      return ParseCommandUpdateBuffer();
     default:
       message_consumer_->Message(MessageConsumer::Severity::kError, token.get(),
                                  "Unknown command: '" + token->GetText() + "'");
@@ -205,16 +227,72 @@ bool Parser::ParseCommand() {
   }
 }
 
+bool Parser::ParseCommandAssertBufferHash() {
+  auto start_token = tokenizer_->NextToken();
+  std::unique_ptr<Token> buffer_identifier;
+  std::vector<CommandDumpBufferText::FormatEntry> format_entries;
+  std::unique_ptr<Token> expected_hash_token;
+  uint64_t expected_hash = 0;
+  if (!ParseParameters(
+          {{Token::Type::kKeywordBuffer,
+            [this, &buffer_identifier]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(MessageConsumer::Severity::kError,
+                                           token.get(),
+                                           "Expected buffer identifier, got '" +
+                                               token->GetText() + "'");
+                return false;
+              }
+              buffer_identifier = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordFormat,
+            [this, &format_entries]() -> bool {
+              if (!ParseFormatEntries(false, &format_entries)) {
+                return false;
+              }
+              if (format_entries.empty()) {
+                auto token = tokenizer_->PeekNextToken();
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected a formatting entry after FORMAT, got '" +
+                        token->GetText() + "'");
+                return false;
+              }
+              return true;
+            }},
+           {Token::Type::kKeywordHash,
+            [this, &expected_hash_token, &expected_hash]() -> bool {
+              return ParseHash(&expected_hash_token, &expected_hash);
+            }}},
+          {}, {Token::Type::kKeywordFormat})) {
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandAssertBufferHash>(
+      std::move(start_token), std::move(buffer_identifier),
+      std::move(format_entries), std::move(expected_hash_token),
+      expected_hash));
+  return true;
+}
+
 bool Parser::ParseCommandAssertEqual() {
   auto start_token = tokenizer_->NextToken();
   std::unique_ptr<Token> argument_identifier_1;
   std::unique_ptr<Token> argument_identifier_2;
   bool arguments_are_renderbuffers = false;
+  std::unique_ptr<Token> filename;
+  std::unique_ptr<Token> tolerance_token;
+  FloatTolerance tolerance = {0.0F, 0.0F, 0};
+  // Counts the BUFFERS, RENDERBUFFERS and BUFFER parameters, exactly one of
+  // which must be present.
+  size_t num_argument_parameters = 0;
   std::vector<CommandAssertEqual::FormatEntry> format_entries;
   if (!ParseParameters(
           {{Token::Type::kKeywordBuffers,
             [this, &arguments_are_renderbuffers, &argument_identifier_1,
-             &argument_identifier_2]() -> bool {
+             &argument_identifier_2, &num_argument_parameters]() -> bool {
+              num_argument_parameters++;
               arguments_are_renderbuffers = false;
               auto token = tokenizer_->NextToken();
               if (!token->IsIdentifier()) {
@@ -236,7 +314,8 @@ bool Parser::ParseCommandAssertEqual() {
             }},
            {Token::Type::kKeywordRenderbuffers,
             [this, &arguments_are_renderbuffers, &argument_identifier_1,
-             &argument_identifier_2]() -> bool {
+             &argument_identifier_2, &num_argument_parameters]() -> bool {
+              num_argument_parameters++;
               arguments_are_renderbuffers = true;
               auto token = tokenizer_->NextToken();
               if (!token->IsIdentifier()) {
@@ -257,6 +336,32 @@ bool Parser::ParseCommandAssertEqual() {
               return true;
             }},
 
+           {Token::Type::kKeywordBuffer,
+            [this, &argument_identifier_1,
+             &num_argument_parameters]() -> bool {
+              num_argument_parameters++;
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected identifier for buffer to be compared");
+                return false;
+              }
+              argument_identifier_1 = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordFile,
+            [this, &filename]() -> bool {
+              filename = tokenizer_->NextToken();
+              if (!filename->IsString()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, filename.get(),
+                    "Expected file with which to compare buffer, got '" +
+                        filename->GetText() + "'");
+                return false;
+              }
+              return true;
+            }},
            {Token::Type::kKeywordFormat,
             [this, &format_entries, &start_token]() -> bool {
               bool seen_at_least_one_format_entry = false;
@@ -307,11 +412,38 @@ bool Parser::ParseCommandAssertEqual() {
                 format_entries.push_back(
                     {std::move(format_start_token), kind, count});
               }
+            }},
+           {Token::Type::kKeywordTolerance,
+            [this, &tolerance_token, &tolerance]() -> bool {
+              return ParseFloatTolerance(&tolerance_token, &tolerance);
             }}},
-          // BUFFERS and RENDERBUFFERS are mutually exclusive parameters
-          {{Token::Type::kKeywordBuffers, Token::Type::kKeywordRenderbuffers}},
-
-          {Token::Type::kKeywordFormat})) {
+          {},
+          {Token::Type::kKeywordBuffers, Token::Type::kKeywordRenderbuffers,
+           Token::Type::kKeywordBuffer, Token::Type::kKeywordFile,
+           Token::Type::kKeywordFormat, Token::Type::kKeywordTolerance})) {
+    return false;
+  }
+  // BUFFERS, RENDERBUFFERS and BUFFER are mutually exclusive parameters, and
+  // FILE goes with BUFFER.
+  if (num_argument_parameters != 1) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        num_argument_parameters == 0 ? tokenizer_->PeekNextToken().get()
+                                     : start_token.get(),
+        num_argument_parameters == 0
+            ? "Missing parameter 'BUFFERS', 'RENDERBUFFERS' or 'BUFFER'"
+            : "Only one of the parameters 'BUFFERS', 'RENDERBUFFERS' and "
+              "'BUFFER' can be present");
+    return false;
+  }
+  const bool compares_with_file = argument_identifier_2 == nullptr;
+  if (compares_with_file != (filename != nullptr)) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError,
+        compares_with_file ? tokenizer_->PeekNextToken().get()
+                           : filename.get(),
+        compares_with_file ? "Missing parameter 'FILE'"
+                           : "Parameter 'FILE' can only be used with 'BUFFER'");
     return false;
   }
   if (arguments_are_renderbuffers) {
@@ -322,19 +454,71 @@ bool Parser::ParseCommandAssertEqual() {
                                  "for renderbuffers arguments");
       return false;
     }
+    if (tolerance_token != nullptr) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError, tolerance_token.get(),
+          "TOLERANCE cannot be used with renderbuffer arguments");
+      return false;
+    }
     parsed_commands_.push_back(MakeUnique<CommandAssertEqual>(
         std::move(start_token), std::move(argument_identifier_1),
         std::move(argument_identifier_2)));
     return true;
   }
 
+  if (compares_with_file) {
+    parsed_commands_.push_back(MakeUnique<CommandAssertEqual>(
+        std::move(start_token), std::move(argument_identifier_1),
+        std::move(format_entries), std::move(filename),
+        std::move(tolerance_token), tolerance));
+    return true;
+  }
+
   parsed_commands_.push_back(MakeUnique<CommandAssertEqual>(
       std::move(start_token), std::move(argument_identifier_1),
-      std::move(argument_identifier_2), std::move(format_entries)));
+      std::move(argument_identifier_2), std::move(format_entries),
+      std::move(tolerance_token), tolerance));
 
   return true;
 }
 
+bool Parser::ParseCommandAssertMatchesImage() {
+  auto start_token = tokenizer_->NextToken();
+  std::unique_ptr<Token> renderbuffer_identifier;
+  std::unique_ptr<Token> filename;
+  if (!ParseParameters(
+          {{Token::Type::kKeywordRenderbuffer,
+            [this, &renderbuffer_identifier]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected renderbuffer identifier, got '" +
+                        token->GetText() + "'");
+                return false;
+              }
+              renderbuffer_identifier = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordFile, [this, &filename]() -> bool {
+              filename = tokenizer_->NextToken();
+              if (!filename->IsString()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, filename.get(),
+                    "Expected file with which to compare renderbuffer, got '" +
+                        filename->GetText() + "'");
+                return false;
+              }
+              return true;
+            }}})) {
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandAssertMatchesImage>(
+      std::move(start_token), std::move(renderbuffer_identifier),
+      std::move(filename)));
+  return true;
+}
+
 bool Parser::ParseCommandAssertPixels() {
   auto start_token = tokenizer_->NextToken();
   uint8_t expected_r;
@@ -423,6 +607,37 @@ bool Parser::ParseCommandAssertPixels() {
   return true;
 }
 
+bool Parser::ParseCommandAssertRenderbufferHash() {
+  auto start_token = tokenizer_->NextToken();
+  std::unique_ptr<Token> renderbuffer_identifier;
+  std::unique_ptr<Token> expected_hash_token;
+  uint64_t expected_hash = 0;
+  if (!ParseParameters(
+          {{Token::Type::kKeywordRenderbuffer,
+            [this, &renderbuffer_identifier]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected renderbuffer identifier, got '" +
+                        token->GetText() + "'");
+                return false;
+              }
+              renderbuffer_identifier = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordHash,
+            [this, &expected_hash_token, &expected_hash]() -> bool {
+              return ParseHash(&expected_hash_token, &expected_hash);
+            }}})) {
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandAssertRenderbufferHash>(
+      std::move(start_token), std::move(renderbuffer_identifier),
+      std::move(expected_hash_token), expected_hash));
+  return true;
+}
+
 bool Parser::ParseCommandAssertSimilarEmdHistogram() {
   auto start_token = tokenizer_->NextToken();
   std::unique_ptr<Token> renderbuffer_identifier_1;
@@ -466,6 +681,107 @@ bool Parser::ParseCommandAssertSimilarEmdHistogram() {
   return true;
 }
 
+bool Parser::ParseCommandAssertSimilarImage() {
+  auto start_token = tokenizer_->NextToken();
+  std::unique_ptr<Token> renderbuffer_identifier_1;
+  std::unique_ptr<Token> renderbuffer_identifier_2;
+  std::unique_ptr<Token> tolerance_token;
+  uint8_t channel_tolerance = 0;
+  std::unique_ptr<Token> max_differing_fraction_token;
+  float max_differing_fraction = 0.0F;
+  std::unique_ptr<Token> min_ssim_token;
+  float min_ssim = 0.0F;
+  std::unique_ptr<Token> min_psnr_token;
+  float min_psnr = 0.0F;
+  if (!ParseParameters(
+          {{Token::Type::kKeywordRenderbuffers,
+            [this, &renderbuffer_identifier_1,
+             &renderbuffer_identifier_2]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(MessageConsumer::Severity::kError,
+                                           token.get(),
+                                           "Expected identifier for first "
+                                           "renderbuffer to be compared");
+                return false;
+              }
+              renderbuffer_identifier_1 = std::move(token);
+              token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(MessageConsumer::Severity::kError,
+                                           token.get(),
+                                           "Expected identifier for second "
+                                           "renderbuffer to be compared");
+                return false;
+              }
+              renderbuffer_identifier_2 = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordTolerance,
+            [this, &tolerance_token, &channel_tolerance]() -> bool {
+              tolerance_token = tokenizer_->PeekNextToken();
+              auto maybe_tolerance = ParseUint8("channel tolerance");
+              if (!maybe_tolerance.first) {
+                return false;
+              }
+              channel_tolerance = maybe_tolerance.second;
+              return true;
+            }},
+           {Token::Type::kKeywordMaxDifferingFraction,
+            [this, &max_differing_fraction_token,
+             &max_differing_fraction]() -> bool {
+              auto maybe_fraction =
+                  ParseFloatInRange("maximum differing fraction", 0.0F, 1.0F,
+                                    &max_differing_fraction_token);
+              if (!maybe_fraction.first) {
+                return false;
+              }
+              max_differing_fraction = maybe_fraction.second;
+              return true;
+            }},
+           {Token::Type::kKeywordMinSsim,
+            [this, &min_ssim_token, &min_ssim]() -> bool {
+              auto maybe_ssim = ParseFloatInRange("minimum SSIM", -1.0F, 1.0F,
+                                                  &min_ssim_token);
+              if (!maybe_ssim.first) {
+                return false;
+              }
+              min_ssim = maybe_ssim.second;
+              return true;
+            }},
+           {Token::Type::kKeywordMinPsnr,
+            [this, &min_psnr_token, &min_psnr]() -> bool {
+              min_psnr_token = tokenizer_->PeekNextToken();
+              auto maybe_psnr = ParseFloat("minimum PSNR");
+              if (!maybe_psnr.first) {
+                return false;
+              }
+              min_psnr = maybe_psnr.second;
+              return true;
+            }}},
+          {},
+          {Token::Type::kKeywordTolerance,
+           Token::Type::kKeywordMaxDifferingFraction,
+           Token::Type::kKeywordMinSsim, Token::Type::kKeywordMinPsnr})) {
+    return false;
+  }
+  if (tolerance_token == nullptr && max_differing_fraction_token == nullptr &&
+      min_ssim_token == nullptr && min_psnr_token == nullptr) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, start_token.get(),
+        "ASSERT_SIMILAR_IMAGE requires at least one of TOLERANCE, "
+        "MAX_DIFFERING_FRACTION, MIN_SSIM and MIN_PSNR");
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandAssertSimilarImage>(
+      std::move(start_token), std::move(renderbuffer_identifier_1),
+      std::move(renderbuffer_identifier_2), std::move(tolerance_token),
+      channel_tolerance, std::move(max_differing_fraction_token),
+      max_differing_fraction, std::move(min_ssim_token), min_ssim,
+      std::move(min_psnr_token), min_psnr));
+  return true;
+}
+
 bool Parser::ParseCommandBindSampler() {
   auto start_token = tokenizer_->NextToken();
   std::unique_ptr<Token> sampler_identifier;
@@ -680,6 +996,9 @@ bool Parser::ParseCommandCreateBuffer() {
   size_t size_bytes;
   std::vector<ValuesSegment> values;
   std::unique_ptr<Token> size_in_bytes_token = nullptr;
+  // Buffers are streamed unless a usage is given, which suits buffers that
+  // are written once and then used for a small number of commands.
+  CommandCreateBuffer::Usage usage = CommandCreateBuffer::Usage::kStream;
   if (!ParseParameters(
           {{Token::Type::kKeywordSizeBytes,
             [this, &size_bytes, &size_in_bytes_token]() -> bool {
@@ -691,26 +1010,34 @@ bool Parser::ParseCommandCreateBuffer() {
               size_bytes = maybe_size.second;
               return true;
             }},
-           {Token::Type::kKeywordInitValues, [this, &values]() -> bool {
-              while (true) {
-                switch (tokenizer_->PeekNextToken()->GetType()) {
-                  case Token::Type::kKeywordTypeByte:
-                  case Token::Type::kKeywordTypeFloat:
-                  case Token::Type::kKeywordTypeInt:
-                  case Token::Type::kKeywordTypeUint: {
-                    std::pair<bool, ValuesSegment> maybe_values_segment =
-                        ParseValuesSegment();
-                    if (!maybe_values_segment.first) {
-                      return false;
-                    }
-                    values.push_back(maybe_values_segment.second);
-                    break;
-                  }
-                  default:
-                    return true;
-                }
+           {Token::Type::kKeywordInitValues,
+            [this, &values]() -> bool {
+              return ParseInitValues(&values, true);
+            }},
+           {Token::Type::kKeywordUsage,
+            [this, &usage]() -> bool {
+              auto token = tokenizer_->NextToken();
+              switch (token->GetType()) {
+                case Token::Type::kKeywordStatic:
+                  usage = CommandCreateBuffer::Usage::kStatic;
+                  return true;
+                case Token::Type::kKeywordDynamic:
+                  usage = CommandCreateBuffer::Usage::kDynamic;
+                  return true;
+                case Token::Type::kKeywordStream:
+                  usage = CommandCreateBuffer::Usage::kStream;
+                  return true;
+                case Token::Type::kKeywordRead:
+                  usage = CommandCreateBuffer::Usage::kRead;
+                  return true;
+                default:
+                  message_consumer_->Message(
+                      MessageConsumer::Severity::kError, token.get(),
+                      "Unknown buffer usage: '" + token->GetText() + "'");
+                  return false;
               }
-            }}})) {
+            }}},
+          {}, {Token::Type::kKeywordUsage})) {
     return false;
   }
   size_t actual_size =
@@ -728,7 +1055,7 @@ bool Parser::ParseCommandCreateBuffer() {
     return false;
   }
   parsed_commands_.push_back(MakeUnique<CommandCreateBuffer>(
-      std::move(start_token), std::move(result_identifier), values));
+      std::move(start_token), std::move(result_identifier), values, usage));
   return true;
 }
 
@@ -816,8 +1143,184 @@ bool Parser::ParseCommandCreateSampler() {
             token->GetText() + "'");
     return false;
   }
-  parsed_commands_.push_back(MakeUnique<CommandCreateSampler>(
-      std::move(start_token), std::move(token)));
+  parsed_commands_.push_back(MakeUnique<CommandCreateSampler>(
+      std::move(start_token), std::move(token)));
+  return true;
+}
+
+bool Parser::ParseCommandCreateTexture2d() {
+  auto start_token = tokenizer_->NextToken();
+  auto result_identifier = tokenizer_->NextToken();
+  if (!result_identifier->IsIdentifier()) {
+    message_consumer_->Message(MessageConsumer::Severity::kError,
+                               result_identifier.get(),
+                               "Expected identifier for texture, got '" +
+                                   result_identifier->GetText() + "'");
+    return false;
+  }
+  size_t width = 0;
+  size_t height = 0;
+  CommandCreateTexture2D::Format format =
+      CommandCreateTexture2D::Format::kRgba8;
+  std::unique_ptr<Token> width_token;
+  std::unique_ptr<Token> height_token;
+  std::unique_ptr<Token> format_token;
+  std::unique_ptr<Token> init_file;
+  std::unique_ptr<Token> init_values_token;
+  std::vector<ValuesSegment> values;
+  bool generate_mipmaps = false;
+  if (!ParseParameters(
+          {{Token::Type::kKeywordWidth,
+            [this, &width, &width_token]() -> bool {
+              width_token = tokenizer_->PeekNextToken();
+              auto maybe_width = ParseUint32("width");
+              if (!maybe_width.first) {
+                return false;
+              }
+              width = maybe_width.second;
+              return true;
+            }},
+           {Token::Type::kKeywordHeight,
+            [this, &height, &height_token]() -> bool {
+              height_token = tokenizer_->PeekNextToken();
+              auto maybe_height = ParseUint32("height");
+              if (!maybe_height.first) {
+                return false;
+              }
+              height = maybe_height.second;
+              return true;
+            }},
+           {Token::Type::kKeywordFormat,
+            [this, &format, &format_token]() -> bool {
+              format_token = tokenizer_->NextToken();
+              switch (format_token->GetType()) {
+                case Token::Type::kKeywordRgba8:
+                  format = CommandCreateTexture2D::Format::kRgba8;
+                  return true;
+                case Token::Type::kKeywordR8:
+                  format = CommandCreateTexture2D::Format::kR8;
+                  return true;
+                case Token::Type::kKeywordRg16f:
+                  format = CommandCreateTexture2D::Format::kRg16f;
+                  return true;
+                case Token::Type::kKeywordRgba32f:
+                  format = CommandCreateTexture2D::Format::kRgba32f;
+                  return true;
+                case Token::Type::kKeywordR32ui:
+                  format = CommandCreateTexture2D::Format::kR32ui;
+                  return true;
+                default:
+                  message_consumer_->Message(
+                      MessageConsumer::Severity::kError, format_token.get(),
+                      "Unknown texture format: '" + format_token->GetText() +
+                          "'");
+                  return false;
+              }
+            }},
+           {Token::Type::kKeywordInitFile,
+            [this, &init_file]() -> bool {
+              init_file = tokenizer_->NextToken();
+              if (!init_file->IsString()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, init_file.get(),
+                    "Expected image file from which to initialize texture, "
+                    "got '" +
+                        init_file->GetText() + "'");
+                return false;
+              }
+              return true;
+            }},
+           {Token::Type::kKeywordInitValues,
+            [this, &values, &init_values_token]() -> bool {
+              init_values_token = tokenizer_->PeekNextToken();
+              return ParseInitValues(&values, false);
+            }},
+           {Token::Type::kKeywordGenerateMipmaps,
+            [&generate_mipmaps]() -> bool {
+              generate_mipmaps = true;
+              return true;
+            }}},
+          {{Token::Type::kKeywordInitFile, Token::Type::kKeywordInitValues}},
+          {Token::Type::kKeywordWidth, Token::Type::kKeywordHeight,
+           Token::Type::kKeywordFormat,
+           Token::Type::kKeywordGenerateMipmaps})) {
+    return false;
+  }
+
+  if (init_file != nullptr) {
+    // The dimensions and format of a texture initialized from an image are
+    // those of the image, so they cannot be given separately.
+    for (const auto* token :
+         {width_token.get(), height_token.get(), format_token.get()}) {
+      if (token != nullptr) {
+        message_consumer_->Message(
+            MessageConsumer::Severity::kError, token,
+            "WIDTH, HEIGHT and FORMAT cannot be used with INIT_FILE; the "
+            "texture takes its dimensions from the image, and has format "
+            "RGBA8");
+        return false;
+      }
+    }
+    parsed_commands_.push_back(MakeUnique<CommandCreateTexture2D>(
+        std::move(start_token), std::move(result_identifier),
+        std::move(init_file), generate_mipmaps));
+    return true;
+  }
+
+  if (width_token == nullptr || height_token == nullptr) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, start_token.get(),
+        "WIDTH and HEIGHT are required when a texture is initialized with "
+        "INIT_VALUES");
+    return false;
+  }
+  ValuesSegment::ElementType expected_element_type =
+      ValuesSegment::ElementType::kByte;
+  std::string expected_element_type_name = "byte";
+  switch (format) {
+    case CommandCreateTexture2D::Format::kRgba8:
+    case CommandCreateTexture2D::Format::kR8:
+      break;
+    case CommandCreateTexture2D::Format::kRg16f:
+    case CommandCreateTexture2D::Format::kRgba32f:
+      expected_element_type = ValuesSegment::ElementType::kFloat;
+      expected_element_type_name = "float";
+      break;
+    case CommandCreateTexture2D::Format::kR32ui:
+      expected_element_type = ValuesSegment::ElementType::kUint;
+      expected_element_type_name = "uint";
+      break;
+  }
+  for (const auto& segment : values) {
+    if (segment.GetElementType() != expected_element_type) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError, init_values_token.get(),
+          "The initial values of a texture with format " +
+              CommandCreateTexture2D::FormatToString(format) + " must be " +
+              expected_element_type_name + " values");
+      return false;
+    }
+  }
+  size_t expected_size = width * height *
+                         CommandCreateTexture2D::GetTexelDataSizeBytes(format);
+  size_t actual_size =
+      std::accumulate(values.begin(), values.end(), size_t{0U},
+                      [](size_t a, const ValuesSegment& segment) {
+                        return a + segment.GetSizeBytes();
+                      });
+  if (expected_size != actual_size) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, init_values_token.get(),
+        "A " + std::to_string(width) + "x" + std::to_string(height) + " " +
+            CommandCreateTexture2D::FormatToString(format) + " texture needs " +
+            std::to_string(expected_size) +
+            " bytes of initial values, but the provided values occupy " +
+            std::to_string(actual_size) + " bytes");
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandCreateTexture2D>(
+      std::move(start_token), std::move(result_identifier), width, height,
+      format, values, generate_mipmaps));
   return true;
 }
 
@@ -825,9 +1328,7 @@ bool Parser::ParseCommandRunCompute() {
   auto start_token = tokenizer_->NextToken();
 
   std::unique_ptr<Token> program_identifier;
-  size_t num_groups_x;
-  size_t num_groups_y;
-  size_t num_groups_z;
+  std::vector<CommandRunCompute::NumGroups> num_groups;
 
   if (!ParseParameters(
           {{Token::Type::kKeywordProgram,
@@ -845,22 +1346,102 @@ bool Parser::ParseCommandRunCompute() {
               return true;
             }},
            {Token::Type::kKeywordNumGroups,
-            [this, &num_groups_x, &num_groups_y, &num_groups_z]() -> bool {
-              for (auto* num_groups :
-                   {&num_groups_x, &num_groups_y, &num_groups_z}) {
-                auto maybe_num_groups = ParseUint32("number of groups");
-                if (!maybe_num_groups.first) {
+            [this, &num_groups]() -> bool {
+              // Either a single triple of group counts, or a bracketed,
+              // comma-separated list of triples to be dispatched in turn.
+              bool is_list = tokenizer_->PeekNextToken()->GetText() == "[";
+              if (is_list) {
+                tokenizer_->NextToken();
+                if (tokenizer_->PeekNextToken()->GetText() == "]") {
+                  message_consumer_->Message(
+                      MessageConsumer::Severity::kError,
+                      tokenizer_->PeekNextToken().get(),
+                      "Expected at least one number of groups");
+                  return false;
+                }
+              }
+              while (true) {
+                CommandRunCompute::NumGroups dispatch = {0, 0, 0};
+                for (auto* count : {&dispatch.x, &dispatch.y, &dispatch.z}) {
+                  auto maybe_num_groups = ParseUint32("number of groups");
+                  if (!maybe_num_groups.first) {
+                    return false;
+                  }
+                  *count = maybe_num_groups.second;
+                }
+                num_groups.push_back(dispatch);
+                if (!is_list) {
+                  return true;
+                }
+                auto comma_or_square_brace_token = tokenizer_->NextToken();
+                if (comma_or_square_brace_token->GetText() == "]") {
+                  return true;
+                }
+                if (comma_or_square_brace_token->GetText() != ",") {
+                  message_consumer_->Message(
+                      MessageConsumer::Severity::kError,
+                      comma_or_square_brace_token.get(),
+                      "Expected ',' or ']', got '" +
+                          comma_or_square_brace_token->GetText() + "'");
                   return false;
                 }
-                *num_groups = maybe_num_groups.second;
               }
-              return true;
             }}})) {
     return false;
   }
   parsed_commands_.push_back(MakeUnique<CommandRunCompute>(
-      std::move(start_token), std::move(program_identifier), num_groups_x,
-      num_groups_y, num_groups_z));
+      std::move(start_token), std::move(program_identifier),
+      std::move(num_groups)));
+  return true;
+}
+
+bool Parser::ParseCommandRunComputeIndirect() {
+  auto start_token = tokenizer_->NextToken();
+
+  std::unique_ptr<Token> program_identifier;
+  std::unique_ptr<Token> buffer_identifier;
+  std::vector<size_t> offsets_bytes;
+  std::vector<std::unique_ptr<Token>> offset_tokens;
+
+  if (!ParseParameters(
+          {{Token::Type::kKeywordProgram,
+            [this, &program_identifier]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(MessageConsumer::Severity::kError,
+                                           token.get(),
+                                           "Expected an identifier for the "
+                                           "compute program to be run, got '" +
+                                               token->GetText() + "'");
+                return false;
+              }
+              program_identifier = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordBuffer,
+            [this, &buffer_identifier]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected an identifier for the buffer holding the "
+                    "numbers of groups, got '" +
+                        token->GetText() + "'");
+                return false;
+              }
+              buffer_identifier = std::move(token);
+              return true;
+            }},
+           {Token::Type::kKeywordOffsetBytes,
+            [this, &offsets_bytes, &offset_tokens]() -> bool {
+              return ParseOffsetsBytes(&offsets_bytes, &offset_tokens);
+            }}})) {
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandRunComputeIndirect>(
+      std::move(start_token), std::move(program_identifier),
+      std::move(buffer_identifier), std::move(offsets_bytes),
+      std::move(offset_tokens)));
   return true;
 }
 
@@ -870,7 +1451,14 @@ bool Parser::ParseCommandRunGraphics() {
   std::unique_ptr<Token> program_identifier;
   std::unordered_map<size_t, VertexAttributeInfo> vertex_data;
   std::unique_ptr<Token> index_data_buffer_identifier;
-  size_t vertex_count;
+  std::unique_ptr<Token> index_size_bytes_token;
+  size_t index_size_bytes = 4;
+  size_t vertex_count = 0;
+  std::unique_ptr<Token> instance_count_token;
+  size_t instance_count = 1;
+  std::unique_ptr<Token> indirect_data_buffer_identifier;
+  std::vector<size_t> indirect_offsets_bytes;
+  std::vector<std::unique_ptr<Token>> indirect_offset_tokens;
   CommandRunGraphics::Topology topology;
   std::unordered_map<size_t, std::unique_ptr<Token>> framebuffer_attachments;
 
@@ -944,6 +1532,26 @@ bool Parser::ParseCommandRunGraphics() {
               index_data_buffer_identifier = std::move(token);
               return true;
             }},
+           {Token::Type::kKeywordIndexSizeBytes,
+            [this, &index_size_bytes_token, &index_size_bytes]() -> bool {
+              index_size_bytes_token = tokenizer_->PeekNextToken();
+              auto maybe_index_size = ParseUint32("index size");
+              if (!maybe_index_size.first) {
+                return false;
+              }
+              if (maybe_index_size.second != 1 &&
+                  maybe_index_size.second != 2 &&
+                  maybe_index_size.second != 4) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError,
+                    index_size_bytes_token.get(),
+                    "Index size must be 1, 2 or 4 bytes, got '" +
+                        index_size_bytes_token->GetText() + "'");
+                return false;
+              }
+              index_size_bytes = maybe_index_size.second;
+              return true;
+            }},
            {Token::Type::kKeywordVertexCount,
             [this, &vertex_count]() -> bool {
               auto maybe_vertex_count = ParseUint32("vertex count");
@@ -953,6 +1561,38 @@ bool Parser::ParseCommandRunGraphics() {
               vertex_count = maybe_vertex_count.second;
               return true;
             }},
+           {Token::Type::kKeywordInstanceCount,
+            [this, &instance_count_token, &instance_count]() -> bool {
+              instance_count_token = tokenizer_->PeekNextToken();
+              auto maybe_instance_count = ParseUint32("instance count");
+              if (!maybe_instance_count.first) {
+                return false;
+              }
+              instance_count = maybe_instance_count.second;
+              return true;
+            }},
+           {Token::Type::kKeywordIndirectData,
+            [this, &indirect_data_buffer_identifier, &indirect_offsets_bytes,
+             &indirect_offset_tokens]() -> bool {
+              auto token = tokenizer_->NextToken();
+              if (!token->IsIdentifier()) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected identifier for indirect data buffer, got '" +
+                        token->GetText() + "'");
+                return false;
+              }
+              indirect_data_buffer_identifier = std::move(token);
+              token = tokenizer_->NextToken();
+              if (token->GetType() != Token::Type::kKeywordOffsetBytes) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, token.get(),
+                    "Expected 'OFFSET_BYTES', got '" + token->GetText() + "'");
+                return false;
+              }
+              return ParseOffsetsBytes(&indirect_offsets_bytes,
+                                       &indirect_offset_tokens);
+            }},
            {Token::Type::kKeywordTopology,
             [this, &topology]() -> bool {
               auto token = tokenizer_->NextToken();
@@ -1048,13 +1688,37 @@ bool Parser::ParseCommandRunGraphics() {
               }
               tokenizer_->NextToken();
               return true;
-            }}})) {
+            }}},
+          // VERTEX_COUNT and INDIRECT_DATA are mutually exclusive: an indirect
+          // draw reads its vertex count from the indirect data buffer.
+          {{Token::Type::kKeywordVertexCount,
+            Token::Type::kKeywordIndirectData}},
+          {Token::Type::kKeywordIndexData, Token::Type::kKeywordIndexSizeBytes,
+           Token::Type::kKeywordInstanceCount})) {
+    return false;
+  }
+  if (index_size_bytes_token != nullptr &&
+      index_data_buffer_identifier == nullptr) {
+    message_consumer_->Message(MessageConsumer::Severity::kError,
+                               index_size_bytes_token.get(),
+                               "INDEX_SIZE_BYTES requires INDEX_DATA");
+    return false;
+  }
+  if (instance_count_token != nullptr &&
+      indirect_data_buffer_identifier != nullptr) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, instance_count_token.get(),
+        "INSTANCE_COUNT cannot be used with INDIRECT_DATA; the instance count "
+        "of an indirect draw is read from the indirect data buffer");
     return false;
   }
   parsed_commands_.push_back(MakeUnique<CommandRunGraphics>(
       std::move(start_token), std::move(program_identifier),
       std::move(vertex_data), std::move(index_data_buffer_identifier),
-      vertex_count, topology, std::move(framebuffer_attachments)));
+      index_size_bytes, vertex_count, instance_count,
+      std::move(indirect_data_buffer_identifier),
+      std::move(indirect_offsets_bytes), std::move(indirect_offset_tokens),
+      topology, std::move(framebuffer_attachments)));
   return true;
 }
 
@@ -1153,6 +1817,7 @@ bool Parser::ParseCommandDumpBufferBinary() {
   auto start_token = tokenizer_->NextToken();
   std::unique_ptr<Token> buffer_identifier;
   std::unique_ptr<Token> filename;
+  bool compressed = false;
   if (!ParseParameters(
           {{Token::Type::kKeywordBuffer,
             [this, &buffer_identifier]() -> bool {
@@ -1167,7 +1832,8 @@ bool Parser::ParseCommandDumpBufferBinary() {
               buffer_identifier = std::move(token);
               return true;
             }},
-           {Token::Type::kKeywordFile, [this, &filename]() -> bool {
+           {Token::Type::kKeywordFile,
+            [this, &filename]() -> bool {
               filename = tokenizer_->NextToken();
               if (!filename->IsString()) {
                 message_consumer_->Message(
@@ -1177,12 +1843,17 @@ bool Parser::ParseCommandDumpBufferBinary() {
                 return false;
               }
               return true;
-            }}})) {
+            }},
+           {Token::Type::kKeywordCompressed, [&compressed]() -> bool {
+              compressed = true;
+              return true;
+            }}},
+          {}, {Token::Type::kKeywordCompressed})) {
     return false;
   }
   parsed_commands_.push_back(MakeUnique<CommandDumpBufferBinary>(
-      std::move(start_token), std::move(buffer_identifier),
-      std::move(filename)));
+      std::move(start_token), std::move(buffer_identifier), std::move(filename),
+      compressed));
   return true;
 }
 
@@ -1218,45 +1889,7 @@ bool Parser::ParseCommandDumpBufferText() {
               return true;
             }},
            {Token::Type::kKeywordFormat, [this, &format_entries]() -> bool {
-              while (true) {
-                CommandDumpBufferText::FormatEntry::Kind kind;
-                switch (tokenizer_->PeekNextToken()->GetType()) {
-                  case Token::Type::kKeywordSkipBytes:
-                    kind = CommandDumpBufferText::FormatEntry::Kind::kSkip;
-                    break;
-                  case Token::Type::kKeywordTypeByte:
-                    kind = CommandDumpBufferText::FormatEntry::Kind::kByte;
-                    break;
-                  case Token::Type::kKeywordTypeFloat:
-                    kind = CommandDumpBufferText::FormatEntry::Kind::kFloat;
-                    break;
-                  case Token::Type::kKeywordTypeInt:
-                    kind = CommandDumpBufferText::FormatEntry::Kind::kInt;
-                    break;
-                  case Token::Type::kKeywordTypeUint: {
-                    kind = CommandDumpBufferText::FormatEntry::Kind::kUint;
-                    break;
-                    case Token::Type::kString:
-                      kind = CommandDumpBufferText::FormatEntry::Kind::kString;
-                      break;
-                    default:
-                      return true;
-                  }
-                }
-                auto format_start_token = tokenizer_->NextToken();
-                size_t count;
-                if (kind == CommandDumpBufferText::FormatEntry::Kind::kString) {
-                  count = 0;
-                } else {
-                  auto maybe_count = ParseUint32("count");
-                  if (!maybe_count.first) {
-                    return false;
-                  }
-                  count = maybe_count.second;
-                }
-                format_entries.push_back(
-                    {std::move(format_start_token), kind, count});
-              }
+              return ParseFormatEntries(true, &format_entries);
             }}})) {
     return false;
   }
@@ -1270,6 +1903,10 @@ bool Parser::ParseCommandDumpRenderbuffer() {
   auto start_token = tokenizer_->NextToken();
   std::unique_ptr<Token> renderbuffer_identifier;
   std::unique_ptr<Token> filename;
+  ImageFormat format = ImageFormat::kPng;
+  std::unique_ptr<Token> format_token;
+  int compression_level = kDefaultPngCompressionLevel;
+  std::unique_ptr<Token> compression_token;
   if (!ParseParameters(
           {{Token::Type::kKeywordRenderbuffer,
             [this, &renderbuffer_identifier]() -> bool {
@@ -1284,7 +1921,8 @@ bool Parser::ParseCommandDumpRenderbuffer() {
               renderbuffer_identifier = std::move(token);
               return true;
             }},
-           {Token::Type::kKeywordFile, [this, &filename]() -> bool {
+           {Token::Type::kKeywordFile,
+            [this, &filename]() -> bool {
               filename = tokenizer_->NextToken();
               if (!filename->IsString()) {
                 message_consumer_->Message(
@@ -1294,12 +1932,67 @@ bool Parser::ParseCommandDumpRenderbuffer() {
                 return false;
               }
               return true;
-            }}})) {
+            }},
+           {Token::Type::kKeywordFormat,
+            [this, &format, &format_token]() -> bool {
+              format_token = tokenizer_->NextToken();
+              switch (format_token->GetType()) {
+                case Token::Type::kKeywordPng:
+                  format = ImageFormat::kPng;
+                  return true;
+                case Token::Type::kKeywordPpm:
+                  format = ImageFormat::kPpm;
+                  return true;
+                case Token::Type::kKeywordPam:
+                  format = ImageFormat::kPam;
+                  return true;
+                case Token::Type::kKeywordRaw:
+                  format = ImageFormat::kRaw;
+                  return true;
+                case Token::Type::kKeywordQoi:
+                  format = ImageFormat::kQoi;
+                  return true;
+                default:
+                  message_consumer_->Message(
+                      MessageConsumer::Severity::kError, format_token.get(),
+                      "Unknown image format: '" + format_token->GetText() +
+                          "'");
+                  return false;
+              }
+            }},
+           {Token::Type::kKeywordCompression,
+            [this, &compression_level, &compression_token]() -> bool {
+              compression_token = tokenizer_->PeekNextToken();
+              auto maybe_level = ParseUint32("compression level");
+              if (!maybe_level.first) {
+                return false;
+              }
+              if (maybe_level.second >
+                  static_cast<uint32_t>(kMaxPngCompressionLevel)) {
+                message_consumer_->Message(
+                    MessageConsumer::Severity::kError, compression_token.get(),
+                    "Compression level must be between 0 and " +
+                        std::to_string(kMaxPngCompressionLevel) + ", got '" +
+                        compression_token->GetText() + "'");
+                return false;
+              }
+              compression_level = static_cast<int>(maybe_level.second);
+              return true;
+            }}},
+          {},
+          {Token::Type::kKeywordFormat, Token::Type::kKeywordCompression})) {
+    return false;
+  }
+  if (compression_token != nullptr && format != ImageFormat::kPng) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, compression_token.get(),
+        "COMPRESSION can only be used with the PNG format; the " +
+            ImageFormatToString(format) + " format is not compressed");
     return false;
   }
   parsed_commands_.push_back(MakeUnique<CommandDumpRenderbuffer>(
       std::move(start_token), std::move(renderbuffer_identifier),
-      std::move(filename)));
+      std::move(filename), format, compression_level));
   return true;
 }
 
@@ -1574,6 +2267,39 @@ bool Parser::ParseCommandSetUniform() {
   return true;
 }
 
+bool Parser::ParseCommandUpdateBuffer() {
+  auto start_token = tokenizer_->NextToken();
+  auto buffer_identifier = tokenizer_->NextToken();
+  if (!buffer_identifier->IsIdentifier()) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, buffer_identifier.get(),
+        "Expected an identifier for the buffer being updated, got '" +
+            buffer_identifier->GetText() + "'");
+    return false;
+  }
+  size_t offset_bytes;
+  std::vector<ValuesSegment> values;
+  if (!ParseParameters(
+          {{Token::Type::kKeywordOffsetBytes,
+            [this, &offset_bytes]() -> bool {
+              auto maybe_offset = ParseUint32("offset");
+              if (!maybe_offset.first) {
+                return false;
+              }
+              offset_bytes = maybe_offset.second;
+              return true;
+            }},
+           {Token::Type::kKeywordInitValues, [this, &values]() -> bool {
+              return ParseInitValues(&values, true);
+            }}})) {
+    return false;
+  }
+  parsed_commands_.push_back(MakeUnique<CommandUpdateBuffer>(
+      std::move(start_token), std::move(buffer_identifier), offset_bytes,
+      values));
+  return true;
+}
+
 std::pair<bool, UniformValue> Parser::ProcessUniformValue(
     UniformValue::ElementType type,
     const std::pair<bool, size_t>& maybe_array_size,
@@ -1649,6 +2375,142 @@ std::pair<bool, UniformValue> Parser::ProcessUniformValue(
   }
 }
 
+bool Parser::ParseFormatEntries(
+    bool allow_strings,
+    std::vector<CommandDumpBufferText::FormatEntry>* format_entries) {
+  while (true) {
+    CommandDumpBufferText::FormatEntry::Kind kind;
+    switch (tokenizer_->PeekNextToken()->GetType()) {
+      case Token::Type::kKeywordSkipBytes:
+        kind = CommandDumpBufferText::FormatEntry::Kind::kSkip;
+        break;
+      case Token::Type::kKeywordTypeByte:
+        kind = CommandDumpBufferText::FormatEntry::Kind::kByte;
+        break;
+      case Token::Type::kKeywordTypeFloat:
+        kind = CommandDumpBufferText::FormatEntry::Kind::kFloat;
+        break;
+      case Token::Type::kKeywordTypeInt:
+        kind = CommandDumpBufferText::FormatEntry::Kind::kInt;
+        break;
+      case Token::Type::kKeywordTypeUint:
+        kind = CommandDumpBufferText::FormatEntry::Kind::kUint;
+        break;
+      case Token::Type::kString:
+        if (!allow_strings) {
+          auto token = tokenizer_->NextToken();
+          message_consumer_->Message(
+              MessageConsumer::Severity::kError, token.get(),
+              "String formatting entries are not allowed here, got '" +
+                  token->GetText() + "'");
+          return false;
+        }
+        kind = CommandDumpBufferText::FormatEntry::Kind::kString;
+        break;
+      default:
+        return true;
+    }
+    auto format_start_token = tokenizer_->NextToken();
+    size_t count;
+    if (kind == CommandDumpBufferText::FormatEntry::Kind::kString) {
+      count = 0;
+    } else {
+      auto maybe_count = ParseUint32("count");
+      if (!maybe_count.first) {
+        return false;
+      }
+      count = maybe_count.second;
+    }
+    format_entries->push_back({std::move(format_start_token), kind, count});
+  }
+}
+
+bool Parser::ParseFloatTolerance(std::unique_ptr<Token>* tolerance_token,
+                                 FloatTolerance* tolerance) {
+  std::set<Token::Type> seen;
+  while (true) {
+    auto token_type = tokenizer_->PeekNextToken()->GetType();
+    if (token_type != Token::Type::kKeywordAbs &&
+        token_type != Token::Type::kKeywordRel &&
+        token_type != Token::Type::kKeywordUlp) {
+      break;
+    }
+    auto kind_token = tokenizer_->NextToken();
+    if (seen.count(token_type) != 0) {
+      message_consumer_->Message(
+          MessageConsumer::Severity::kError, kind_token.get(),
+          "Duplicate tolerance '" + kind_token->GetText() + "'");
+      return false;
+    }
+    seen.insert(token_type);
+    if (token_type == Token::Type::kKeywordUlp) {
+      auto maybe_ulps = ParseUint32("ULP tolerance");
+      if (!maybe_ulps.first) {
+        return false;
+      }
+      tolerance->ulps = maybe_ulps.second;
+    } else {
+      auto value_token = tokenizer_->NextToken();
+      if (!value_token->IsFloatLiteral() ||
+          std::stof(value_token->GetText()) < 0.0F) {
+        message_consumer_->Message(
+            MessageConsumer::Severity::kError, value_token.get(),
+            "Expected non-negative float tolerance, got '" +
+                value_token->GetText() + "'");
+        return false;
+      }
+      if (token_type == Token::Type::kKeywordAbs) {
+        tolerance->absolute = std::stof(value_token->GetText());
+      } else {
+        tolerance->relative = std::stof(value_token->GetText());
+      }
+    }
+    if (*tolerance_token == nullptr) {
+      *tolerance_token = std::move(kind_token);
+    }
+  }
+  if (seen.empty()) {
+    auto token = tokenizer_->PeekNextToken();
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, token.get(),
+        "Expected 'ABS', 'REL' or 'ULP' after TOLERANCE, got '" +
+            token->GetText() + "'");
+    return false;
+  }
+  return true;
+}
+
+bool Parser::ParseHash(std::unique_ptr<Token>* hash_token, uint64_t* hash) {
+  const size_t kHashDigits = 16;
+  *hash_token = tokenizer_->NextToken();
+  const std::string& text = (*hash_token)->GetText();
+  bool valid = (*hash_token)->IsString() && text.size() == kHashDigits;
+  *hash = 0;
+  for (size_t i = 0; valid && i < kHashDigits; i++) {
+    const char digit = text[i];
+    uint64_t value;
+    if (digit >= '0' && digit <= '9') {
+      value = static_cast<uint64_t>(digit - '0');
+    } else if (digit >= 'a' && digit <= 'f') {
+      value = static_cast<uint64_t>(digit - 'a' + 10);
+    } else if (digit >= 'A' && digit <= 'F') {
+      value = static_cast<uint64_t>(digit - 'A' + 10);
+    } else {
+      valid = false;
+      break;
+    }
+    *hash = (*hash << 4U) | value;
+  }
+  if (!valid) {
+    message_consumer_->Message(
+        MessageConsumer::Severity::kError, hash_token->get(),
+        "Expected a string of " + std::to_string(kHashDigits) +
+            " hexadecimal digits for the hash, got '" + text + "'");
+    return false;
+  }
+  return true;
+}
+
 bool Parser::ParseParameters(
     const std::map<Token::Type, std::function<bool()>>& parameter_parsers,
     const std::map<Token::Type, Token::Type>& mutually_exclusive,
@@ -1737,6 +2599,7 @@ std::pair<bool, VertexAttributeInfo> Parser::ParseVertexAttributeInfo() {
   size_t offset_bytes;
   size_t stride_bytes;
   size_t dimension;
+  size_t divisor = 0;
   if (!ParseParameters(
           {{Token::Type::kKeywordBuffer,
             [this, &buffer_identifier]() -> bool {
@@ -1769,18 +2632,68 @@ std::pair<bool, VertexAttributeInfo> Parser::ParseVertexAttributeInfo() {
               stride_bytes = maybe_stride.second;
               return true;
             }},
-           {Token::Type::kKeywordDimension, [this, &dimension]() -> bool {
+           {Token::Type::kKeywordDimension,
+            [this, &dimension]() -> bool {
               auto maybe_dimension = ParseUint32("dimension");
               if (!maybe_dimension.first) {
                 return false;
               }
               dimension = maybe_dimension.second;
               return true;
-            }}})) {
-    return {false, VertexAttributeInfo(nullptr, 0, 0, 0)};
+            }},
+           {Token::Type::kKeywordDivisor, [this, &divisor]() -> bool {
+              auto maybe_divisor = ParseUint32("divisor");
+              if (!maybe_divisor.first) {
+                return false;
+              }
+              divisor = maybe_divisor.second;
+              return true;
+            }}},
+          {}, {Token::Type::kKeywordDivisor})) {
+    return {false, VertexAttributeInfo(nullptr, 0, 0, 0, 0)};
   }
   return {true, VertexAttributeInfo(std::move(buffer_identifier), offset_bytes,
-                                    stride_bytes, dimension)};
+                                    stride_bytes, dimension, divisor)};
+}
+
+bool Parser::ParseOffsetsBytes(
+    std::vector<size_t>* offsets_bytes,
+    std::vector<std::unique_ptr<Token>>* offset_tokens) {
+  // Either a single offset, or a bracketed, comma-separated list of offsets.
+  bool is_list = tokenizer_->PeekNextToken()->GetText() == "[";
+  if (is_list) {
+    tokenizer_->NextToken();
+    if (tokenizer_->PeekNextToken()->GetText() == "]") {
+      message_consumer_->Message(MessageConsumer::Severity::kError,
+                                 tokenizer_->PeekNextToken().get(),
+                                 "Expected at least one offset");
+      return false;
+    }
+  }
+  while (true) {
+    auto offset_token = tokenizer_->PeekNextToken();
+    auto maybe_offset = ParseUint32("offset");
+    if (!maybe_offset.first) {
+      return false;
+    }
+    offsets_bytes->push_back(maybe_offset.second);
+    offset_tokens->push_back(std::move(offset_token));
+    if (!is_list) {
+      return true;
+    }
+    auto comma_or_square_brace_token = tokenizer_->NextToken();
+    if (comma_or_square_brace_token->GetText() == "]") {
+      return true;
+    }
+    if (comma_or_square_brace_token->GetText() != ",") {
+      message_consumer_->Message(MessageConsumer::Severity::kError,
+                                 comma_or_square_brace_token.get(),
+                                 "Expected ',' or ']', got '" +
+                                     comma_or_square_brace_token->GetText() +
+                                     "'");
+      return false;
+    }
+  }
 }
 
 std::pair<bool, uint8_t> Parser::ParseUint8(const std::string& result_name) {
@@ -1837,7 +2750,49 @@ std::pair<bool, float> Parser::ParseFloat(const std::string& result_name) {
   return {true, std::stof(token->GetText())};
 }
 
-std::pair<bool, ValuesSegment> Parser::ParseValuesSegment() {
+std::pair<bool, float> Parser::ParseFloatInRange(
+    const std::string& result_name, float min_value, float max_value,
+    std::unique_ptr<Token>* token) {
+  *token = tokenizer_->PeekNextToken();
+  auto maybe_float = ParseFloat(result_name);
+  if (!maybe_float.first) {
+    return {false, 0.0F};
+  }
+  if (maybe_float.second < min_value || maybe_float.second > max_value) {
+    std::stringstream stringstream;
+    stringstream << "Expected float " << result_name << " in the range ["
+                 << min_value << ", " << max_value << "], got '"
+                 << (*token)->GetText() << "'";
+    message_consumer_->Message(MessageConsumer::Severity::kError,
+                               token->get(), stringstream.str());
+    return {false, 0.0F};
+  }
+  return maybe_float;
+}
+
+bool Parser::ParseInitValues(std::vector<ValuesSegment>* values,
+                             bool whole_words) {
+  while (true) {
+    switch (tokenizer_->PeekNextToken()->GetType()) {
+      case Token::Type::kKeywordTypeByte:
+      case Token::Type::kKeywordTypeFloat:
+      case Token::Type::kKeywordTypeInt:
+      case Token::Type::kKeywordTypeUint: {
+        std::pair<bool, ValuesSegment> maybe_values_segment =
+            ParseValuesSegment(whole_words);
+        if (!maybe_values_segment.first) {
+          return false;
+        }
+        values->push_back(maybe_values_segment.second);
+        break;
+      }
+      default:
+        return true;
+    }
+  }
+}
+
+std::pair<bool, ValuesSegment> Parser::ParseValuesSegment(bool whole_words) {
   std::pair<bool, ValuesSegment> failure = {
       false, ValuesSegment(std::vector<uint8_t>())};
   auto token = tokenizer_->NextToken();
@@ -1852,7 +2807,7 @@ std::pair<bool, ValuesSegment> Parser::ParseValuesSegment() {
         }
         byte_data.push_back(maybe_byte.second);
       }
-      if ((byte_data.size() % 4) != 0) {
+      if (whole_words && (byte_data.size() % 4) != 0) {
         message_consumer_->Message(
             MessageConsumer::Severity::kError, token.get(),
             "The number of byte literals supplied in a buffer initializer must "
@@ -27,7 +27,44 @@ Token::Token(Type type, std::string text, size_t line, size_t column)
 
 bool Token::IsEOS() const { return type_ == Type::kEOS; }
 
-bool Token::IsIdentifier() const { return type_ == Type::kIdentifier; }
+bool Token::IsIdentifier() const {
+  switch (type_) {
+    case Type::kIdentifier:
+    case Type::kKeywordAbs:
+    case Type::kKeywordCompressed:
+    case Type::kKeywordCompression:
+    case Type::kKeywordDivisor:
+    case Type::kKeywordDynamic:
+    case Type::kKeywordGenerateMipmaps:
+    case Type::kKeywordHash:
+    case Type::kKeywordIndexSizeBytes:
+    case Type::kKeywordIndirectData:
+    case Type::kKeywordInitFile:
+    case Type::kKeywordInstanceCount:
+    case Type::kKeywordMaxDifferingFraction:
+    case Type::kKeywordMinPsnr:
+    case Type::kKeywordMinSsim:
+    case Type::kKeywordPam:
+    case Type::kKeywordPng:
+    case Type::kKeywordPpm:
+    case Type::kKeywordQoi:
+    case Type::kKeywordR32ui:
+    case Type::kKeywordR8:
+    case Type::kKeywordRaw:
+    case Type::kKeywordRead:
+    case Type::kKeywordRel:
+    case Type::kKeywordRg16f:
+    case Type::kKeywordRgba32f:
+    case Type::kKeywordRgba8:
+    case Type::kKeywordStatic:
+    case Type::kKeywordStream:
+    case Type::kKeywordUlp:
+    case Type::kKeywordUsage:
+      return true;
+    default:
+      return false;
+  }
+}
 
 bool Token::IsIntLiteral() const { return type_ == Type::kIntLiteral; }
 
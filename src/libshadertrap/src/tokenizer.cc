@@ -250,10 +250,16 @@ std::string Tokenizer::SkipLine() {
 //  an alternative approach.
 const std::unordered_map<std::string, Token::Type>
     Tokenizer::keyword_to_token_type = {  // NOLINT(cert-err58-cpp)
+        {"ABS", Token::Type::kKeywordAbs},
+        {"ASSERT_BUFFER_HASH", Token::Type::kKeywordAssertBufferHash},
+        {"ASSERT_MATCHES_IMAGE", Token::Type::kKeywordAssertMatchesImage},
         {"ASSERT_PIXELS", Token::Type::kKeywordAssertPixels},
         {"ASSERT_EQUAL", Token::Type::kKeywordAssertEqual},
+        {"ASSERT_RENDERBUFFER_HASH",
+         Token::Type::kKeywordAssertRenderbufferHash},
         {"ASSERT_SIMILAR_EMD_HISTOGRAM",
          Token::Type::kKeywordAssertSimilarEmdHistogram},
+        {"ASSERT_SIMILAR_IMAGE", Token::Type::kKeywordAssertSimilarImage},
         {"BINDING", Token::Type::kKeywordBinding},
         {"BIND_SAMPLER", Token::Type::kKeywordBindSampler},
         {"BIND_SHADER_STORAGE_BUFFER",
@@ -263,17 +269,22 @@ const std::unordered_map<std::string, Token::Type>
         {"BUFFER", Token::Type::kKeywordBuffer},
         {"BUFFERS", Token::Type::kKeywordBuffers},
         {"COMPILE_SHADER", Token::Type::kKeywordCompileShader},
+        {"COMPRESSED", Token::Type::kKeywordCompressed},
+        {"COMPRESSION", Token::Type::kKeywordCompression},
         {"COMPUTE", Token::Type::kKeywordCompute},
         {"CREATE_BUFFER", Token::Type::kKeywordCreateBuffer},
         {"CREATE_EMPTY_TEXTURE_2D", Token::Type::kKeywordCreateEmptyTexture2d},
         {"CREATE_PROGRAM", Token::Type::kKeywordCreateProgram},
         {"CREATE_RENDERBUFFER", Token::Type::kKeywordCreateRenderbuffer},
         {"CREATE_SAMPLER", Token::Type::kKeywordCreateSampler},
+        {"CREATE_TEXTURE_2D", Token::Type::kKeywordCreateTexture2d},
         {"DECLARE_SHADER", Token::Type::kKeywordDeclareShader},
         {"DIMENSION", Token::Type::kKeywordDimension},
+        {"DIVISOR", Token::Type::kKeywordDivisor},
         {"DUMP_BUFFER_BINARY", Token::Type::kKeywordDumpBufferBinary},
         {"DUMP_BUFFER_TEXT", Token::Type::kKeywordDumpBufferText},
         {"DUMP_RENDERBUFFER", Token::Type::kKeywordDumpRenderbuffer},
+        {"DYNAMIC", Token::Type::kKeywordDynamic},
         {"END", Token::Type::kKeywordEnd},
         {"EXPECTED", Token::Type::kKeywordExpected},
         {"FILE", Token::Type::kKeywordFile},
@@ -281,25 +292,47 @@ const std::unordered_map<std::string, Token::Type>
         {"FRAGMENT", Token::Type::kKeywordFragment},
         {"FRAMEBUFFER_ATTACHMENTS",
          Token::Type::kKeywordFramebufferAttachments},
+        {"GENERATE_MIPMAPS", Token::Type::kKeywordGenerateMipmaps},
         {"GL", Token::Type::kKeywordGl},
         {"GLES", Token::Type::kKeywordGles},
+        {"HASH", Token::Type::kKeywordHash},
         {"HEIGHT", Token::Type::kKeywordHeight},
         {"INDEX_DATA", Token::Type::kKeywordIndexData},
+        {"INDEX_SIZE_BYTES", Token::Type::kKeywordIndexSizeBytes},
+        {"INDIRECT_DATA", Token::Type::kKeywordIndirectData},
+        {"INIT_FILE", Token::Type::kKeywordInitFile},
         {"INIT_TYPE", Token::Type::kKeywordInitType},
         {"INIT_VALUES", Token::Type::kKeywordInitValues},
+        {"INSTANCE_COUNT", Token::Type::kKeywordInstanceCount},
         {"KIND", Token::Type::kKeywordKind},
         {"LINEAR", Token::Type::kKeywordLinear},
         {"LOCATION", Token::Type::kKeywordLocation},
+        {"MAX_DIFFERING_FRACTION", Token::Type::kKeywordMaxDifferingFraction},
+        {"MIN_PSNR", Token::Type::kKeywordMinPsnr},
+        {"MIN_SSIM", Token::Type::kKeywordMinSsim},
         {"NAME", Token::Type::kKeywordName},
         {"NEAREST", Token::Type::kKeywordNearest},
         {"NUM_GROUPS", Token::Type::kKeywordNumGroups},
         {"OFFSET_BYTES", Token::Type::kKeywordOffsetBytes},
+        {"PAM", Token::Type::kKeywordPam},
         {"PARAMETER", Token::Type::kKeywordParameter},
+        {"PNG", Token::Type::kKeywordPng},
+        {"PPM", Token::Type::kKeywordPpm},
         {"PROGRAM", Token::Type::kKeywordProgram},
+        {"QOI", Token::Type::kKeywordQoi},
+        {"R32UI", Token::Type::kKeywordR32ui},
+        {"R8", Token::Type::kKeywordR8},
+        {"RAW", Token::Type::kKeywordRaw},
+        {"READ", Token::Type::kKeywordRead},
         {"RECTANGLE", Token::Type::kKeywordRectangle},
+        {"REL", Token::Type::kKeywordRel},
         {"RENDERBUFFER", Token::Type::kKeywordRenderbuffer},
         {"RENDERBUFFERS", Token::Type::kKeywordRenderbuffers},
+        {"RG16F", Token::Type::kKeywordRg16f},
+        {"RGBA32F", Token::Type::kKeywordRgba32f},
+        {"RGBA8", Token::Type::kKeywordRgba8},
         {"RUN_COMPUTE", Token::Type::kKeywordRunCompute},
+        {"RUN_COMPUTE_INDIRECT", Token::Type::kKeywordRunComputeIndirect},
         {"RUN_GRAPHICS", Token::Type::kKeywordRunGraphics},
         {"SAMPLER", Token::Type::kKeywordSampler},
         {"SET_SAMPLER_PARAMETER", Token::Type::kKeywordSetSamplerParameter},
@@ -309,6 +342,8 @@ const std::unordered_map<std::string, Token::Type>
         {"SHADERS", Token::Type::kKeywordShaders},
         {"SIZE_BYTES", Token::Type::kKeywordSizeBytes},
         {"SKIP_BYTES", Token::Type::kKeywordSkipBytes},
+        {"STATIC", Token::Type::kKeywordStatic},
+        {"STREAM", Token::Type::kKeywordStream},
         {"STRIDE_BYTES", Token::Type::kKeywordStrideBytes},
         {"TEXTURE", Token::Type::kKeywordTexture},
         {"TEXTURE_MAG_FILTER", Token::Type::kKeywordTextureMagFilter},
@@ -341,6 +376,9 @@ const std::unordered_map<std::string, Token::Type>
         {"vec2", Token::Type::kKeywordTypeVec2},
         {"vec3", Token::Type::kKeywordTypeVec3},
         {"vec4", Token::Type::kKeywordTypeVec4},
+        {"ULP", Token::Type::kKeywordUlp},
+        {"UPDATE_BUFFER", Token::Type::kKeywordUpdateBuffer},
+        {"USAGE", Token::Type::kKeywordUsage},
         {"VALUE", Token::Type::kKeywordValue},
         {"VALUES", Token::Type::kKeywordValues},
         {"VERTEX", Token::Type::kKeywordVertex},
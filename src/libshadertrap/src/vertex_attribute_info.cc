@@ -20,10 +20,11 @@ namespace shadertrap {
 
 VertexAttributeInfo::VertexAttributeInfo(
     std::unique_ptr<Token> buffer_identifier, size_t offset_bytes,
-    size_t stride_bytes, size_t dimension)
+    size_t stride_bytes, size_t dimension, size_t divisor)
     : buffer_identifier_(std::move(buffer_identifier)),
       offset_bytes_(offset_bytes),
       stride_bytes_(stride_bytes),
-      dimension_(dimension) {}
+      dimension_(dimension),
+      divisor_(divisor) {}
 
 }  // namespace shadertrap
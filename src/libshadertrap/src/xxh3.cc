@@ -0,0 +1,352 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/xxh3.h"
+
+#include <algorithm>
+#include <cstring>
+
+// This follows the specification of XXH3 in
+// https://github.com/Cyan4973/xxHash/blob/dev/doc/xxhash_spec.md, specialized
+// to the default secret and a seed of 0, using only portable scalar code.
+
+namespace shadertrap {
+
+namespace {
+
+const uint64_t kPrime32_1 = 0x9E3779B1U;
+const uint64_t kPrime32_2 = 0x85EBCA77U;
+const uint64_t kPrime32_3 = 0xC2B2AE3DU;
+const uint64_t kPrime64_1 = 0x9E3779B185EBCA87ULL;
+const uint64_t kPrime64_2 = 0xC2B2AE3D27D4EB4FULL;
+const uint64_t kPrime64_3 = 0x165667B19E3779F9ULL;
+const uint64_t kPrime64_4 = 0x85EBCA77C2B2AE63ULL;
+const uint64_t kPrime64_5 = 0x27D4EB2F165667C5ULL;
+const uint64_t kPrimeMx1 = 0x165667919E3779F9ULL;
+const uint64_t kPrimeMx2 = 0x9FB21C651E98DF25ULL;
+
+const size_t kSecretSizeBytes = 192;
+
+const uint8_t kSecret[kSecretSizeBytes] = {
+    0xb8, 0xfe, 0x6c, 0x39, 0x23, 0xa4, 0x4b, 0xbe, 0x7c, 0x01, 0x81, 0x2c,
+    0xf7, 0x21, 0xad, 0x1c, 0xde, 0xd4, 0x6d, 0xe9, 0x83, 0x90, 0x97, 0xdb,
+    0x72, 0x40, 0xa4, 0xa4, 0xb7, 0xb3, 0x67, 0x1f, 0xcb, 0x79, 0xe6, 0x4e,
+    0xcc, 0xc0, 0xe5, 0x78, 0x82, 0x5a, 0xd0, 0x7d, 0xcc, 0xff, 0x72, 0x21,
+    0xb8, 0x08, 0x46, 0x74, 0xf7, 0x43, 0x24, 0x8e, 0xe0, 0x35, 0x90, 0xe6,
+    0x81, 0x3a, 0x26, 0x4c, 0x3c, 0x28, 0x52, 0xbb, 0x91, 0xc3, 0x00, 0xcb,
+    0x88, 0xd0, 0x65, 0x8b, 0x1b, 0x53, 0x2e, 0xa3, 0x71, 0x64, 0x48, 0x97,
+    0xa2, 0x0d, 0xf9, 0x4e, 0x38, 0x19, 0xef, 0x46, 0xa9, 0xde, 0xac, 0xd8,
+    0xa8, 0xfa, 0x76, 0x3f, 0xe3, 0x9c, 0x34, 0x3f, 0xf9, 0xdc, 0xbb, 0xc7,
+    0xc7, 0x0b, 0x4f, 0x1d, 0x8a, 0x51, 0xe0, 0x4b, 0xcd, 0xb4, 0x59, 0x31,
+    0xc8, 0x9f, 0x7e, 0xc9, 0xd9, 0x78, 0x73, 0x64, 0xea, 0xc5, 0xac, 0x83,
+    0x34, 0xd3, 0xeb, 0xc3, 0xc5, 0x81, 0xa0, 0xff, 0xfa, 0x13, 0x63, 0xeb,
+    0x17, 0x0d, 0xdd, 0x51, 0xb7, 0xf0, 0xda, 0x49, 0xd3, 0x16, 0x55, 0x26,
+    0x29, 0xd4, 0x68, 0x9e, 0x2b, 0x16, 0xbe, 0x58, 0x7d, 0x47, 0xa1, 0xfc,
+    0x8f, 0xf8, 0xb8, 0xd1, 0x7a, 0xd0, 0x31, 0xce, 0x45, 0xcb, 0x3a, 0x8f,
+    0x95, 0x16, 0x04, 0x28, 0xaf, 0xd7, 0xfb, 0xca, 0xbb, 0x4b, 0x40, 0x7e,
+};
+
+// Inputs up to this size are hashed without the accumulator loop.
+const size_t kMidSizeMaxBytes = 240;
+
+const size_t kStripeSizeBytes = 64;
+const size_t kSecretConsumeRateBytes = 8;
+const size_t kNumAccumulators = 8;
+const size_t kStripesPerBlock =
+    (kSecretSizeBytes - kStripeSizeBytes) / kSecretConsumeRateBytes;
+const size_t kBlockSizeBytes = kStripeSizeBytes * kStripesPerBlock;
+
+uint32_t Read32(const uint8_t* data) {
+  return static_cast<uint32_t>(data[0]) |
+         (static_cast<uint32_t>(data[1]) << 8U) |
+         (static_cast<uint32_t>(data[2]) << 16U) |
+         (static_cast<uint32_t>(data[3]) << 24U);
+}
+
+uint64_t Read64(const uint8_t* data) {
+  return static_cast<uint64_t>(Read32(data)) |
+         (static_cast<uint64_t>(Read32(data + 4)) << 32U);
+}
+
+uint64_t RotateLeft(uint64_t value, unsigned int amount) {
+  return (value << amount) | (value >> (64U - amount));
+}
+
+uint64_t Swap64(uint64_t value) {
+  uint64_t result = 0;
+  for (size_t i = 0; i < 8; i++) {
+    result = (result << 8U) | ((value >> (8 * i)) & 0xffU);
+  }
+  return result;
+}
+
+// Returns the exclusive or of the low and high halves of the 128-bit product
+// of |lhs| and |rhs|.
+uint64_t Multiply128Fold64(uint64_t lhs, uint64_t rhs) {
+  const uint64_t lhs_low = lhs & 0xffffffffU;
+  const uint64_t lhs_high = lhs >> 32U;
+  const uint64_t rhs_low = rhs & 0xffffffffU;
+  const uint64_t rhs_high = rhs >> 32U;
+  const uint64_t low_low = lhs_low * rhs_low;
+  const uint64_t high_low = lhs_high * rhs_low;
+  const uint64_t low_high = lhs_low * rhs_high;
+  const uint64_t high_high = lhs_high * rhs_high;
+  const uint64_t cross = (low_low >> 32U) + (high_low & 0xffffffffU) + low_high;
+  const uint64_t upper = (high_low >> 32U) + (cross >> 32U) + high_high;
+  const uint64_t lower = (cross << 32U) | (low_low & 0xffffffffU);
+  return lower ^ upper;
+}
+
+uint64_t Xxh64Avalanche(uint64_t hash) {
+  hash ^= hash >> 33U;
+  hash *= kPrime64_2;
+  hash ^= hash >> 29U;
+  hash *= kPrime64_3;
+  hash ^= hash >> 32U;
+  return hash;
+}
+
+uint64_t Avalanche(uint64_t hash) {
+  hash ^= hash >> 37U;
+  hash *= kPrimeMx1;
+  hash ^= hash >> 32U;
+  return hash;
+}
+
+uint64_t Mix16(const uint8_t* data, const uint8_t* secret) {
+  return Multiply128Fold64(Read64(data) ^ Read64(secret),
+                           Read64(data + 8) ^ Read64(secret + 8));
+}
+
+uint64_t Hash0To16(const uint8_t* data, size_t size) {
+  if (size > 8) {
+    const uint64_t low = Read64(data) ^ (Read64(kSecret + 24) ^
+                                         Read64(kSecret + 32));
+    const uint64_t high = Read64(data + size - 8) ^
+                          (Read64(kSecret + 40) ^ Read64(kSecret + 48));
+    return Avalanche(size + Swap64(low) + high +
+                     Multiply128Fold64(low, high));
+  }
+  if (size >= 4) {
+    const uint64_t combined =
+        Read32(data + size - 4) + (static_cast<uint64_t>(Read32(data)) << 32U);
+    uint64_t hash =
+        combined ^ (Read64(kSecret + 8) ^ Read64(kSecret + 16));
+    hash ^= RotateLeft(hash, 49) ^ RotateLeft(hash, 24);
+    hash *= kPrimeMx2;
+    hash ^= (hash >> 35U) + size;
+    hash *= kPrimeMx2;
+    return hash ^ (hash >> 28U);
+  }
+  if (size > 0) {
+    const uint32_t combined = (static_cast<uint32_t>(data[0]) << 16U) |
+                              (static_cast<uint32_t>(data[size >> 1U]) << 24U) |
+                              static_cast<uint32_t>(data[size - 1]) |
+                              (static_cast<uint32_t>(size) << 8U);
+    return Xxh64Avalanche(combined ^ (Read32(kSecret) ^ Read32(kSecret + 4)));
+  }
+  return Xxh64Avalanche(Read64(kSecret + 56) ^ Read64(kSecret + 64));
+}
+
+uint64_t Hash17To128(const uint8_t* data, size_t size) {
+  uint64_t hash = size * kPrime64_1;
+  const size_t num_rounds = ((size - 1) / 32) + 1;
+  for (size_t i = num_rounds; i-- > 0;) {
+    hash += Mix16(data + 16 * i, kSecret + 32 * i);
+    hash += Mix16(data + size - 16 * (i + 1), kSecret + 32 * i + 16);
+  }
+  return Avalanche(hash);
+}
+
+uint64_t Hash129To240(const uint8_t* data, size_t size) {
+  const size_t kStartOffset = 3;
+  const size_t kLastOffset = 17;
+  const size_t kMinSecretSizeBytes = 136;
+  uint64_t hash = size * kPrime64_1;
+  const size_t num_rounds = size / 16;
+  for (size_t i = 0; i < 8; i++) {
+    hash += Mix16(data + 16 * i, kSecret + 16 * i);
+  }
+  hash = Avalanche(hash);
+  for (size_t i = 8; i < num_rounds; i++) {
+    hash += Mix16(data + 16 * i, kSecret + 16 * (i - 8) + kStartOffset);
+  }
+  hash += Mix16(data + size - 16, kSecret + kMinSecretSizeBytes - kLastOffset);
+  return Avalanche(hash);
+}
+
+void AccumulateStripe(const uint8_t* data, const uint8_t* secret,
+                      uint64_t* accumulators) {
+  for (size_t i = 0; i < kNumAccumulators; i++) {
+    const uint64_t value = Read64(data + 8 * i);
+    const uint64_t keyed = value ^ Read64(secret + 8 * i);
+    accumulators[i ^ 1U] += value;
+    accumulators[i] += (keyed & 0xffffffffU) * (keyed >> 32U);
+  }
+}
+
+void Accumulate(const uint8_t* data, size_t num_stripes,
+                uint64_t* accumulators) {
+  for (size_t stripe = 0; stripe < num_stripes; stripe++) {
+    AccumulateStripe(data + stripe * kStripeSizeBytes,
+                     kSecret + stripe * kSecretConsumeRateBytes, accumulators);
+  }
+}
+
+void Scramble(uint64_t* accumulators) {
+  const uint8_t* secret = kSecret + kSecretSizeBytes - kStripeSizeBytes;
+  for (size_t i = 0; i < kNumAccumulators; i++) {
+    uint64_t accumulator = accumulators[i];
+    accumulator ^= accumulator >> 47U;
+    accumulator ^= Read64(secret + 8 * i);
+    accumulators[i] = accumulator * kPrime32_1;
+  }
+}
+
+void InitializeAccumulators(uint64_t* accumulators) {
+  const uint64_t kInitialAccumulators[kNumAccumulators] = {
+      kPrime32_3, kPrime64_1, kPrime64_2, kPrime64_3,
+      kPrime64_4, kPrime32_2, kPrime64_5, kPrime32_1};
+  memcpy(accumulators, kInitialAccumulators, sizeof(kInitialAccumulators));
+}
+
+// Completes the hash of |size| bytes, more than kMidSizeMaxBytes, whose
+// stripes up to but excluding the last byte have been accumulated into
+// |accumulators|; |last_stripe| holds the final kStripeSizeBytes bytes.
+uint64_t FinishLong(uint64_t* accumulators, const uint8_t* last_stripe,
+                    uint64_t size) {
+  const size_t kLastStripeSecretOffset = 7;
+  const size_t kMergeSecretOffset = 11;
+  AccumulateStripe(last_stripe,
+                   kSecret + kSecretSizeBytes - kStripeSizeBytes -
+                       kLastStripeSecretOffset,
+                   accumulators);
+  uint64_t hash = size * kPrime64_1;
+  for (size_t i = 0; i < kNumAccumulators / 2; i++) {
+    const uint8_t* secret = kSecret + kMergeSecretOffset + 16 * i;
+    hash += Multiply128Fold64(accumulators[2 * i] ^ Read64(secret),
+                              accumulators[2 * i + 1] ^ Read64(secret + 8));
+  }
+  return Avalanche(hash);
+}
+
+uint64_t HashLong(const uint8_t* data, size_t size) {
+  uint64_t accumulators[kNumAccumulators];
+  InitializeAccumulators(accumulators);
+  const size_t num_blocks = (size - 1) / kBlockSizeBytes;
+  for (size_t block = 0; block < num_blocks; block++) {
+    Accumulate(data + block * kBlockSizeBytes, kStripesPerBlock, accumulators);
+    Scramble(accumulators);
+  }
+  const size_t num_stripes =
+      ((size - 1) - num_blocks * kBlockSizeBytes) / kStripeSizeBytes;
+  Accumulate(data + num_blocks * kBlockSizeBytes, num_stripes, accumulators);
+  return FinishLong(accumulators, data + size - kStripeSizeBytes, size);
+}
+
+}  // namespace
+
+uint64_t Xxh3Hash64(const uint8_t* data, size_t size) {
+  if (size <= 16) {
+    return Hash0To16(data, size);
+  }
+  if (size <= 128) {
+    return Hash17To128(data, size);
+  }
+  if (size <= kMidSizeMaxBytes) {
+    return Hash129To240(data, size);
+  }
+  return HashLong(data, size);
+}
+
+Xxh3Hasher::Xxh3Hasher()
+    : num_block_stripes_(0),
+      total_size_(0),
+      short_input_{},
+      previous_stripe_{},
+      stripe_{},
+      stripe_size_(0) {
+  static_assert(kShortInputSizeBytes == kMidSizeMaxBytes &&
+                    kBufferedStripeSizeBytes == kStripeSizeBytes &&
+                    kNumHashAccumulators == kNumAccumulators,
+                "The hasher's buffers must match the XXH3 parameters");
+  InitializeAccumulators(accumulators_);
+}
+
+void Xxh3Hasher::Update(const uint8_t* data, size_t size) {
+  if (total_size_ < kShortInputSizeBytes) {
+    const size_t short_bytes = static_cast<size_t>(
+        std::min<uint64_t>(size, kShortInputSizeBytes - total_size_));
+    memcpy(short_input_ + total_size_, data, short_bytes);
+  }
+  total_size_ += size;
+  if (stripe_size_ + size <= kStripeSizeBytes) {
+    memcpy(stripe_ + stripe_size_, data, size);
+    stripe_size_ += size;
+    return;
+  }
+  // A stripe is only accumulated once it is known not to hold the last byte
+  // of the input, as HashLong does; the final bytes are kept in |stripe_|.
+  if (stripe_size_ > 0) {
+    const size_t fill_bytes = kStripeSizeBytes - stripe_size_;
+    memcpy(stripe_ + stripe_size_, data, fill_bytes);
+    data += fill_bytes;
+    size -= fill_bytes;
+    ConsumeStripe(stripe_);
+    memcpy(previous_stripe_, stripe_, kStripeSizeBytes);
+  }
+  if (size > kStripeSizeBytes) {
+    for (; size > kStripeSizeBytes; size -= kStripeSizeBytes) {
+      ConsumeStripe(data);
+      data += kStripeSizeBytes;
+    }
+    memcpy(previous_stripe_, data - kStripeSizeBytes, kStripeSizeBytes);
+  }
+  memcpy(stripe_, data, size);
+  stripe_size_ = size;
+}
+
+uint64_t Xxh3Hasher::Digest() const {
+  if (total_size_ <= kShortInputSizeBytes) {
+    return Xxh3Hash64(short_input_, static_cast<size_t>(total_size_));
+  }
+  uint8_t last_stripe[kStripeSizeBytes];
+  memcpy(last_stripe, previous_stripe_ + stripe_size_,
+         kStripeSizeBytes - stripe_size_);
+  memcpy(last_stripe + kStripeSizeBytes - stripe_size_, stripe_, stripe_size_);
+  uint64_t accumulators[kNumAccumulators];
+  memcpy(accumulators, accumulators_, sizeof(accumulators));
+  return FinishLong(accumulators, last_stripe, total_size_);
+}
+
+void Xxh3Hasher::ConsumeStripe(const uint8_t* stripe) {
+  AccumulateStripe(stripe,
+                   kSecret + num_block_stripes_ * kSecretConsumeRateBytes,
+                   accumulators_);
+  if (++num_block_stripes_ == kStripesPerBlock) {
+    Scramble(accumulators_);
+    num_block_stripes_ = 0;
+  }
+}
+
+std::string HashToHexString(uint64_t hash) {
+  const char kDigits[] = "0123456789abcdef";
+  std::string result(16, '0');
+  for (size_t i = 0; i < 16; i++) {
+    result[15 - i] = kDigits[(hash >> (4 * i)) & 0xfU];
+  }
+  return result;
+}
+
+}  // namespace shadertrap
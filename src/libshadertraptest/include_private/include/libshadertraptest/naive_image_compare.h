@@ -0,0 +1,42 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef LIBSHADERTRAPTEST_NAIVE_IMAGE_COMPARE_H
+#define LIBSHADERTRAPTEST_NAIVE_IMAGE_COMPARE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "libshadertrap/image_compare.h"
+
+namespace shadertrap {
+
+// Returns a |width| x |height| RGBA image whose channels take varied values.
+std::vector<uint8_t> MakeImage(size_t width, size_t height);
+
+// Returns a copy of |pixels| with small changes to scattered channels.
+std::vector<uint8_t> Perturb(const std::vector<uint8_t>& pixels);
+
+// Compares the images one pixel and one window at a time, sharing no work
+// between windows, as a reference for CompareImages.
+ImageDifferences CompareImagesNaively(const std::vector<uint8_t>& data_1,
+                                      const std::vector<uint8_t>& data_2,
+                                      size_t width, size_t height,
+                                      uint8_t channel_tolerance,
+                                      bool compute_ssim);
+
+}  // namespace shadertrap
+
+#endif  // LIBSHADERTRAPTEST_NAIVE_IMAGE_COMPARE_H
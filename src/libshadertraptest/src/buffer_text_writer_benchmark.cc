@@ -0,0 +1,116 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <streambuf>
+#include <vector>
+
+#include "libshadertrap/buffer_text_writer.h"
+#include "libshadertrap/token.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+using FormatEntry = CommandDumpBufferText::FormatEntry;
+
+// A stream buffer that discards its output, so that the benchmark measures
+// formatting rather than the growth of a string.
+class NullStreamBuffer : public std::streambuf {
+ protected:
+  std::streamsize xsputn(const char* /*unused*/, std::streamsize count) final {
+    return count;
+  }
+  int_type overflow(int_type c) final { return traits_type::not_eof(c); }
+};
+
+// Formats |count| values of type T from |data| in the way DUMP_BUFFER_TEXT
+// used to, by copying them out and writing each to |stream|.
+template <typename T>
+void WriteWithStream(const uint8_t* data, size_t count, std::ostream* stream) {
+  std::vector<T> values(count);
+  memcpy(values.data(), data, count * sizeof(T));
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) {
+      *stream << " ";
+    }
+    *stream << values[i];
+  }
+}
+
+// Reports the throughput of formatting each kind of value, compared with
+// writing each value to an output stream.
+TEST(BufferTextWriterBenchmark, Throughput) {
+  const size_t kNumValues = 16 * 1024 * 1024;
+  // Values of varied magnitude, most of which are not whole numbers when
+  // interpreted as floats.
+  std::vector<uint32_t> words(kNumValues);
+  for (size_t i = 0; i < kNumValues; i++) {
+    words[i] =
+        static_cast<uint32_t>(0x3c000000U + i * 2654435761U % 0x06000000U);
+  }
+  std::vector<uint8_t> data(words.size() * sizeof(uint32_t));
+  memcpy(data.data(), words.data(), data.size());
+  const struct {
+    const char* name;
+    FormatEntry::Kind kind;
+    size_t count;
+  } kKinds[] = {{"byte", FormatEntry::Kind::kByte, kNumValues * 4},
+                {"int", FormatEntry::Kind::kInt, kNumValues},
+                {"uint", FormatEntry::Kind::kUint, kNumValues},
+                {"float", FormatEntry::Kind::kFloat, kNumValues}};
+  NullStreamBuffer null_stream_buffer;
+  for (const auto& kind : kKinds) {
+    std::vector<FormatEntry> format_entries;
+    format_entries.push_back({nullptr, kind.kind, kind.count});
+    std::ostream stream(&null_stream_buffer);
+    auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(WriteBufferText(data.data(), format_entries, &stream));
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::ostream reference_stream(&null_stream_buffer);
+    auto reference_start = std::chrono::steady_clock::now();
+    switch (kind.kind) {
+      case FormatEntry::Kind::kByte:
+        // An output stream writes each byte as a character.
+        WriteWithStream<uint8_t>(data.data(), kind.count, &reference_stream);
+        break;
+      case FormatEntry::Kind::kInt:
+        WriteWithStream<int32_t>(data.data(), kind.count, &reference_stream);
+        break;
+      case FormatEntry::Kind::kUint:
+        WriteWithStream<uint32_t>(data.data(), kind.count, &reference_stream);
+        break;
+      default:
+        WriteWithStream<float>(data.data(), kind.count, &reference_stream);
+        break;
+    }
+    std::chrono::duration<double> reference_elapsed =
+        std::chrono::steady_clock::now() - reference_start;
+    std::cout << "Formatted " << kind.count << " " << kind.name
+              << " values at "
+              << static_cast<double>(kind.count) / elapsed.count() / 1e6
+              << " M/s; an output stream manages "
+              << static_cast<double>(kind.count) / reference_elapsed.count() /
+                     1e6
+              << " M/s" << std::endl;
+  }
+}
+
+}  // namespace
+}  // namespace shadertrap
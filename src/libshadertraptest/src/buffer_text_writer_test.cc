@@ -0,0 +1,206 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/buffer_text_writer.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/make_unique.h"
+#include "libshadertrap/token.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+using FormatEntry = CommandDumpBufferText::FormatEntry;
+
+std::vector<FormatEntry> MakeFormat(FormatEntry::Kind kind, size_t count) {
+  std::vector<FormatEntry> format_entries;
+  format_entries.push_back({nullptr, kind, count});
+  return format_entries;
+}
+
+template <typename T>
+std::vector<uint8_t> ToBytes(const std::vector<T>& values) {
+  std::vector<uint8_t> bytes(values.size() * sizeof(T));
+  memcpy(bytes.data(), values.data(), bytes.size());
+  return bytes;
+}
+
+std::string WriteToString(const std::vector<uint8_t>& data,
+                          const std::vector<FormatEntry>& format_entries) {
+  std::ostringstream stream;
+  EXPECT_TRUE(WriteBufferText(data.data(), format_entries, &stream));
+  return stream.str();
+}
+
+// Formats |count| values of type T from |data| in the way DUMP_BUFFER_TEXT
+// used to, by copying them out and writing each to |stream|.
+template <typename T>
+void WriteWithStream(const uint8_t* data, size_t count, std::ostream* stream) {
+  std::vector<T> values(count);
+  memcpy(values.data(), data, count * sizeof(T));
+  for (size_t i = 0; i < count; i++) {
+    if (i > 0) {
+      *stream << " ";
+    }
+    *stream << values[i];
+  }
+}
+
+template <typename T>
+std::string WriteWithStream(const std::vector<T>& values) {
+  std::ostringstream stream;
+  WriteWithStream<T>(ToBytes(values).data(), values.size(), &stream);
+  return stream.str();
+}
+
+TEST(BufferTextWriterTest, IntegersMatchStreamOutput) {
+  std::vector<int32_t> ints = {0,
+                               1,
+                               -1,
+                               42,
+                               -1000000,
+                               std::numeric_limits<int32_t>::max(),
+                               std::numeric_limits<int32_t>::min()};
+  ASSERT_EQ(WriteWithStream(ints),
+            WriteToString(ToBytes(ints),
+                          MakeFormat(FormatEntry::Kind::kInt, ints.size())));
+  std::vector<uint32_t> uints = {0, 9, 10, 4294967295U};
+  ASSERT_EQ(WriteWithStream(uints),
+            WriteToString(ToBytes(uints),
+                          MakeFormat(FormatEntry::Kind::kUint, uints.size())));
+}
+
+TEST(BufferTextWriterTest, BytesAreWrittenAsIntegers) {
+  ASSERT_EQ("0 7 128 255", WriteToString({0, 7, 128, 255},
+                                         MakeFormat(FormatEntry::Kind::kByte,
+                                                    4)));
+}
+
+TEST(BufferTextWriterTest, FloatsExactInSixDigitsMatchStreamOutput) {
+  std::vector<float> floats = {0.0F,
+                               -0.0F,
+                               1.0F,
+                               -2.5F,
+                               0.1F,
+                               1e-3F,
+                               123456.0F,
+                               -999999.0F,
+                               1e6F,
+                               1e10F,
+                               3e-20F,
+                               std::numeric_limits<float>::infinity(),
+                               -std::numeric_limits<float>::infinity(),
+                               std::numeric_limits<float>::quiet_NaN()};
+  ASSERT_EQ(
+      WriteWithStream(floats),
+      WriteToString(ToBytes(floats),
+                    MakeFormat(FormatEntry::Kind::kFloat, floats.size())));
+}
+
+TEST(BufferTextWriterTest, FloatsReadBackExactly) {
+  std::vector<float> floats = {3.14159265F, 1234567.0F, 16777215.0F,
+                               1.0F / 3.0F};
+  ASSERT_EQ("3.1415927 1234567 16777215 0.33333334",
+            WriteToString(ToBytes(floats),
+                          MakeFormat(FormatEntry::Kind::kFloat, 4)));
+  // Bit patterns spread across the whole range of floats.
+  floats.clear();
+  for (uint32_t bits = 0; bits < 0xff000000U; bits += 0x00f0f0f1U) {
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    if (std::isfinite(value)) {
+      floats.push_back(value);
+      floats.push_back(-value);
+    }
+  }
+  std::istringstream text(WriteToString(
+      ToBytes(floats), MakeFormat(FormatEntry::Kind::kFloat, floats.size())));
+  for (float expected : floats) {
+    std::string word;
+    text >> word;
+    ASSERT_EQ(expected, std::strtof(word.c_str(), nullptr)) << word;
+  }
+}
+
+TEST(BufferTextWriterTest, FloatsUseShortestPrecisionThatReadsBack) {
+  // Bit patterns spread densely across the range of floats that have an
+  // exact integer formatting path, plus powers of two, whose neighbouring
+  // floats are unevenly spaced.
+  std::vector<float> floats;
+  for (uint32_t bits = 0x3a000000U; bits < 0x5b000000U; bits += 0x0000f0f1U) {
+    float value;
+    memcpy(&value, &bits, sizeof(float));
+    floats.push_back(value);
+  }
+  for (int exponent = -20; exponent <= 60; exponent++) {
+    floats.push_back(std::ldexp(1.0F, exponent));
+  }
+  std::istringstream text(WriteToString(
+      ToBytes(floats), MakeFormat(FormatEntry::Kind::kFloat, floats.size())));
+  for (float value : floats) {
+    std::string word;
+    text >> word;
+    char expected[32];
+    for (int precision = 6; precision <= 9; precision++) {
+      snprintf(expected, sizeof(expected), "%.*g", precision,
+               static_cast<double>(value));
+      if (std::strtof(expected, nullptr) == value) {
+        break;
+      }
+    }
+    ASSERT_EQ(std::string(expected), word);
+  }
+}
+
+TEST(BufferTextWriterTest, StringsAndSkippedBytes) {
+  std::vector<uint8_t> data = ToBytes(std::vector<int32_t>({3, -4, 99}));
+  std::vector<uint8_t> float_data = ToBytes(std::vector<float>({0.5F}));
+  data.insert(data.end(), float_data.begin(), float_data.end());
+  std::vector<FormatEntry> format_entries;
+  format_entries.push_back(
+      {MakeUnique<Token>(Token::Type::kString, "x = ", 1, 1),
+       FormatEntry::Kind::kString, 0});
+  format_entries.push_back({nullptr, FormatEntry::Kind::kInt, 2});
+  format_entries.push_back({nullptr, FormatEntry::Kind::kSkip, 4});
+  format_entries.push_back({MakeUnique<Token>(Token::Type::kString, "\n", 1, 1),
+                            FormatEntry::Kind::kString, 0});
+  format_entries.push_back({nullptr, FormatEntry::Kind::kFloat, 1});
+  ASSERT_EQ("x = 3 -4\n0.5", WriteToString(data, format_entries));
+}
+
+TEST(BufferTextWriterTest, OutputLargerThanAChunk) {
+  std::vector<uint32_t> uints(1000000);
+  std::string expected;
+  for (size_t i = 0; i < uints.size(); i++) {
+    uints[i] = static_cast<uint32_t>(i * 4099);
+    expected += (i > 0 ? " " : "") + std::to_string(uints[i]);
+  }
+  ASSERT_EQ(expected,
+            WriteToString(ToBytes(uints),
+                          MakeFormat(FormatEntry::Kind::kUint, uints.size())));
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -504,6 +504,100 @@ CREATE_EMPTY_TEXTURE_2D name WIDTH 12 HEIGHT 12
             message_consumer.GetMessageString(0));
 }
 
+TEST_F(CheckerTestFixture, AssertEqualFileBadBuffer) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_RENDERBUFFER rb WIDTH 8 HEIGHT 8
+ASSERT_EQUAL BUFFER rb FILE "expected.bin"
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 3:21: 'rb' must be a buffer",
+            message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, AssertMatchesImageBadRenderbuffer) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_MATCHES_IMAGE RENDERBUFFER doesnotexist FILE "expected.png"
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:35: 'doesnotexist' must be a renderbuffer",
+            message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, AssertEqualToleranceWithoutFloats) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_BUFFER buf1 SIZE_BYTES 8 INIT_VALUES uint 1 2
+CREATE_BUFFER buf2 SIZE_BYTES 8 INIT_VALUES uint 1 2
+ASSERT_EQUAL BUFFERS buf1 buf2 FORMAT uint 2 TOLERANCE ULP 1
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 4:56: TOLERANCE only applies to 'float' formatting entries, and "
+      "there are none",
+      message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, AssertBufferHashBadBuffer) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_BUFFER_HASH BUFFER doesnotexist HASH "78af5f94892f3950"
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:27: 'doesnotexist' must be a buffer",
+            message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, AssertBufferHashFormatDoesNotCoverBuffer) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_BUFFER buf SIZE_BYTES 16 INIT_VALUES uint 1 2 3 4
+ASSERT_BUFFER_HASH BUFFER buf FORMAT SKIP_BYTES 4 uint 2
+    HASH "a38b4227fb240906"
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 3:38: The number of bytes specified in the formatting of 'buf' "
+      "is 12, but 'buf' was declared with size 16 bytes at 2:1",
+      message_consumer.GetMessageString(0));
+}
+
 TEST_F(CheckerTestFixture, AssertEqualDifferentWidthRenderbuffers) {
   std::string program = R"(GLES 3.1
 CREATE_RENDERBUFFER buf1 WIDTH 1 HEIGHT 1
@@ -805,6 +899,43 @@ ASSERT_SIMILAR_EMD_HISTOGRAM RENDERBUFFERS buf1 buf2 TOLERANCE 1.0
       message_consumer.GetMessageString(0));
 }
 
+TEST_F(CheckerTestFixture, AssertSimilarImageBadSecondArgument) {
+  std::string program = R"(GLES 3.1
+CREATE_RENDERBUFFER rb1 WIDTH 24 HEIGHT 24
+ASSERT_SIMILAR_IMAGE RENDERBUFFERS rb1 rb2 TOLERANCE 1
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 3:40: 'rb2' must be a renderbuffer",
+            message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, AssertSimilarImageSsimOfSmallRenderbuffers) {
+  std::string program = R"(GLES 3.1
+CREATE_RENDERBUFFER rb1 WIDTH 24 HEIGHT 4
+CREATE_RENDERBUFFER rb2 WIDTH 24 HEIGHT 4
+ASSERT_SIMILAR_IMAGE RENDERBUFFERS rb1 rb2 MIN_SSIM 0.9
+)";
+
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 4:53: MIN_SSIM requires renderbuffers of at least 8x8 pixels, "
+      "but 'rb1' is 24x4",
+      message_consumer.GetMessageString(0));
+}
+
 TEST_F(CheckerTestFixture, BindSamplerBadSampler) {
   std::string program = R"(GLES 3.1
 BIND_SAMPLER SAMPLER doesnotexist TEXTURE_UNIT 1
@@ -1648,5 +1779,264 @@ ASSERT_EQUAL BUFFERS buf1 buf2 FORMAT SKIP_BYTES 3 float 4
       message_consumer.GetMessageString(0));
 }
 
+TEST_F(CheckerTestFixture, RunComputeIndirectBadOffsets) {
+  std::string program =
+      R"(GLES 3.1
+DECLARE_SHADER comp KIND COMPUTE
+#version 310 es
+void main() { }
+END
+COMPILE_SHADER comp_compiled SHADER comp
+CREATE_PROGRAM prog SHADERS comp_compiled
+CREATE_BUFFER buf SIZE_BYTES 16 INIT_VALUES uint 1 1 1 1
+RUN_COMPUTE_INDIRECT PROGRAM prog BUFFER buf OFFSET_BYTES [ 0, 4, 6, 8 ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 9:67: The offset 6 into 'buf' must be a multiple of 4",
+            message_consumer.GetMessageString(0));
+  ASSERT_EQ(
+      "ERROR: 9:70: The numbers of groups at offset 8 occupy 12 bytes, which "
+      "overruns 'buf', declared with size 16 bytes at 8:1",
+      message_consumer.GetMessageString(1));
+}
+
+TEST_F(CheckerTestFixture, RunComputeIndirectNonexistentBuffer) {
+  std::string program =
+      R"(GLES 3.1
+DECLARE_SHADER comp KIND COMPUTE
+#version 310 es
+void main() { }
+END
+COMPILE_SHADER comp_compiled SHADER comp
+CREATE_PROGRAM prog SHADERS comp_compiled
+RUN_COMPUTE_INDIRECT PROGRAM prog BUFFER buf OFFSET_BYTES 0
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 8:42: 'buf' must be a buffer",
+            message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, InstancingNotSupportedWithGles2) {
+  std::string program =
+      R"(GLES 2.0
+DECLARE_SHADER frag KIND FRAGMENT
+#version 100
+precision highp float;
+void main() {
+ gl_FragColor = vec4(1.0, 0.0, 0.0, 1.0);
+}
+END
+DECLARE_SHADER vert KIND VERTEX
+#version 100
+attribute vec2 a_pos;
+void main(void) {
+    gl_Position = vec4(a_pos, 0.0, 1.0);
+}
+END
+COMPILE_SHADER frag_compiled SHADER frag
+COMPILE_SHADER vert_compiled SHADER vert
+CREATE_PROGRAM program SHADERS vert_compiled frag_compiled
+CREATE_BUFFER vertex_buffer SIZE_BYTES 24 INIT_VALUES float
+                           0.0 -1.0
+                           -1.0 1.0
+                            1.0 1.0
+CREATE_RENDERBUFFER renderbuffer WIDTH 256 HEIGHT 256
+RUN_GRAPHICS
+  PROGRAM program
+  VERTEX_DATA
+    [ 0 -> BUFFER vertex_buffer OFFSET_BYTES 0 STRIDE_BYTES 8 DIMENSION 2
+                  DIVISOR 1 ]
+  VERTEX_COUNT 3
+  INSTANCE_COUNT 2
+  TOPOLOGY TRIANGLES
+  FRAMEBUFFER_ATTACHMENTS
+    [ 0 -> renderbuffer ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 27:19: Vertex attribute divisors are not supported before "
+      "OpenGL 3.3 or OpenGL ES 3.0",
+      message_consumer.GetMessageString(0));
+  ASSERT_EQ(
+      "ERROR: 24:1: Instanced draws are not supported before OpenGL 3.1 or "
+      "OpenGL ES 3.0",
+      message_consumer.GetMessageString(1));
+}
+
+TEST_F(CheckerTestFixture, RunGraphicsIndirectBadOffsets) {
+  std::string program =
+      R"(GLES 3.1
+DECLARE_SHADER frag KIND FRAGMENT
+#version 310 es
+precision highp float;
+layout(location = 0) out vec4 color;
+void main() {
+ color = vec4(1.0, 0.0, 0.0, 1.0);
+}
+END
+DECLARE_SHADER vert KIND VERTEX
+#version 310 es
+layout(location = 0) in vec2 pos;
+void main(void) {
+    gl_Position = vec4(pos, 0.0, 1.0);
+}
+END
+COMPILE_SHADER frag_compiled SHADER frag
+COMPILE_SHADER vert_compiled SHADER vert
+CREATE_PROGRAM program SHADERS vert_compiled frag_compiled
+CREATE_BUFFER vertex_buffer SIZE_BYTES 24 INIT_VALUES float
+                           0.0 -1.0
+                           -1.0 1.0
+                            1.0 1.0
+CREATE_BUFFER draws SIZE_BYTES 32 INIT_VALUES uint 3 1 0 0 3 1 0 0
+CREATE_RENDERBUFFER renderbuffer WIDTH 256 HEIGHT 256
+RUN_GRAPHICS
+  PROGRAM program
+  VERTEX_DATA
+    [ 0 -> BUFFER vertex_buffer OFFSET_BYTES 0 STRIDE_BYTES 8 DIMENSION 2 ]
+  INDIRECT_DATA draws OFFSET_BYTES [ 0, 2, 16, 20 ]
+  TOPOLOGY TRIANGLES
+  FRAMEBUFFER_ATTACHMENTS
+    [ 0 -> renderbuffer ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 30:41: The offset 2 into 'draws' must be a multiple of 4",
+            message_consumer.GetMessageString(0));
+  ASSERT_EQ(
+      "ERROR: 30:48: The draw parameters at offset 20 occupy 16 bytes, which "
+      "overruns 'draws', declared with size 32 bytes at 24:1",
+      message_consumer.GetMessageString(1));
+}
+
+TEST_F(CheckerTestFixture, UpdateBufferOverrun) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_BUFFER buf SIZE_BYTES 16 INIT_VALUES uint 1 2 3 4
+UPDATE_BUFFER buf OFFSET_BYTES 8 INIT_VALUES uint 5 6
+UPDATE_BUFFER buf OFFSET_BYTES 12 INIT_VALUES uint 7 8
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 4:1: Updating 8 bytes at offset 12 overruns 'buf', declared with "
+      "size 16 bytes at 2:1",
+      message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, UpdateBufferNonexistentBuffer) {
+  std::string program =
+      R"(GLES 3.1
+UPDATE_BUFFER buf OFFSET_BYTES 0 INIT_VALUES uint 1
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:15: 'buf' must be a buffer",
+            message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, CreateTexture2DFormatNotSupportedWithGles2) {
+  std::string program =
+      R"(GLES 2.0
+CREATE_TEXTURE_2D tex WIDTH 1 HEIGHT 1 FORMAT R8 INIT_VALUES byte 255
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:1: Texture format R8 is not supported before OpenGL 3.0 or "
+      "OpenGL ES 3.0",
+      message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, CreateTexture2DGenerateMipmapsIntegerFormat) {
+  std::string program =
+      R"(GL 4.5
+CREATE_TEXTURE_2D tex WIDTH 1 HEIGHT 1 FORMAT R32UI INIT_VALUES uint 1
+    GENERATE_MIPMAPS
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:1: GENERATE_MIPMAPS cannot be used with texture format R32UI: "
+      "integer formats are not filterable",
+      message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, CreateTexture2DGenerateMipmapsFloatFormatGles) {
+  std::string program =
+      R"(GLES 3.2
+CREATE_TEXTURE_2D tex WIDTH 1 HEIGHT 1 FORMAT RGBA32F
+    INIT_VALUES float 1.0 1.0 1.0 1.0 GENERATE_MIPMAPS
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_FALSE(checker.VisitCommands(parsed_program.get()));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:1: GENERATE_MIPMAPS cannot be used with texture format "
+      "RGBA32F: it is not filterable or color-renderable on OpenGL ES",
+      message_consumer.GetMessageString(0));
+}
+
+TEST_F(CheckerTestFixture, CreateTexture2DGenerateMipmapsFloatFormatGl) {
+  std::string program =
+      R"(GL 4.5
+CREATE_TEXTURE_2D tex WIDTH 1 HEIGHT 1 FORMAT RGBA32F
+    INIT_VALUES float 1.0 1.0 1.0 1.0 GENERATE_MIPMAPS
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  Checker checker(&message_consumer, parsed_program->GetApiVersion());
+  ASSERT_TRUE(checker.VisitCommands(parsed_program.get()));
+}
+
 }  // namespace
 }  // namespace shadertrap
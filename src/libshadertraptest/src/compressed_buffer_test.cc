@@ -0,0 +1,129 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/compressed_buffer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+#ifdef SHADERTRAP_LODEPNG
+
+TEST(CompressedBufferTest, RoundTripInSeveralChunks) {
+  // Mostly zeros with a repeating pattern, as in typical buffer dumps, split
+  // into chunks the last of which is short.
+  std::vector<uint8_t> data(10000, 0);
+  for (size_t i = 0; i < data.size(); i += 7) {
+    data[i] = static_cast<uint8_t>(i);
+  }
+  std::vector<uint8_t> compressed;
+  std::string error;
+  ASSERT_TRUE(CompressBuffer(data.data(), data.size(), 4096, &compressed,
+                             &error));
+  ASSERT_LT(compressed.size(), data.size() / 4);
+  ASSERT_EQ("STZB", std::string(compressed.begin(), compressed.begin() + 4));
+  std::vector<uint8_t> decompressed;
+  ASSERT_TRUE(DecompressBuffer(compressed.data(), compressed.size(),
+                               &decompressed, &error));
+  ASSERT_EQ(data, decompressed);
+}
+
+TEST(CompressedBufferTest, StreamedRoundTripIsPassedOnAChunkAtATime) {
+  std::vector<uint8_t> data(10000);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<uint8_t>(i / 100);
+  }
+  std::stringstream compressed;
+  std::string error;
+  size_t num_compressed_pieces = 0;
+  ASSERT_TRUE(CompressBuffer(
+      data.data(), data.size(), 4096,
+      [&compressed, &num_compressed_pieces](const uint8_t* piece,
+                                            size_t size) -> bool {
+        compressed.write(reinterpret_cast<const char*>(piece),
+                         static_cast<std::streamsize>(size));
+        num_compressed_pieces++;
+        return true;
+      },
+      &error));
+  // The header, then the size and the data of each of the three chunks.
+  ASSERT_EQ(7, num_compressed_pieces);
+  std::vector<size_t> piece_sizes;
+  std::vector<uint8_t> decompressed;
+  ASSERT_TRUE(DecompressBuffer(
+      &compressed,
+      [&piece_sizes, &decompressed](const uint8_t* piece, size_t size) -> bool {
+        piece_sizes.push_back(size);
+        decompressed.insert(decompressed.end(), piece, piece + size);
+        return true;
+      },
+      &error));
+  ASSERT_EQ(std::vector<size_t>({4096, 4096, 1808}), piece_sizes);
+  ASSERT_EQ(data, decompressed);
+}
+
+TEST(CompressedBufferTest, EmptyBuffer) {
+  std::vector<uint8_t> compressed;
+  std::string error;
+  ASSERT_TRUE(CompressBuffer(nullptr, 0, kCompressedBufferChunkSizeBytes,
+                             &compressed, &error));
+  ASSERT_EQ(16, compressed.size());
+  std::vector<uint8_t> decompressed(1, 0);
+  ASSERT_TRUE(DecompressBuffer(compressed.data(), compressed.size(),
+                               &decompressed, &error));
+  ASSERT_TRUE(decompressed.empty());
+}
+
+TEST(CompressedBufferTest, InvalidData) {
+  std::vector<uint8_t> data(100, 42);
+  std::vector<uint8_t> compressed;
+  std::string error;
+  ASSERT_TRUE(
+      CompressBuffer(data.data(), data.size(), 64, &compressed, &error));
+  std::vector<uint8_t> decompressed;
+  ASSERT_FALSE(DecompressBuffer(data.data(), data.size(), &decompressed,
+                                &error));
+  ASSERT_EQ("not a compressed buffer", error);
+  ASSERT_FALSE(DecompressBuffer(compressed.data(), compressed.size() - 1,
+                                &decompressed, &error));
+  ASSERT_EQ("truncated chunk at offset ", error.substr(0, 26));
+  compressed.push_back(0);
+  ASSERT_FALSE(DecompressBuffer(compressed.data(), compressed.size(),
+                                &decompressed, &error));
+  ASSERT_EQ(
+      "unexpected data at offset " + std::to_string(compressed.size() - 1),
+      error);
+}
+
+#else
+
+TEST(CompressedBufferTest, UnavailableWithoutLodepng) {
+  const uint8_t data = 0;
+  std::vector<uint8_t> compressed;
+  std::string error;
+  ASSERT_FALSE(CompressBuffer(&data, 1, kCompressedBufferChunkSizeBytes,
+                              &compressed, &error));
+}
+
+#endif
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,52 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "libshadertrap/emd_histogram.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+// Reports the throughput of computing histograms on the host, as used when
+// compute shaders are unavailable.
+TEST(EmdHistogramBenchmark, HistogramThroughput) {
+  const size_t kNumPixels = 4096 * 4096;
+  const size_t kRepetitions = 8;
+  std::vector<uint8_t> pixels(kNumPixels * 4);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    pixels[i] = static_cast<uint8_t>((i * 7) ^ (i >> 10));
+  }
+  uint64_t total = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kRepetitions; i++) {
+    total += ComputeChannelHistograms(pixels.data(), kNumPixels)[0];
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  ASSERT_LT(0, total);
+  std::cout << "Computed histograms of " << kRepetitions << " x " << kNumPixels
+            << " pixels at "
+            << static_cast<double>(kRepetitions * kNumPixels) /
+                   elapsed.count() / 1e6
+            << " Mpixels/s" << std::endl;
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,94 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/emd_histogram.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+// Returns |num_pixels| RGBA pixels whose channels take varied values.
+std::vector<uint8_t> MakePixels(size_t num_pixels) {
+  std::vector<uint8_t> pixels(num_pixels * 4);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    pixels[i] = static_cast<uint8_t>((i * 7) ^ (i >> 10));
+  }
+  return pixels;
+}
+
+TEST(EmdHistogramTest, HistogramCountsEachChannel) {
+  const std::vector<uint8_t> pixels = {1, 2, 3, 4, 1, 5, 6, 4, 255, 2, 0, 4};
+  std::vector<uint64_t> histograms = ComputeChannelHistograms(pixels.data(), 3);
+  ASSERT_EQ(4 * kNumHistogramBins, histograms.size());
+  std::vector<uint64_t> expected(4 * kNumHistogramBins, 0);
+  expected[1] = 2;
+  expected[255] = 1;
+  expected[kNumHistogramBins + 2] = 2;
+  expected[kNumHistogramBins + 5] = 1;
+  expected[2 * kNumHistogramBins + 0] = 1;
+  expected[2 * kNumHistogramBins + 3] = 1;
+  expected[2 * kNumHistogramBins + 6] = 1;
+  expected[3 * kNumHistogramBins + 4] = 3;
+  ASSERT_EQ(expected, histograms);
+}
+
+TEST(EmdHistogramTest, LargeHistogramMatchesSequentialCount) {
+  // Large enough, with an uneven number of pixels, for the work to be split
+  // between threads on a multi-core machine.
+  const size_t kNumPixels = 3000001;
+  std::vector<uint8_t> pixels = MakePixels(kNumPixels);
+  std::vector<uint64_t> expected(4 * kNumHistogramBins, 0);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    expected[(i % 4) * kNumHistogramBins + pixels[i]]++;
+  }
+  ASSERT_EQ(expected, ComputeChannelHistograms(pixels.data(), kNumPixels));
+}
+
+TEST(EmdHistogramTest, EmdOfIdenticalHistogramsIsZero) {
+  std::vector<uint8_t> pixels = MakePixels(1000);
+  std::vector<uint64_t> histograms =
+      ComputeChannelHistograms(pixels.data(), 1000);
+  ASSERT_EQ(0.0, ComputeMaxEmd(histograms, histograms, 1000));
+}
+
+TEST(EmdHistogramTest, EmdIsMaximumOverChannels) {
+  // All pixels of the first image are black and all pixels of the second have
+  // full red and half green, so the red channel's earth is moved furthest.
+  std::vector<uint8_t> pixels_1(16 * 4, 0);
+  std::vector<uint8_t> pixels_2;
+  for (size_t i = 0; i < 16; i++) {
+    pixels_2.insert(pixels_2.end(), {255, 128, 0, 0});
+  }
+  ASSERT_DOUBLE_EQ(
+      255.0 / 256.0,
+      ComputeMaxEmd(ComputeChannelHistograms(pixels_1.data(), 16),
+                    ComputeChannelHistograms(pixels_2.data(), 16), 16));
+  // Moving half of the red channel's earth by one bin.
+  pixels_2 = pixels_1;
+  for (size_t i = 0; i < 8; i++) {
+    pixels_2[i * 4] = 1;
+  }
+  ASSERT_DOUBLE_EQ(
+      0.5 / 256.0,
+      ComputeMaxEmd(ComputeChannelHistograms(pixels_1.data(), 16),
+                    ComputeChannelHistograms(pixels_2.data(), 16), 16));
+}
+
+}  // namespace
+}  // namespace shadertrap
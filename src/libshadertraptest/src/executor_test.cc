@@ -0,0 +1,160 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/executor.h"
+
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <string>
+
+#include "libshadertrap/gl_error_policy.h"
+#include "libshadertrap/gl_functions.h"
+#include "libshadertrap/memory_output_sink.h"
+#include "libshadertrap/parser.h"
+#include "libshadertrap/shadertrap_program.h"
+#include "libshadertraptest/collecting_message_consumer.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+// Creates a buffer of 8 bytes, whose creation the fake GL implementation below
+// makes fail, after one that is created successfully.
+const char* const kProgram = R"(GLES 3.1
+CREATE_BUFFER good SIZE_BYTES 4 INIT_VALUES uint 1
+CREATE_BUFFER bad SIZE_BYTES 8 INIT_VALUES uint 1 2
+)";
+
+// Records the GL functions called by the executor that are relevant to error
+// reporting. Creating a buffer of 8 bytes raises two GL_INVALID_VALUE errors,
+// which are returned by glGetError and are also passed to the debug message
+// callback if one is installed.
+class FakeGl {
+ public:
+  FakeGl() : num_get_error_calls_(0), callback_(nullptr), user_param_(nullptr) {
+    functions_.glBindBuffer_ = [](GLenum /*target*/, GLuint /*buffer*/) {};
+    functions_.glBufferData_ = [this](GLenum /*target*/, GLsizeiptr size,
+                                      const void* /*data*/, GLenum /*usage*/) {
+      if (size != 8) {
+        return;
+      }
+      for (int i = 0; i < 2; i++) {
+        pending_errors_.push_back(GL_INVALID_VALUE);
+        if (callback_ != nullptr) {
+          const std::string message = "size is not allowed";
+          callback_(GL_DEBUG_SOURCE_API, GL_DEBUG_TYPE_ERROR, 0,
+                    GL_DEBUG_SEVERITY_HIGH,
+                    static_cast<GLsizei>(message.size()), message.c_str(),
+                    user_param_);
+        }
+      }
+    };
+    functions_.glDebugMessageCallback_ = [this](GLDEBUGPROC callback,
+                                                const void* user_param) {
+      callback_ = callback;
+      user_param_ = user_param;
+    };
+    functions_.glDebugMessageControl_ =
+        [](GLenum /*source*/, GLenum /*type*/, GLenum /*severity*/,
+           GLsizei /*count*/, const GLuint* /*ids*/, GLboolean /*enabled*/) {};
+    functions_.glEnable_ = [](GLenum /*capability*/) {};
+    functions_.glGenBuffers_ = [](GLsizei count, GLuint* buffers) {
+      for (GLsizei i = 0; i < count; i++) {
+        buffers[i] = static_cast<GLuint>(i + 1);
+      }
+    };
+    functions_.glGetError_ = [this]() -> GLenum {
+      num_get_error_calls_++;
+      if (pending_errors_.empty()) {
+        return GL_NO_ERROR;
+      }
+      GLenum result = pending_errors_.front();
+      pending_errors_.pop_front();
+      return result;
+    };
+  }
+
+  FakeGl(const FakeGl&) = delete;
+
+  FakeGl& operator=(const FakeGl&) = delete;
+
+  GlFunctions* GetFunctions() { return &functions_; }
+
+  size_t GetNumGetErrorCalls() const { return num_get_error_calls_; }
+
+ private:
+  GlFunctions functions_;
+  std::deque<GLenum> pending_errors_;
+  size_t num_get_error_calls_;
+  GLDEBUGPROC callback_;
+  const void* user_param_;
+};
+
+// Runs kProgram with the fake GL implementation using |error_policy|.
+bool RunProgram(FakeGl* fake_gl, GlErrorPolicy error_policy,
+                CollectingMessageConsumer* message_consumer) {
+  Parser parser(kProgram, message_consumer);
+  EXPECT_TRUE(parser.Parse());
+  auto program = parser.GetParsedProgram();
+  MemoryOutputSink output_sink;
+  ExecutorOptions options;
+  options.error_policy = error_policy;
+  options.max_mismatch_reports = 0;
+  Executor executor(fake_gl->GetFunctions(), message_consumer, &output_sink,
+                    program->GetApiVersion(), options);
+  return executor.VisitCommands(program.get());
+}
+
+TEST(ExecutorTest, PerCommandPolicyDrainsErrorsOncePerCommand) {
+  FakeGl fake_gl;
+  CollectingMessageConsumer message_consumer;
+  ASSERT_FALSE(
+      RunProgram(&fake_gl, GlErrorPolicy::kPerCommand, &message_consumer));
+  // One call finds no error after the first command; after the second, both
+  // errors are drained and a final call finds no more.
+  ASSERT_EQ(4, fake_gl.GetNumGetErrorCalls());
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 3:1: OpenGL error: GL_INVALID_VALUE",
+            message_consumer.GetMessageString(0));
+  ASSERT_EQ("ERROR: 3:1: OpenGL error: GL_INVALID_VALUE",
+            message_consumer.GetMessageString(1));
+}
+
+TEST(ExecutorTest, StrictPolicyChecksEachCall) {
+  FakeGl fake_gl;
+  CollectingMessageConsumer message_consumer;
+  ASSERT_FALSE(RunProgram(&fake_gl, GlErrorPolicy::kStrict, &message_consumer));
+  // Three calls per command, the last of which fails at glBufferData.
+  ASSERT_EQ(6, fake_gl.GetNumGetErrorCalls());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 3:1: OpenGL error: glBufferData(): GL_INVALID_VALUE",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ExecutorTest, DebugCallbackPolicyBlamesCommandThatRaisedError) {
+  FakeGl fake_gl;
+  CollectingMessageConsumer message_consumer;
+  ASSERT_FALSE(
+      RunProgram(&fake_gl, GlErrorPolicy::kDebugCallback, &message_consumer));
+  ASSERT_EQ(0, fake_gl.GetNumGetErrorCalls());
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 3:1: OpenGL error: size is not allowed",
+            message_consumer.GetMessageString(0));
+  ASSERT_EQ("ERROR: 3:1: OpenGL error: size is not allowed",
+            message_consumer.GetMessageString(1));
+}
+
+}  // namespace
+}  // namespace shadertrap
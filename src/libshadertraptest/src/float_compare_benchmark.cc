@@ -0,0 +1,68 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "libshadertrap/float_compare.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+using FindFunction = size_t (*)(const uint8_t*, const uint8_t*, size_t,
+                                const FloatTolerance&, FloatErrors*);
+
+// Reports the throughput of comparing large regions of floats that differ in
+// every element but are within tolerance, using SIMD where the target
+// supports it and using scalar code.
+TEST(FloatCompareBenchmark, Throughput) {
+  const size_t kCount = 64 * 1024 * 1024;
+  const size_t kRepetitions = 8;
+  std::vector<float> values_1(kCount);
+  std::vector<float> values_2(kCount);
+  for (size_t i = 0; i < kCount; i++) {
+    values_1[i] = static_cast<float>(i);
+    values_2[i] = std::nextafter(values_1[i], 0.0F);
+  }
+  const struct {
+    const char* name;
+    FindFunction find;
+  } kPaths[] = {{"default", FindFirstFloatOutsideTolerance},
+                {"scalar", FindFirstFloatOutsideToleranceScalar}};
+  for (const auto& path : kPaths) {
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < kRepetitions; i++) {
+      FloatErrors errors = {0.0F, 0.0F, 0};
+      ASSERT_EQ(kCount,
+                path.find(reinterpret_cast<const uint8_t*>(values_1.data()),
+                          reinterpret_cast<const uint8_t*>(values_2.data()),
+                          kCount, {0.0F, 0.0F, 1}, &errors));
+    }
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    std::cout << "Compared " << kRepetitions << " x " << kCount
+              << " floats using the " << path.name << " path at "
+              << static_cast<double>(kRepetitions * kCount * sizeof(float)) /
+                     elapsed.count() / 1e9
+              << " GB/s per buffer" << std::endl;
+  }
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,150 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/float_compare.h"
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+size_t FindFirstOutside(const std::vector<float>& values_1,
+                        const std::vector<float>& values_2,
+                        const FloatTolerance& tolerance,
+                        FloatErrors* errors) {
+  return FindFirstFloatOutsideTolerance(
+      reinterpret_cast<const uint8_t*>(values_1.data()),
+      reinterpret_cast<const uint8_t*>(values_2.data()), values_1.size(),
+      tolerance, errors);
+}
+
+TEST(FloatCompareTest, EachTolerance) {
+  std::vector<float> values_1 = {1.0F, 100.0F, 0.0F, 3.0F};
+  std::vector<float> values_2 = {1.0F, 100.5F, -0.0F,
+                                 std::nextafter(3.0F, 4.0F)};
+  FloatErrors errors = {0.0F, 0.0F, 0};
+  // Without tolerance, only +0 and -0 match despite differing bitwise.
+  ASSERT_EQ(1, FindFirstOutside(values_1, values_2, {0.0F, 0.0F, 0}, &errors));
+  errors = {0.0F, 0.0F, 0};
+  ASSERT_EQ(4, FindFirstOutside(values_1, values_2, {0.5F, 0.0F, 0}, &errors));
+  ASSERT_EQ(0.5F, errors.max_absolute);
+  ASSERT_FLOAT_EQ(0.5F / 100.5F, errors.max_relative);
+  // Floats between 64 and 128 are 2^-17 apart.
+  ASSERT_EQ(65536, errors.max_ulps);
+  errors = {0.0F, 0.0F, 0};
+  ASSERT_EQ(4,
+            FindFirstOutside(values_1, values_2, {0.0F, 0.005F, 1}, &errors));
+  errors = {0.0F, 0.0F, 0};
+  ASSERT_EQ(1, FindFirstOutside(values_1, values_2, {0.0F, 0.0F, 1}, &errors));
+}
+
+TEST(FloatCompareTest, UlpDistanceAcrossZero) {
+  const float kSmallest = std::numeric_limits<float>::denorm_min();
+  std::vector<float> values_1 = {kSmallest};
+  std::vector<float> values_2 = {-kSmallest};
+  FloatErrors errors = {0.0F, 0.0F, 0};
+  ASSERT_EQ(0, FindFirstOutside(values_1, values_2, {0.0F, 0.0F, 1}, &errors));
+  ASSERT_EQ(2, errors.max_ulps);
+  ASSERT_EQ(1, FindFirstOutside(values_1, values_2, {0.0F, 0.0F, 2}, &errors));
+}
+
+TEST(FloatCompareTest, UlpDistanceAboveInt32Max) {
+  const float kMax = std::numeric_limits<float>::max();
+  std::vector<float> values_1 = {kMax, -kMax, kMax, -kMax, kMax};
+  std::vector<float> values_2 = {-kMax, kMax, -kMax, kMax, -kMax};
+  FloatErrors errors = {0.0F, 0.0F, 0};
+  ASSERT_EQ(5, FindFirstOutside(values_1, values_2,
+                                {0.0F, 0.0F, 0xFEFFFFFEU}, &errors));
+  ASSERT_EQ(0xFEFFFFFEU, errors.max_ulps);
+  ASSERT_EQ(0, FindFirstOutside(values_1, values_2,
+                                {0.0F, 0.0F, 0xFEFFFFFDU}, &errors));
+}
+
+TEST(FloatCompareTest, NanAndInfinity) {
+  const float kNan = std::numeric_limits<float>::quiet_NaN();
+  const float kInfinity = std::numeric_limits<float>::infinity();
+  std::vector<float> values_1 = {kNan, kInfinity, kNan};
+  std::vector<float> values_2 = {kNan, kInfinity, 1.0F};
+  FloatErrors errors = {0.0F, 0.0F, 0};
+  // Bitwise equal NaNs match, but a NaN never matches a number, however large
+  // the tolerance.
+  ASSERT_EQ(2, FindFirstOutside(values_1, values_2, {1e30F, 1e30F, 0xFFFFFFFFU},
+                                &errors));
+  ASSERT_EQ(0.0F, errors.max_absolute);
+  ASSERT_EQ(0.0F, errors.max_relative);
+  ASSERT_EQ(0, errors.max_ulps);
+}
+
+TEST(FloatCompareTest, MismatchAtEachPosition) {
+  // Covers mismatches in every lane of a vector, and in the elements left over
+  // after the last whole vector.
+  const size_t kCount = 200;
+  std::vector<float> values_1(kCount, 2.0F);
+  std::vector<float> close(values_1);
+  for (float& value : close) {
+    value = std::nextafter(value, 3.0F);
+  }
+  for (size_t position = 0; position < kCount; position++) {
+    std::vector<float> values_2(close);
+    values_2[position] = 2.5F;
+    FloatErrors errors = {0.0F, 0.0F, 0};
+    ASSERT_EQ(position,
+              FindFirstOutside(values_1, values_2, {0.0F, 0.0F, 1}, &errors));
+    // The differences of the mismatching pair are included.
+    ASSERT_EQ(0.5F, errors.max_absolute);
+  }
+  FloatErrors errors = {0.0F, 0.0F, 0};
+  ASSERT_EQ(kCount,
+            FindFirstOutside(values_1, close, {0.0F, 0.0F, 1}, &errors));
+  ASSERT_EQ(1, errors.max_ulps);
+}
+
+TEST(FloatCompareTest, ScalarPathGivesTheSameResults) {
+  const size_t kCount = 37;
+  std::vector<float> values_1(kCount);
+  std::vector<float> close(kCount);
+  for (size_t i = 0; i < kCount; i++) {
+    values_1[i] = static_cast<float>(i) * 0.75F - 10.0F;
+    close[i] = values_1[i] + static_cast<float>(i % 5) * 0.01F;
+  }
+  const FloatTolerance tolerance = {0.05F, 0.0F, 0};
+  for (size_t position = 0; position <= kCount; position++) {
+    std::vector<float> values_2(close);
+    if (position < kCount) {
+      values_2[position] = 100.0F;
+    }
+    FloatErrors errors = {0.0F, 0.0F, 0};
+    FloatErrors scalar_errors = {0.0F, 0.0F, 0};
+    ASSERT_EQ(position,
+              FindFirstOutside(values_1, values_2, tolerance, &errors));
+    ASSERT_EQ(position,
+              FindFirstFloatOutsideToleranceScalar(
+                  reinterpret_cast<const uint8_t*>(values_1.data()),
+                  reinterpret_cast<const uint8_t*>(values_2.data()), kCount,
+                  tolerance, &scalar_errors));
+    ASSERT_EQ(scalar_errors.max_absolute, errors.max_absolute);
+    ASSERT_EQ(scalar_errors.max_relative, errors.max_relative);
+    ASSERT_EQ(scalar_errors.max_ulps, errors.max_ulps);
+  }
+}
+
+}  // namespace
+}  // namespace shadertrap
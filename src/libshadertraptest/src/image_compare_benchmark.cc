@@ -0,0 +1,58 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "libshadertrap/image_compare.h"
+#include "libshadertraptest/gtest.h"
+#include "libshadertraptest/naive_image_compare.h"
+
+namespace shadertrap {
+namespace {
+
+// Reports the time taken to compare 4K images, and the time taken by the
+// naive reference comparison.
+TEST(ImageCompareBenchmark, Throughput) {
+  const size_t kWidth = 3840;
+  const size_t kHeight = 2160;
+  const size_t kRepetitions = 8;
+  const std::vector<uint8_t> pixels_1 = MakeImage(kWidth, kHeight);
+  const std::vector<uint8_t> pixels_2 = Perturb(pixels_1);
+  ImageDifferences differences = {0, 0, 0.0, 1.0};
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kRepetitions; i++) {
+    differences = CompareImages(pixels_1.data(), pixels_2.data(), kWidth,
+                                kHeight, 2, true);
+  }
+  std::chrono::duration<double, std::milli> elapsed =
+      std::chrono::steady_clock::now() - start;
+  start = std::chrono::steady_clock::now();
+  const ImageDifferences naive = CompareImagesNaively(
+      pixels_1, pixels_2, kWidth, kHeight, 2, true);
+  std::chrono::duration<double, std::milli> naive_elapsed =
+      std::chrono::steady_clock::now() - start;
+  // Using the results keeps the comparisons from being optimized away.
+  ASSERT_EQ(naive.num_differing_pixels, differences.num_differing_pixels);
+  ASSERT_NEAR(naive.ssim, differences.ssim, 1e-9);
+  std::cout << "Compared " << kWidth << "x" << kHeight << " images in "
+            << elapsed.count() / kRepetitions << " ms; the naive comparison "
+            << "took " << naive_elapsed.count() << " ms" << std::endl;
+}
+
+}  // namespace
+}  // namespace shadertrap
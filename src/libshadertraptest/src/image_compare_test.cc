@@ -0,0 +1,133 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/image_compare.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+#include "libshadertraptest/naive_image_compare.h"
+
+namespace shadertrap {
+namespace {
+
+void AssertMatchesNaiveComparison(size_t width, size_t height,
+                                  uint8_t channel_tolerance) {
+  const std::vector<uint8_t> pixels_1 = MakeImage(width, height);
+  const std::vector<uint8_t> pixels_2 = Perturb(pixels_1);
+  const ImageDifferences expected = CompareImagesNaively(
+      pixels_1, pixels_2, width, height, channel_tolerance, true);
+  const ImageDifferences actual =
+      CompareImages(pixels_1.data(), pixels_2.data(), width, height,
+                    channel_tolerance, true);
+  ASSERT_LT(0, expected.num_differing_pixels);
+  ASSERT_GT(1.0, expected.ssim);
+  ASSERT_EQ(expected.num_differing_pixels, actual.num_differing_pixels);
+  ASSERT_EQ(expected.max_channel_difference, actual.max_channel_difference);
+  ASSERT_DOUBLE_EQ(expected.mean_squared_error, actual.mean_squared_error);
+  ASSERT_NEAR(expected.ssim, actual.ssim, 1e-9);
+}
+
+TEST(ImageCompareTest, IdenticalImages) {
+  const std::vector<uint8_t> pixels = MakeImage(37, 23);
+  const ImageDifferences differences =
+      CompareImages(pixels.data(), pixels.data(), 37, 23, 0, true);
+  ASSERT_EQ(0, differences.num_differing_pixels);
+  ASSERT_EQ(0, differences.max_channel_difference);
+  ASSERT_EQ(0.0, differences.mean_squared_error);
+  ASSERT_DOUBLE_EQ(1.0, differences.ssim);
+  ASSERT_EQ(std::numeric_limits<double>::infinity(),
+            ComputePsnr(differences.mean_squared_error));
+}
+
+TEST(ImageCompareTest, ChannelTolerance) {
+  // Five pixels, so that both whole vectors and leftover pixels are compared.
+  const std::vector<uint8_t> pixels_1 = {0, 0, 0, 0, 10, 10, 10, 10, 7, 7,
+                                         7, 7, 0, 0, 0, 0, 255, 0, 0, 0};
+  const std::vector<uint8_t> pixels_2 = {0, 3, 0, 0, 10, 10, 10, 15, 7, 7,
+                                         7, 7, 0, 0, 0, 0, 0, 0, 0, 0};
+  ImageDifferences differences =
+      CompareImages(pixels_1.data(), pixels_2.data(), 5, 1, 3, false);
+  ASSERT_EQ(2, differences.num_differing_pixels);
+  ASSERT_EQ(255, differences.max_channel_difference);
+  ASSERT_DOUBLE_EQ((9.0 + 25.0 + 65025.0) / 20.0,
+                   differences.mean_squared_error);
+  ASSERT_EQ(1.0, differences.ssim);
+  differences = CompareImages(pixels_1.data(), pixels_2.data(), 5, 1, 2, false);
+  ASSERT_EQ(3, differences.num_differing_pixels);
+}
+
+TEST(ImageCompareTest, Psnr) {
+  ASSERT_DOUBLE_EQ(0.0, ComputePsnr(255.0 * 255.0));
+  ASSERT_DOUBLE_EQ(20.0, ComputePsnr(255.0 * 255.0 / 100.0));
+}
+
+TEST(ImageCompareTest, SsimDetectsLostStructure) {
+  // A checkerboard and a flat image of the same mean have a low SSIM.
+  const size_t kSize = 16;
+  std::vector<uint8_t> checkerboard(kSize * kSize * 4);
+  for (size_t i = 0; i < checkerboard.size(); i++) {
+    const size_t pixel = i / 4;
+    checkerboard[i] = ((pixel % kSize + pixel / kSize) % 2 == 0) ? 0 : 254;
+  }
+  const std::vector<uint8_t> flat(checkerboard.size(), 127);
+  const ImageDifferences differences =
+      CompareImages(checkerboard.data(), flat.data(), kSize, kSize, 0, true);
+  ASSERT_LT(differences.ssim, 0.01);
+}
+
+TEST(ImageCompareTest, MatchesNaiveComparison) {
+  // The dimensions leave margins that no SSIM window covers.
+  AssertMatchesNaiveComparison(37, 29, 2);
+}
+
+TEST(ImageCompareTest, MatchesNaiveComparisonAcrossThreads) {
+  // Large enough for the work to be split between threads on a multi-core
+  // machine.
+  AssertMatchesNaiveComparison(1031, 517, 4);
+}
+
+TEST(ImageCompareTest, BandsMatchNaiveComparison) {
+  // Bands shorter than, equal to and taller than an SSIM window, so that
+  // windows straddle two or more bands.
+  const size_t kWidth = 37;
+  const size_t kHeight = 29;
+  const std::vector<uint8_t> pixels_1 = MakeImage(kWidth, kHeight);
+  const std::vector<uint8_t> pixels_2 = Perturb(pixels_1);
+  const ImageDifferences expected = CompareImagesNaively(
+      pixels_1, pixels_2, kWidth, kHeight, 2, true);
+  const size_t kRowsPerBand[] = {1, 3, 4, 5, 8, 13, 29};
+  for (size_t rows_per_band : kRowsPerBand) {
+    ImageComparer comparer(kWidth, kHeight, 2, true);
+    for (size_t end_row = kHeight; end_row > 0;) {
+      const size_t num_rows = std::min(rows_per_band, end_row);
+      const size_t offset = (end_row - num_rows) * kWidth * 4;
+      comparer.AddBand(end_row - num_rows, num_rows, pixels_1.data() + offset,
+                       pixels_2.data() + offset);
+      end_row -= num_rows;
+    }
+    const ImageDifferences actual = comparer.GetDifferences();
+    ASSERT_EQ(expected.num_differing_pixels, actual.num_differing_pixels);
+    ASSERT_EQ(expected.max_channel_difference, actual.max_channel_difference);
+    ASSERT_DOUBLE_EQ(expected.mean_squared_error, actual.mean_squared_error);
+    ASSERT_NEAR(expected.ssim, actual.ssim, 1e-9);
+  }
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,99 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/image_encoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+// Returns the encoding in |format| of the |width|x|height| image in |data|.
+std::vector<uint8_t> Encode(const std::vector<uint8_t>& data, size_t width,
+                            size_t height, ImageFormat format) {
+  std::vector<uint8_t> encoded;
+  std::string error;
+  EXPECT_TRUE(EncodeImage(data, width, height, format,
+                          kDefaultPngCompressionLevel, &encoded, &error));
+  return encoded;
+}
+
+// Returns the characters of |header| followed by |body|.
+std::vector<uint8_t> Concatenate(const std::string& header,
+                                 const std::vector<uint8_t>& body) {
+  std::vector<uint8_t> result(header.begin(), header.end());
+  result.insert(result.end(), body.begin(), body.end());
+  return result;
+}
+
+// Returns a QOI file for a |width|x1 image, made of |chunks| and the header
+// and end marker.
+std::vector<uint8_t> QoiFile(uint8_t width,
+                             const std::vector<uint8_t>& chunks) {
+  std::vector<uint8_t> result = {'q', 'o', 'i', 'f', 0, 0, 0, width,
+                                 0,   0,   0,   1,   4, 0};
+  result.insert(result.end(), chunks.begin(), chunks.end());
+  result.insert(result.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+  return result;
+}
+
+TEST(ImageEncoderTest, Ppm) {
+  ASSERT_EQ(Concatenate("P6\n2 1\n255\n", {1, 2, 3, 5, 6, 7}),
+            Encode({1, 2, 3, 4, 5, 6, 7, 8}, 2, 1, ImageFormat::kPpm));
+}
+
+TEST(ImageEncoderTest, Pam) {
+  ASSERT_EQ(Concatenate("P7\nWIDTH 1\nHEIGHT 2\nDEPTH 4\nMAXVAL 255\n"
+                        "TUPLTYPE RGB_ALPHA\nENDHDR\n",
+                        {1, 2, 3, 4, 5, 6, 7, 8}),
+            Encode({1, 2, 3, 4, 5, 6, 7, 8}, 1, 2, ImageFormat::kPam));
+}
+
+TEST(ImageEncoderTest, Raw) {
+  ASSERT_EQ(Concatenate("RGBA", {1, 0, 0, 0, 2, 0, 0, 0, 1, 2, 3, 4, 5, 6, 7,
+                                 8}),
+            Encode({1, 2, 3, 4, 5, 6, 7, 8}, 1, 2, ImageFormat::kRaw));
+}
+
+TEST(ImageEncoderTest, QoiChunkKinds) {
+  const std::vector<uint8_t> pixels = {
+      1,   255, 0,   255,  // Differs slightly from the initial black pixel.
+      100, 0,   200, 255,  // Differs too much for a diff or luma chunk.
+      0,   0,   0,   0,    // Matches the initially zero index.
+      1,   255, 0,   255,  // Matches the index entry for the first pixel.
+      1,   255, 0,   255,  // Repeats the previous pixel twice.
+      1,   255, 0,   255,
+      2,   253, 3,   255,  // Differs moderately from the previous pixel.
+  };
+  ASSERT_EQ(QoiFile(7, {0x76, 0xfe, 100, 0, 200, 0x00, 0x33, 0xc1, 0x9e, 0xbd}),
+            Encode(pixels, 7, 1, ImageFormat::kQoi));
+}
+
+TEST(ImageEncoderTest, QoiLongRun) {
+  // A run covers at most 62 pixels.
+  std::vector<uint8_t> pixels;
+  for (size_t i = 0; i < 63; i++) {
+    pixels.insert(pixels.end(), {0, 0, 0, 255});
+  }
+  ASSERT_EQ(QoiFile(63, {0xfd, 0xc0}),
+            Encode(pixels, 63, 1, ImageFormat::kQoi));
+}
+
+}  // namespace
+}  // namespace shadertrap
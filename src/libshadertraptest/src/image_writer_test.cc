@@ -0,0 +1,95 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/image_writer.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/file_output_sink.h"
+#include "libshadertrap/memory_output_sink.h"
+#include "libshadertrap/output_sink.h"
+#include "libshadertrap/token.h"
+#include "libshadertraptest/collecting_message_consumer.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+TEST(ImageWriterTest, ManyWritesToOneFileWithBackpressure) {
+  // The pending-bytes limit is smaller than one image, so each write waits for
+  // the previous one to complete.
+  const size_t kWidth = 64;
+  const size_t kHeight = 32;
+  MemoryOutputSink output_sink;
+  ImageWriter image_writer(&output_sink, 4, 1);
+  Token start_token(Token::Type::kKeywordDumpRenderbuffer, 1, 1);
+  const std::string filename = "image.raw";
+  for (size_t i = 0; i < 16; i++) {
+    image_writer.Write(&start_token, filename, ImageFormat::kRaw,
+                       kDefaultPngCompressionLevel, kWidth, kHeight,
+                       std::vector<std::uint8_t>(kWidth * kHeight * 4,
+                                                 static_cast<std::uint8_t>(i)));
+  }
+  CollectingMessageConsumer message_consumer;
+  ASSERT_TRUE(image_writer.Flush(&message_consumer));
+  ASSERT_EQ(0, message_consumer.GetNumMessages());
+  // The writes happen in order, so the output holds the last image.
+  const auto outputs = output_sink.GetOutputs();
+  ASSERT_EQ(1, outputs.size());
+  ASSERT_EQ(OutputSink::Kind::kImage, outputs.at(filename).kind);
+  const std::vector<uint8_t>& contents = outputs.at(filename).data;
+  ASSERT_EQ(12 + kWidth * kHeight * 4, contents.size());
+  ASSERT_EQ(15, contents[12]);
+  ASSERT_EQ(15, contents.back());
+}
+
+TEST(ImageWriterTest, WritesWithoutThreads) {
+  FileOutputSink output_sink;
+  ImageWriter image_writer(&output_sink, 0, 0);
+  Token start_token(Token::Type::kKeywordDumpRenderbuffer, 7, 1);
+  image_writer.Write(&start_token, "no_such_directory/image.raw",
+                     ImageFormat::kRaw, kDefaultPngCompressionLevel, 1, 1,
+                     std::vector<std::uint8_t>(4, 0));
+  CollectingMessageConsumer message_consumer;
+  ASSERT_FALSE(image_writer.Flush(&message_consumer));
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 7:1: Writing RAW data to 'no_such_directory/image.raw' failed",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ImageWriterTest, FailuresAreReportedByFlush) {
+  FileOutputSink output_sink;
+  ImageWriter image_writer(&output_sink, 2, 1024);
+  Token start_token_1(Token::Type::kKeywordDumpRenderbuffer, 3, 1);
+  Token start_token_2(Token::Type::kKeywordDumpRenderbuffer, 5, 1);
+  image_writer.Write(&start_token_1, "no_such_directory/first.raw",
+                     ImageFormat::kRaw, kDefaultPngCompressionLevel, 2, 2,
+                     std::vector<std::uint8_t>(2 * 2 * 4, 0));
+  image_writer.Write(&start_token_2, "no_such_directory/second.raw",
+                     ImageFormat::kRaw, kDefaultPngCompressionLevel, 2, 2,
+                     std::vector<std::uint8_t>(2 * 2 * 4, 0));
+  CollectingMessageConsumer message_consumer;
+  ASSERT_FALSE(image_writer.Flush(&message_consumer));
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+  // Failures are only reported once.
+  ASSERT_TRUE(image_writer.Flush(&message_consumer));
+  ASSERT_EQ(2, message_consumer.GetNumMessages());
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,48 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+#include "libshadertrap/memory_compare.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+// Reports the throughput of comparing large identical regions.
+TEST(MemoryCompareBenchmark, Throughput) {
+  const size_t kSize = 256 * 1024 * 1024;
+  const size_t kRepetitions = 8;
+  std::vector<uint8_t> data_1(kSize, 1);
+  std::vector<uint8_t> data_2(kSize, 1);
+  data_2[kSize - 1] = 2;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < kRepetitions; i++) {
+    ASSERT_EQ(kSize - 1,
+              FindFirstMismatch(data_1.data(), data_2.data(), kSize));
+  }
+  std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << "Compared " << kRepetitions << " x " << kSize << " bytes at "
+            << static_cast<double>(kRepetitions * kSize) / elapsed.count() /
+                   1e9
+            << " GB/s" << std::endl;
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,68 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/memory_compare.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+TEST(MemoryCompareTest, IdenticalRegions) {
+  std::vector<uint8_t> data_1(10000);
+  for (size_t i = 0; i < data_1.size(); i++) {
+    data_1[i] = static_cast<uint8_t>(i * 7);
+  }
+  std::vector<uint8_t> data_2(data_1);
+  ASSERT_EQ(0, FindFirstMismatch(data_1.data(), data_2.data(), 0));
+  ASSERT_EQ(data_1.size(),
+            FindFirstMismatch(data_1.data(), data_2.data(), data_1.size()));
+}
+
+TEST(MemoryCompareTest, MismatchAtEachPosition) {
+  // Covers mismatches at the start, middle and end of vectors and blocks, and
+  // in the trailing bytes that do not fill a vector.
+  const size_t kSize = 8195;
+  std::vector<uint8_t> data_1(kSize, 42);
+  for (size_t position = 0; position < kSize; position++) {
+    std::vector<uint8_t> data_2(data_1);
+    data_2[position] = 43;
+    ASSERT_EQ(position,
+              FindFirstMismatch(data_1.data(), data_2.data(), kSize));
+    // Only the first of several mismatches is reported.
+    data_2[kSize - 1] = 0;
+    ASSERT_EQ(position,
+              FindFirstMismatch(data_1.data(), data_2.data(), kSize));
+  }
+}
+
+TEST(MemoryCompareTest, UnalignedRegions) {
+  std::vector<uint8_t> data_1(300, 1);
+  std::vector<uint8_t> data_2(300, 1);
+  data_2[200] = 2;
+  for (size_t offset_1 = 0; offset_1 < 32; offset_1++) {
+    for (size_t offset_2 = 0; offset_2 < 32; offset_2++) {
+      ASSERT_EQ(200 - offset_2,
+                FindFirstMismatch(data_1.data() + offset_1,
+                                  data_2.data() + offset_2, 250));
+    }
+  }
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -0,0 +1,111 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertraptest/naive_image_compare.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace shadertrap {
+
+std::vector<uint8_t> MakeImage(size_t width, size_t height) {
+  std::vector<uint8_t> pixels(width * height * 4);
+  for (size_t i = 0; i < pixels.size(); i++) {
+    pixels[i] = static_cast<uint8_t>((i * 7) ^ (i >> 10));
+  }
+  return pixels;
+}
+
+std::vector<uint8_t> Perturb(const std::vector<uint8_t>& pixels) {
+  std::vector<uint8_t> result(pixels);
+  for (size_t i = 0; i < result.size(); i++) {
+    if ((i * 13) % 5 == 0) {
+      result[i] = static_cast<uint8_t>(
+          std::min<size_t>(255, static_cast<size_t>(result[i]) + i % 7));
+    }
+  }
+  return result;
+}
+
+ImageDifferences CompareImagesNaively(const std::vector<uint8_t>& data_1,
+                                      const std::vector<uint8_t>& data_2,
+                                      size_t width, size_t height,
+                                      uint8_t channel_tolerance,
+                                      bool compute_ssim) {
+  ImageDifferences result = {0, 0, 0.0, 1.0};
+  double sum_squared_errors = 0.0;
+  for (size_t pixel = 0; pixel < width * height; pixel++) {
+    bool differs = false;
+    for (size_t channel = 0; channel < 4; channel++) {
+      const int difference = std::abs(data_1[pixel * 4 + channel] -
+                                      data_2[pixel * 4 + channel]);
+      differs = differs || difference > channel_tolerance;
+      result.max_channel_difference = std::max(
+          result.max_channel_difference, static_cast<uint8_t>(difference));
+      sum_squared_errors += difference * difference;
+    }
+    if (differs) {
+      result.num_differing_pixels++;
+    }
+  }
+  result.mean_squared_error =
+      sum_squared_errors / static_cast<double>(width * height * 4);
+  if (!compute_ssim || width < kSsimWindowSize || height < kSsimWindowSize) {
+    return result;
+  }
+  const double kC1 = (0.01 * 255) * (0.01 * 255);
+  const double kC2 = (0.03 * 255) * (0.03 * 255);
+  const double kWindowArea = kSsimWindowSize * kSsimWindowSize;
+  for (size_t channel = 0; channel < 4; channel++) {
+    double ssim_sum = 0.0;
+    size_t num_windows = 0;
+    for (size_t top = 0; top + kSsimWindowSize <= height;
+         top += kSsimWindowSize / 2) {
+      for (size_t left = 0; left + kSsimWindowSize <= width;
+           left += kSsimWindowSize / 2) {
+        double mean_1 = 0.0;
+        double mean_2 = 0.0;
+        for (size_t y = top; y < top + kSsimWindowSize; y++) {
+          for (size_t x = left; x < left + kSsimWindowSize; x++) {
+            mean_1 += data_1[(y * width + x) * 4 + channel] / kWindowArea;
+            mean_2 += data_2[(y * width + x) * 4 + channel] / kWindowArea;
+          }
+        }
+        double variance_1 = 0.0;
+        double variance_2 = 0.0;
+        double covariance = 0.0;
+        for (size_t y = top; y < top + kSsimWindowSize; y++) {
+          for (size_t x = left; x < left + kSsimWindowSize; x++) {
+            const double deviation_1 =
+                data_1[(y * width + x) * 4 + channel] - mean_1;
+            const double deviation_2 =
+                data_2[(y * width + x) * 4 + channel] - mean_2;
+            variance_1 += deviation_1 * deviation_1 / kWindowArea;
+            variance_2 += deviation_2 * deviation_2 / kWindowArea;
+            covariance += deviation_1 * deviation_2 / kWindowArea;
+          }
+        }
+        ssim_sum += ((2 * mean_1 * mean_2 + kC1) * (2 * covariance + kC2)) /
+                    ((mean_1 * mean_1 + mean_2 * mean_2 + kC1) *
+                     (variance_1 + variance_2 + kC2));
+        num_windows++;
+      }
+    }
+    result.ssim =
+        std::min(result.ssim, ssim_sum / static_cast<double>(num_windows));
+  }
+  return result;
+}
+
+}  // namespace shadertrap
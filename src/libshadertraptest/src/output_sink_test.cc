@@ -0,0 +1,108 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/framed_output_sink.h"
+#include "libshadertrap/memory_output_sink.h"
+#include "libshadertrap/output_sink.h"
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+TEST(OutputSinkTest, FramedOutputs) {
+  std::ostringstream stream;
+  FramedOutputSink output_sink(&stream);
+  const std::string text = "1 2\n3";
+  const std::vector<uint8_t> binary = {0, '\n', 255};
+  ASSERT_TRUE(output_sink.Write(
+      "out.txt", OutputSink::Kind::kText,
+      reinterpret_cast<const uint8_t*>(text.data()), text.size()));
+  ASSERT_TRUE(output_sink.Write("my dump.bin", OutputSink::Kind::kBinary,
+                                binary.data(), binary.size()));
+  ASSERT_EQ(std::string("SHADERTRAP_OUTPUT text 5 out.txt\n1 2\n3\n"
+                        "SHADERTRAP_OUTPUT binary 3 my dump.bin\n") +
+                std::string("\0\n\xff\n", 4),
+            stream.str());
+}
+
+TEST(OutputSinkTest, FramedChunkedOutput) {
+  std::ostringstream stream;
+  FramedOutputSink output_sink(&stream);
+  const std::string first = "1 2\n";
+  const std::string second = "3";
+  ASSERT_TRUE(output_sink.Begin("out.txt", OutputSink::Kind::kText));
+  ASSERT_TRUE(output_sink.Append(
+      reinterpret_cast<const uint8_t*>(first.data()), first.size()));
+  ASSERT_TRUE(output_sink.Append(nullptr, 0));
+  ASSERT_TRUE(output_sink.Append(
+      reinterpret_cast<const uint8_t*>(second.data()), second.size()));
+  ASSERT_TRUE(output_sink.End());
+  const uint8_t data = 7;
+  ASSERT_TRUE(
+      output_sink.Write("a.bin", OutputSink::Kind::kBinary, &data, 1));
+  ASSERT_EQ(
+      "SHADERTRAP_OUTPUT text chunked out.txt\n4\n1 2\n\n1\n3\n0\n"
+      "SHADERTRAP_OUTPUT binary 1 a.bin\n\x07\n",
+      stream.str());
+}
+
+TEST(OutputSinkTest, FramedOutputNameWithNewline) {
+  std::ostringstream stream;
+  FramedOutputSink output_sink(&stream);
+  const uint8_t data = 0;
+  ASSERT_FALSE(output_sink.Write("a\nb", OutputSink::Kind::kBinary, &data, 1));
+  ASSERT_TRUE(stream.str().empty());
+}
+
+TEST(OutputSinkTest, LaterMemoryOutputsReplaceEarlierOnes) {
+  MemoryOutputSink output_sink;
+  const std::vector<uint8_t> first = {1, 2, 3};
+  const std::vector<uint8_t> second = {4};
+  ASSERT_TRUE(output_sink.Write("a.bin", OutputSink::Kind::kBinary,
+                                first.data(), first.size()));
+  ASSERT_TRUE(output_sink.Write("b.png", OutputSink::Kind::kImage,
+                                first.data(), first.size()));
+  ASSERT_TRUE(output_sink.Write("a.bin", OutputSink::Kind::kBinary,
+                                second.data(), second.size()));
+  auto outputs = output_sink.TakeOutputs();
+  ASSERT_EQ(2, outputs.size());
+  ASSERT_EQ(second, outputs.at("a.bin").data);
+  ASSERT_EQ(OutputSink::Kind::kImage, outputs.at("b.png").kind);
+  ASSERT_EQ(first, outputs.at("b.png").data);
+  ASSERT_TRUE(output_sink.GetOutputs().empty());
+}
+
+TEST(OutputSinkTest, MemoryOutputReceivedInPieces) {
+  MemoryOutputSink output_sink;
+  const std::vector<uint8_t> first = {1, 2};
+  const std::vector<uint8_t> second = {3};
+  ASSERT_TRUE(output_sink.Begin("a.bin", OutputSink::Kind::kBinary));
+  ASSERT_TRUE(output_sink.Append(first.data(), first.size()));
+  ASSERT_TRUE(output_sink.GetOutputs().empty());
+  ASSERT_TRUE(output_sink.Append(second.data(), second.size()));
+  ASSERT_TRUE(output_sink.End());
+  auto outputs = output_sink.TakeOutputs();
+  ASSERT_EQ(1, outputs.size());
+  ASSERT_EQ(OutputSink::Kind::kBinary, outputs.at("a.bin").kind);
+  ASSERT_EQ(std::vector<uint8_t>({1, 2, 3}), outputs.at("a.bin").data);
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -16,7 +16,17 @@
 
 #include <cstring>
 
+#include "libshadertrap/command_assert_buffer_hash.h"
+#include "libshadertrap/command_assert_equal.h"
+#include "libshadertrap/command_assert_matches_image.h"
+#include "libshadertrap/command_assert_renderbuffer_hash.h"
+#include "libshadertrap/command_assert_similar_image.h"
 #include "libshadertrap/command_create_buffer.h"
+#include "libshadertrap/command_create_texture_2d.h"
+#include "libshadertrap/command_dump_buffer_binary.h"
+#include "libshadertrap/command_dump_renderbuffer.h"
+#include "libshadertrap/command_run_compute.h"
+#include "libshadertrap/image_encoder.h"
 #include "libshadertraptest/collecting_message_consumer.h"
 #include "libshadertraptest/gtest.h"
 
@@ -433,5 +443,546 @@ ASSERT_EQUAL BUFFERS buf1 buf2 FORMAT float -1
             message_consumer.GetMessageString(0));
 }
 
+TEST(ParserTest, AssertEqualFile) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFER buf FILE "expected.bin"
+ASSERT_EQUAL FILE "expected.bin" BUFFER buf FORMAT uint 1 SKIP_BYTES 4
+ASSERT_MATCHES_IMAGE RENDERBUFFER rb FILE "expected.png"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* assert_1 =
+      static_cast<CommandAssertEqual*>(parsed_program->GetCommand(0));
+  ASSERT_TRUE(assert_1->GetComparesWithFile());
+  ASSERT_FALSE(assert_1->GetArgumentsAreRenderbuffers());
+  ASSERT_EQ("buf", assert_1->GetArgumentIdentifier1());
+  ASSERT_EQ("expected.bin", assert_1->GetFilename());
+  ASSERT_TRUE(assert_1->GetFormatEntries().empty());
+  auto* assert_2 =
+      static_cast<CommandAssertEqual*>(parsed_program->GetCommand(1));
+  ASSERT_TRUE(assert_2->GetComparesWithFile());
+  ASSERT_EQ(2, assert_2->GetFormatEntries().size());
+  auto* assert_3 =
+      static_cast<CommandAssertMatchesImage*>(parsed_program->GetCommand(2));
+  ASSERT_EQ("rb", assert_3->GetRenderbufferIdentifier());
+  ASSERT_EQ("expected.png", assert_3->GetFilename());
+}
+
+TEST(ParserTest, AssertEqualFileWithoutBuffer) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFERS buf1 buf2 FILE "expected.bin"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:37: Parameter 'FILE' can only be used with 'BUFFER'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertEqualBufferWithoutFile) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFER buf
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 3:1: Missing parameter 'FILE'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertEqualBuffersAndBuffer) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFERS buf1 buf2 BUFFER buf FILE "expected.bin"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:1: Only one of the parameters 'BUFFERS', 'RENDERBUFFERS' and "
+      "'BUFFER' can be present",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertEqualTolerance) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFERS buf1 buf2 FORMAT float 4 TOLERANCE ABS 0.001 ULP 4
+ASSERT_EQUAL TOLERANCE REL 0.5 BUFFER buf FILE "expected.bin" FORMAT float 4
+ASSERT_EQUAL BUFFERS buf1 buf2 FORMAT float 4
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* assert_1 =
+      static_cast<CommandAssertEqual*>(parsed_program->GetCommand(0));
+  ASSERT_TRUE(assert_1->HasTolerance());
+  ASSERT_EQ("ABS", assert_1->GetToleranceToken().GetText());
+  ASSERT_EQ(0.001F, assert_1->GetTolerance().absolute);
+  ASSERT_EQ(0.0F, assert_1->GetTolerance().relative);
+  ASSERT_EQ(4, assert_1->GetTolerance().ulps);
+  auto* assert_2 =
+      static_cast<CommandAssertEqual*>(parsed_program->GetCommand(1));
+  ASSERT_TRUE(assert_2->HasTolerance());
+  ASSERT_EQ(0.0F, assert_2->GetTolerance().absolute);
+  ASSERT_EQ(0.5F, assert_2->GetTolerance().relative);
+  ASSERT_EQ(0, assert_2->GetTolerance().ulps);
+  auto* assert_3 =
+      static_cast<CommandAssertEqual*>(parsed_program->GetCommand(2));
+  ASSERT_FALSE(assert_3->HasTolerance());
+}
+
+TEST(ParserTest, AssertEqualToleranceMissingKind) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFERS buf1 buf2 TOLERANCE FORMAT float 4
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:42: Expected 'ABS', 'REL' or 'ULP' after TOLERANCE, got "
+            "'FORMAT'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertEqualToleranceNegative) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL BUFFERS buf1 buf2 TOLERANCE ULP 1 ABS -0.5
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:52: Expected non-negative float tolerance, got '-0.5'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertEqualToleranceRenderbuffers) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_EQUAL RENDERBUFFERS rb1 rb2 TOLERANCE ULP 1
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:46: TOLERANCE cannot be used with renderbuffer "
+            "arguments",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertSimilarImage) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_SIMILAR_IMAGE RENDERBUFFERS rb1 rb2 TOLERANCE 3 MIN_PSNR 30.0
+ASSERT_SIMILAR_IMAGE MIN_SSIM 0.95 RENDERBUFFERS rb1 rb2
+  MAX_DIFFERING_FRACTION 0.01
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* assert_1 =
+      static_cast<CommandAssertSimilarImage*>(parsed_program->GetCommand(0));
+  ASSERT_EQ("rb1", assert_1->GetRenderbufferIdentifier1());
+  ASSERT_EQ("rb2", assert_1->GetRenderbufferIdentifier2());
+  ASSERT_TRUE(assert_1->CountsDifferingPixels());
+  ASSERT_EQ(3, assert_1->GetChannelTolerance());
+  ASSERT_EQ(0.0F, assert_1->GetMaxDifferingFraction());
+  ASSERT_FALSE(assert_1->HasMinSsim());
+  ASSERT_TRUE(assert_1->HasMinPsnr());
+  ASSERT_EQ(30.0F, assert_1->GetMinPsnr());
+  auto* assert_2 =
+      static_cast<CommandAssertSimilarImage*>(parsed_program->GetCommand(1));
+  ASSERT_TRUE(assert_2->CountsDifferingPixels());
+  ASSERT_EQ(0, assert_2->GetChannelTolerance());
+  ASSERT_EQ(0.01F, assert_2->GetMaxDifferingFraction());
+  ASSERT_TRUE(assert_2->HasMinSsim());
+  ASSERT_EQ(0.95F, assert_2->GetMinSsim());
+  ASSERT_FALSE(assert_2->HasMinPsnr());
+}
+
+TEST(ParserTest, AssertSimilarImageWithoutCriteria) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_SIMILAR_IMAGE RENDERBUFFERS rb1 rb2
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:1: ASSERT_SIMILAR_IMAGE requires at least one of "
+            "TOLERANCE, MAX_DIFFERING_FRACTION, MIN_SSIM and MIN_PSNR",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertSimilarImageFractionOutOfRange) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_SIMILAR_IMAGE RENDERBUFFERS rb1 rb2 MAX_DIFFERING_FRACTION 1.5
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:67: Expected float maximum differing fraction in the "
+            "range [0, 1], got '1.5'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, RunComputeDispatchList) {
+  std::string program =
+      R"(GLES 3.1
+RUN_COMPUTE PROGRAM prog NUM_GROUPS [ 4 1 1, 2 3 1, 1 1 5 ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* run_compute =
+      static_cast<CommandRunCompute*>(parsed_program->GetCommand(0));
+  ASSERT_EQ(3, run_compute->GetNumGroups().size());
+  ASSERT_EQ(2, run_compute->GetNumGroups()[1].x);
+  ASSERT_EQ(3, run_compute->GetNumGroups()[1].y);
+  ASSERT_EQ(5, run_compute->GetNumGroups()[2].z);
+}
+
+TEST(ParserTest, RunComputeEmptyDispatchList) {
+  std::string program =
+      R"(GLES 3.1
+RUN_COMPUTE PROGRAM prog NUM_GROUPS [ ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:39: Expected at least one number of groups",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, RunComputeIndirectMissingSeparator) {
+  std::string program =
+      R"(GLES 3.1
+RUN_COMPUTE_INDIRECT PROGRAM prog BUFFER buf OFFSET_BYTES [ 0 12 ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:63: Expected ',' or ']', got '12'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, RunGraphicsIndexSizeWithoutIndexData) {
+  std::string program =
+      R"(GLES 3.0
+RUN_GRAPHICS PROGRAM prog VERTEX_DATA [ ] INDEX_SIZE_BYTES 2 VERTEX_COUNT 3
+  TOPOLOGY TRIANGLES FRAMEBUFFER_ATTACHMENTS [ 0 -> rb ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:60: INDEX_SIZE_BYTES requires INDEX_DATA",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, RunGraphicsBadIndexSize) {
+  std::string program =
+      R"(GLES 3.0
+RUN_GRAPHICS PROGRAM prog VERTEX_DATA [ ] INDEX_DATA buf INDEX_SIZE_BYTES 3
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:75: Index size must be 1, 2 or 4 bytes, got '3'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, RunGraphicsInstanceCountWithIndirectData) {
+  std::string program =
+      R"(GLES 3.1
+RUN_GRAPHICS PROGRAM prog VERTEX_DATA [ ] INDIRECT_DATA buf OFFSET_BYTES [ 0, 16 ]
+  INSTANCE_COUNT 4 TOPOLOGY TRIANGLES FRAMEBUFFER_ATTACHMENTS [ 0 -> rb ]
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 3:18: INSTANCE_COUNT cannot be used with INDIRECT_DATA; the "
+      "instance count of an indirect draw is read from the indirect data "
+      "buffer",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, CreateBufferUsage) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_BUFFER buf SIZE_BYTES 8 INIT_VALUES uint 1 2 USAGE DYNAMIC
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* create_buffer =
+      static_cast<CommandCreateBuffer*>(parsed_program->GetCommand(0));
+  ASSERT_EQ(CommandCreateBuffer::Usage::kDynamic, create_buffer->GetUsage());
+}
+
+TEST(ParserTest, CreateBufferUnknownUsage) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_BUFFER buf SIZE_BYTES 8 USAGE STATIC_DRAW INIT_VALUES uint 1 2
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:38: Unknown buffer usage: 'STATIC_DRAW'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, CreateTexture2DFromValues) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_TEXTURE_2D tex WIDTH 3 HEIGHT 1 FORMAT R8 INIT_VALUES byte 1 2 3
+  GENERATE_MIPMAPS
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* create_texture_2d =
+      static_cast<CommandCreateTexture2D*>(parsed_program->GetCommand(0));
+  ASSERT_FALSE(create_texture_2d->HasInitFile());
+  ASSERT_EQ(CommandCreateTexture2D::Format::kR8,
+            create_texture_2d->GetFormat());
+  ASSERT_EQ(3, create_texture_2d->GetData().size());
+  ASSERT_TRUE(create_texture_2d->GetGenerateMipmaps());
+}
+
+TEST(ParserTest, CreateTexture2DWrongValueType) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_TEXTURE_2D tex WIDTH 1 HEIGHT 1 FORMAT RGBA32F INIT_VALUES uint 1 2 3 4
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:67: The initial values of a texture with format RGBA32F must "
+      "be float values",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, CreateTexture2DWrongSize) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_TEXTURE_2D tex WIDTH 2 HEIGHT 2 FORMAT R32UI INIT_VALUES uint 1 2 3
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:65: A 2x2 R32UI texture needs 16 bytes of initial values, but "
+      "the provided values occupy 12 bytes",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, CreateTexture2DFromFileWithDimensions) {
+  std::string program =
+      R"(GLES 3.1
+CREATE_TEXTURE_2D tex INIT_FILE "image.png" WIDTH 16
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:51: WIDTH, HEIGHT and FORMAT cannot be used with INIT_FILE; "
+      "the texture takes its dimensions from the image, and has format RGBA8",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertBufferHash) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_BUFFER_HASH BUFFER buf HASH "78af5f94892f3950"
+ASSERT_BUFFER_HASH BUFFER buf FORMAT SKIP_BYTES 4 uint 2 SKIP_BYTES 4
+    HASH "A38B4227FB240906"
+ASSERT_RENDERBUFFER_HASH RENDERBUFFER rb HASH "000000000000abcd"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* assert_1 =
+      static_cast<CommandAssertBufferHash*>(parsed_program->GetCommand(0));
+  ASSERT_EQ("buf", assert_1->GetBufferIdentifier());
+  ASSERT_TRUE(assert_1->GetFormatEntries().empty());
+  ASSERT_EQ(0x78af5f94892f3950ULL, assert_1->GetExpectedHash());
+  auto* assert_2 =
+      static_cast<CommandAssertBufferHash*>(parsed_program->GetCommand(1));
+  ASSERT_EQ(3, assert_2->GetFormatEntries().size());
+  ASSERT_EQ(0xa38b4227fb240906ULL, assert_2->GetExpectedHash());
+  auto* assert_3 = static_cast<CommandAssertRenderbufferHash*>(
+      parsed_program->GetCommand(2));
+  ASSERT_EQ("rb", assert_3->GetRenderbufferIdentifier());
+  ASSERT_EQ(0xabcdULL, assert_3->GetExpectedHash());
+}
+
+TEST(ParserTest, AssertBufferHashBadHash) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_BUFFER_HASH BUFFER buf HASH "78af5f94892f395g"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:36: Expected a string of 16 hexadecimal digits for the hash, "
+      "got '78af5f94892f395g'",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertBufferHashEmptyFormat) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_BUFFER_HASH BUFFER buf FORMAT HASH "78af5f94892f3950"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:38: Expected a formatting entry after FORMAT, got 'HASH'",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, AssertBufferHashStringFormatEntry) {
+  std::string program =
+      R"(GLES 3.1
+ASSERT_BUFFER_HASH BUFFER buf FORMAT "x" byte 4 HASH "78af5f94892f3950"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:38: String formatting entries are not allowed here, got 'x'",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, DumpBufferBinaryCompressed) {
+  std::string program =
+      R"(GLES 3.1
+DUMP_BUFFER_BINARY BUFFER buf FILE "out.bin"
+DUMP_BUFFER_BINARY COMPRESSED BUFFER buf FILE "out.stz"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  ASSERT_FALSE(static_cast<CommandDumpBufferBinary*>(
+                   parsed_program->GetCommand(0))
+                   ->GetCompressed());
+  ASSERT_TRUE(static_cast<CommandDumpBufferBinary*>(
+                  parsed_program->GetCommand(1))
+                  ->GetCompressed());
+}
+
+TEST(ParserTest, DumpRenderbufferFormats) {
+  std::string program =
+      R"(GLES 3.1
+DUMP_RENDERBUFFER RENDERBUFFER rb FILE "out.png" COMPRESSION 1
+DUMP_RENDERBUFFER RENDERBUFFER rb FILE "out.qoi" FORMAT QOI
+DUMP_RENDERBUFFER RENDERBUFFER rb FILE "out.png"
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* dump_1 =
+      static_cast<CommandDumpRenderbuffer*>(parsed_program->GetCommand(0));
+  ASSERT_EQ(ImageFormat::kPng, dump_1->GetFormat());
+  ASSERT_EQ(1, dump_1->GetCompressionLevel());
+  auto* dump_2 =
+      static_cast<CommandDumpRenderbuffer*>(parsed_program->GetCommand(1));
+  ASSERT_EQ(ImageFormat::kQoi, dump_2->GetFormat());
+  auto* dump_3 =
+      static_cast<CommandDumpRenderbuffer*>(parsed_program->GetCommand(2));
+  ASSERT_EQ(ImageFormat::kPng, dump_3->GetFormat());
+  ASSERT_EQ(kDefaultPngCompressionLevel, dump_3->GetCompressionLevel());
+}
+
+TEST(ParserTest, DumpRenderbufferCompressionOutOfRange) {
+  std::string program =
+      R"(GLES 3.1
+DUMP_RENDERBUFFER RENDERBUFFER rb FILE "out.png" COMPRESSION 10
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ("ERROR: 2:62: Compression level must be between 0 and 9, got '10'",
+            message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, DumpRenderbufferCompressionOfUncompressedFormat) {
+  std::string program =
+      R"(GLES 3.1
+DUMP_RENDERBUFFER RENDERBUFFER rb FILE "out.ppm" FORMAT PPM COMPRESSION 3
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_FALSE(parser.Parse());
+  ASSERT_EQ(1, message_consumer.GetNumMessages());
+  ASSERT_EQ(
+      "ERROR: 2:73: COMPRESSION can only be used with the PNG format; the PPM "
+      "format is not compressed",
+      message_consumer.GetMessageString(0));
+}
+
+TEST(ParserTest, ParameterKeywordsAsIdentifiers) {
+  // Keywords that only name parameters or their values can still be used as
+  // identifiers, as they could be before those parameters were added.
+  std::string program =
+      R"(GLES 3.1
+CREATE_BUFFER HASH SIZE_BYTES 4 INIT_VALUES uint 1 USAGE STATIC
+ASSERT_BUFFER_HASH BUFFER HASH HASH "0123456789abcdef"
+DUMP_RENDERBUFFER RENDERBUFFER RAW FILE "out.raw" FORMAT RAW
+)";
+  CollectingMessageConsumer message_consumer;
+  Parser parser(program, &message_consumer);
+  ASSERT_TRUE(parser.Parse());
+  auto parsed_program = parser.GetParsedProgram();
+  auto* create_buffer =
+      static_cast<CommandCreateBuffer*>(parsed_program->GetCommand(0));
+  ASSERT_EQ("HASH", create_buffer->GetResultIdentifier());
+  auto* assert_buffer_hash =
+      static_cast<CommandAssertBufferHash*>(parsed_program->GetCommand(1));
+  ASSERT_EQ("HASH", assert_buffer_hash->GetBufferIdentifier());
+  auto* dump_renderbuffer =
+      static_cast<CommandDumpRenderbuffer*>(parsed_program->GetCommand(2));
+  ASSERT_EQ("RAW", dump_renderbuffer->GetRenderbufferIdentifier());
+  ASSERT_EQ(ImageFormat::kRaw, dump_renderbuffer->GetFormat());
+}
+
 }  // namespace
 }  // namespace shadertrap
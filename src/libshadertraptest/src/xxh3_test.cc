@@ -0,0 +1,84 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "libshadertrap/xxh3.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "libshadertraptest/gtest.h"
+
+namespace shadertrap {
+namespace {
+
+TEST(Xxh3Test, MatchesReferenceImplementation) {
+  // The expected hashes were computed with the reference implementation of
+  // XXH3, and cover each of the ways in which inputs of different lengths are
+  // hashed.
+  const std::vector<std::pair<size_t, std::string>> expected = {
+      {0, "2d06800538d394c2"},    {3, "15f7093b173d005c"},
+      {8, "dec6a9a43575982e"},    {16, "7e484c18d74895d0"},
+      {128, "f92b70eaa21a6288"},  {240, "ccc7375172c41f03"},
+      {241, "0b3b630948ce4a00"},  {1025, "c09fdfbc398c7d82"},
+      {10000, "441f01d9711bebed"}};
+  for (const auto& entry : expected) {
+    std::vector<uint8_t> data(entry.first);
+    for (size_t i = 0; i < data.size(); i++) {
+      data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    ASSERT_EQ(entry.second,
+              HashToHexString(Xxh3Hash64(data.data(), data.size())))
+        << "for " << entry.first << " bytes";
+  }
+}
+
+TEST(Xxh3Test, HashOfString) {
+  const std::string text = "abc";
+  ASSERT_EQ(0x78af5f94892f3950ULL,
+            Xxh3Hash64(reinterpret_cast<const uint8_t*>(text.data()),
+                       text.size()));
+}
+
+TEST(Xxh3Test, HasherMatchesOneShotHash) {
+  // Covers inputs that end at and around stripe and block boundaries, split
+  // into pieces that do not align with stripes.
+  for (size_t size : {0, 1, 16, 63, 64, 65, 128, 240, 241, 1023, 1024, 1025,
+                      2048, 2049, 10000}) {
+    std::vector<uint8_t> data(size);
+    for (size_t i = 0; i < data.size(); i++) {
+      data[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    const uint64_t expected = Xxh3Hash64(data.data(), data.size());
+    for (size_t piece_size : {1, 7, 64, 100, 1000, 10000}) {
+      Xxh3Hasher hasher;
+      for (size_t offset = 0; offset < size; offset += piece_size) {
+        hasher.Update(data.data() + offset,
+                      std::min(piece_size, size - offset));
+      }
+      ASSERT_EQ(expected, hasher.Digest())
+          << "for " << size << " bytes in pieces of " << piece_size;
+    }
+  }
+}
+
+TEST(Xxh3Test, HexStringHasLeadingZeros) {
+  ASSERT_EQ("000000000000abcd", HashToHexString(0xabcdU));
+}
+
+}  // namespace
+}  // namespace shadertrap
@@ -32,10 +32,14 @@
 #include "libshadertrap/command_visitor.h"
 #include "libshadertrap/compound_visitor.h"
 #include "libshadertrap/executor.h"
+#include "libshadertrap/file_output_sink.h"
+#include "libshadertrap/framed_output_sink.h"
+#include "libshadertrap/gl_error_policy.h"
 #include "libshadertrap/gl_functions.h"
 #include "libshadertrap/glslang.h"
 #include "libshadertrap/make_unique.h"
 #include "libshadertrap/message_consumer.h"
+#include "libshadertrap/output_sink.h"
 #include "libshadertrap/parser.h"
 #include "libshadertrap/shadertrap_program.h"
 #include "libshadertrap/token.h"
@@ -48,10 +52,18 @@ const EGLint kHeight = 256;
 const EGLint kDepthSize = 16;
 const EGLint kRequiredEglMinorVersionForGl = 5;
 
+const char* const kOptionCompareOnGpu = "--compare-on-gpu";
+const char* const kOptionConservativeBarriers = "--conservative-barriers";
+const char* const kOptionDumpToStdout = "--dump-to-stdout";
 const char* const kOptionPrefix = "--";
+const char* const kOptionGlErrorPolicy = "--gl-error-policy";
+const char* const kOptionMaxMismatchReports = "--max-mismatch-reports";
+const char* const kOptionPoolBuffers = "--pool-buffers";
 const char* const kOptionRequiredVendorRendererSubstring =
     "--require-vendor-renderer-substring";
+const char* const kOptionShowBufferStatistics = "--show-buffer-statistics";
 const char* const kOptionShowGlInfo = "--show-gl-info";
+const char* const kOptionWriteDiffMasks = "--write-diff-masks";
 
 class ConsoleMessageConsumer : public shadertrap::MessageConsumer {
   void Message(Severity severity, const shadertrap::Token* token,
@@ -135,6 +147,68 @@ int main(int argc, const char** argv) {
   if (args.size() < 2) {
     std::cerr << "Usage: " << args[0] + "[options] SCRIPT" << std::endl;
     std::cerr << "Options:" << std::endl;
+    std::cerr << "  " << kOptionCompareOnGpu << std::endl;
+    std::cerr << "      Make ASSERT_EQUAL compare its arguments using a "
+                 "compute shader when"
+              << std::endl;
+    std::cerr << "      possible, reading them back only if they differ."
+              << std::endl;
+    std::cerr << "  " << kOptionConservativeBarriers << std::endl;
+    std::cerr << "      Follow every compute dispatch with glFlush and a "
+                 "barrier on all memory,"
+              << std::endl;
+    std::cerr << "      instead of only the memory barriers that later "
+                 "commands need."
+              << std::endl;
+    std::cerr << "  " << kOptionDumpToStdout << std::endl;
+    std::cerr << "      Write the data dumped by DUMP_* commands, and diff "
+                 "masks, to standard"
+              << std::endl;
+    std::cerr << "      output instead of to files. Each is preceded by a "
+                 "line of the form"
+              << std::endl;
+    std::cerr << "      'SHADERTRAP_OUTPUT kind size name' and followed by a "
+                 "newline. Text"
+              << std::endl;
+    std::cerr << "      and compressed dumps have 'chunked' in place of the "
+                 "size, and are"
+              << std::endl;
+    std::cerr << "      written as pieces, each preceded by a line holding its "
+                 "size and"
+              << std::endl;
+    std::cerr << "      followed by a newline, ending with a line holding 0."
+              << std::endl;
+    std::cerr << "      The output of " << kOptionShowGlInfo << " and "
+              << kOptionShowBufferStatistics << " then goes to"
+              << std::endl;
+    std::cerr << "      standard error." << std::endl;
+    std::cerr << "  " << kOptionGlErrorPolicy
+              << " strict|per-command|debug-callback" << std::endl;
+    std::cerr << "      Controls how OpenGL errors are detected. 'strict' (the "
+                 "default) calls"
+              << std::endl;
+    std::cerr << "      glGetError after every GL call. 'per-command' calls "
+                 "glGetError once at"
+              << std::endl;
+    std::cerr << "      the end of each command. 'debug-callback' receives "
+                 "errors via a"
+              << std::endl;
+    std::cerr << "      GL_KHR_debug callback, falling back to 'per-command' "
+                 "if this is"
+              << std::endl;
+    std::cerr << "      not supported." << std::endl;
+    std::cerr << "  " << kOptionMaxMismatchReports << " count" << std::endl;
+    std::cerr << "      The number of mismatching elements or pixels that a "
+                 "failing assertion"
+              << std::endl;
+    std::cerr << "      reports individually before summarizing the rest ("
+              << shadertrap::ExecutorOptions().max_mismatch_reports
+              << " by default)." << std::endl;
+    std::cerr << "  " << kOptionPoolBuffers << std::endl;
+    std::cerr << "      Suballocate small buffers from a few large buffer "
+                 "objects, rather than"
+              << std::endl;
+    std::cerr << "      creating a buffer object for each buffer." << std::endl;
     std::cerr << "  " << kOptionRequiredVendorRendererSubstring << " string"
               << std::endl;
     std::cerr << "      Requires that at least one of the GL_VENDOR or "
@@ -144,20 +218,70 @@ int main(int argc, const char** argv) {
                  "devices until a suitable"
               << std::endl;
     std::cerr << "      device is found." << std::endl;
+    std::cerr << "  " << kOptionShowBufferStatistics << std::endl;
+    std::cerr << "      Show how many buffer objects, and how many bytes, the "
+                 "script's buffers"
+              << std::endl;
+    std::cerr << "      used once it has run." << std::endl;
     std::cerr << "  " << kOptionShowGlInfo << std::endl;
     std::cerr << "      Show GL information before running the script"
               << std::endl;
+    std::cerr << "  " << kOptionWriteDiffMasks << std::endl;
+    std::cerr << "      When an assertion on renderbuffers fails, write "
+                 "diff_mask_LINE.png, in"
+              << std::endl;
+    std::cerr << "      which mismatching pixels are white." << std::endl;
     return 1;
   }
 
+  shadertrap::ExecutorOptions executor_options;
+  bool dump_to_stdout = false;
+  bool show_buffer_statistics = false;
   bool show_gl_info = false;
+  std::string max_mismatch_reports_string;
   std::string vendor_or_renderer_substring;
+  std::string gl_error_policy_name;
   std::string script_name;
   std::string option_prefix(kOptionPrefix);
   for (size_t i = 1; i < static_cast<size_t>(argc); i++) {
     std::string argument(argv[i]);
-    if (argument == kOptionShowGlInfo) {
+    if (argument == kOptionCompareOnGpu) {
+      executor_options.compare_on_gpu = true;
+    } else if (argument == kOptionConservativeBarriers) {
+      executor_options.conservative_barriers = true;
+    } else if (argument == kOptionDumpToStdout) {
+      dump_to_stdout = true;
+    } else if (argument == kOptionPoolBuffers) {
+      executor_options.pool_buffers = true;
+    } else if (argument == kOptionShowBufferStatistics) {
+      show_buffer_statistics = true;
+    } else if (argument == kOptionShowGlInfo) {
       show_gl_info = true;
+    } else if (argument == kOptionWriteDiffMasks) {
+      executor_options.write_diff_masks = true;
+    } else if (argument == kOptionMaxMismatchReports) {
+      if (!max_mismatch_reports_string.empty()) {
+        std::cerr << "Maximum mismatch reports specified multiple times."
+                  << std::endl;
+        return 1;
+      }
+      if (i == static_cast<size_t>(argc) - 1) {
+        std::cerr << "No maximum mismatch reports specified." << std::endl;
+        return 1;
+      }
+      i++;
+      max_mismatch_reports_string = argv[i];
+    } else if (argument == kOptionGlErrorPolicy) {
+      if (!gl_error_policy_name.empty()) {
+        std::cerr << "GL error policy specified multiple times." << std::endl;
+        return 1;
+      }
+      if (i == static_cast<size_t>(argc) - 1) {
+        std::cerr << "No GL error policy specified." << std::endl;
+        return 1;
+      }
+      i++;
+      gl_error_policy_name = argv[i];
     } else if (argument == kOptionRequiredVendorRendererSubstring) {
       if (!vendor_or_renderer_substring.empty()) {
         std::cerr << "Vendor/renderer substring specified multiple times."
@@ -188,6 +312,32 @@ int main(int argc, const char** argv) {
     return 1;
   }
 
+  if (gl_error_policy_name.empty() || gl_error_policy_name == "strict") {
+    executor_options.error_policy = shadertrap::GlErrorPolicy::kStrict;
+  } else if (gl_error_policy_name == "per-command") {
+    executor_options.error_policy = shadertrap::GlErrorPolicy::kPerCommand;
+  } else if (gl_error_policy_name == "debug-callback") {
+    executor_options.error_policy =
+        shadertrap::GlErrorPolicy::kDebugCallback;
+  } else {
+    std::cerr << "Unknown GL error policy " << gl_error_policy_name
+              << std::endl;
+    return 1;
+  }
+
+  if (!max_mismatch_reports_string.empty()) {
+    const size_t kMaxDigits = 9;
+    if (max_mismatch_reports_string.length() > kMaxDigits ||
+        max_mismatch_reports_string.find_first_not_of("0123456789") !=
+            std::string::npos) {
+      std::cerr << "Invalid maximum mismatch reports "
+                << max_mismatch_reports_string << std::endl;
+      return 1;
+    }
+    executor_options.max_mismatch_reports =
+        std::stoul(max_mismatch_reports_string);
+  }
+
   auto char_data = ReadFile(script_name);
   auto data = std::string(char_data.begin(), char_data.end());
 
@@ -391,12 +541,25 @@ int main(int argc, const char** argv) {
       continue;
     }
 
+    // When dumped data is written to standard output, information is written
+    // to standard error so that it does not corrupt the framed data.
+    std::ostream& info_stream = dump_to_stdout ? std::cerr : std::cout;
     if (show_gl_info) {
-      std::cout << "GL_VENDOR: " + gl_vendor << std::endl;
-      std::cout << "GL_RENDERER: " + gl_renderer << std::endl;
-      std::cout << "GL_VERSION: " + gl_version << std::endl;
-      std::cout << "GL_SHADING_LANGUAGE_VERSION: " + gl_shading_language_version
+      info_stream << "GL_VENDOR: " + gl_vendor << std::endl;
+      info_stream << "GL_RENDERER: " + gl_renderer << std::endl;
+      info_stream << "GL_VERSION: " + gl_version << std::endl;
+      info_stream << "GL_SHADING_LANGUAGE_VERSION: " +
+                         gl_shading_language_version
+                  << std::endl;
+    }
+
+    if (executor_options.error_policy ==
+            shadertrap::GlErrorPolicy::kDebugCallback &&
+        glDebugMessageCallback == nullptr) {
+      std::cerr << "GL_KHR_debug callbacks are not available; using the "
+                   "per-command GL error policy instead."
                 << std::endl;
+      executor_options.error_policy = shadertrap::GlErrorPolicy::kPerCommand;
     }
 
     shadertrap::GlFunctions functions = shadertrap::GetGlFunctions();
@@ -404,12 +567,43 @@ int main(int argc, const char** argv) {
     std::vector<std::unique_ptr<shadertrap::CommandVisitor>> temp;
     temp.push_back(shadertrap::MakeUnique<shadertrap::Checker>(
         &message_consumer, shadertrap_program->GetApiVersion()));
-    temp.push_back(shadertrap::MakeUnique<shadertrap::Executor>(
-        &functions, &message_consumer, shadertrap_program->GetApiVersion()));
+    std::unique_ptr<shadertrap::OutputSink> output_sink;
+    if (dump_to_stdout) {
+      output_sink = shadertrap::MakeUnique<shadertrap::FramedOutputSink>(
+          &std::cout);
+    } else {
+      output_sink = shadertrap::MakeUnique<shadertrap::FileOutputSink>();
+    }
+    auto executor = shadertrap::MakeUnique<shadertrap::Executor>(
+        &functions, &message_consumer, output_sink.get(),
+        shadertrap_program->GetApiVersion(), executor_options);
+    executor->PlanPixelReadbacks(shadertrap_program.get());
+    executor->PlanRenderbufferReadbacks(shadertrap_program.get());
+    executor->PlanMemoryBarriers(shadertrap_program.get());
+    executor->PlanBufferPools(shadertrap_program.get());
+    // The compound visitor takes ownership of the executor, but it remains
+    // alive until dumped images have been written and the statistics have been
+    // shown.
+    shadertrap::Executor* executor_ptr = executor.get();
+    temp.push_back(std::move(executor));
     shadertrap::CompoundVisitor checker_and_executor(std::move(temp));
     ShInitialize();
     bool success = checker_and_executor.VisitCommands(shadertrap_program.get());
     ShFinalize();
+    // Images are written in the background, so a failure to write one is only
+    // known once they have all been written.
+    if (!executor_ptr->FlushImageWrites()) {
+      success = false;
+    }
+
+    if (show_buffer_statistics) {
+      const auto& statistics = executor_ptr->GetBufferStatistics();
+      info_stream << "Buffers: " << statistics.num_buffers << " ("
+                  << statistics.buffer_bytes << " bytes)" << std::endl;
+      info_stream << "Buffer objects: " << statistics.num_buffer_objects
+                  << " (" << statistics.buffer_object_bytes << " bytes)"
+                  << std::endl;
+    }
 
     if (!success) {
       std::cerr << "Errors occurred during execution." << std::endl;
@@ -0,0 +1,66 @@
+// Copyright 2021 The ShaderTrap Project Authors
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "libshadertrap/compressed_buffer.h"
+
+// Decompresses a buffer dumped by a DUMP_BUFFER_BINARY command with the
+// COMPRESSED option, writing the raw contents of the buffer to a file.
+int main(int argc, const char** argv) {
+  std::vector<std::string> args(argv, argv + argc);
+  if (args.size() != 3) {
+    std::cerr << "Usage: " << args[0] << " COMPRESSED_DUMP OUTPUT" << std::endl;
+    std::cerr << "Decompresses a buffer dumped by DUMP_BUFFER_BINARY with the "
+                 "COMPRESSED option."
+              << std::endl;
+    return 1;
+  }
+  std::ifstream input_file(args[1], std::ios::binary);
+  if (!input_file) {
+    std::cerr << "Could not open '" << args[1] << "'." << std::endl;
+    return 1;
+  }
+  std::ofstream output_file(args[2], std::ios::binary);
+  if (!output_file) {
+    std::cerr << "Could not open '" << args[2] << "'." << std::endl;
+    return 1;
+  }
+  // The buffer is decompressed and written a chunk at a time, so that neither
+  // the compressed nor the decompressed buffer is held in memory whole.
+  std::string error;
+  if (!shadertrap::DecompressBuffer(
+          &input_file,
+          [&output_file](const uint8_t* data, size_t size) -> bool {
+            output_file.write(reinterpret_cast<const char*>(data),
+                              static_cast<std::streamsize>(size));
+            return !output_file.fail();
+          },
+          &error)) {
+    std::cerr << "Decompressing '" << args[1] << "' failed: " << error
+              << std::endl;
+    return 1;
+  }
+  output_file.close();
+  if (!output_file) {
+    std::cerr << "Writing '" << args[2] << "' failed." << std::endl;
+    return 1;
+  }
+  return 0;
+}